@@ -0,0 +1,122 @@
+/*
+    Bloom filter benchmark.
+
+    usage: ./benchmark [keys]
+    keys defaults to 2000000.
+
+    For a few target false positive rates it fills a filter with `keys`
+    keys, then queries as many keys that were never added and reports the
+    measured false positive rate, the bits used per key and the cost of
+    single and batched add / may_contain in nanoseconds per key.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bloom_filter.h"
+
+#define KEY_SIZE 24
+
+static double elapsed_ns(clock_t start, size_t ops)
+{
+    return (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / ops;
+}
+
+static void benchmark(double fp_rate, size_t n, const void **in,
+                      const void **out, const size_t *lens, uint8_t *results)
+{
+    bloom_filter_t *single = bloom_create(n, fp_rate);
+    bloom_filter_t *batched = bloom_create(n, fp_rate);
+    if (!single || !batched)
+    {
+        printf("unable to create a filter for %g\n", fp_rate);
+        bloom_free(single);
+        bloom_free(batched);
+        return;
+    }
+
+    clock_t start = clock();
+    for (size_t i = 0; i < n; i++)
+    {
+        bloom_add(single, in[i], lens[i]);
+    }
+    double add_ns = elapsed_ns(start, n);
+
+    start = clock();
+    bloom_add_many(batched, in, lens, n);
+    double add_many_ns = elapsed_ns(start, n);
+
+    size_t positives = 0;
+    start = clock();
+    for (size_t i = 0; i < n; i++)
+    {
+        positives += bloom_may_contain(single, out[i], lens[i]);
+    }
+    double query_ns = elapsed_ns(start, n);
+
+    start = clock();
+    bloom_may_contain_many(batched, out, lens, n, results);
+    double query_many_ns = elapsed_ns(start, n);
+
+    size_t batched_positives = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        batched_positives += results[i];
+    }
+
+    double bits_per_key = (double)single->nblocks * BLOOM_BLOCK_BITS / n;
+    printf("%8g %10.5f %8.2f %4u %10.1f %10.1f %10.1f %10.1f\n", fp_rate,
+           (double)positives / n, bits_per_key, single->k, add_ns,
+           add_many_ns, query_ns, query_many_ns);
+
+    if (batched_positives != positives)
+    {
+        printf("batched and single lookups disagree\n");
+    }
+
+    bloom_free(single);
+    bloom_free(batched);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 0) : 2000000;
+    char(*keys)[KEY_SIZE] = malloc(2 * n * sizeof(*keys));
+    const void **in = malloc(n * sizeof(*in));
+    const void **out = malloc(n * sizeof(*out));
+    size_t *lens = malloc(n * sizeof(*lens));
+    uint8_t *results = malloc(n);
+    if (n == 0 || !keys || !in || !out || !lens || !results)
+    {
+        printf("unable to allocate %zu keys\n", n);
+        return 1;
+    }
+
+    // keys added and keys never added have the same lengths
+    for (size_t i = 0; i < n; i++)
+    {
+        lens[i] = (size_t)snprintf(keys[2 * i], KEY_SIZE, "user:%08zu", i);
+        snprintf(keys[2 * i + 1], KEY_SIZE, "uzer:%08zu", i);
+        in[i] = keys[2 * i];
+        out[i] = keys[2 * i + 1];
+    }
+
+    printf("%zu keys\n\n", n);
+    printf("%8s %10s %8s %4s %10s %10s %10s %10s\n", "target", "measured",
+           "bits/key", "k", "add ns", "batch ns", "query ns", "batch ns");
+
+    const double rates[] = {0.05, 0.01, 0.001, 0.0001};
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+    {
+        benchmark(rates[r], n, in, out, lens, results);
+    }
+
+    free(keys);
+    free(in);
+    free(out);
+    free(lens);
+    free(results);
+
+    return 0;
+}
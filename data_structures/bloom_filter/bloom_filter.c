@@ -0,0 +1,485 @@
+#include "bloom_filter.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BLOOM_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BLOOM_PREFETCH(p, rw) __builtin_prefetch((p), (rw), 1)
+#else
+#define BLOOM_PREFETCH(p, rw) ((void)(p))
+#endif
+
+/* file format, see bloom_save */
+#define BLOOM_MAGIC "BLOOMBLK"
+#define BLOOM_BYTE_ORDER 0x01020304u
+#define BLOOM_NAME_SIZE 16
+
+/*
+    probe bits are the top 9 bits of x = x * BLOOM_PROBE_MUL + h1, starting
+    from x = h2. (h1 + i * h2) mod 512 would be the textbook double hashing,
+    but its 2^17 probe patterns repeat so often within a block that the
+    false positive rate stops falling below about 1e-3
+*/
+#define BLOOM_PROBE_MUL 0x9e3779b97f4a7c15ULL
+#define BLOOM_PROBE_SHIFT (64 - 9)
+
+/* largest number of blocks, so that block selection fits in 64 bits */
+#define BLOOM_MAX_BLOCKS ((uint64_t)1 << 32)
+
+typedef struct
+{
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t k;
+    uint64_t nblocks;
+    uint64_t seed;
+    char h1[BLOOM_NAME_SIZE];
+    char h2[BLOOM_NAME_SIZE];
+} bloom_file_header;
+
+/* the header keeps the blocks of a mapped file on 64-byte boundaries */
+typedef char bloom_header_is_64_bytes[sizeof(bloom_file_header) == 64 ? 1 : -1];
+
+/*
+    utility function
+    murmur3 finalizer; spreads every input bit over the whole word, so that
+    the weak low bits of djb2 or sdbm do not cluster the blocks
+*/
+static uint64_t mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/*
+    utility function
+    computes the block of a key and the start and increment of its probes
+*/
+static inline void bloom_hash(const bloom_filter_t *filter, const void *key,
+                              size_t len, uint64_t *block, uint64_t *first,
+                              uint64_t *step)
+{
+    uint64_t h1 = mix(filter->h1->hash(key, len, filter->seed));
+    uint64_t h2 = mix(filter->h2->hash(key, len, filter->seed) + 1);
+
+    /* maps the high half of h1 onto [0, nblocks) without a division */
+    *block = ((h1 >> 32) * filter->nblocks) >> 32;
+    *first = h2;
+    *step = h1;
+}
+
+static inline void set_bits(uint64_t *block, uint64_t first, uint64_t step,
+                            unsigned k)
+{
+    uint64_t x = first;
+    for (unsigned i = 0; i < k; i++)
+    {
+        x = x * BLOOM_PROBE_MUL + step;
+        unsigned bit = (unsigned)(x >> BLOOM_PROBE_SHIFT);
+        block[bit / 64] |= (uint64_t)1 << (bit % 64);
+    }
+}
+
+static inline int test_bits(const uint64_t *block, uint64_t first,
+                            uint64_t step, unsigned k)
+{
+    uint64_t missing = 0;
+    uint64_t x = first;
+    for (unsigned i = 0; i < k; i++)
+    {
+        x = x * BLOOM_PROBE_MUL + step;
+        unsigned bit = (unsigned)(x >> BLOOM_PROBE_SHIFT);
+        missing |= ~block[bit / 64] & ((uint64_t)1 << (bit % 64));
+    }
+    return missing == 0;
+}
+
+/*
+    utility function
+    allocates nblocks zeroed blocks aligned to a cache line.
+    'memory' receives the pointer to free.
+*/
+static uint64_t *alloc_blocks(uint64_t nblocks, void **memory)
+{
+    unsigned char *raw = calloc(nblocks * BLOOM_BLOCK_BITS / 8 + 64, 1);
+    *memory = raw;
+    if (!raw)
+    {
+        return NULL;
+    }
+    return (uint64_t *)(raw + (64 - (uintptr_t)raw % 64) % 64);
+}
+
+bloom_filter_t *bloom_create_with_hash(uint64_t nblocks, unsigned k,
+                                       const hash_function_t *h1,
+                                       const hash_function_t *h2,
+                                       uint64_t seed)
+{
+    if (nblocks == 0 || nblocks > BLOOM_MAX_BLOCKS || k < BLOOM_MIN_K ||
+        k > BLOOM_MAX_K || !h1 || !h2)
+    {
+        return NULL;
+    }
+
+    bloom_filter_t *filter = malloc(sizeof(bloom_filter_t));
+    if (!filter)
+    {
+        return NULL;
+    }
+    filter->bits = alloc_blocks(nblocks, &filter->memory);
+    if (!filter->bits)
+    {
+        free(filter);
+        return NULL;
+    }
+    filter->nblocks = nblocks;
+    filter->k = k;
+    filter->h1 = h1;
+    filter->h2 = h2;
+    filter->seed = seed;
+    filter->mapped_size = 0;
+
+    return filter;
+}
+
+/*
+    utility function
+    expected false positive rate of a blocked filter: the number of keys in
+    a block is about Poisson distributed, and crowded blocks answer yes far
+    more often than the classic formula predicts for the average one
+*/
+static double blocked_fp_rate(double keys_per_block, unsigned k)
+{
+    double rate = 0;
+    double p = exp(-keys_per_block); /* Poisson probability of j keys */
+    double limit = keys_per_block + 10 * sqrt(keys_per_block) + 10;
+
+    for (unsigned j = 0; j <= limit; j++)
+    {
+        double unset = pow(1.0 - 1.0 / BLOOM_BLOCK_BITS, (double)j * k);
+        rate += p * pow(1.0 - unset, k);
+        p *= keys_per_block / (j + 1);
+    }
+    return rate;
+}
+
+bloom_filter_t *bloom_create(uint64_t expected_items, double fp_rate)
+{
+    if (expected_items == 0 || !(fp_rate > 0 && fp_rate < 1))
+    {
+        return NULL;
+    }
+
+    /* optimal size and probe count of a classic Bloom filter */
+    double ln2 = log(2.0);
+    double bits = ceil(-(double)expected_items * log(fp_rate) / (ln2 * ln2));
+    double nblocks = ceil(bits / BLOOM_BLOCK_BITS);
+    long k;
+
+    /* grown until blocking no longer costs more than the requested rate */
+    for (;;)
+    {
+        k = lround(nblocks * BLOOM_BLOCK_BITS / expected_items * ln2);
+        k = k < BLOOM_MIN_K ? BLOOM_MIN_K : k > BLOOM_MAX_K ? BLOOM_MAX_K : k;
+
+        if (nblocks > (double)BLOOM_MAX_BLOCKS)
+        {
+            return NULL;
+        }
+        if (blocked_fp_rate(expected_items / nblocks, (unsigned)k) <= fp_rate)
+        {
+            break;
+        }
+        nblocks = ceil(nblocks * 1.02);
+    }
+
+    return bloom_create_with_hash((uint64_t)nblocks, (unsigned)k, &hash_djb2,
+                                  &hash_sdbm, 0);
+}
+
+void bloom_add(bloom_filter_t *filter, const void *key, size_t len)
+{
+    uint64_t block;
+    uint64_t first, step;
+
+    bloom_hash(filter, key, len, &block, &first, &step);
+    set_bits(filter->bits + block * BLOOM_BLOCK_WORDS, first, step, filter->k);
+}
+
+int bloom_may_contain(const bloom_filter_t *filter, const void *key, size_t len)
+{
+    uint64_t block;
+    uint64_t first, step;
+
+    bloom_hash(filter, key, len, &block, &first, &step);
+    return test_bits(filter->bits + block * BLOOM_BLOCK_WORDS, first, step,
+                     filter->k);
+}
+
+void bloom_add_many(bloom_filter_t *filter, const void *const *keys,
+                    const size_t *lens, size_t n)
+{
+    uint64_t block[BLOOM_BATCH];
+    uint64_t first[BLOOM_BATCH], step[BLOOM_BATCH];
+
+    for (size_t i = 0; i < n; i += BLOOM_BATCH)
+    {
+        size_t batch = n - i < BLOOM_BATCH ? n - i : BLOOM_BATCH;
+
+        for (size_t j = 0; j < batch; j++)
+        {
+            bloom_hash(filter, keys[i + j], lens[i + j], &block[j], &first[j],
+                       &step[j]);
+            BLOOM_PREFETCH(filter->bits + block[j] * BLOOM_BLOCK_WORDS, 1);
+        }
+        for (size_t j = 0; j < batch; j++)
+        {
+            set_bits(filter->bits + block[j] * BLOOM_BLOCK_WORDS, first[j],
+                     step[j], filter->k);
+        }
+    }
+}
+
+void bloom_may_contain_many(const bloom_filter_t *filter,
+                            const void *const *keys, const size_t *lens,
+                            size_t n, uint8_t *results)
+{
+    uint64_t block[BLOOM_BATCH];
+    uint64_t first[BLOOM_BATCH], step[BLOOM_BATCH];
+
+    for (size_t i = 0; i < n; i += BLOOM_BATCH)
+    {
+        size_t batch = n - i < BLOOM_BATCH ? n - i : BLOOM_BATCH;
+
+        for (size_t j = 0; j < batch; j++)
+        {
+            bloom_hash(filter, keys[i + j], lens[i + j], &block[j], &first[j],
+                       &step[j]);
+            BLOOM_PREFETCH(filter->bits + block[j] * BLOOM_BLOCK_WORDS, 0);
+        }
+        for (size_t j = 0; j < batch; j++)
+        {
+            results[i + j] =
+                (uint8_t)test_bits(filter->bits + block[j] * BLOOM_BLOCK_WORDS,
+                                   first[j], step[j], filter->k);
+        }
+    }
+}
+
+int bloom_merge(bloom_filter_t *dst, const bloom_filter_t *src)
+{
+    if (dst->nblocks != src->nblocks || dst->k != src->k ||
+        dst->h1 != src->h1 || dst->h2 != src->h2 || dst->seed != src->seed)
+    {
+        return -1;
+    }
+
+    for (uint64_t i = 0; i < dst->nblocks * BLOOM_BLOCK_WORDS; i++)
+    {
+        dst->bits[i] |= src->bits[i];
+    }
+    return 0;
+}
+
+uint64_t bloom_bits_set(const bloom_filter_t *filter)
+{
+    uint64_t count = 0;
+
+    for (uint64_t i = 0; i < filter->nblocks * BLOOM_BLOCK_WORDS; i++)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        count += __builtin_popcountll(filter->bits[i]);
+#else
+        for (uint64_t word = filter->bits[i]; word; word &= word - 1)
+        {
+            count++;
+        }
+#endif
+    }
+    return count;
+}
+
+/*
+    File layout, in the byte order of the host that saved it:
+        bloom_file_header   64 bytes
+        blocks              nblocks * 64 bytes
+*/
+int bloom_save(const bloom_filter_t *filter, const char *path)
+{
+    bloom_file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BLOOM_MAGIC, sizeof(header.magic));
+    header.byte_order = BLOOM_BYTE_ORDER;
+    header.k = filter->k;
+    header.nblocks = filter->nblocks;
+    header.seed = filter->seed;
+    strncpy(header.h1, filter->h1->name, BLOOM_NAME_SIZE - 1);
+    strncpy(header.h2, filter->h2->name, BLOOM_NAME_SIZE - 1);
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        return -1;
+    }
+
+    size_t words = filter->nblocks * BLOOM_BLOCK_WORDS;
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(filter->bits, sizeof(uint64_t), words, file) == words;
+
+    return fclose(file) == 0 && ok ? 0 : -1;
+}
+
+/*
+    utility function
+    looks a hash function up by the name stored in a file
+*/
+static const hash_function_t *find_hash_function(const char name[])
+{
+    for (int i = 0; hash_functions[i]; i++)
+    {
+        if (strncmp(hash_functions[i]->name, name, BLOOM_NAME_SIZE) == 0)
+        {
+            return hash_functions[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+    utility function
+    checks a header against the size of its file and fills the shape of
+    'filter' from it. returns 0 if the header is valid otherwise -1
+*/
+static int read_header(const bloom_file_header *header, uint64_t file_size,
+                       bloom_filter_t *filter)
+{
+    if (memcmp(header->magic, BLOOM_MAGIC, sizeof(header->magic)) != 0 ||
+        header->byte_order != BLOOM_BYTE_ORDER || header->k < BLOOM_MIN_K ||
+        header->k > BLOOM_MAX_K || header->nblocks == 0 ||
+        header->nblocks > BLOOM_MAX_BLOCKS ||
+        file_size != sizeof(*header) + header->nblocks * BLOOM_BLOCK_BITS / 8 ||
+        header->h1[BLOOM_NAME_SIZE - 1] != '\0' ||
+        header->h2[BLOOM_NAME_SIZE - 1] != '\0')
+    {
+        return -1;
+    }
+
+    filter->nblocks = header->nblocks;
+    filter->k = header->k;
+    filter->seed = header->seed;
+    filter->h1 = find_hash_function(header->h1);
+    filter->h2 = find_hash_function(header->h2);
+
+    return filter->h1 && filter->h2 ? 0 : -1;
+}
+
+bloom_filter_t *bloom_load(const char *path)
+{
+    bloom_file_header header;
+    bloom_filter_t shape;
+
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (size < (long)sizeof(header) ||
+        fread(&header, sizeof(header), 1, file) != 1 ||
+        read_header(&header, (uint64_t)size, &shape) != 0)
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    bloom_filter_t *filter = bloom_create_with_hash(
+        shape.nblocks, shape.k, shape.h1, shape.h2, shape.seed);
+    size_t words = shape.nblocks * BLOOM_BLOCK_WORDS;
+    if (filter && fread(filter->bits, sizeof(uint64_t), words, file) != words)
+    {
+        bloom_free(filter);
+        filter = NULL;
+    }
+    fclose(file);
+
+    return filter;
+}
+
+bloom_filter_t *bloom_map(const char *path)
+{
+#ifdef BLOOM_HAVE_MMAP
+    struct stat info;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(bloom_file_header))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)info.st_size;
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    bloom_filter_t *filter = malloc(sizeof(bloom_filter_t));
+    if (!filter || read_header(base, size, filter) != 0)
+    {
+        free(filter);
+        munmap(base, size);
+        return NULL;
+    }
+#ifdef MADV_RANDOM
+    /* every lookup touches one block anywhere: read-ahead would be wasted */
+    madvise(base, size, MADV_RANDOM);
+#endif
+    filter->bits = (uint64_t *)((unsigned char *)base + sizeof(bloom_file_header));
+    filter->memory = base;
+    filter->mapped_size = size;
+
+    return filter;
+#else
+    return bloom_load(path);
+#endif
+}
+
+void bloom_free(bloom_filter_t *filter)
+{
+    if (!filter)
+    {
+        return;
+    }
+#ifdef BLOOM_HAVE_MMAP
+    if (filter->mapped_size)
+    {
+        munmap(filter->memory, filter->mapped_size);
+        free(filter);
+        return;
+    }
+#endif
+    free(filter->memory);
+    free(filter);
+}
@@ -0,0 +1,120 @@
+/*
+    Cache-line-blocked Bloom filter.
+
+    The bit array is split into blocks of 512 bits, one 64-byte cache line.
+    Every key sets or tests k bits inside a single block, so a lookup costs
+    at most one cache miss whatever k is. The block and the k bits are taken
+    from two hash functions of hash_functions.h by double hashing:
+    the first selects the block, then both seed a short multiply-add sequence
+    whose top 9 bits give the k bits of the block.
+
+    A filter is saved as a flat file: a 64-byte header followed by the
+    blocks exactly as they are in memory, so the file can be mapped and
+    queried in place. Filters of the same shape are merged by OR-ing their
+    bits, which gives the filter of the union of their keys.
+*/
+
+#ifndef __BLOOM_FILTER__
+#define __BLOOM_FILTER__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../hash_set/hash_functions.h"
+
+/* bits of one block, one cache line */
+#define BLOOM_BLOCK_BITS 512
+#define BLOOM_BLOCK_WORDS (BLOOM_BLOCK_BITS / 64)
+
+/* probes per key are kept between these bounds */
+#define BLOOM_MIN_K 1
+#define BLOOM_MAX_K 16
+
+/* keys hashed ahead of their probes by the batched calls */
+#define BLOOM_BATCH 16
+
+typedef struct
+{
+    /* nblocks * BLOOM_BLOCK_WORDS words, aligned to 64 bytes */
+    uint64_t *bits;
+    uint64_t nblocks;
+    unsigned k;
+
+    /* h1 selects the block, h2 the step between probes */
+    const hash_function_t *h1;
+    const hash_function_t *h2;
+    uint64_t seed;
+
+    /* allocation or private file mapping holding bits */
+    void *memory;
+    size_t mapped_size;
+} bloom_filter_t;
+
+/*
+    bloom_create: a filter sized for `expected_items` keys at a false
+    positive rate of about `fp_rate`, probing with djb2 and sdbm.
+    returns NULL if the arguments are invalid or out of memory
+*/
+bloom_filter_t *bloom_create(uint64_t expected_items, double fp_rate);
+
+/*
+    bloom_create_with_hash: a filter of `nblocks` blocks with `k` probes per
+    key, probing with the given hash functions and seed
+*/
+bloom_filter_t *bloom_create_with_hash(uint64_t nblocks, unsigned k,
+                                       const hash_function_t *h1,
+                                       const hash_function_t *h2,
+                                       uint64_t seed);
+
+void bloom_add(bloom_filter_t *, const void *key, size_t len);
+
+/*
+    bloom_may_contain: returns 0 if the key was never added,
+    1 if it probably was
+*/
+int bloom_may_contain(const bloom_filter_t *, const void *key, size_t len);
+
+/*
+    batched versions: the blocks of BLOOM_BATCH keys are computed and
+    prefetched before any of them is touched, so their cache misses overlap.
+    results[i] receives bloom_may_contain of keys[i].
+*/
+void bloom_add_many(bloom_filter_t *, const void *const *keys,
+                    const size_t *lens, size_t n);
+
+void bloom_may_contain_many(const bloom_filter_t *, const void *const *keys,
+                            const size_t *lens, size_t n, uint8_t *results);
+
+/*
+    bloom_merge: adds every key of `src` to `dst`.
+    returns 0 on success, -1 if the filters differ in size, k, hash
+    functions or seed
+*/
+int bloom_merge(bloom_filter_t *dst, const bloom_filter_t *src);
+
+/*
+    bloom_save: writes the filter to `path`.
+    returns 0 on success, -1 on error
+*/
+int bloom_save(const bloom_filter_t *, const char *path);
+
+/*
+    bloom_load: reads a filter saved by bloom_save into memory.
+    returns NULL if the file cannot be read, is not a filter of this byte
+    order or names an unknown hash function
+*/
+bloom_filter_t *bloom_load(const char *path);
+
+/*
+    bloom_map: like bloom_load, but maps the file instead of reading it.
+    the mapping is private: keys added afterwards are not written back.
+    falls back to bloom_load where mmap is not available.
+*/
+bloom_filter_t *bloom_map(const char *path);
+
+/* bloom_bits_set: number of set bits, to estimate how full a filter is */
+uint64_t bloom_bits_set(const bloom_filter_t *);
+
+void bloom_free(bloom_filter_t *);
+
+#endif
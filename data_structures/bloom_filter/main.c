@@ -0,0 +1,140 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bloom_filter.h"
+
+#define KEYS 100000
+#define KEY_SIZE 16
+
+// writes key number i of a family ("in" or "out") into key
+static size_t make_key(char key[KEY_SIZE], const char *family, unsigned i)
+{
+    return (size_t)snprintf(key, KEY_SIZE, "%s-%u", family, i);
+}
+
+static double false_positive_rate(const bloom_filter_t *filter)
+{
+    char key[KEY_SIZE];
+    unsigned positives = 0;
+
+    for (unsigned i = 0; i < KEYS; i++)
+    {
+        size_t len = make_key(key, "out", i);
+        positives += bloom_may_contain(filter, key, len);
+    }
+    return (double)positives / KEYS;
+}
+
+int main()
+{
+    char key[KEY_SIZE];
+    bloom_filter_t *filter = bloom_create(KEYS, 0.01);
+    assert(filter);
+
+    printf("%llu blocks, %u probes per key\n",
+           (unsigned long long)filter->nblocks, filter->k);
+
+    // no false negatives, and about the requested false positive rate
+    for (unsigned i = 0; i < KEYS; i++)
+    {
+        size_t len = make_key(key, "in", i);
+        bloom_add(filter, key, len);
+    }
+    for (unsigned i = 0; i < KEYS; i++)
+    {
+        size_t len = make_key(key, "in", i);
+        assert(bloom_may_contain(filter, key, len));
+    }
+    double rate = false_positive_rate(filter);
+    printf("false positive rate %.4f (target 0.01)\n", rate);
+    assert(rate < 0.015);
+
+    // the batched calls agree with the single ones
+    char(*keys)[KEY_SIZE] = malloc(KEYS * sizeof(*keys));
+    const void **pointers = malloc(KEYS * sizeof(*pointers));
+    size_t *lens = malloc(KEYS * sizeof(*lens));
+    uint8_t *results = malloc(KEYS);
+    assert(keys && pointers && lens && results);
+
+    for (unsigned i = 0; i < KEYS; i++)
+    {
+        lens[i] = make_key(keys[i], i % 2 ? "in" : "out", i);
+        pointers[i] = keys[i];
+    }
+    bloom_may_contain_many(filter, pointers, lens, KEYS, results);
+    for (unsigned i = 0; i < KEYS; i++)
+    {
+        assert(results[i] == bloom_may_contain(filter, keys[i], lens[i]));
+    }
+
+    bloom_filter_t *batched = bloom_create(KEYS, 0.01);
+    for (unsigned i = 0; i < KEYS; i++)
+    {
+        lens[i] = make_key(keys[i], "in", i);
+    }
+    bloom_add_many(batched, pointers, lens, KEYS - 3);
+    bloom_add_many(batched, pointers + KEYS - 3, lens + KEYS - 3, 3);
+    assert(memcmp(batched->bits, filter->bits,
+                  filter->nblocks * BLOOM_BLOCK_BITS / 8) == 0);
+
+    // merging two halves gives the filter of all keys
+    bloom_filter_t *low = bloom_create(KEYS, 0.01);
+    bloom_filter_t *high = bloom_create(KEYS, 0.01);
+    bloom_add_many(low, pointers, lens, KEYS / 2);
+    bloom_add_many(high, pointers + KEYS / 2, lens + KEYS / 2, KEYS - KEYS / 2);
+    assert(bloom_merge(low, high) == 0);
+    assert(memcmp(low->bits, filter->bits,
+                  filter->nblocks * BLOOM_BLOCK_BITS / 8) == 0);
+
+    bloom_filter_t *other = bloom_create_with_hash(
+        filter->nblocks, filter->k, &hash_crc32, &hash_sdbm, 0);
+    assert(bloom_merge(low, other) == -1);
+    bloom_free(other);
+
+    // saved filters load and map to the same bits
+    const char *path = "bloom_filter_test.bin";
+    assert(bloom_save(filter, path) == 0);
+
+    bloom_filter_t *loaded = bloom_load(path);
+    bloom_filter_t *mapped = bloom_map(path);
+    assert(loaded && mapped);
+    assert(loaded->k == filter->k && mapped->nblocks == filter->nblocks);
+    assert(memcmp(loaded->bits, filter->bits,
+                  filter->nblocks * BLOOM_BLOCK_BITS / 8) == 0);
+    assert(memcmp(mapped->bits, filter->bits,
+                  filter->nblocks * BLOOM_BLOCK_BITS / 8) == 0);
+    assert(bloom_bits_set(mapped) == bloom_bits_set(filter));
+
+    // adding to a mapped filter leaves the file unchanged
+    size_t len = make_key(key, "extra", 0);
+    bloom_add(mapped, key, len);
+    assert(bloom_may_contain(mapped, key, len));
+    bloom_free(loaded);
+    loaded = bloom_load(path);
+    assert(memcmp(loaded->bits, filter->bits,
+                  filter->nblocks * BLOOM_BLOCK_BITS / 8) == 0);
+
+    // a file that is not a filter is refused
+    FILE *file = fopen(path, "r+b");
+    fputc('X', file);
+    fclose(file);
+    assert(bloom_load(path) == NULL && bloom_map(path) == NULL);
+    remove(path);
+
+    printf("all tests passed\n");
+
+    bloom_free(loaded);
+    bloom_free(mapped);
+    bloom_free(low);
+    bloom_free(high);
+    bloom_free(batched);
+    bloom_free(filter);
+    free(keys);
+    free(pointers);
+    free(lens);
+    free(results);
+
+    return 0;
+}
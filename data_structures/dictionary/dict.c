@@ -1,25 +1,49 @@
 #include "dict.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-/* simple constructor */
+/*
+    utility function
+    allocates an empty bucket array of 'size' buckets
+    returns 0 if allocation was sucessful otherwise -1
+*/
+static int init_table(DictTable *table, size_t size)
+{
+    table->buckets = calloc(size, sizeof(DictEntry *));
+    table->size = table->buckets ? size : 0;
+    table->used = 0;
+
+    return table->buckets ? 0 : -1;
+}
+
+/* simple constructor, hashing with mix64 under a random seed */
 Dictionary *create_dict(void)
+{
+    return create_dict_with_hash(&hash_mix64, hash_random_seed());
+}
+
+Dictionary *create_dict_with_hash(const hash_function_t *hash_function,
+                                  uint64_t seed)
 {
     Dictionary *p_dic = malloc(sizeof(Dictionary));
-    if (p_dic)
+    if (p_dic && init_table(&p_dic->tables[0], DICT_INITIAL_SIZE) == 0)
     {
+        p_dic->tables[1].buckets = NULL;
+        p_dic->tables[1].size = 0;
+        p_dic->tables[1].used = 0;
+        p_dic->rehash_index = -1;
+        p_dic->indexed = NULL;
+        p_dic->indexed_capacity = 0;
         p_dic->number_of_elements = 0;
-
-        /* initializes the elemens of the array with NULL-pointer */
-        for (int i = 0; i < MAXELEMENTS; i++)
-        {
-            p_dic->elements[i] = NULL;
-        }
+        p_dic->hash_function = hash_function;
+        p_dic->seed = seed;
 
         return p_dic;
     }
     else
     {
+        free(p_dic);
         printf("unable to create a dictionary\n");
         return NULL;
     }
@@ -27,46 +51,182 @@ Dictionary *create_dict(void)
 
 /*
     utility function
-    sdbm hash algorithm
     returns a hashcode for the given string 's'
+    computed with the hash function of the dictionary
 */
-int get_hash(char s[])
+static uint64_t get_hash(const Dictionary *dic, const char s[])
 {
-    unsigned int hash_code = 0;
+    return dic->hash_function->hash(s, strlen(s), dic->seed);
+}
+
+/*
+    utility function
+    moves up to 'steps' non-empty buckets of tables[0] into tables[1],
+    looking at no more than 10 empty buckets per step.
+    finishes the growth once tables[0] is empty.
+*/
+static void rehash_step(Dictionary *dic, int steps)
+{
+    DictTable *from = &dic->tables[0];
+    DictTable *to = &dic->tables[1];
+    int empty_visits = steps * 10;
+
+    if (dic->rehash_index < 0)
+    {
+        return;
+    }
+
+    while (steps-- > 0 && from->used > 0)
+    {
+        while (from->buckets[dic->rehash_index] == NULL)
+        {
+            dic->rehash_index++;
+            if (--empty_visits == 0)
+            {
+                return;
+            }
+        }
+
+        DictEntry *entry = from->buckets[dic->rehash_index];
+        while (entry)
+        {
+            DictEntry *next = entry->next;
+            size_t bucket = entry->hash & (to->size - 1);
 
-    /* iterates over string at each character */
-    for (int counter = 0; s[counter] != '\0'; counter++)
+            entry->next = to->buckets[bucket];
+            to->buckets[bucket] = entry;
+            from->used--;
+            to->used++;
+            entry = next;
+        }
+        from->buckets[dic->rehash_index++] = NULL;
+    }
+
+    if (from->used == 0)
     {
-        /* actual computing of the hash code */
-        hash_code =
-            s[counter] + (hash_code << 6) + (hash_code << 16) - hash_code;
+        free(from->buckets);
+        *from = *to;
+        to->buckets = NULL;
+        to->size = 0;
+        to->used = 0;
+        dic->rehash_index = -1;
     }
+}
 
-    /* % modulo is for fitting the index in array. */
-    return hash_code % MAXELEMENTS;
+/*
+    utility function
+    returns the address of the link pointing to the entry of 'label'
+    and stores the table holding it in 'owner' (if not NULL),
+    or returns NULL if the label is not in the dictionary
+*/
+static DictEntry **find_entry(Dictionary *dic, const char label[],
+                              uint64_t hash, DictTable **owner)
+{
+    for (int t = 0; t < 2; t++)
+    {
+        DictTable *table = &dic->tables[t];
+        if (table->size == 0)
+        {
+            break;
+        }
+
+        DictEntry **link = &table->buckets[hash & (table->size - 1)];
+        while (*link)
+        {
+            if ((*link)->hash == hash && strcmp((*link)->label, label) == 0)
+            {
+                if (owner)
+                {
+                    *owner = table;
+                }
+                return link;
+            }
+            link = &(*link)->next;
+        }
+
+        if (dic->rehash_index < 0)
+        {
+            break;
+        }
+    }
+
+    return NULL;
 }
 
 int add_item_label(Dictionary *dic, char label[], void *item)
 {
-    unsigned int index = get_hash(label);
+    uint64_t hash = get_hash(dic, label);
+
+    rehash_step(dic, DICT_REHASH_STEP);
 
-    /* make sure index is fitting */
-    if (index < MAXELEMENTS)
+    DictEntry **link = find_entry(dic, label, hash, NULL);
+    if (link)
     {
-        dic->elements[index] = item;
+        (*link)->item = item;
         return 0;
     }
 
-    /* error case */
-    return -1;
+    /* start growing once there are as many labels as buckets */
+    if (dic->rehash_index < 0 && dic->tables[0].used >= dic->tables[0].size)
+    {
+        if (init_table(&dic->tables[1], dic->tables[0].size << 1) == 0)
+        {
+            dic->rehash_index = 0;
+        }
+    }
+
+    size_t length = strlen(label) + 1;
+    DictEntry *entry = malloc(sizeof(DictEntry) + length);
+    if (!entry)
+    {
+        /* error case */
+        return -1;
+    }
+    entry->hash = hash;
+    entry->item = item;
+    memcpy(entry->label, label, length);
+
+    /* while growing, new labels go straight into the new table */
+    DictTable *table = &dic->tables[dic->rehash_index < 0 ? 0 : 1];
+    size_t bucket = hash & (table->size - 1);
+    entry->next = table->buckets[bucket];
+    table->buckets[bucket] = entry;
+    table->used++;
+    dic->number_of_elements++;
+
+    return 0;
 }
 
 int add_item_index(Dictionary *dic, int index, void *item)
 {
+    if (index < 0)
+    {
+        return -1;
+    }
+
+    if (index >= dic->indexed_capacity)
+    {
+        int capacity = dic->indexed_capacity ? dic->indexed_capacity : 16;
+        while (capacity <= index)
+        {
+            capacity <<= 1;
+        }
+
+        void **indexed = realloc(dic->indexed, capacity * sizeof(void *));
+        if (!indexed)
+        {
+            return -1;
+        }
+        memset(indexed + dic->indexed_capacity, 0,
+               (capacity - dic->indexed_capacity) * sizeof(void *));
+        dic->indexed = indexed;
+        dic->indexed_capacity = capacity;
+    }
+
     /* make sure whether this place is already given */
-    if (!dic->elements[index])
+    if (!dic->indexed[index])
     {
-        dic->elements[index] = item;
+        dic->indexed[index] = item;
         return 0;
     }
 
@@ -76,10 +236,14 @@ int add_item_index(Dictionary *dic, int index, void *item)
 
 void *get_element_label(Dictionary *dict, char s[])
 {
-    int index = get_hash(s);
-    if (dict->elements[index])
+    uint64_t hash = get_hash(dict, s);
+
+    rehash_step(dict, DICT_REHASH_STEP);
+
+    DictEntry **link = find_entry(dict, s, hash, NULL);
+    if (link)
     {
-        return dict->elements[index];
+        return (*link)->item;
     }
 
     printf("None entry at given label\n");
@@ -88,13 +252,75 @@ void *get_element_label(Dictionary *dict, char s[])
 
 void *get_element_index(Dictionary *dict, int index)
 {
-    if (index >= 0 && index < MAXELEMENTS)
+    if (index < 0)
     {
-        return dict->elements[index];
+        printf("index out of bounds!\n");
+        return NULL;
     }
 
-    printf("index out of bounds!\n");
-    return NULL;
+    return index < dict->indexed_capacity ? dict->indexed[index] : NULL;
 }
 
-void destroy(Dictionary *dict) { free(dict); }
\ No newline at end of file
+int remove_item_label(Dictionary *dic, char label[])
+{
+    uint64_t hash = get_hash(dic, label);
+
+    rehash_step(dic, DICT_REHASH_STEP);
+
+    DictTable *table;
+    DictEntry **link = find_entry(dic, label, hash, &table);
+    if (!link)
+    {
+        return -1;
+    }
+
+    DictEntry *entry = *link;
+    *link = entry->next;
+    free(entry);
+    table->used--;
+    dic->number_of_elements--;
+
+    return 0;
+}
+
+void for_each_item(Dictionary *dict,
+                   void (*visit)(const char *label, void *item, void *context),
+                   void *context)
+{
+    for (int t = 0; t < 2; t++)
+    {
+        DictTable *table = &dict->tables[t];
+
+        for (size_t i = 0; i < table->size; i++)
+        {
+            for (DictEntry *entry = table->buckets[i]; entry;
+                 entry = entry->next)
+            {
+                visit(entry->label, entry->item, context);
+            }
+        }
+    }
+}
+
+void destroy(Dictionary *dict)
+{
+    for (int t = 0; t < 2; t++)
+    {
+        DictTable *table = &dict->tables[t];
+
+        for (size_t i = 0; i < table->size; i++)
+        {
+            DictEntry *entry = table->buckets[i];
+            while (entry)
+            {
+                DictEntry *next = entry->next;
+                free(entry);
+                entry = next;
+            }
+        }
+        free(table->buckets);
+    }
+
+    free(dict->indexed);
+    free(dict);
+}
@@ -2,13 +2,46 @@
     author: Christian Bender
     public interface for the dictionary.
 
-    The dictionary prepares space for 1000 elements.
+    Labels are copied into the dictionary and kept in a chained hash
+    table that grows without limit. Growing is incremental: the buckets
+    of the old table are moved a few at a time by every later operation,
+    so no single insert pays for rehashing the whole dictionary.
 */
 
 #ifndef __DICT__H
 #define __DICT__H
 
-#define MAXELEMENTS 1000
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../hash_set/hash_functions.h"
+
+/* number of buckets of a new dictionary */
+#define DICT_INITIAL_SIZE 16
+
+/* buckets moved to the new table per operation while growing */
+#define DICT_REHASH_STEP 1
+
+/*
+    one label of the dictionary, the label is stored inline
+*/
+typedef struct DictEntry
+{
+    struct DictEntry *next;
+    uint64_t hash;
+    void *item;
+    char label[];
+} DictEntry;
+
+/*
+    bucket array; 'size' is always a power of two
+*/
+typedef struct DictTable
+{
+    DictEntry **buckets;
+    size_t size;
+    size_t used;
+} DictTable;
 
 /*
     special data type called 'Dictionary'
@@ -17,26 +50,44 @@
 typedef struct Dict
 {
     /*
-        void* array for generic use of the dictionary.
-        there actual saves the entries.
+        tables[0] holds the entries, tables[1] is only in use while
+        growing: then buckets below 'rehash_index' of tables[0] have
+        already been moved to it.
     */
-    void *elements[MAXELEMENTS];
+    DictTable tables[2];
+    long rehash_index;
 
-    /* contains the number of elements in this dictionary */
+    /* items added with add_item_index, independent of the labels */
+    void **indexed;
+    int indexed_capacity;
+
+    /* contains the number of labels in this dictionary */
     int number_of_elements;
 
+    /* hash function and seed used to place labels */
+    const hash_function_t *hash_function;
+    uint64_t seed;
+
 } Dictionary;
 
 /*
     create_dict: is a simple constructor for creating
                 a dictionary and setting up the
                 member field 'number_of_elements'
-                and prepares the inner array 'elements'
+                and prepares the inner hash table
 */
 Dictionary *create_dict(void);
 
 /*
-    add_item_label: adds item (void*) to the dictionary at given label
+    create_dict_with_hash: like create_dict but places labels with the
+                given hash function and seed instead of mix64 under a
+                random seed; pass keyed blake2b for untrusted labels
+*/
+Dictionary *create_dict_with_hash(const hash_function_t *, uint64_t seed);
+
+/*
+    add_item_label: adds item (void*) to the dictionary at given label,
+    replacing the item of an existing equal label
     returns 0 if adding was sucessful otherwise -1
 */
 int add_item_label(Dictionary *, char label[], void *);
@@ -57,9 +108,23 @@ void *get_element_label(Dictionary *, char[]);
 */
 void *get_element_index(Dictionary *, int);
 
+/*
+    remove_item_label: removes the given label from the dictionary
+    returns 0 if the label was found otherwise -1
+*/
+int remove_item_label(Dictionary *, char label[]);
+
+/*
+    for_each_item: calls 'visit' once for every label and its item.
+    the dictionary must not be modified from inside 'visit'.
+*/
+void for_each_item(Dictionary *,
+                   void (*visit)(const char *label, void *item, void *context),
+                   void *context);
+
 /*
     simple destrcutor function
 */
 void destroy(Dictionary *);
 
-#endif
\ No newline at end of file
+#endif
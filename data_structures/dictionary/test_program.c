@@ -3,11 +3,21 @@
     This is a simple test program for the dictionary.
 */
 
+#include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 /* includes the dictionary */
 #include "dict.h"
 
+/* counts the visited labels, used with for_each_item */
+static void count_item(const char *label, void *item, void *context)
+{
+    (void)label;
+    (void)item;
+    (*(int *)context)++;
+}
+
 int main(void)
 {
     Dictionary *testObj1;
@@ -45,5 +55,42 @@ int main(void)
     destroy(testObj1);
     destroy(testObj2);
 
+    /*
+        many labels: every one must survive collisions and growing,
+        removed labels must disappear and iteration must see the rest
+    */
+    const int count = 200000;
+    char label[32];
+    int *numbers = malloc(count * sizeof(int));
+    Dictionary *big = create_dict_with_hash(&hash_mix64, 12345);
+
+    for (int i = 0; i < count; i++)
+    {
+        numbers[i] = i;
+        snprintf(label, sizeof(label), "label-%d", i);
+        assert(add_item_label(big, label, &numbers[i]) == 0);
+    }
+    assert(big->number_of_elements == count);
+
+    for (int i = 0; i < count; i += 2)
+    {
+        snprintf(label, sizeof(label), "label-%d", i);
+        assert(remove_item_label(big, label) == 0);
+        assert(remove_item_label(big, label) == -1);
+    }
+    for (int i = 1; i < count; i += 2)
+    {
+        snprintf(label, sizeof(label), "label-%d", i);
+        assert(*(int *)get_element_label(big, label) == i);
+    }
+
+    int visited = 0;
+    for_each_item(big, count_item, &visited);
+    assert(visited == count / 2 && big->number_of_elements == count / 2);
+    printf("%d labels kept after removing every second one\n", visited);
+
+    destroy(big);
+    free(numbers);
+
     return 0;
 }
\ No newline at end of file
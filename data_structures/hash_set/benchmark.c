@@ -0,0 +1,164 @@
+/*
+    Hash function benchmark for hash_set.
+
+    usage: ./benchmark [word list] [seed]
+    The word list defaults to ../trie/dictionary.txt (one word per line).
+
+    For every entry of hash_functions[] it reports the number of keys
+    sharing a bucket of a power-of-two table with at least one bucket per
+    key, the mean and longest probe distance inside hash_set and the
+    insert / lookup cost in nanoseconds per key.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hash_set.h"
+
+#define LOOKUP_ROUNDS 5
+
+static char *read_words(const char *path, char ***words, unsigned *count)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = malloc(size + 1);
+    if (!text || fread(text, 1, size, file) != (size_t)size)
+    {
+        free(text);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    text[size] = '\0';
+
+    unsigned n = 0;
+    for (long i = 0; i < size; i++)
+    {
+        if (text[i] == '\n')
+        {
+            n++;
+        }
+    }
+
+    *words = malloc((n + 1) * sizeof(char *));
+    *count = 0;
+    for (char *line = strtok(text, "\r\n"); line; line = strtok(NULL, "\r\n"))
+    {
+        (*words)[(*count)++] = line;
+    }
+
+    return text;
+}
+
+static double elapsed_ns(clock_t start, unsigned ops)
+{
+    return (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / ops;
+}
+
+static void benchmark(const hash_function_t *function, uint64_t seed,
+                      char **words, unsigned n)
+{
+    unsigned buckets = 1;
+    while (buckets < n)
+    {
+        buckets <<= 1;
+    }
+
+    unsigned char *used = calloc(buckets, 1);
+    unsigned collisions = 0;
+    for (unsigned i = 0; i < n; i++)
+    {
+        long long h = (long long)function->hash(words[i], strlen(words[i]),
+                                                seed);
+        unsigned bucket = retrieve_index_from_hash(h, buckets);
+
+        collisions += used[bucket];
+        used[bucket] = 1;
+    }
+    free(used);
+
+    hash_set_t *set = init_hash_set_with_hash(function, seed);
+
+    clock_t start = clock();
+    for (unsigned i = 0; i < n; i++)
+    {
+        add(set, words[i]);
+    }
+    double insert_ns = elapsed_ns(start, n);
+
+    unsigned found = 0;
+    start = clock();
+    for (int round = 0; round < LOOKUP_ROUNDS; round++)
+    {
+        for (unsigned i = 0; i < n; i++)
+        {
+            found += contains(set, words[i]);
+        }
+    }
+    double lookup_ns = elapsed_ns(start, n * LOOKUP_ROUNDS);
+
+    unsigned long long probes = 0;
+    unsigned longest = 0;
+    unsigned mask = set->capacity - 1;
+    for (unsigned slot = 0; slot < set->capacity; slot++)
+    {
+        if (set->ctrl[slot] != HASH_SET_EMPTY)
+        {
+            unsigned distance = (slot - set->table[slot].hash) & mask;
+
+            probes += distance;
+            longest = distance > longest ? distance : longest;
+        }
+    }
+
+    printf("%-8s %10u %12u %10.3f %10u %12.1f %12.1f\n", function->name,
+           set->length, collisions, (double)probes / set->length, longest,
+           insert_ns, lookup_ns);
+
+    if (found != set->length * LOOKUP_ROUNDS)
+    {
+        printf("lookup mismatch for %s\n", function->name);
+    }
+
+    free_hash_set(set);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = argc > 1 ? argv[1] : "../trie/dictionary.txt";
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 0) : 0;
+    char **words;
+    unsigned n;
+
+    char *text = read_words(path, &words, &n);
+    if (!text)
+    {
+        printf("unable to read %s\n", path);
+        return 1;
+    }
+
+    printf("%u words from %s, seed %llu\n\n", n, path,
+           (unsigned long long)seed);
+    printf("%-8s %10s %12s %10s %10s %12s %12s\n", "hash", "keys",
+           "collisions", "mean probe", "max probe", "insert ns", "lookup ns");
+
+    for (int i = 0; hash_functions[i]; i++)
+    {
+        benchmark(hash_functions[i], seed, words, n);
+    }
+
+    free(words);
+    free(text);
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+    Scaling benchmark for concurrent_hash_set.
+
+    usage: ./concurrent_benchmark [max threads] [keys]
+    max threads defaults to 16, keys to 1000000.
+
+    For 1, 2, 4, ... max threads it reports the total lookup rate on a
+    set filled with `keys` keys, and the rate of a mix of 90% lookups and
+    10% delete / add pairs. Every thread runs the same number of operations,
+    so perfect scaling doubles the rate with the thread count up to the
+    number of cores.
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "concurrent_hash_set.h"
+
+#define OPS_PER_THREAD 2000000
+#define KEY_SIZE 16
+
+typedef struct
+{
+    unsigned id;
+    unsigned write_percent;
+    unsigned found;
+} worker_t;
+
+static concurrent_hash_set_t *set;
+static char (*words)[KEY_SIZE];
+static unsigned key_count;
+static pthread_barrier_t start_line;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *work(void *arg)
+{
+    worker_t *worker = arg;
+    // xorshift, seeded per thread
+    uint32_t x = 2463534242u + worker->id * 2654435761u;
+    unsigned found = 0;
+
+    pthread_barrier_wait(&start_line);
+
+    for (unsigned i = 0; i < OPS_PER_THREAD; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        char *key = words[x % key_count];
+
+        if (x / key_count % 100 < worker->write_percent)
+        {
+            concurrent_delete(set, key);
+            concurrent_add(set, key);
+        }
+        else
+        {
+            found += concurrent_contains(set, key);
+        }
+    }
+
+    worker->found = found;
+    return NULL;
+}
+
+// returns millions of operations per second over all threads
+static double run(unsigned threads, unsigned write_percent)
+{
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    worker_t *workers = malloc(threads * sizeof(worker_t));
+
+    pthread_barrier_init(&start_line, NULL, threads + 1);
+    for (unsigned t = 0; t < threads; t++)
+    {
+        workers[t].id = t;
+        workers[t].write_percent = write_percent;
+        pthread_create(&ids[t], NULL, work, &workers[t]);
+    }
+
+    pthread_barrier_wait(&start_line);
+    double start = now();
+    for (unsigned t = 0; t < threads; t++)
+    {
+        pthread_join(ids[t], NULL);
+    }
+    double seconds = now() - start;
+
+    pthread_barrier_destroy(&start_line);
+    free(ids);
+    free(workers);
+
+    return (double)threads * OPS_PER_THREAD / seconds / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned max_threads = argc > 1 ? (unsigned)atoi(argv[1]) : 16;
+    key_count = argc > 2 ? (unsigned)atoi(argv[2]) : 1000000;
+    if (max_threads == 0 || key_count == 0)
+    {
+        printf("usage: %s [max threads] [keys]\n", argv[0]);
+        return 1;
+    }
+
+    set = init_concurrent_hash_set(0);
+    words = malloc((size_t)key_count * KEY_SIZE);
+    if (!set || !words)
+    {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    for (unsigned i = 0; i < key_count; i++)
+    {
+        snprintf(words[i], KEY_SIZE, "key%u", i);
+        concurrent_add(set, words[i]);
+    }
+
+    printf("%u keys, %u shards, %u operations per thread\n\n", key_count,
+           set->shard_count, OPS_PER_THREAD);
+    printf("%8s %14s %10s %14s %10s\n", "threads", "lookup Mops/s", "speedup",
+           "10% write", "speedup");
+
+    double lookup_base = 0, mixed_base = 0;
+    for (unsigned threads = 1; threads <= max_threads; threads <<= 1)
+    {
+        double lookup = run(threads, 0);
+        double mixed = run(threads, 10);
+        if (threads == 1)
+        {
+            lookup_base = lookup;
+            mixed_base = mixed;
+        }
+
+        printf("%8u %14.2f %10.2f %14.2f %10.2f\n", threads, lookup,
+               lookup / lookup_base, mixed, mixed / mixed_base);
+    }
+
+    free_concurrent_hash_set(set);
+    free(words);
+
+    return 0;
+}
@@ -0,0 +1,472 @@
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "concurrent_hash_set.h"
+
+// address stored in a deleted slot; probes continue past it
+static char tombstone_value;
+#define TOMBSTONE ((void *)&tombstone_value)
+
+// murmur3 finalizer: the shard comes from the high bits, the slot from the low
+static uint64_t mix_hash(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static uint64_t hash_value(const concurrent_hash_set_t *set, void *value)
+{
+    return mix_hash(
+        set->hash_function->hash(value, strlen(value), set->seed));
+}
+
+static concurrent_shard_t *shard_of(const concurrent_hash_set_t *set,
+                                    uint64_t hash)
+{
+    return &set->shards[(hash >> 32) & (set->shard_count - 1)];
+}
+
+static concurrent_table_t *create_table(unsigned capacity)
+{
+    concurrent_table_t *table = malloc(sizeof(concurrent_table_t));
+    if (!table)
+    {
+        return NULL;
+    }
+
+    table->capacity = capacity;
+    table->hashes = malloc(capacity * sizeof(uint32_t));
+    table->keys = malloc(capacity * sizeof(_Atomic(void *)));
+
+    if (!table->hashes || !table->keys)
+    {
+        free(table->hashes);
+        free(table->keys);
+        free(table);
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < capacity; i++)
+    {
+        atomic_init(&table->keys[i], NULL);
+    }
+
+    return table;
+}
+
+static void free_table(concurrent_table_t *table)
+{
+    if (table)
+    {
+        free(table->hashes);
+        free(table->keys);
+        free(table);
+    }
+}
+
+/*
+    Epoch based reclamation of retired tables, shared by every set.
+
+    Each thread that looks up gets a reader slot of its own, on its own
+    cache line. A lookup stores the current global epoch in its slot before
+    it loads a table and 0 once it is done, so lookups only ever write their
+    own slot. Slots are never freed: a thread that exits hands its slot to
+    the next thread that looks up.
+*/
+typedef struct reader_slot
+{
+    _Alignas(64) atomic_uint_fast64_t epoch; // 0 outside of a lookup
+    atomic_int in_use;
+    struct reader_slot *next;
+} reader_slot_t;
+
+static atomic_uint_fast64_t global_epoch = 1;
+static _Atomic(reader_slot_t *) reader_slots;
+static _Thread_local reader_slot_t *own_slot;
+static pthread_key_t slot_key;
+static pthread_once_t slot_key_once = PTHREAD_ONCE_INIT;
+
+// thread exit: the slot is idle, so the next thread may take it over
+static void release_slot(void *slot)
+{
+    atomic_store(&((reader_slot_t *)slot)->in_use, 0);
+}
+
+static void create_slot_key(void)
+{
+    pthread_key_create(&slot_key, release_slot);
+}
+
+// returns the reader slot of the calling thread, or NULL if out of memory
+static reader_slot_t *reader_slot(void)
+{
+    if (own_slot)
+    {
+        return own_slot;
+    }
+    pthread_once(&slot_key_once, create_slot_key);
+
+    reader_slot_t *slot = atomic_load(&reader_slots);
+    for (; slot; slot = slot->next)
+    {
+        int idle = 0;
+        if (atomic_compare_exchange_strong(&slot->in_use, &idle, 1))
+        {
+            break;
+        }
+    }
+
+    if (!slot)
+    {
+        slot = aligned_alloc(_Alignof(reader_slot_t), sizeof(reader_slot_t));
+        if (!slot)
+        {
+            return NULL;
+        }
+        atomic_init(&slot->epoch, 0);
+        atomic_init(&slot->in_use, 1);
+        slot->next = atomic_load(&reader_slots);
+        while (!atomic_compare_exchange_weak(&reader_slots, &slot->next, slot))
+        {
+        }
+    }
+
+    pthread_setspecific(slot_key, slot);
+    own_slot = slot;
+    return slot;
+}
+
+/*
+    called by a writer after it published a new table. A lookup that may
+    still walk the old table stored its epoch before that store, so it
+    announced an epoch below the one started here; lookups that announce
+    this epoch or a later one load the new table.
+*/
+static void wait_for_readers(void)
+{
+    uint64_t epoch = atomic_fetch_add(&global_epoch, 1) + 1;
+
+    for (reader_slot_t *slot = atomic_load(&reader_slots); slot;
+         slot = slot->next)
+    {
+        for (;;)
+        {
+            uint64_t seen = atomic_load(&slot->epoch);
+            if (seen == 0 || seen >= epoch)
+            {
+                break;
+            }
+            sched_yield();
+        }
+    }
+}
+
+/*
+    returns the slot holding value, or capacity if it is absent.
+    with `insert_slot` set, also reports the first slot an insertion of
+    value may reuse (a tombstone or the empty slot ending the probe)
+*/
+static unsigned find_slot(const concurrent_table_t *table, uint32_t hash,
+                          void *value, unsigned *insert_slot)
+{
+    unsigned mask = table->capacity - 1;
+    unsigned slot = hash & mask;
+    unsigned free_slot = table->capacity;
+
+    for (;;)
+    {
+        void *key = atomic_load_explicit(&table->keys[slot],
+                                         memory_order_acquire);
+        if (key == value)
+        {
+            return slot;
+        }
+        if (key == NULL || key == TOMBSTONE)
+        {
+            if (free_slot == table->capacity)
+            {
+                free_slot = slot;
+            }
+            if (key == NULL)
+            {
+                break;
+            }
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (insert_slot)
+    {
+        *insert_slot = free_slot;
+    }
+    return table->capacity;
+}
+
+/*
+    utility function, called with the shard locked.
+    copies the live entries into a new table sized for one more entry,
+    publishes it and frees the old table once no lookup can reach it
+*/
+static int rebuild_shard(concurrent_shard_t *shard, concurrent_table_t *old)
+{
+    unsigned live = atomic_load_explicit(&shard->live, memory_order_relaxed);
+    unsigned capacity = old->capacity;
+
+    // plenty of tombstones: rebuilding at the same size is enough
+    while ((unsigned long long)(live + 1) * SHARD_MAX_LOAD_DEN * 2 >
+           (unsigned long long)capacity * SHARD_MAX_LOAD_NUM)
+    {
+        capacity <<= 1;
+    }
+
+    concurrent_table_t *table = create_table(capacity);
+    if (!table)
+    {
+        return -1;
+    }
+
+    unsigned mask = capacity - 1;
+    for (unsigned i = 0; i < old->capacity; i++)
+    {
+        void *key = atomic_load_explicit(&old->keys[i], memory_order_relaxed);
+        if (key == NULL || key == TOMBSTONE)
+        {
+            continue;
+        }
+
+        unsigned slot = old->hashes[i] & mask;
+        while (atomic_load_explicit(&table->keys[slot],
+                                    memory_order_relaxed) != NULL)
+        {
+            slot = (slot + 1) & mask;
+        }
+        table->hashes[slot] = old->hashes[i];
+        atomic_store_explicit(&table->keys[slot], key, memory_order_relaxed);
+    }
+
+    shard->used = live;
+    // seq_cst: a reader that sees the new table also sees its slots, and
+    // the store is ordered before wait_for_readers() reads the slots
+    atomic_store(&shard->table, table);
+
+    wait_for_readers();
+    free_table(old);
+
+    return 0;
+}
+
+extern concurrent_hash_set_t *init_concurrent_hash_set(unsigned shard_count)
+{
+    return init_concurrent_hash_set_with_hash(shard_count, &hash_mix64,
+                                              hash_random_seed());
+}
+
+extern concurrent_hash_set_t *
+init_concurrent_hash_set_with_hash(unsigned shard_count,
+                                   const hash_function_t *hash_function,
+                                   uint64_t seed)
+{
+    if (shard_count == 0)
+    {
+        shard_count = DEFAULT_CONCURRENT_SHARDS;
+    }
+    unsigned shards = 1;
+    while (shards < shard_count && shards < (1u << 31))
+    {
+        shards <<= 1;
+    }
+
+    concurrent_hash_set_t *set = malloc(sizeof(concurrent_hash_set_t));
+    if (!set)
+    {
+        return NULL;
+    }
+
+    set->shard_count = shards;
+    set->hash_function = hash_function;
+    set->seed = seed;
+    set->shards = aligned_alloc(_Alignof(concurrent_shard_t),
+                                shards * sizeof(concurrent_shard_t));
+    if (!set->shards)
+    {
+        free(set);
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < shards; i++)
+    {
+        concurrent_shard_t *shard = &set->shards[i];
+        concurrent_table_t *table = create_table(DEFAULT_SHARD_CAPACITY);
+
+        pthread_mutex_init(&shard->lock, NULL);
+        shard->used = 0;
+        atomic_init(&shard->live, 0);
+        atomic_init(&shard->table, table);
+
+        if (!table)
+        {
+            set->shard_count = i + 1;
+            free_concurrent_hash_set(set);
+            return NULL;
+        }
+    }
+
+    return set;
+}
+
+// concurrent_add with the shard of hash locked
+static unsigned add_locked(concurrent_shard_t *shard, uint64_t hash,
+                           void *value)
+{
+    concurrent_table_t *table =
+        atomic_load_explicit(&shard->table, memory_order_relaxed);
+    unsigned slot;
+
+    if (find_slot(table, (uint32_t)hash, value, &slot) != table->capacity)
+    {
+        return 0;
+    }
+
+    // only a fresh empty slot adds to the load; a reused tombstone does not
+    void *previous =
+        atomic_load_explicit(&table->keys[slot], memory_order_relaxed);
+    if (previous == NULL &&
+        (unsigned long long)(shard->used + 1) * SHARD_MAX_LOAD_DEN >
+            (unsigned long long)table->capacity * SHARD_MAX_LOAD_NUM)
+    {
+        if (rebuild_shard(shard, table) != 0)
+        {
+            return 0;
+        }
+        table = atomic_load_explicit(&shard->table, memory_order_relaxed);
+        find_slot(table, (uint32_t)hash, value, &slot);
+        previous =
+            atomic_load_explicit(&table->keys[slot], memory_order_relaxed);
+    }
+
+    table->hashes[slot] = (uint32_t)hash;
+    // release: the hash is in place before the key becomes visible
+    atomic_store_explicit(&table->keys[slot], value, memory_order_release);
+    if (previous == NULL)
+    {
+        shard->used++;
+    }
+    atomic_fetch_add_explicit(&shard->live, 1, memory_order_relaxed);
+
+    return 1;
+}
+
+unsigned concurrent_add(concurrent_hash_set_t *set, void *value)
+{
+    uint64_t hash = hash_value(set, value);
+    concurrent_shard_t *shard = shard_of(set, hash);
+
+    pthread_mutex_lock(&shard->lock);
+    unsigned added = add_locked(shard, hash, value);
+    pthread_mutex_unlock(&shard->lock);
+
+    return added;
+}
+
+int concurrent_contains(const concurrent_hash_set_t *set, void *value)
+{
+    uint64_t hash = hash_value(set, value);
+    concurrent_shard_t *shard = shard_of(set, hash);
+
+    reader_slot_t *slot = reader_slot();
+    if (!slot)
+    {
+        // no slot to announce the lookup in: wait for the writers instead
+        pthread_mutex_lock(&shard->lock);
+        const concurrent_table_t *table =
+            atomic_load_explicit(&shard->table, memory_order_relaxed);
+        int found = find_slot(table, (uint32_t)hash, value, NULL) !=
+                    table->capacity;
+        pthread_mutex_unlock(&shard->lock);
+        return found;
+    }
+
+    // seq_cst: the epoch is announced before the table pointer is read
+    atomic_store(&slot->epoch, atomic_load(&global_epoch));
+
+    const concurrent_table_t *table = atomic_load(&shard->table);
+    int found = find_slot(table, (uint32_t)hash, value, NULL) !=
+                table->capacity;
+
+    // release: the probe is done before a writer may free the table
+    atomic_store_explicit(&slot->epoch, 0, memory_order_release);
+
+    return found;
+}
+
+void concurrent_delete(concurrent_hash_set_t *set, void *value)
+{
+    uint64_t hash = hash_value(set, value);
+    concurrent_shard_t *shard = shard_of(set, hash);
+
+    pthread_mutex_lock(&shard->lock);
+
+    concurrent_table_t *table =
+        atomic_load_explicit(&shard->table, memory_order_relaxed);
+    unsigned slot = find_slot(table, (uint32_t)hash, value, NULL);
+
+    if (slot != table->capacity)
+    {
+        unsigned mask = table->capacity - 1;
+
+        atomic_store_explicit(&table->keys[slot], TOMBSTONE,
+                              memory_order_release);
+        atomic_fetch_sub_explicit(&shard->live, 1, memory_order_relaxed);
+
+        /*
+            tombstones directly before an empty slot end their probe run, so
+            no stored key is found by probing past them: emptying them only
+            stops lookups for absent keys sooner. Other tombstones keep
+            counting in `used` until the next rebuild.
+        */
+        if (atomic_load_explicit(&table->keys[(slot + 1) & mask],
+                                 memory_order_relaxed) == NULL)
+        {
+            while (atomic_load_explicit(&table->keys[slot],
+                                        memory_order_relaxed) == TOMBSTONE)
+            {
+                atomic_store_explicit(&table->keys[slot], NULL,
+                                      memory_order_relaxed);
+                shard->used--;
+                slot = (slot - 1) & mask;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+}
+
+unsigned concurrent_length(const concurrent_hash_set_t *set)
+{
+    unsigned length = 0;
+
+    for (unsigned i = 0; i < set->shard_count; i++)
+    {
+        length +=
+            atomic_load_explicit(&set->shards[i].live, memory_order_relaxed);
+    }
+
+    return length;
+}
+
+void free_concurrent_hash_set(concurrent_hash_set_t *set)
+{
+    for (unsigned i = 0; i < set->shard_count; i++)
+    {
+        pthread_mutex_destroy(&set->shards[i].lock);
+        free_table(atomic_load_explicit(&set->shards[i].table,
+                                        memory_order_relaxed));
+    }
+    free(set->shards);
+    free(set);
+}
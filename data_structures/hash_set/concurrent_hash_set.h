@@ -0,0 +1,90 @@
+#ifndef __CONCURRENT_HASH_SET__
+#define __CONCURRENT_HASH_SET__
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "hash_functions.h"
+
+#define DEFAULT_CONCURRENT_SHARDS 64
+#define DEFAULT_SHARD_CAPACITY (1 << 6)
+
+// a shard is rebuilt once live entries and tombstones exceed capacity * 7 / 8
+#define SHARD_MAX_LOAD_NUM 7
+#define SHARD_MAX_LOAD_DEN 8
+
+/*
+    One generation of a shard's slots. Writers fill hashes[slot] before they
+    publish keys[slot], readers only look at keys. A slot holds NULL while
+    empty and a tombstone once its key was deleted.
+*/
+typedef struct
+{
+    unsigned capacity;
+    uint32_t *hashes;
+    _Atomic(void *) *keys;
+} concurrent_table_t;
+
+/*
+    The writer side (lock, counters) and the reader side (table) of a shard
+    live on different cache lines, so lookups never share a line that
+    inserts into the same shard keep writing.
+
+    Lookups write nothing in the shard. Each thread announces the epoch it
+    started a lookup in through its own cache line; a writer that replaced
+    the table waits for the lookups of earlier epochs before it frees the
+    old table.
+*/
+typedef struct
+{
+    _Alignas(64) pthread_mutex_t lock;
+    unsigned used; // live entries plus tombstones
+    atomic_uint live;
+    _Alignas(64) _Atomic(concurrent_table_t *) table;
+} concurrent_shard_t;
+
+/*
+    Concurrent set of pointers split into independently locked shards.
+
+    add and delete take the lock of one shard. contains takes no lock: it
+    loads the shard's current table and probes it, so it never waits for a
+    writer. A shard grows by building a new table and publishing it; the
+    old one is freed once the lookups that may still be walking it are
+    done. delete turns the tombstones at the end of a probe run back into
+    empty slots, so add/delete churn does not force rebuilds.
+
+    Like hash_set, values are hashed as NUL terminated strings with
+    hash_function and seed and compared by pointer. NULL cannot be stored.
+*/
+typedef struct
+{
+    unsigned shard_count;
+    concurrent_shard_t *shards;
+    const hash_function_t *hash_function;
+    uint64_t seed;
+} concurrent_hash_set_t;
+
+// hashes with mix64 under a seed from hash_random_seed(); shard_count is
+// rounded up to a power of two, 0 picks the default
+extern concurrent_hash_set_t *init_concurrent_hash_set(unsigned shard_count);
+
+extern concurrent_hash_set_t *
+init_concurrent_hash_set_with_hash(unsigned shard_count,
+                                   const hash_function_t *hash_function,
+                                   uint64_t seed);
+
+// returns 1 if value was added, 0 if it was already stored or out of memory
+extern unsigned concurrent_add(concurrent_hash_set_t *set, void *value);
+
+extern int concurrent_contains(const concurrent_hash_set_t *set, void *value);
+
+extern void concurrent_delete(concurrent_hash_set_t *set, void *value);
+
+// number of stored values; only a snapshot while writers are running
+extern unsigned concurrent_length(const concurrent_hash_set_t *set);
+
+// must not run concurrently with any other call on the set
+extern void free_concurrent_hash_set(concurrent_hash_set_t *set);
+
+#endif
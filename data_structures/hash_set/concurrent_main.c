@@ -0,0 +1,194 @@
+/*
+    Stress test for concurrent_hash_set.
+
+    usage: ./concurrent_main [threads]
+    threads defaults to 8.
+
+    Every thread owns a range of keys. While the writers add their range,
+    delete the odd keys and add them back, readers keep checking that
+    keys added before the threads started are always found and that keys
+    never added are never found. Few shards keep the writers contending.
+
+    A second test runs add/delete churn through a single shard while a
+    reader keeps looking up, and checks that the shard's table never grows
+    past the size its few live keys need: retired tables are freed, so that
+    table is all the memory the shard holds.
+*/
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "concurrent_hash_set.h"
+
+#define KEYS_PER_THREAD 20000
+#define ROUNDS 3
+#define KEY_SIZE 16
+#define CHURN_PAIRS 200000
+#define CHURN_LIVE 16
+
+static concurrent_hash_set_t *set;
+static unsigned thread_count;
+static char (*words)[KEY_SIZE];   // keys the writers add
+static char (*stable)[KEY_SIZE];  // keys added before the threads start
+static char (*missing)[KEY_SIZE]; // keys never added
+static atomic_int writers_done;
+
+static void *writer(void *arg)
+{
+    unsigned first = (unsigned)(size_t)arg * KEYS_PER_THREAD;
+
+    for (unsigned round = 0; round < ROUNDS; round++)
+    {
+        for (unsigned i = first; i < first + KEYS_PER_THREAD; i++)
+        {
+            assert(concurrent_add(set, words[i]) == (round == 0 || i & 1));
+        }
+        for (unsigned i = first; i < first + KEYS_PER_THREAD; i++)
+        {
+            assert(concurrent_contains(set, words[i]));
+        }
+        for (unsigned i = first + 1; i < first + KEYS_PER_THREAD; i += 2)
+        {
+            concurrent_delete(set, words[i]);
+            assert(!concurrent_contains(set, words[i]));
+        }
+    }
+
+    atomic_fetch_add(&writers_done, 1);
+    return NULL;
+}
+
+static void *reader(void *arg)
+{
+    (void)arg;
+    unsigned passes = 0;
+
+    while (atomic_load(&writers_done) < (int)thread_count || passes == 0)
+    {
+        for (unsigned i = 0; i < KEYS_PER_THREAD; i++)
+        {
+            assert(concurrent_contains(set, stable[i]));
+            assert(!concurrent_contains(set, missing[i]));
+        }
+        passes++;
+    }
+
+    return NULL;
+}
+
+static void *churn_reader(void *arg)
+{
+    concurrent_hash_set_t *churned = arg;
+
+    while (!atomic_load(&writers_done))
+    {
+        for (unsigned i = 0; i < CHURN_LIVE; i++)
+        {
+            assert(concurrent_contains(churned, stable[i]));
+        }
+        assert(!concurrent_contains(churned, missing[0]));
+    }
+
+    return NULL;
+}
+
+static void churn_test(void)
+{
+    concurrent_hash_set_t *churned = init_concurrent_hash_set(1);
+    char(*keys)[KEY_SIZE] = malloc((size_t)CHURN_PAIRS * KEY_SIZE);
+    pthread_t thread;
+    assert(churned && keys);
+
+    for (unsigned i = 0; i < CHURN_LIVE; i++)
+    {
+        assert(concurrent_add(churned, stable[i]) == 1);
+    }
+
+    atomic_store(&writers_done, 0);
+    pthread_create(&thread, NULL, churn_reader, churned);
+
+    unsigned most = 0;
+    for (unsigned i = 0; i < CHURN_PAIRS; i++)
+    {
+        snprintf(keys[i], KEY_SIZE, "churn%u", i);
+        assert(concurrent_add(churned, keys[i]) == 1);
+        concurrent_delete(churned, keys[i]);
+
+        unsigned capacity = atomic_load(&churned->shards[0].table)->capacity;
+        most = capacity > most ? capacity : most;
+    }
+
+    atomic_store(&writers_done, 1);
+    pthread_join(thread, NULL);
+
+    assert(concurrent_length(churned) == CHURN_LIVE);
+    assert(most == DEFAULT_SHARD_CAPACITY);
+
+    printf("%u add/delete pairs kept the shard at %u slots\n", CHURN_PAIRS,
+           most);
+
+    free_concurrent_hash_set(churned);
+    free(keys);
+}
+
+int main(int argc, char *argv[])
+{
+    thread_count = argc > 1 ? (unsigned)atoi(argv[1]) : 8;
+    if (thread_count == 0)
+    {
+        thread_count = 1;
+    }
+
+    set = init_concurrent_hash_set(4);
+    words = malloc((size_t)thread_count * KEYS_PER_THREAD * KEY_SIZE);
+    stable = malloc(KEYS_PER_THREAD * KEY_SIZE);
+    missing = malloc(KEYS_PER_THREAD * KEY_SIZE);
+    pthread_t *threads = malloc(2 * thread_count * sizeof(pthread_t));
+    assert(set && words && stable && missing && threads);
+
+    for (unsigned i = 0; i < thread_count * KEYS_PER_THREAD; i++)
+    {
+        snprintf(words[i], KEY_SIZE, "key%u", i);
+    }
+    for (unsigned i = 0; i < KEYS_PER_THREAD; i++)
+    {
+        snprintf(stable[i], KEY_SIZE, "stable%u", i);
+        snprintf(missing[i], KEY_SIZE, "missing%u", i);
+        assert(concurrent_add(set, stable[i]) == 1);
+    }
+
+    for (unsigned t = 0; t < thread_count; t++)
+    {
+        pthread_create(&threads[t], NULL, writer, (void *)(size_t)t);
+        pthread_create(&threads[thread_count + t], NULL, reader, NULL);
+    }
+    for (unsigned t = 0; t < 2 * thread_count; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    // the even keys of every range and the stable keys are left
+    unsigned expected = thread_count * KEYS_PER_THREAD / 2 + KEYS_PER_THREAD;
+    assert(concurrent_length(set) == expected);
+    for (unsigned i = 0; i < thread_count * KEYS_PER_THREAD; i++)
+    {
+        assert(concurrent_contains(set, words[i]) == !(i & 1));
+    }
+
+    printf("%u threads: %u keys in %u shards\n", thread_count, expected,
+           set->shard_count);
+
+    free_concurrent_hash_set(set);
+
+    churn_test();
+    printf("all tests passed\n");
+
+    free(words);
+    free(stable);
+    free(missing);
+    free(threads);
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../hash/hash_adler32.h"
+#include "../../hash/hash_blake2b.h"
+#include "../../hash/hash_crc32.h"
+#include "../../hash/hash_djb2.h"
+#include "../../hash/hash_sdbm.h"
+#include "hash_functions.h"
+
+#define ROTL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+// little-endian 64-bit load that works for any alignment
+static uint64_t load64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--)
+    {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+// base ^ exp modulo 2^64
+static uint64_t pow64(uint64_t base, size_t exp)
+{
+    uint64_t result = 1;
+
+    for (; exp; exp >>= 1, base *= base)
+    {
+        if (exp & 1)
+        {
+            result *= base;
+        }
+    }
+    return result;
+}
+
+/*
+    djb2 and sdbm are linear in their start value: starting from s instead of
+    the classic start adds (s - classic) * multiplier^len to the result
+*/
+static uint64_t seeded_djb2(const void *key, size_t len, uint64_t seed)
+{
+    return djb2_buffer(key, len) + ((5381 ^ seed) - 5381) * pow64(33, len);
+}
+
+static uint64_t seeded_sdbm(const void *key, size_t len, uint64_t seed)
+{
+    return sdbm_buffer(key, len) + seed * pow64(65599, len);
+}
+
+static uint64_t seeded_crc32(const void *key, size_t len, uint64_t seed)
+{
+    crc32_ctx ctx;
+
+    crc32_init(&ctx);
+    ctx.crc = ~(uint32_t)seed;
+    crc32_update(&ctx, key, len);
+    return crc32_final(&ctx);
+}
+
+static uint64_t seeded_adler32(const void *key, size_t len, uint64_t seed)
+{
+    adler32_ctx ctx = {(uint32_t)(1 + seed % MODADLER) % MODADLER,
+                       (uint32_t)((seed >> 16) % MODADLER)};
+
+    adler32_update(&ctx, key, len);
+    return adler32_final(&ctx);
+}
+
+// BLAKE2b with an 8 byte digest, keyed with the seed when it is non zero
+static uint64_t seeded_blake2b(const void *key, size_t len, uint64_t seed)
+{
+    blake2b_ctx ctx;
+    uint8_t seed_bytes[8], digest[8];
+
+    for (int i = 0; i < 8; i++)
+    {
+        seed_bytes[i] = (uint8_t)(seed >> (8 * i));
+    }
+    blake2b_init(&ctx, seed_bytes, seed ? 8 : 0, 8);
+    blake2b_update(&ctx, key, len);
+    blake2b_final(&ctx, digest);
+
+    return load64(digest);
+}
+
+// murmur3 64-bit finalizer
+static uint64_t fmix64(uint64_t k)
+{
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCD;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53;
+    k ^= k >> 33;
+    return k;
+}
+
+// multiply-xorshift hash consuming 8 bytes per step
+static uint64_t mix64(const void *key, size_t len, uint64_t seed)
+{
+    const uint8_t *p = key;
+    uint64_t hash = seed ^ (len * 0x9E3779B97F4A7C15);
+
+    for (; len >= 8; len -= 8, p += 8)
+    {
+        uint64_t k = load64(p) * 0x87C37B91114253D5;
+        hash = ROTL64(hash ^ ROTL64(k, 31) * 0x4CF5AD432745937F, 27);
+        hash = hash * 5 + 0x52DCE729;
+    }
+
+    uint64_t tail = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        tail |= (uint64_t)p[i] << (8 * i);
+    }
+
+    return fmix64(hash ^ tail * 0x87C37B91114253D5);
+}
+
+const hash_function_t hash_djb2 = {"djb2", seeded_djb2};
+const hash_function_t hash_sdbm = {"sdbm", seeded_sdbm};
+const hash_function_t hash_crc32 = {"crc32", seeded_crc32};
+const hash_function_t hash_adler32 = {"adler32", seeded_adler32};
+const hash_function_t hash_blake2b = {"blake2b", seeded_blake2b};
+const hash_function_t hash_mix64 = {"mix64", mix64};
+
+const hash_function_t *const hash_functions[] = {
+    &hash_djb2,    &hash_sdbm,    &hash_crc32, &hash_adler32,
+    &hash_blake2b, &hash_mix64,   NULL};
+
+// reads /dev/urandom, mixed with the clock and an address in case it is missing
+static uint64_t read_process_seed(void)
+{
+    uint64_t seed = 0;
+
+    FILE *urandom = fopen("/dev/urandom", "rb");
+    if (urandom)
+    {
+        if (fread(&seed, sizeof(seed), 1, urandom) != 1)
+        {
+            seed = 0;
+        }
+        fclose(urandom);
+    }
+
+    seed ^= fmix64((uint64_t)time(NULL) ^ ((uint64_t)clock() << 32) ^
+                   (uint64_t)(uintptr_t)&seed);
+
+    // 0 marks the process seed as not read yet
+    return seed ? seed : 1;
+}
+
+uint64_t hash_random_seed(void)
+{
+    static atomic_uint_fast64_t process_seed;
+    static atomic_uint_fast64_t calls;
+
+    uint64_t base = atomic_load_explicit(&process_seed, memory_order_acquire);
+    if (!base)
+    {
+        // threads racing here read /dev/urandom each, but only one seed wins
+        uint64_t expected = 0;
+        base = read_process_seed();
+        if (!atomic_compare_exchange_strong(&process_seed, &expected, base))
+        {
+            base = expected;
+        }
+    }
+
+    // fmix64 is a bijection, so every call gets a different seed
+    uint64_t seed = fmix64(
+        base + atomic_fetch_add_explicit(&calls, 1, memory_order_relaxed) *
+                   0x9E3779B97F4A7C15);
+
+    // 0 would leave blake2b unkeyed
+    return seed ? seed : 1;
+}
@@ -0,0 +1,44 @@
+#ifndef __HASH_FUNCTIONS__
+#define __HASH_FUNCTIONS__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    seeded hash of `len` bytes at `key`.
+    a seed of 0 gives the classic, unseeded result of each algorithm.
+
+    djb2, sdbm, crc32, adler32 and blake2b wrap the kernels of hash/, so
+    djb2 and sdbm add bytes as `char` there and here.
+
+    djb2, sdbm, crc32 and adler32 only start from the seed, so two keys of
+    equal length that collide do so under every seed. mix64 spreads similar
+    keys well but is not a keyed PRF either. Only blake2b keyed with a secret
+    seed resists collision flooding by chosen keys.
+*/
+typedef uint64_t (*hash_fn_t)(const void *key, size_t len, uint64_t seed);
+
+/* hash function table entry, passed to the containers by pointer */
+typedef struct
+{
+    const char *name;
+    hash_fn_t hash;
+} hash_function_t;
+
+extern const hash_function_t hash_djb2;
+extern const hash_function_t hash_sdbm;
+extern const hash_function_t hash_crc32;
+extern const hash_function_t hash_adler32;
+extern const hash_function_t hash_blake2b;
+extern const hash_function_t hash_mix64;
+
+/* every function above, terminated by NULL */
+extern const hash_function_t *const hash_functions[];
+
+/*
+    non zero seed, different on every call. /dev/urandom is read once per
+    process; each call mixes that seed with a counter.
+*/
+extern uint64_t hash_random_seed(void);
+
+#endif
@@ -1,101 +1,290 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "hash_set.h"
 
+// murmur3 64-bit finalizer: every input bit reaches the 32 bits kept per
+// slot, so weak hashes of similar keys still spread over the whole table
+static uint32_t mix_hash(const long long hash)
+{
+    uint64_t k = (uint64_t)hash;
+
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCD;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53;
+    k ^= k >> 33;
+    return (uint32_t)k;
+}
+
+// how far the entry in `slot` sits from the slot its hash points to
+static unsigned probe_distance(const hash_set_t *set, unsigned slot)
+{
+    if (set->ctrl[slot] != HASH_SET_FAR)
+    {
+        return set->ctrl[slot] - 1;
+    }
+
+    return (slot - set->table[slot].hash) & (set->capacity - 1);
+}
+
+static void fill_slot(hash_set_t *set, unsigned slot, void *key, uint32_t hash,
+                      unsigned index, unsigned distance)
+{
+    set->ctrl[slot] =
+        distance + 1 < HASH_SET_FAR ? (uint8_t)(distance + 1) : HASH_SET_FAR;
+    set->table[slot].key = key;
+    set->table[slot].hash = hash;
+    set->table[slot].index = index;
+    set->slots[index] = slot;
+}
+
+// returns the slot holding `value`, or capacity if it is not stored
+static unsigned find_slot(const hash_set_t *set, uint32_t hash, void *value)
+{
+    unsigned mask = set->capacity - 1;
+    unsigned slot = hash & mask;
+
+    for (unsigned distance = 0; set->ctrl[slot] != HASH_SET_EMPTY; distance++)
+    {
+        // a richer entry would have taken this slot, so value is absent
+        if (probe_distance(set, slot) < distance)
+        {
+            break;
+        }
+
+        if (set->table[slot].hash == hash && set->table[slot].key == value)
+        {
+            return slot;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return set->capacity;
+}
+
+// robin hood insertion: displaces any entry closer to its home slot
+static void insert_entry(hash_set_t *set, void *key, uint32_t hash,
+                         unsigned index)
+{
+    unsigned mask = set->capacity - 1;
+    unsigned slot = hash & mask;
+    unsigned distance = 0;
+
+    while (set->ctrl[slot] != HASH_SET_EMPTY)
+    {
+        unsigned resident = probe_distance(set, slot);
+
+        if (resident < distance)
+        {
+            hash_set_slot_t displaced = set->table[slot];
+
+            fill_slot(set, slot, key, hash, index, distance);
+
+            key = displaced.key;
+            hash = displaced.hash;
+            index = displaced.index;
+            distance = resident;
+        }
+
+        slot = (slot + 1) & mask;
+        distance++;
+    }
+
+    fill_slot(set, slot, key, hash, index, distance);
+}
+
 extern hash_set_t *init_hash_set()
+{
+    return init_hash_set_with_hash(&hash_mix64, hash_random_seed());
+}
+
+extern hash_set_t *init_hash_set_with_hash(const hash_function_t *hash_function,
+                                           uint64_t seed)
 {
     hash_set_t *set = (hash_set_t *)malloc(sizeof(hash_set_t));
-    set->keys = calloc(DEFAULT_HASH_SET_CAPACITY, sizeof(void **));
-    set->values = calloc(DEFAULT_HASH_SET_CAPACITY, sizeof(void **));
+    if (!set)
+    {
+        return NULL;
+    }
+
     set->length = 0;
     set->capacity = DEFAULT_HASH_SET_CAPACITY;
+    set->values = malloc(set->capacity * sizeof(void *));
+    set->ctrl = calloc(set->capacity, sizeof(uint8_t));
+    set->table = malloc(set->capacity * sizeof(hash_set_slot_t));
+    set->slots = malloc(set->capacity * sizeof(unsigned));
+    set->hash_function = hash_function;
+    set->seed = seed;
+
+    if (!set->values || !set->ctrl || !set->table || !set->slots)
+    {
+        free_hash_set(set);
+        return NULL;
+    }
 
     return set;
 }
 
 unsigned add(hash_set_t *set, void *value)
 {
-    return put(set, hash(value), value);
+    return put(set, hash_of(set, value), value);
 }
 
 unsigned put(hash_set_t *set, long long hash, void *value)
 {
-    if (contains_hash(set, hash))
+    uint32_t mixed = mix_hash(hash);
+
+    if (find_slot(set, mixed, value) != set->capacity)
     {
-        if (set->keys[retrieve_index_from_hash(hash, set->capacity)] == value)
-        {
-            return 0;
-        }
+        return 0;
+    }
 
-        // collision
+    if ((unsigned long long)(set->length + 1) * HASH_SET_MAX_LOAD_DEN >
+        (unsigned long long)set->capacity * HASH_SET_MAX_LOAD_NUM)
+    {
         resize(set);
+    }
 
-        return put(set, hash, value);
+    // resize() could not allocate and there is no free slot left
+    if (set->length == set->capacity)
+    {
+        return 0;
     }
 
-    set->keys[retrieve_index_from_hash(hash, set->capacity)] = value;
-    set->values[set->length++] = value;
+    set->values[set->length] = value;
+    insert_entry(set, value, mixed, set->length);
+    set->length++;
 
     return 1;
 }
 
 int contains(hash_set_t *set, void *value)
 {
-    return set->keys[retrieve_index_from_hash(hash(value), set->capacity)] ==
-                   value
-               ? 1
-               : 0;
+    unsigned slot = find_slot(set, mix_hash(hash_of(set, value)), value);
+
+    return slot != set->capacity ? 1 : 0;
 }
 
 int contains_hash(hash_set_t *set, long long hash)
 {
-    return set->keys[retrieve_index_from_hash(hash, set->capacity)] ? 1 : 0;
+    uint32_t mixed = mix_hash(hash);
+    unsigned mask = set->capacity - 1;
+    unsigned slot = mixed & mask;
+
+    for (unsigned distance = 0; set->ctrl[slot] != HASH_SET_EMPTY; distance++)
+    {
+        if (probe_distance(set, slot) < distance)
+        {
+            break;
+        }
+
+        if (set->table[slot].hash == mixed)
+        {
+            return 1;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return 0;
 }
 
 void delete (hash_set_t *set, void *value)
 {
-    set->keys[retrieve_index_from_hash(hash(value), set->capacity)] = NULL;
-}
+    unsigned mask = set->capacity - 1;
+    unsigned slot = find_slot(set, mix_hash(hash_of(set, value)), value);
 
-// adler_32 hash
-long long hash(void *value)
-{
-    char *str = value;
+    if (slot == set->capacity)
+    {
+        return;
+    }
 
-    int a = 1;
-    int b = 0;
-    const int MODADLER = 65521;
+    // keep values[] dense by moving the last value into the freed position
+    unsigned removed = set->table[slot].index;
+    unsigned last = --set->length;
+    if (removed != last)
+    {
+        set->values[removed] = set->values[last];
+        set->slots[removed] = set->slots[last];
+        set->table[set->slots[removed]].index = removed;
+    }
 
-    for (int i = 0; str[i] != '\0'; i++)
+    // backward shift deletion: pull the following run one slot closer home
+    unsigned next = (slot + 1) & mask;
+    while (set->ctrl[next] != HASH_SET_EMPTY && probe_distance(set, next) > 0)
     {
-        a = (a + str[i]) % MODADLER;
-        b = (b + a) % MODADLER;
+        hash_set_slot_t moved = set->table[next];
+
+        fill_slot(set, slot, moved.key, moved.hash, moved.index,
+                  probe_distance(set, next) - 1);
+        slot = next;
+        next = (next + 1) & mask;
     }
 
-    return (b << 16) | a;
+    set->ctrl[slot] = HASH_SET_EMPTY;
+    set->table[slot].key = NULL;
+}
+
+long long hash_of(const hash_set_t *set, void *value)
+{
+    return (long long)set->hash_function->hash(value, strlen(value),
+                                               set->seed);
 }
 
 unsigned retrieve_index_from_hash(const long long hash, const unsigned capacity)
 {
-    return (capacity - 1) & (hash ^ (hash >> 12));
+    return (capacity - 1) & mix_hash(hash);
 }
 
 void resize(hash_set_t *set)
 {
-    void **keys_resized = calloc((set->capacity <<= 1), sizeof(void **));
+    unsigned capacity = set->capacity << 1;
+
+    uint8_t *ctrl = calloc(capacity, sizeof(uint8_t));
+    hash_set_slot_t *table = malloc(capacity * sizeof(hash_set_slot_t));
+    void **values = realloc(set->values, capacity * sizeof(void *));
+    if (values)
+    {
+        set->values = values;
+    }
+    unsigned *slots = realloc(set->slots, capacity * sizeof(unsigned));
+    if (slots)
+    {
+        set->slots = slots;
+    }
 
-    for (int i = 0; i < set->length; i++)
+    if (!ctrl || !table || !values || !slots)
     {
-        keys_resized[retrieve_index_from_hash(hash(set->values[i]),
-                                              set->capacity)] = set->values[i];
+        free(ctrl);
+        free(table);
+        return;
     }
 
-    free(set->keys);
+    hash_set_slot_t *old_table = set->table;
+
+    free(set->ctrl);
 
-    set->keys = keys_resized;
+    set->capacity = capacity;
+    set->ctrl = ctrl;
+    set->table = table;
 
-    void **new_values =
-        (void **)realloc(set->values, set->capacity * sizeof(void **));
-    set->values = new_values;
+    // the cached hashes make rehashing independent of the key length
+    for (unsigned i = 0; i < set->length; i++)
+    {
+        insert_entry(set, set->values[i], old_table[set->slots[i]].hash, i);
+    }
+
+    free(old_table);
+}
+
+void free_hash_set(hash_set_t *set)
+{
+    free(set->values);
+    free(set->ctrl);
+    free(set->table);
+    free(set->slots);
+    free(set);
 }
@@ -1,18 +1,61 @@
 #ifndef __HASH_SET__
 #define __HASH_SET__
 
-#define DEFAULT_HASH_SET_CAPACITY 1 << 10
+#include <stdint.h>
 
+#include "hash_functions.h"
+
+#define DEFAULT_HASH_SET_CAPACITY (1 << 10)
+
+// the table is grown once length would exceed capacity * 7 / 8
+#define HASH_SET_MAX_LOAD_NUM 7
+#define HASH_SET_MAX_LOAD_DEN 8
+
+// control byte of an empty slot; any other value is probe distance + 1
+#define HASH_SET_EMPTY 0
+// control byte of a slot whose probe distance does not fit in a byte
+#define HASH_SET_FAR 0xff
+
+/*
+    one slot of the table: the key, the low 32 bits of its finalized hash
+    and its position in values. 16 bytes, so four slots share a cache line.
+*/
+typedef struct
+{
+    void *key;
+    uint32_t hash;
+    unsigned index;
+} hash_set_slot_t;
+
+/*
+    Robin Hood open-addressing set of pointers.
+
+    ctrl and table hold `capacity` entries, so a probe reads one line of
+    control bytes and the one or two lines of slots it walks over.
+    values holds the `length` stored pointers densely and slots maps each
+    of them back to the slot it lives in.
+    Keys are hashed as NUL terminated strings with hash_function and seed,
+    and the result is finalized with a 64-bit mixer before it picks a slot.
+*/
 typedef struct
 {
     unsigned capacity;
     unsigned length;
     void **values;
-    void **keys;
+    uint8_t *ctrl;
+    hash_set_slot_t *table;
+    unsigned *slots;
+    const hash_function_t *hash_function;
+    uint64_t seed;
 } hash_set_t;
 
+// hashes with mix64 under a seed from hash_random_seed(); hash_of() computes
+// the hashes put() and contains_hash() expect
 extern hash_set_t *init_hash_set();
 
+extern hash_set_t *init_hash_set_with_hash(const hash_function_t *hash_function,
+                                           uint64_t seed);
+
 extern unsigned add(hash_set_t *set, void *value);
 
 unsigned put(hash_set_t *set, long long hash, void *value);
@@ -23,11 +66,14 @@ int contains_hash(hash_set_t *set, long long hash);
 
 extern void delete (hash_set_t *set, void *value);
 
-extern long long hash(void *value);
+// hash of value as computed by the set itself, to be used with put()
+extern long long hash_of(const hash_set_t *set, void *value);
 
 extern unsigned retrieve_index_from_hash(const long long hash,
                                          const unsigned capacity);
 
 extern void resize(hash_set_t *set);
 
-#endif
\ No newline at end of file
+extern void free_hash_set(hash_set_t *set);
+
+#endif
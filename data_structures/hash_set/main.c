@@ -1,4 +1,6 @@
+#include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "hash_set.h"
 
@@ -38,5 +40,39 @@ int main()
 
     printf("contains %d ? %d\n", v6, contains(set, &v6));
 
+    free_hash_set(set);
+
+    // many colliding string keys: the table only grows on load factor
+    const unsigned n = 100000;
+    char(*words)[16] = malloc(n * sizeof(*words));
+    set = init_hash_set();
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        snprintf(words[i], sizeof(words[i]), "key%u", i);
+        assert(add(set, words[i]) == 1);
+    }
+    assert(set->length == n);
+    assert(set->capacity <= 2 * n * HASH_SET_MAX_LOAD_DEN /
+                                 HASH_SET_MAX_LOAD_NUM);
+
+    for (unsigned i = 0; i < n; i += 2)
+    {
+        delete (set, words[i]);
+    }
+    for (unsigned i = 0; i < n; i++)
+    {
+        assert(contains(set, words[i]) == (int)(i & 1));
+    }
+    for (unsigned i = 0; i < set->length; i++)
+    {
+        assert(contains(set, set->values[i]));
+    }
+
+    printf("%u keys stored in %u slots\n", set->length, set->capacity);
+
+    free_hash_set(set);
+    free(words);
+
     return 0;
 }
\ No newline at end of file
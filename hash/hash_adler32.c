@@ -1,36 +1,49 @@
 /**
- * @addtogroup hash Hash algorithms
- * @{
- * @file hash_adler32.c
- * @author [Christian Bender](https://github.com/christianbender)
- * @brief 32-bit [Adler hash](https://en.wikipedia.org/wiki/Adler-32) algorithm
+ * @file
+ * @brief Tests and kernel throughput of the Adler-32 of hash_adler32.h
  */
-#include <assert.h>
-#include <inttypes.h>
-#include <stdio.h>
+#include <assert.h>    /// for assert
+#include <inttypes.h>  /// for fixed-width integer types
+#include <stdio.h>     /// for IO
+#include <stdlib.h>    /// for malloc, rand and free
+#include <time.h>      /// for clock
+
+#include "hash_adler32.h"
 
 /**
- * @brief 32-bit Adler algorithm implementation
+ * @brief byte-at-a-time reference used to check the kernels
  *
- * @param s NULL terminated ASCII string to hash
- * @return 32-bit hash result
+ * @param p data to hash
+ * @param len number of bytes at p
+ * @return 32-bit checksum
  */
-uint32_t adler32(const char* s)
+static uint32_t adler32_reference(const uint8_t *p, size_t len)
 {
-    uint32_t a = 1;
-    uint32_t b = 0;
-    const uint32_t MODADLER = 65521;
-
-    size_t i = 0;
-    while (s[i] != '\0')
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < len; i++)
     {
-        a = (a + s[i]) % MODADLER;
+        a = (a + p[i]) % MODADLER;
         b = (b + a) % MODADLER;
-        i++;
     }
     return (b << 16) | a;
 }
 
+/**
+ * @brief checks one kernel against ::adler32_reference
+ *
+ * @param kernel kernel to check
+ * @param data test data
+ * @param len number of bytes at data
+ * @returns void
+ */
+static void check_kernel(adler32_kernel kernel, const uint8_t *data,
+                         size_t len)
+{
+    uint32_t a = 1, b = 0;
+    kernel(&a, &b, data, len);
+    assert(((b << 16) | a) == adler32_reference(data, len));
+}
+
 /**
  * @brief Test function for ::adler32
  * \returns None
@@ -41,14 +54,101 @@ void test_adler32()
     assert(adler32("Hello World!") == 474547262);
     assert(adler32("Hello world") == 413860925);
     assert(adler32("Hello world!") == 487130206);
+
+    /* all 0xff bytes push the deferred sums as high as they can go */
+    const size_t size = 3 * ADLER32_NMAX + 100;
+    uint8_t *data = malloc(size);
+    assert(data != NULL);
+    for (int fill = 0; fill < 2; fill++)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            data[i] = fill ? (uint8_t)rand() : 0xff;
+        }
+        for (size_t len = 0; len <= size; len += len < 200 ? 1 : 997)
+        {
+            check_kernel(adler32_scalar, data, len);
+#ifdef ADLER32_SIMD
+            check_kernel(adler32_sse2, data, len);
+            if (adler32_cpu_has_avx2())
+            {
+                check_kernel(adler32_avx2, data, len);
+            }
+#endif
+            /* split in two: streamed, and combined from independent parts */
+            uint32_t expected = adler32_reference(data, len);
+            size_t cut = len / 3;
+            adler32_ctx ctx;
+            adler32_init(&ctx);
+            adler32_update(&ctx, data, cut);
+            adler32_update(&ctx, data + cut, len - cut);
+            assert(adler32_final(&ctx) == expected);
+            assert(adler32_combine(adler32_buffer(data, cut),
+                                   adler32_buffer(data + cut, len - cut),
+                                   len - cut) == expected);
+        }
+    }
+    free(data);
     printf("Tests passed\n");
 }
 
-/** @} */
+/**
+ * @brief prints the throughput of each available kernel
+ * \returns None
+ */
+static void benchmark_adler32()
+{
+    const size_t len = 1 << 24;
+    const int rounds = 8;
+    uint8_t *data = malloc(len);
+    if (!data)
+    {
+        return;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        data[i] = (uint8_t)i;
+    }
+
+    const struct
+    {
+        const char *name;
+        adler32_kernel kernel;
+    } kernels[] = {
+        {"scalar", adler32_scalar},
+#ifdef ADLER32_SIMD
+        {"sse2", adler32_sse2},
+        {"avx2", adler32_cpu_has_avx2() ? adler32_avx2 : NULL},
+#endif
+    };
+
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+    {
+        if (!kernels[k].kernel)
+        {
+            continue;
+        }
+
+        volatile uint32_t sink = 0;
+        clock_t start = clock();
+        for (int r = 0; r < rounds; r++)
+        {
+            uint32_t a = 1, b = 0;
+            kernels[k].kernel(&a, &b, data, len);
+            sink ^= a ^ b;
+        }
+        double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        printf("%-6s %8.1f MB/s\n", kernels[k].name,
+               rounds * len / 1e6 / seconds);
+    }
+
+    free(data);
+}
 
 /** Main function */
 int main()
 {
     test_adler32();
+    benchmark_adler32();
     return 0;
 }
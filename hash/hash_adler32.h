@@ -0,0 +1,379 @@
+/**
+ * @addtogroup hash Hash algorithms
+ * @{
+ * @file hash_adler32.h
+ * @author [Christian Bender](https://github.com/christianbender)
+ * @brief 32-bit [Adler hash](https://en.wikipedia.org/wiki/Adler-32) algorithm
+ *
+ * The checksum is computed over `(buffer, length)` pairs, either at once
+ * with ::adler32_buffer or piecewise through ::adler32_init /
+ * ::adler32_update / ::adler32_final. Checksums of consecutive chunks hashed
+ * independently (e.g. on different threads) are merged with
+ * ::adler32_combine.
+ *
+ * Instead of reducing both sums modulo 65521 after every byte, the sums are
+ * only reduced every ::ADLER32_NMAX bytes, the largest run that cannot
+ * overflow 32 bits. Within such a run the bytes are summed 16 (SSE2) or 32
+ * (AVX2) at a time on x86 processors, with a portable scalar fallback.
+ *
+ * The tests and a throughput benchmark are in hash_adler32.c.
+ */
+#ifndef HASH_ADLER32_H
+#define HASH_ADLER32_H
+
+#include <stddef.h>    /// for size_t
+#include <stdint.h>    /// for fixed-width integer types
+#include <string.h>    /// for strlen
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#define ADLER32_SIMD 1  ///< the SSE2 and AVX2 kernels are compiled in
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ADLER32_TARGET_SSE2
+#define ADLER32_TARGET_AVX2
+#else
+/** enables SSE2 code generation for a single function */
+#define ADLER32_TARGET_SSE2 __attribute__((target("sse2")))
+/** enables AVX2 code generation for a single function */
+#define ADLER32_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#define MODADLER 65521  ///< largest prime below 2^16
+/** largest n such that 255 n (n + 1) / 2 + (n + 1) (MODADLER - 1) < 2^32 */
+#define ADLER32_NMAX 5552
+
+/**
+ * @brief state of a running Adler-32 computation
+ */
+typedef struct
+{
+    uint32_t a;  ///< 1 + sum of all bytes, modulo ::MODADLER
+    uint32_t b;  ///< sum of all values of a, modulo ::MODADLER
+} adler32_ctx;
+
+/** signature shared by the kernels; the sums are reduced on return */
+typedef void (*adler32_kernel)(uint32_t *a, uint32_t *b, const uint8_t *p,
+                               size_t len);
+
+/**
+ * @brief portable kernel with deferred modulo
+ *
+ * @param a running sum of bytes
+ * @param b running sum of a
+ * @param p data to add
+ * @param len number of bytes at p
+ * @returns void
+ */
+static inline void adler32_scalar(uint32_t *a, uint32_t *b, const uint8_t *p,
+                                  size_t len)
+{
+    uint32_t s1 = *a, s2 = *b;
+
+    while (len > 0)
+    {
+        size_t n = len < ADLER32_NMAX ? len : ADLER32_NMAX;
+        len -= n;
+
+        for (; n >= 4; n -= 4, p += 4)
+        {
+            s1 += p[0];
+            s2 += s1;
+            s1 += p[1];
+            s2 += s1;
+            s1 += p[2];
+            s2 += s1;
+            s1 += p[3];
+            s2 += s1;
+        }
+        while (n--)
+        {
+            s1 += *p++;
+            s2 += s1;
+        }
+
+        s1 %= MODADLER;
+        s2 %= MODADLER;
+    }
+
+    *a = s1;
+    *b = s2;
+}
+
+#ifdef ADLER32_SIMD
+/**
+ * @brief SSE2 kernel, 16 bytes per step
+ *
+ * For a block of 16 bytes, a grows by the plain sum of the bytes and b by
+ * 16 a plus the bytes weighted 16, 15, ..., 1. Per run the block sums,
+ * weighted sums and prefix sums of a are accumulated in vector lanes and
+ * only folded into the scalars, and reduced, at the end of the run.
+ *
+ * @param a running sum of bytes
+ * @param b running sum of a
+ * @param p data to add
+ * @param len number of bytes at p
+ * @returns void
+ */
+ADLER32_TARGET_SSE2
+static inline void adler32_sse2(uint32_t *a, uint32_t *b, const uint8_t *p,
+                                size_t len)
+{
+    const size_t BLOCK = 16;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weights_lo = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+    const __m128i weights_hi = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+    uint32_t s1 = *a, s2 = *b;
+
+    while (len >= BLOCK)
+    {
+        size_t blocks = len / BLOCK;
+        if (blocks > ADLER32_NMAX / BLOCK)
+        {
+            blocks = ADLER32_NMAX / BLOCK;
+        }
+        len -= blocks * BLOCK;
+
+        __m128i v_ps = zero, v_s1 = zero, v_s2 = zero;
+        uint64_t t2 = s2 + (uint64_t)s1 * blocks * BLOCK;
+
+        while (blocks--)
+        {
+            __m128i bytes = _mm_loadu_si128((const __m128i *)p);
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes, zero));
+            v_s2 = _mm_add_epi32(
+                v_s2,
+                _mm_madd_epi16(_mm_unpacklo_epi8(bytes, zero), weights_lo));
+            v_s2 = _mm_add_epi32(
+                v_s2,
+                _mm_madd_epi16(_mm_unpackhi_epi8(bytes, zero), weights_hi));
+            p += BLOCK;
+        }
+
+        uint32_t lanes[4];
+        uint64_t sum1, prefix, weighted;
+
+        _mm_storeu_si128((__m128i *)lanes, v_s1);
+        sum1 = (uint64_t)lanes[0] + lanes[2];
+        _mm_storeu_si128((__m128i *)lanes, v_ps);
+        prefix = (uint64_t)lanes[0] + lanes[2];
+        _mm_storeu_si128((__m128i *)lanes, v_s2);
+        weighted = (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+        s1 = (uint32_t)((s1 + sum1) % MODADLER);
+        s2 = (uint32_t)((t2 + BLOCK * prefix + weighted) % MODADLER);
+    }
+
+    adler32_scalar(&s1, &s2, p, len);
+    *a = s1;
+    *b = s2;
+}
+
+/**
+ * @brief AVX2 kernel, 32 bytes per step; see ::adler32_sse2
+ *
+ * @param a running sum of bytes
+ * @param b running sum of a
+ * @param p data to add
+ * @param len number of bytes at p
+ * @returns void
+ */
+ADLER32_TARGET_AVX2
+static inline void adler32_avx2(uint32_t *a, uint32_t *b, const uint8_t *p,
+                                size_t len)
+{
+    const size_t BLOCK = 32;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i weights = _mm256_setr_epi8(
+        32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15,
+        14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    uint32_t s1 = *a, s2 = *b;
+
+    while (len >= BLOCK)
+    {
+        size_t blocks = len / BLOCK;
+        if (blocks > ADLER32_NMAX / BLOCK)
+        {
+            blocks = ADLER32_NMAX / BLOCK;
+        }
+        len -= blocks * BLOCK;
+
+        __m256i v_ps = zero, v_s1 = zero, v_s2 = zero;
+        uint64_t t2 = s2 + (uint64_t)s1 * blocks * BLOCK;
+
+        while (blocks--)
+        {
+            __m256i bytes = _mm256_loadu_si256((const __m256i *)p);
+            v_ps = _mm256_add_epi32(v_ps, v_s1);
+            v_s1 = _mm256_add_epi32(v_s1, _mm256_sad_epu8(bytes, zero));
+            v_s2 = _mm256_add_epi32(
+                v_s2,
+                _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, weights), ones));
+            p += BLOCK;
+        }
+
+        uint32_t lanes[8];
+        uint64_t sum1 = 0, prefix = 0, weighted = 0;
+
+        _mm256_storeu_si256((__m256i *)lanes, v_s1);
+        for (int i = 0; i < 8; i += 2)
+        {
+            sum1 += lanes[i];
+        }
+        _mm256_storeu_si256((__m256i *)lanes, v_ps);
+        for (int i = 0; i < 8; i += 2)
+        {
+            prefix += lanes[i];
+        }
+        _mm256_storeu_si256((__m256i *)lanes, v_s2);
+        for (int i = 0; i < 8; i++)
+        {
+            weighted += lanes[i];
+        }
+
+        s1 = (uint32_t)((s1 + sum1) % MODADLER);
+        s2 = (uint32_t)((t2 + BLOCK * prefix + weighted) % MODADLER);
+    }
+
+    adler32_scalar(&s1, &s2, p, len);
+    *a = s1;
+    *b = s2;
+}
+
+/**
+ * @brief checks whether the processor and OS support AVX2
+ * @returns 1 if ::adler32_avx2 may be used, 0 otherwise
+ */
+static inline int adler32_cpu_has_avx2(void)
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+    {
+        return 0;
+    }
+    __cpuid(regs, 1);
+    /* bit 27: OSXSAVE, bit 28: AVX */
+    if ((regs[2] & (3 << 27)) != (3 << 27) || (_xgetbv(0) & 6) != 6)
+    {
+        return 0;
+    }
+    __cpuidex(regs, 7, 0);
+    return (regs[1] >> 5) & 1;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+/**
+ * @brief picks the fastest kernel available on this processor, once
+ * @returns the kernel
+ */
+static inline adler32_kernel adler32_select_kernel(void)
+{
+    static adler32_kernel kernel = NULL;
+    if (!kernel)
+    {
+#ifdef ADLER32_SIMD
+        kernel = adler32_cpu_has_avx2() ? adler32_avx2 : adler32_sse2;
+#else
+        kernel = adler32_scalar;
+#endif
+    }
+    return kernel;
+}
+
+/**
+ * @brief starts a new Adler-32 computation
+ * @param ctx state to initialize
+ * @returns void
+ */
+static inline void adler32_init(adler32_ctx *ctx)
+{
+    ctx->a = 1;
+    ctx->b = 0;
+}
+
+/**
+ * @brief adds `len` bytes to a running Adler-32
+ *
+ * @param ctx state initialized by ::adler32_init
+ * @param data bytes to add, may contain NUL bytes
+ * @param len number of bytes at data
+ * @returns void
+ */
+static inline void adler32_update(adler32_ctx *ctx, const void *data,
+                                  size_t len)
+{
+    adler32_select_kernel()(&ctx->a, &ctx->b, data, len);
+}
+
+/**
+ * @brief finishes an Adler-32 computation
+ * @param ctx state of the computation
+ * @return 32-bit checksum of all bytes passed to ::adler32_update
+ */
+static inline uint32_t adler32_final(const adler32_ctx *ctx)
+{
+    return (ctx->b << 16) | ctx->a;
+}
+
+/**
+ * @brief Adler-32 of a single buffer
+ *
+ * @param data bytes to hash
+ * @param len number of bytes at data
+ * @return 32-bit checksum
+ */
+static inline uint32_t adler32_buffer(const void *data, size_t len)
+{
+    adler32_ctx ctx;
+    adler32_init(&ctx);
+    adler32_update(&ctx, data, len);
+    return adler32_final(&ctx);
+}
+
+/**
+ * @brief checksum of the concatenation of two chunks
+ *
+ * @param adler_a checksum of the first chunk
+ * @param adler_b checksum of the second chunk
+ * @param len_b length of the second chunk in bytes
+ * @return checksum of the first chunk followed by the second
+ */
+static inline uint32_t adler32_combine(uint32_t adler_a, uint32_t adler_b,
+                                       uint64_t len_b)
+{
+    uint32_t rem = (uint32_t)(len_b % MODADLER);
+    uint32_t a = adler_a & 0xffff;
+    uint32_t b = (uint32_t)((uint64_t)rem * a % MODADLER);
+
+    /* the second chunk started from a = 1 instead of a, b = 0 instead of b */
+    a += (adler_b & 0xffff) + MODADLER - 1;
+    b += (adler_a >> 16) + (adler_b >> 16) + MODADLER - rem;
+
+    a %= MODADLER;
+    b %= MODADLER;
+    return (b << 16) | a;
+}
+
+/**
+ * @brief 32-bit Adler algorithm implementation
+ *
+ * @param s NULL terminated ASCII string to hash
+ * @return 32-bit hash result
+ */
+static inline uint32_t adler32(const char* s)
+{
+    return adler32_buffer(s, strlen(s));
+}
+
+/** @} */
+
+#endif /* HASH_ADLER32_H */
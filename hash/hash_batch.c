@@ -0,0 +1,202 @@
+/**
+ * @addtogroup hash Hash algorithms
+ * @{
+ * @file hash_batch.c
+ * @brief Tests and benchmark of ::hash_many, which hashes many keys per call
+ *
+ * The kernels are in hash_batch.h. The benchmark hashes millions of keys of
+ * random length one at a time, with the interleaved scalar kernels and with
+ * the AVX2 kernels where the processor has them.
+ */
+#include <assert.h>  /// for assert
+#include <stdio.h>   /// for IO
+#include <stdlib.h>  /// for malloc, rand and free
+#include <string.h>  /// for strlen
+#include <time.h>    /// for clock
+
+#include "hash_batch.h"  /// for hash_many
+
+/**
+ * @brief Test function for ::hash_many
+ * \returns None
+ */
+void test_hash_many()
+{
+    /* the test vectors of the one-key files */
+    const char *hello[4] = {"Hello World", "Hello World!", "Hello world",
+                            "Hello world!"};
+    const uint64_t expected[HASH_ALGO_COUNT][4] = {
+        {13827776004929097857U, 13594750393630990530U, 13827776004967047329U,
+         13594750394883323106U},
+        {12881824461405877380U, 7903571203300273309U, 15154913742888948900U,
+         15254999417003201661U},
+        {228, 195, 196, 163},
+        {403375133, 474547262, 413860925, 487130206}};
+    size_t hello_lens[4];
+    uint64_t out[4];
+
+    for (int j = 0; j < 4; j++)
+    {
+        hello_lens[j] = strlen(hello[j]);
+    }
+    for (int algo = 0; algo < HASH_ALGO_COUNT; algo++)
+    {
+        hash_many((hash_algo)algo, hello, hello_lens, 4, out);
+        for (int j = 0; j < 4; j++)
+        {
+            assert(out[j] == expected[algo][j]);
+            assert(hash_one((hash_algo)algo, hello[j], hello_lens[j]) ==
+                   expected[algo][j]);
+        }
+    }
+
+    /* binary keys of mixed lengths, a few of them long enough to need the
+     * deferred Adler-32 reductions, in every count around the group sizes;
+     * the first 32 keys are long enough for the wide kernels and keys 48 to
+     * 63 short enough for the transposing ones */
+    enum
+    {
+        KEYS = 67
+    };
+    const char *keys[KEYS];
+    size_t lens[KEYS];
+    uint64_t batched[KEYS], narrow[KEYS];
+    char *data[KEYS];
+
+    for (int k = 0; k < KEYS; k++)
+    {
+        lens[k] = k % 16 == 5 ? (size_t)(70000 + rand() % 100)
+                              : (size_t)(rand() % 41);
+        lens[k] += k < 32 ? 8 : 0;
+        lens[k] = k >= 48 && k < 64 ? (size_t)(rand() % 17) : lens[k];
+        data[k] = malloc(lens[k] + 1);
+        assert(data[k]);
+        for (size_t i = 0; i < lens[k]; i++)
+        {
+            data[k][i] = (char)rand();
+        }
+        keys[k] = data[k];
+    }
+    for (int algo = 0; algo < HASH_ALGO_COUNT; algo++)
+    {
+        for (size_t n = 0; n <= KEYS; n += n < 20 ? 1 : 47)
+        {
+            hash_many((hash_algo)algo, keys, lens, n, batched);
+            hash_many_kernels((hash_algo)algo, keys, lens, n, narrow, 0);
+            for (size_t k = 0; k < n; k++)
+            {
+                uint64_t one = hash_one((hash_algo)algo, keys[k], lens[k]);
+                assert(batched[k] == one);
+                assert(narrow[k] == one);
+            }
+        }
+    }
+    for (int k = 0; k < KEYS; k++)
+    {
+        free(data[k]);
+    }
+    printf("Tests passed\n");
+}
+
+/**
+ * @brief prints the rate of one-at-a-time, interleaved scalar and batched
+ * hashing of the same keys with every algorithm
+ * @param keys `n` keys
+ * @param lens their lengths
+ * @param n number of keys
+ * @param out room for `n` hashes
+ * \returns None
+ */
+static void benchmark_keys(const char **keys, const size_t *lens, size_t n,
+                           uint64_t *out)
+{
+    printf("%-8s %12s %12s %12s  (Mkeys/s)\n", "", "one-by-one",
+           "interleaved", "batched");
+    for (int algo = 0; algo < HASH_ALGO_COUNT; algo++)
+    {
+        volatile uint64_t sink = 0;
+        double rate[3];
+
+        for (int mode = 0; mode < 3; mode++)
+        {
+            clock_t start = clock();
+            if (mode == 0)
+            {
+                for (size_t k = 0; k < n; k++)
+                {
+                    out[k] = hash_one((hash_algo)algo, keys[k], lens[k]);
+                }
+            }
+            else
+            {
+                hash_many_kernels((hash_algo)algo, keys, lens, n, out,
+                                  mode == 2);
+            }
+            double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+            sink ^= out[n - 1];
+            rate[mode] = n / 1e6 / (seconds > 0 ? seconds : 1e-9);
+        }
+        printf("%-8s %12.1f %12.1f %12.1f\n", hash_algo_names[algo], rate[0],
+               rate[1], rate[2]);
+    }
+}
+
+/**
+ * @brief compares one-at-a-time and batched hashing of millions of keys of
+ * random length
+ * \returns None
+ */
+static void benchmark_hash_many()
+{
+    const size_t n = 1 << 21, stride = 32;
+    const struct
+    {
+        const char *name;
+        size_t min_len, max_len;
+    } lengths[] = {{"short", 4, 16}, {"medium", 16, 32}};
+    const char **keys = malloc(n * sizeof(*keys));
+    size_t *lens = malloc(n * sizeof(*lens));
+    uint64_t *out = malloc(n * sizeof(*out));
+    char *arena = malloc(n * stride);
+    if (!keys || !lens || !out || !arena)
+    {
+        free(keys), free(lens), free(out), free(arena);
+        return;
+    }
+
+    /* printable keys, as in a word or identifier list */
+    for (size_t k = 0; k < n; k++)
+    {
+        keys[k] = arena + k * stride;
+        for (size_t i = 0; i < stride; i++)
+        {
+            arena[k * stride + i] = (char)('a' + rand() % 26);
+        }
+    }
+    for (size_t d = 0; d < sizeof(lengths) / sizeof(lengths[0]); d++)
+    {
+        size_t spread = lengths[d].max_len - lengths[d].min_len + 1;
+        for (size_t k = 0; k < n; k++)
+        {
+            lens[k] = lengths[d].min_len + rand() % spread;
+        }
+        printf("%zu %s keys of %zu to %zu bytes\n", n, lengths[d].name,
+               lengths[d].min_len, lengths[d].max_len);
+        benchmark_keys(keys, lens, n, out);
+    }
+
+    free(keys);
+    free(lens);
+    free(out);
+    free(arena);
+}
+
+/** @} */
+
+/** Main function */
+int main()
+{
+    test_hash_many();
+    benchmark_hash_many();
+    return 0;
+}
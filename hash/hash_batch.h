@@ -0,0 +1,966 @@
+/**
+ * @addtogroup hash Hash algorithms
+ * @{
+ * @file hash_batch.h
+ * @brief Hashing many keys per call with the algorithms of this directory
+ *
+ * The other files of this directory hash one NUL terminated string per call.
+ * Every one of those hashes is a chain of dependent steps, so while a single
+ * key is hashed the processor mostly waits for the previous shift, multiply
+ * or table lookup to finish. ::hash_many hashes `n` independent
+ * `(key, length)` pairs instead:
+ * - keys are taken ::HASH_BATCH_LANES at a time and advanced together, so
+ *   that several chains are in flight at once. Past the end of the shorter
+ *   keys of a group their lanes are masked instead of branched around, so
+ *   keys of random lengths do not pay a mispredicted loop exit each;
+ * - djb2, sdbm and Adler-32 run eight keys in the 64-bit lanes of two AVX2
+ *   registers when the processor supports it (checked at runtime). Groups of
+ *   keys of at most ::HASH_BATCH_SHORT bytes are transposed into words with
+ *   zero bytes in front of every key, and each lane starts from a state the
+ *   zeros turn into the usual one, so short keys run without masks;
+ * - xor8 adds eight bytes per multiplication.
+ *
+ * On keys of 4 to 16 bytes this hashes djb2, sdbm and Adler-32 about 1.3 to
+ * 1.5 times as fast as one key at a time.
+ *
+ * CRC-32 is not offered. Slicing-by-8 is bound by the throughput of its
+ * eight table lookups per word rather than by the latency of one key, so
+ * four keys interleaved ran no faster than crc32_buffer() of hash_crc32.h
+ * one key at a time.
+ *
+ * The results equal those of djb2_buffer(), sdbm_buffer(), xor8_buffer()
+ * and adler32_buffer(), which ::hash_one calls. As there, djb2, sdbm and
+ * xor8 add every byte as a `char`. The tests and a benchmark are in
+ * hash_batch.c.
+ */
+#ifndef HASH_BATCH_H
+#define HASH_BATCH_H
+
+#include <limits.h>  /// for CHAR_MIN
+#include <stddef.h>  /// for size_t
+#include <stdint.h>  /// for fixed-width integer types
+#include <string.h>  /// for memcpy and memset
+
+#include "hash_adler32.h"  /// for adler32_buffer and ::MODADLER
+#include "hash_djb2.h"     /// for djb2_buffer
+#include "hash_sdbm.h"     /// for sdbm_buffer
+#include "hash_xor8.h"     /// for xor8_buffer
+
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HASH_BATCH_SIMD 1  ///< the AVX2 kernels are compiled in
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define HASH_BATCH_TARGET_AVX2
+#else
+/** enables AVX2 code generation for a single function */
+#define HASH_BATCH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#define HASH_BATCH_LANES 4  ///< keys advanced together by the scalar kernels
+#define HASH_BATCH_WIDE 8   ///< keys advanced together by the AVX2 kernels
+/** longest key of a group hashed by the transposing short-key kernels */
+#define HASH_BATCH_SHORT 16
+
+/** Adler-32 bytes summed in 64-bit lanes before reducing, a multiple of 8 */
+#define HASH_BATCH_ADLER32_NMAX (1 << 16)
+
+/**
+ * @brief algorithms available to ::hash_many
+ */
+typedef enum
+{
+    HASH_DJB2,
+    HASH_SDBM,
+    HASH_XOR8,
+    HASH_ADLER32,
+    HASH_ALGO_COUNT  ///< number of algorithms, not an algorithm
+} hash_algo;
+
+/** printable names, indexed by ::hash_algo */
+static const char *const hash_algo_names[HASH_ALGO_COUNT] = {
+    "djb2", "sdbm", "xor8", "adler32"};
+
+/**
+ * @brief hashes a group of keys; the group size depends on the kernel
+ */
+typedef void (*hash_group_kernel)(const char *const *keys, const size_t *lens,
+                                  uint64_t *out);
+
+/**
+ * @brief reads a little-endian 64-bit word from any address
+ * @param p pointer to 8 bytes
+ * @returns the word
+ */
+static inline uint64_t hash_batch_load64(const char *p)
+{
+    const unsigned char *u = (const unsigned char *)p;
+    return (uint64_t)u[0] | ((uint64_t)u[1] << 8) | ((uint64_t)u[2] << 16) |
+           ((uint64_t)u[3] << 24) | ((uint64_t)u[4] << 32) |
+           ((uint64_t)u[5] << 40) | ((uint64_t)u[6] << 48) |
+           ((uint64_t)u[7] << 56);
+}
+
+/**
+ * @brief length shared by all keys of a group
+ * @param lens lengths of the keys
+ * @param count number of keys
+ * @returns the smallest length
+ */
+static inline size_t hash_batch_min_len(const size_t *lens, size_t count)
+{
+    size_t m = lens[0];
+    for (size_t j = 1; j < count; j++)
+    {
+        m = lens[j] < m ? lens[j] : m;
+    }
+    return m;
+}
+
+/**
+ * @brief length of the longest key of a group
+ * @param lens lengths of the keys
+ * @param count number of keys
+ * @returns the largest length
+ */
+static inline size_t hash_batch_max_len(const size_t *lens, size_t count)
+{
+    size_t m = lens[0];
+    for (size_t j = 1; j < count; j++)
+    {
+        m = lens[j] > m ? lens[j] : m;
+    }
+    return m;
+}
+
+/** stands in for keys of length 0, so that every lane can read its byte 0 */
+static const char hash_batch_empty[8] = {0};
+
+/**
+ * byte `i` of a key of length `len`, or its byte 0 once `i` is past the end;
+ * the index is masked rather than branched on, so that lanes finishing at
+ * different lengths cost no mispredictions
+ */
+#define HASH_BATCH_BYTE(k, len, i) ((k)[(i) & (0 - (size_t)((i) < (len)))])
+
+/**
+ * @brief picks one of two values without a branch
+ * @param next value to return if `live` is 1
+ * @param h value to return if `live` is 0
+ * @param live 0 or 1
+ * @returns `next` or `h`
+ */
+static inline uint64_t hash_batch_pick(uint64_t next, uint64_t h, uint64_t live)
+{
+    uint64_t mask = 0 - live;
+    return (next & mask) | (h & ~mask);
+}
+
+/**
+ * @brief turns the byte sum of xor8 into the hash
+ * @param sum byte sum of the key
+ * @returns the 8-bit hash
+ */
+static inline uint64_t hash_batch_xor8_final(uint64_t sum)
+{
+    return ((((uint8_t)sum) ^ 0xff) + 1) & 0xff;
+}
+
+/**
+ * @brief sum of the eight bytes of a word, modulo 256
+ *
+ * Even and odd bytes are first added into four 16-bit lanes, which a single
+ * multiplication then sums into the top lane without carries between lanes.
+ * @param w eight bytes
+ * @returns their sum; only its low 8 bits are meaningful
+ */
+static inline uint64_t hash_batch_xor8_word(uint64_t w)
+{
+    const uint64_t even = 0x00ff00ff00ff00ffULL;
+    uint64_t pairs = (w & even) + ((w >> 8) & even);
+    return (pairs * 0x0001000100010001ULL) >> 48;
+}
+
+/**
+ * @brief hashes a single key, the one-at-a-time reference for ::hash_many
+ * @param algo algorithm to use
+ * @param key bytes of the key
+ * @param len number of bytes at key
+ * @returns the hash, zero-extended to 64 bits
+ */
+static inline uint64_t hash_one(hash_algo algo, const char *key, size_t len)
+{
+    switch (algo)
+    {
+    case HASH_DJB2:
+        return djb2_buffer(key, len);
+    case HASH_SDBM:
+        return sdbm_buffer(key, len);
+    case HASH_XOR8:
+        return xor8_buffer(key, len);
+    case HASH_ADLER32:
+        return adler32_buffer(key, len);
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief defines a kernel hashing four keys with the one-byte step `STEP`,
+ * started from `init` and finished with `FINAL`
+ *
+ * The common length of the keys is hashed unmasked; after that every lane
+ * keeps its state once its key has no bytes left.
+ */
+#define DEFINE_NARROW_KERNEL(name, init, STEP, FINAL)                      \
+    static inline void name(const char *const *keys, const size_t *lens,   \
+                            uint64_t *out)                                 \
+    {                                                                      \
+        size_t m = hash_batch_min_len(lens, 4);                            \
+        size_t longest = hash_batch_max_len(lens, 4);                      \
+        size_t l0 = lens[0], l1 = lens[1], l2 = lens[2], l3 = lens[3];     \
+        const char *k0 = l0 ? keys[0] : hash_batch_empty;                  \
+        const char *k1 = l1 ? keys[1] : hash_batch_empty;                  \
+        const char *k2 = l2 ? keys[2] : hash_batch_empty;                  \
+        const char *k3 = l3 ? keys[3] : hash_batch_empty;                  \
+        uint64_t h0 = init, h1 = init, h2 = init, h3 = init;               \
+                                                                           \
+        for (size_t i = 0; i < m; i++)                                     \
+        {                                                                  \
+            h0 = STEP(h0, k0[i]);                                          \
+            h1 = STEP(h1, k1[i]);                                          \
+            h2 = STEP(h2, k2[i]);                                          \
+            h3 = STEP(h3, k3[i]);                                          \
+        }                                                                  \
+        for (size_t i = m; i < longest; i++)                               \
+        {                                                                  \
+            h0 = hash_batch_pick(STEP(h0, HASH_BATCH_BYTE(k0, l0, i)), h0, \
+                                 i < l0);                                  \
+            h1 = hash_batch_pick(STEP(h1, HASH_BATCH_BYTE(k1, l1, i)), h1, \
+                                 i < l1);                                  \
+            h2 = hash_batch_pick(STEP(h2, HASH_BATCH_BYTE(k2, l2, i)), h2, \
+                                 i < l2);                                  \
+            h3 = hash_batch_pick(STEP(h3, HASH_BATCH_BYTE(k3, l3, i)), h3, \
+                                 i < l3);                                  \
+        }                                                                  \
+        out[0] = FINAL(h0);                                                \
+        out[1] = FINAL(h1);                                                \
+        out[2] = FINAL(h2);                                                \
+        out[3] = FINAL(h3);                                                \
+    }
+
+/** one djb2 step */
+#define DJB2_STEP(h, c) (((h) << 5) + (h) + (c))
+/** one sdbm step */
+#define SDBM_STEP(h, c) ((c) + ((h) << 6) + ((h) << 16) - (h))
+/** the hash of djb2 and sdbm is their state */
+#define STATE_FINAL(h) (h)
+
+DEFINE_NARROW_KERNEL(djb2_x4, 5381, DJB2_STEP, STATE_FINAL)
+DEFINE_NARROW_KERNEL(sdbm_x4, 0, SDBM_STEP, STATE_FINAL)
+
+/**
+ * @brief xor8 of four keys
+ *
+ * The common length is summed eight bytes per multiplication, see
+ * ::hash_batch_xor8_word; after that a lane adds zero once its key has ended.
+ * @param keys four keys
+ * @param lens their lengths
+ * @param out four hashes
+ * @returns void
+ */
+static inline void xor8_x4(const char *const *keys, const size_t *lens,
+                           uint64_t *out)
+{
+    size_t m = hash_batch_min_len(lens, 4) & ~(size_t)7;
+    size_t longest = hash_batch_max_len(lens, 4);
+    size_t l0 = lens[0], l1 = lens[1], l2 = lens[2], l3 = lens[3];
+    const char *k0 = l0 ? keys[0] : hash_batch_empty;
+    const char *k1 = l1 ? keys[1] : hash_batch_empty;
+    const char *k2 = l2 ? keys[2] : hash_batch_empty;
+    const char *k3 = l3 ? keys[3] : hash_batch_empty;
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+    for (size_t i = 0; i < m; i += 8)
+    {
+        s0 += hash_batch_xor8_word(hash_batch_load64(k0 + i));
+        s1 += hash_batch_xor8_word(hash_batch_load64(k1 + i));
+        s2 += hash_batch_xor8_word(hash_batch_load64(k2 + i));
+        s3 += hash_batch_xor8_word(hash_batch_load64(k3 + i));
+    }
+    for (size_t i = m; i < longest; i++)
+    {
+        s0 += (uint64_t)HASH_BATCH_BYTE(k0, l0, i) & (0 - (uint64_t)(i < l0));
+        s1 += (uint64_t)HASH_BATCH_BYTE(k1, l1, i) & (0 - (uint64_t)(i < l1));
+        s2 += (uint64_t)HASH_BATCH_BYTE(k2, l2, i) & (0 - (uint64_t)(i < l2));
+        s3 += (uint64_t)HASH_BATCH_BYTE(k3, l3, i) & (0 - (uint64_t)(i < l3));
+    }
+    out[0] = hash_batch_xor8_final(s0);
+    out[1] = hash_batch_xor8_final(s1);
+    out[2] = hash_batch_xor8_final(s2);
+    out[3] = hash_batch_xor8_final(s3);
+}
+
+/**
+ * @brief Adler-32 of four keys, reduced every ::ADLER32_NMAX bytes
+ *
+ * After the common length a lane adds zero bytes to its first sum once its
+ * key has ended, and its second sum is masked.
+ * @param keys four keys
+ * @param lens their lengths
+ * @param out four checksums
+ * @returns void
+ */
+static inline void adler32_x4(const char *const *keys, const size_t *lens,
+                              uint64_t *out)
+{
+    size_t m = hash_batch_min_len(lens, 4);
+    size_t longest = hash_batch_max_len(lens, 4);
+    size_t l0 = lens[0], l1 = lens[1], l2 = lens[2], l3 = lens[3];
+    const unsigned char *k0 =
+        (const unsigned char *)(l0 ? keys[0] : hash_batch_empty);
+    const unsigned char *k1 =
+        (const unsigned char *)(l1 ? keys[1] : hash_batch_empty);
+    const unsigned char *k2 =
+        (const unsigned char *)(l2 ? keys[2] : hash_batch_empty);
+    const unsigned char *k3 =
+        (const unsigned char *)(l3 ? keys[3] : hash_batch_empty);
+    uint32_t a0 = 1, a1 = 1, a2 = 1, a3 = 1;
+    uint32_t b0 = 0, b1 = 0, b2 = 0, b3 = 0;
+
+    for (size_t i = 0; i < longest;)
+    {
+        size_t end = longest - i < ADLER32_NMAX ? longest : i + ADLER32_NMAX;
+        for (; i < end && i < m; i++)
+        {
+            a0 += k0[i], a1 += k1[i], a2 += k2[i], a3 += k3[i];
+            b0 += a0, b1 += a1, b2 += a2, b3 += a3;
+        }
+        for (; i < end; i++)
+        {
+            uint32_t live0 = 0 - (uint32_t)(i < l0);
+            uint32_t live1 = 0 - (uint32_t)(i < l1);
+            uint32_t live2 = 0 - (uint32_t)(i < l2);
+            uint32_t live3 = 0 - (uint32_t)(i < l3);
+
+            a0 += HASH_BATCH_BYTE(k0, l0, i) & live0;
+            a1 += HASH_BATCH_BYTE(k1, l1, i) & live1;
+            a2 += HASH_BATCH_BYTE(k2, l2, i) & live2;
+            a3 += HASH_BATCH_BYTE(k3, l3, i) & live3;
+            b0 += a0 & live0, b1 += a1 & live1;
+            b2 += a2 & live2, b3 += a3 & live3;
+        }
+        a0 %= MODADLER, a1 %= MODADLER;
+        a2 %= MODADLER, a3 %= MODADLER;
+        b0 %= MODADLER, b1 %= MODADLER;
+        b2 %= MODADLER, b3 %= MODADLER;
+    }
+    out[0] = ((uint64_t)b0 << 16) | a0;
+    out[1] = ((uint64_t)b1 << 16) | a1;
+    out[2] = ((uint64_t)b2 << 16) | a2;
+    out[3] = ((uint64_t)b3 << 16) | a3;
+}
+
+#ifdef HASH_BATCH_SIMD
+/**
+ * @brief checks whether the processor and OS support AVX2
+ * @returns 1 if the AVX2 kernels may be used, 0 otherwise
+ */
+static inline int hash_batch_cpu_has_avx2(void)
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+    {
+        return 0;
+    }
+    __cpuid(regs, 1);
+    /* bit 27: OSXSAVE, bit 28: AVX */
+    if ((regs[2] & (3 << 27)) != (3 << 27) || (_xgetbv(0) & 6) != 6)
+    {
+        return 0;
+    }
+    __cpuidex(regs, 7, 0);
+    return (regs[1] >> 5) & 1;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+/**
+ * @brief reads bytes `i` to `i + 7` of a key, zero past its end
+ *
+ * The word is loaded from the last full word of the key not after `i` and
+ * shifted into place, so no lane ever branches on its length. A key shorter
+ * than 8 bytes must be a zero-padded copy, see ::hash_batch_pad_short_keys.
+ * @param p key, with at least 8 readable bytes
+ * @param len length of the key
+ * @param i offset
+ * @returns the little-endian word
+ */
+static inline uint64_t hash_batch_load_padded(const char *p, size_t len,
+                                              size_t i)
+{
+    size_t last = len < 8 ? 0 : len - 8;
+    size_t off = i < last ? i : last;
+    size_t shift = i - off;
+    uint64_t w = hash_batch_load64(p + off) >> (8 * (shift & 7));
+    return w & (0 - (uint64_t)(shift < 8));
+}
+
+/**
+ * @brief copies the keys of a group that are shorter than 8 bytes into
+ * zero-padded words, so that the wide kernels can load a whole word of each
+ * @param keys ::HASH_BATCH_WIDE keys
+ * @param lens their lengths
+ * @param padded receives the keys to hash: the copy or the key itself
+ * @param pad room for the copies
+ * @returns void
+ */
+static inline void hash_batch_pad_short_keys(const char *const *keys,
+                                             const size_t *lens,
+                                             const char **padded,
+                                             char pad[HASH_BATCH_WIDE][8])
+{
+    for (int j = 0; j < HASH_BATCH_WIDE; j++)
+    {
+        padded[j] = keys[j];
+        if (lens[j] < 8)
+        {
+            memset(pad[j], 0, 8);
+            if (lens[j])
+            {
+                memcpy(pad[j], keys[j], lens[j]);
+            }
+            padded[j] = pad[j];
+        }
+    }
+}
+
+/**
+ * @brief loads the 8 bytes at offset `i` of four keys, one key per lane
+ * @param keys four keys, each at least `i + 8` bytes long
+ * @param i offset
+ * @returns the four little-endian words
+ */
+HASH_BATCH_TARGET_AVX2
+static inline __m256i hash_batch_load_lanes(const char *const *keys, size_t i)
+{
+    return _mm256_set_epi64x(
+        (long long)hash_batch_load64(keys[3] + i),
+        (long long)hash_batch_load64(keys[2] + i),
+        (long long)hash_batch_load64(keys[1] + i),
+        (long long)hash_batch_load64(keys[0] + i));
+}
+
+/**
+ * @brief like ::hash_batch_load_lanes for keys that may end before `i + 8`
+ * @param keys four keys, each with at least 8 readable bytes
+ * @param lens their lengths
+ * @param i offset
+ * @returns the four little-endian words, with zeros past the ends
+ */
+HASH_BATCH_TARGET_AVX2
+static inline __m256i hash_batch_load_lanes_padded(const char *const *keys,
+                                                   const size_t *lens, size_t i)
+{
+    return _mm256_set_epi64x(
+        (long long)hash_batch_load_padded(keys[3], lens[3], i),
+        (long long)hash_batch_load_padded(keys[2], lens[2], i),
+        (long long)hash_batch_load_padded(keys[1], lens[1], i),
+        (long long)hash_batch_load_padded(keys[0], lens[0], i));
+}
+
+/**
+ * @brief the low byte of every lane, as a `char` would be added
+ * @param w four words
+ * @returns the bytes, sign-extended when `char` is signed
+ */
+HASH_BATCH_TARGET_AVX2
+static inline __m256i hash_batch_low_chars(__m256i w)
+{
+    __m256i c = _mm256_and_si256(w, _mm256_set1_epi64x(0xff));
+#if CHAR_MIN < 0
+    const __m256i sign = _mm256_set1_epi64x(0x80);
+    c = _mm256_sub_epi64(_mm256_xor_si256(c, sign), sign);
+#endif
+    return c;
+}
+
+/**
+ * @brief picks every lane of `next` where `live` is all ones, else of `h`
+ *
+ * Written with bitwise operations rather than `_mm256_blendv_epi8`, which
+ * some GCC versions miscompile under `-funsigned-char`.
+ * @param next lanes to take where `live` is set
+ * @param h lanes to keep elsewhere
+ * @param live all ones or all zeros in every lane
+ * @returns the selection
+ */
+HASH_BATCH_TARGET_AVX2
+static inline __m256i hash_batch_pick_lanes(__m256i next, __m256i h,
+                                            __m256i live)
+{
+    return _mm256_or_si256(_mm256_and_si256(live, next),
+                           _mm256_andnot_si256(live, h));
+}
+
+/** one djb2 step in every lane of `h` */
+#define DJB2_AVX2(h, c) \
+    _mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(h, 5), h), c)
+
+/** one sdbm step in every lane of `h` */
+#define SDBM_AVX2(h, c)                                                \
+    _mm256_sub_epi64(                                                  \
+        _mm256_add_epi64(_mm256_add_epi64(c, _mm256_slli_epi64(h, 6)), \
+                         _mm256_slli_epi64(h, 16)),                    \
+        h)
+
+/**
+ * @brief defines an AVX2 kernel hashing eight keys in two registers with the
+ * one-byte step `STEP`, started from `init`
+ *
+ * Every key must have at least 8 readable bytes, see
+ * ::hash_batch_load_padded. As in ::DEFINE_NARROW_KERNEL the common length
+ * is hashed unmasked; after that every step is blended in only where the key
+ * has bytes left.
+ */
+#define DEFINE_WIDE_KERNEL(name, init, STEP)                                   \
+    HASH_BATCH_TARGET_AVX2                                                     \
+    static inline void name(const char *const *keys, const size_t *lens,       \
+                            uint64_t *out)                                     \
+    {                                                                          \
+        size_t m = hash_batch_min_len(lens, 8) & ~(size_t)7;                   \
+        size_t longest = hash_batch_max_len(lens, 8);                          \
+        __m256i lo = _mm256_set1_epi64x(init), hi = lo;                        \
+        __m256i len_lo = _mm256_loadu_si256((const __m256i *)lens);            \
+        __m256i len_hi = _mm256_loadu_si256((const __m256i *)(lens + 4));      \
+                                                                               \
+        for (size_t i = 0; i < m; i += 8)                                      \
+        {                                                                      \
+            __m256i wlo = hash_batch_load_lanes(keys, i);                      \
+            __m256i whi = hash_batch_load_lanes(keys + 4, i);                  \
+            for (int j = 0; j < 8; j++)                                        \
+            {                                                                  \
+                lo = STEP(lo, hash_batch_low_chars(wlo));                      \
+                hi = STEP(hi, hash_batch_low_chars(whi));                      \
+                wlo = _mm256_srli_epi64(wlo, 8);                               \
+                whi = _mm256_srli_epi64(whi, 8);                               \
+            }                                                                  \
+        }                                                                      \
+        for (size_t i = m; i < longest; i += 8)                                \
+        {                                                                      \
+            __m256i wlo = hash_batch_load_lanes_padded(keys, lens, i);         \
+            __m256i whi = hash_batch_load_lanes_padded(keys + 4, lens + 4, i); \
+            __m256i at = _mm256_set1_epi64x((long long)i);                     \
+            for (int j = 0; j < 8; j++)                                        \
+            {                                                                  \
+                lo = hash_batch_pick_lanes(                                    \
+                    STEP(lo, hash_batch_low_chars(wlo)), lo,                   \
+                                  _mm256_cmpgt_epi64(len_lo, at));             \
+                hi = hash_batch_pick_lanes(                                    \
+                    STEP(hi, hash_batch_low_chars(whi)), hi,                   \
+                                  _mm256_cmpgt_epi64(len_hi, at));             \
+                wlo = _mm256_srli_epi64(wlo, 8);                               \
+                whi = _mm256_srli_epi64(whi, 8);                               \
+                at = _mm256_add_epi64(at, _mm256_set1_epi64x(1));              \
+            }                                                                  \
+        }                                                                      \
+        _mm256_storeu_si256((__m256i *)out, lo);                               \
+        _mm256_storeu_si256((__m256i *)(out + 4), hi);                         \
+    }
+
+DEFINE_WIDE_KERNEL(djb2_x8_avx2, 5381, DJB2_AVX2)
+DEFINE_WIDE_KERNEL(sdbm_x8_avx2, 0, SDBM_AVX2)
+
+/**
+ * @brief Adler-32 of eight keys, the two sums of each in 64-bit lanes
+ *
+ * 64-bit lanes cannot overflow within ::HASH_BATCH_ADLER32_NMAX bytes, after
+ * which the sums are reduced in scalar code. Past the end of a key its first
+ * sum only receives zeros, and its second sum is masked.
+ * @param keys eight keys, each with at least 8 readable bytes
+ * @param lens their lengths
+ * @param out eight checksums
+ * @returns void
+ */
+HASH_BATCH_TARGET_AVX2
+static inline void adler32_x8_avx2(const char *const *keys, const size_t *lens,
+                                   uint64_t *out)
+{
+    const __m256i byte = _mm256_set1_epi64x(0xff);
+    size_t m = hash_batch_min_len(lens, 8) & ~(size_t)7;
+    size_t longest = hash_batch_max_len(lens, 8);
+    __m256i len_lo = _mm256_loadu_si256((const __m256i *)lens);
+    __m256i len_hi = _mm256_loadu_si256((const __m256i *)(lens + 4));
+    uint64_t a[8], b[8];
+
+    for (int j = 0; j < 8; j++)
+    {
+        a[j] = 1;
+        b[j] = 0;
+    }
+    for (size_t i = 0; i < longest;)
+    {
+        size_t end = longest - i < HASH_BATCH_ADLER32_NMAX
+                         ? longest
+                         : i + HASH_BATCH_ADLER32_NMAX;
+        __m256i alo = _mm256_loadu_si256((const __m256i *)a);
+        __m256i ahi = _mm256_loadu_si256((const __m256i *)(a + 4));
+        __m256i blo = _mm256_loadu_si256((const __m256i *)b);
+        __m256i bhi = _mm256_loadu_si256((const __m256i *)(b + 4));
+
+        for (; i < end && i < m; i += 8)
+        {
+            __m256i wlo = hash_batch_load_lanes(keys, i);
+            __m256i whi = hash_batch_load_lanes(keys + 4, i);
+            for (int j = 0; j < 8; j++)
+            {
+                alo = _mm256_add_epi64(alo, _mm256_and_si256(wlo, byte));
+                ahi = _mm256_add_epi64(ahi, _mm256_and_si256(whi, byte));
+                blo = _mm256_add_epi64(blo, alo);
+                bhi = _mm256_add_epi64(bhi, ahi);
+                wlo = _mm256_srli_epi64(wlo, 8);
+                whi = _mm256_srli_epi64(whi, 8);
+            }
+        }
+        for (; i < end; i += 8)
+        {
+            __m256i wlo = hash_batch_load_lanes_padded(keys, lens, i);
+            __m256i whi = hash_batch_load_lanes_padded(keys + 4, lens + 4, i);
+            __m256i at = _mm256_set1_epi64x((long long)i);
+            for (int j = 0; j < 8; j++)
+            {
+                __m256i live_lo = _mm256_cmpgt_epi64(len_lo, at);
+                __m256i live_hi = _mm256_cmpgt_epi64(len_hi, at);
+                alo = _mm256_add_epi64(alo, _mm256_and_si256(wlo, byte));
+                ahi = _mm256_add_epi64(ahi, _mm256_and_si256(whi, byte));
+                blo = _mm256_add_epi64(blo, _mm256_and_si256(alo, live_lo));
+                bhi = _mm256_add_epi64(bhi, _mm256_and_si256(ahi, live_hi));
+                wlo = _mm256_srli_epi64(wlo, 8);
+                whi = _mm256_srli_epi64(whi, 8);
+                at = _mm256_add_epi64(at, _mm256_set1_epi64x(1));
+            }
+        }
+        _mm256_storeu_si256((__m256i *)a, alo);
+        _mm256_storeu_si256((__m256i *)(a + 4), ahi);
+        _mm256_storeu_si256((__m256i *)b, blo);
+        _mm256_storeu_si256((__m256i *)(b + 4), bhi);
+        for (int j = 0; j < 8; j++)
+        {
+            a[j] %= MODADLER;
+            b[j] %= MODADLER;
+        }
+    }
+    for (int j = 0; j < 8; j++)
+    {
+        out[j] = (b[j] << 16) | a[j];
+    }
+}
+
+/**
+ * @brief transposes eight keys of at most ::HASH_BATCH_SHORT bytes into
+ * words, key `j` in lane `j`, each key right-aligned behind zero bytes
+ *
+ * With the padding in front, every lane runs all `steps` bytes unmasked; the
+ * kernels start each lane from a state that the leading zeros turn into the
+ * usual initial state.
+ * @param keys eight keys
+ * @param lens their lengths
+ * @param words receives word `w` of key `j` in `words[w][j]`
+ * @param pads receives the number of zero bytes in front of every key
+ * @returns the number of bytes every lane runs, 8 or 16
+ */
+static inline size_t hash_batch_transpose_short_keys(
+    const char *const *keys, const size_t *lens,
+    uint64_t words[HASH_BATCH_SHORT / 8][HASH_BATCH_WIDE],
+    size_t pads[HASH_BATCH_WIDE])
+{
+    size_t steps = hash_batch_max_len(lens, HASH_BATCH_WIDE) > 8 ? 16 : 8;
+
+    for (int j = 0; j < HASH_BATCH_WIDE; j++)
+    {
+        size_t len = lens[j];
+        uint64_t first = 0, last = 0;
+
+        pads[j] = steps - len;
+        if (len >= 8)
+        {
+            /* the last word of the key, and the bytes before it shifted
+             * behind the padding; a shift by 64 would be undefined */
+            last = hash_batch_load64(keys[j] + len - 8);
+            first =
+                len > 8 ? hash_batch_load64(keys[j]) << (8 * (16 - len)) : 0;
+        }
+        else if (len)
+        {
+            char row[8] = {0};
+            memcpy(row + 8 - len, keys[j], len);
+            last = hash_batch_load64(row);
+        }
+        /* with 8 steps every key fits the last word */
+        words[0][j] = steps == 8 ? last : first;
+        words[1][j] = last;
+    }
+    return steps;
+}
+
+/**
+ * djb2 state that `k` leading zero bytes turn into 5381, i.e. 5381 times the
+ * inverse of 33^k modulo 2^64, filled by ::hash_batch_wide_kernels
+ */
+static uint64_t djb2_short_init[HASH_BATCH_SHORT + 1];
+
+/**
+ * @brief fills ::djb2_short_init
+ * @returns void
+ */
+static inline void djb2_build_short_init(void)
+{
+    uint64_t inverse = 33;
+    for (int i = 0; i < 5; i++)
+    {
+        inverse *= 2 - 33 * inverse; /* Newton's iteration, 6 more bits */
+    }
+    djb2_short_init[0] = 5381;
+    for (int k = 1; k <= HASH_BATCH_SHORT; k++)
+    {
+        djb2_short_init[k] = djb2_short_init[k - 1] * inverse;
+    }
+}
+
+/**
+ * @brief defines an AVX2 kernel hashing eight keys of at most
+ * ::HASH_BATCH_SHORT bytes with the one-byte step `STEP`; `INIT(pad)` is the
+ * state a lane starts from when `pad` zero bytes precede its key
+ */
+#define DEFINE_SHORT_KERNEL(name, INIT, STEP)                                  \
+    HASH_BATCH_TARGET_AVX2                                                     \
+    static inline void name(const char *const *keys, const size_t *lens,       \
+                            uint64_t *out)                                     \
+    {                                                                          \
+        uint64_t words[HASH_BATCH_SHORT / 8][HASH_BATCH_WIDE];                 \
+        size_t pads[HASH_BATCH_WIDE];                                          \
+        size_t steps =                                                         \
+            hash_batch_transpose_short_keys(keys, lens, words, pads);          \
+        __m256i lo = _mm256_set_epi64x(INIT(pads[3]), INIT(pads[2]),           \
+                                       INIT(pads[1]), INIT(pads[0]));          \
+        __m256i hi = _mm256_set_epi64x(INIT(pads[7]), INIT(pads[6]),           \
+                                       INIT(pads[5]), INIT(pads[4]));          \
+                                                                               \
+        for (size_t w = 0; w < steps / 8; w++)                                 \
+        {                                                                      \
+            __m256i wlo = _mm256_loadu_si256((const __m256i *)words[w]);       \
+            __m256i whi = _mm256_loadu_si256((const __m256i *)(words[w] + 4)); \
+            for (int j = 0; j < 8; j++)                                        \
+            {                                                                  \
+                lo = STEP(lo, hash_batch_low_chars(wlo));                      \
+                hi = STEP(hi, hash_batch_low_chars(whi));                      \
+                wlo = _mm256_srli_epi64(wlo, 8);                               \
+                whi = _mm256_srli_epi64(whi, 8);                               \
+            }                                                                  \
+        }                                                                      \
+        _mm256_storeu_si256((__m256i *)out, lo);                               \
+        _mm256_storeu_si256((__m256i *)(out + 4), hi);                         \
+    }
+
+/** djb2 lane state ahead of `pad` zero bytes */
+#define DJB2_SHORT_INIT(pad) ((long long)djb2_short_init[pad])
+/** sdbm maps 0 to 0 on a zero byte, so leading zeros change nothing */
+#define SDBM_SHORT_INIT(pad) 0LL
+
+DEFINE_SHORT_KERNEL(djb2_x8_short_avx2, DJB2_SHORT_INIT, DJB2_AVX2)
+DEFINE_SHORT_KERNEL(sdbm_x8_short_avx2, SDBM_SHORT_INIT, SDBM_AVX2)
+
+/**
+ * @brief Adler-32 of eight keys of at most ::HASH_BATCH_SHORT bytes
+ *
+ * A leading zero byte leaves the first sum at 1 and adds 1 to the second,
+ * so a lane with `pad` zeros in front starts its second sum at
+ * ::MODADLER - `pad`.
+ * @param keys eight keys
+ * @param lens their lengths
+ * @param out eight checksums
+ * @returns void
+ */
+HASH_BATCH_TARGET_AVX2
+static inline void adler32_x8_short_avx2(const char *const *keys,
+                                         const size_t *lens,
+                                         uint64_t *out)
+{
+    const __m256i byte = _mm256_set1_epi64x(0xff);
+    uint64_t words[HASH_BATCH_SHORT / 8][HASH_BATCH_WIDE];
+    size_t pads[HASH_BATCH_WIDE];
+    size_t steps = hash_batch_transpose_short_keys(keys, lens, words, pads);
+    __m256i alo = _mm256_set1_epi64x(1), ahi = alo;
+    __m256i blo = _mm256_set_epi64x(
+        MODADLER - (long long)pads[3], MODADLER - (long long)pads[2],
+        MODADLER - (long long)pads[1], MODADLER - (long long)pads[0]);
+    __m256i bhi = _mm256_set_epi64x(
+        MODADLER - (long long)pads[7], MODADLER - (long long)pads[6],
+        MODADLER - (long long)pads[5], MODADLER - (long long)pads[4]);
+    uint64_t a[8], b[8];
+
+    for (size_t w = 0; w < steps / 8; w++)
+    {
+        __m256i wlo = _mm256_loadu_si256((const __m256i *)words[w]);
+        __m256i whi = _mm256_loadu_si256((const __m256i *)(words[w] + 4));
+        for (int j = 0; j < 8; j++)
+        {
+            alo = _mm256_add_epi64(alo, _mm256_and_si256(wlo, byte));
+            ahi = _mm256_add_epi64(ahi, _mm256_and_si256(whi, byte));
+            blo = _mm256_add_epi64(blo, alo);
+            bhi = _mm256_add_epi64(bhi, ahi);
+            wlo = _mm256_srli_epi64(wlo, 8);
+            whi = _mm256_srli_epi64(whi, 8);
+        }
+    }
+    _mm256_storeu_si256((__m256i *)a, alo);
+    _mm256_storeu_si256((__m256i *)(a + 4), ahi);
+    _mm256_storeu_si256((__m256i *)b, blo);
+    _mm256_storeu_si256((__m256i *)(b + 4), bhi);
+    for (int j = 0; j < 8; j++)
+    {
+        out[j] = ((b[j] % MODADLER) << 16) | (a[j] % MODADLER);
+    }
+}
+#endif
+
+/** four-key kernels, indexed by ::hash_algo */
+static const hash_group_kernel hash_batch_narrow_kernels[HASH_ALGO_COUNT] = {
+    djb2_x4, sdbm_x4, xor8_x4, adler32_x4};
+
+/**
+ * @brief eight-key kernels usable on this processor, indexed by ::hash_algo;
+ * NULL where there is none
+ * @param short_keys nonzero for the kernels of groups whose keys all have at
+ * most ::HASH_BATCH_SHORT bytes
+ * @returns the table
+ */
+static inline const hash_group_kernel *hash_batch_wide_kernels(int short_keys)
+{
+    static hash_group_kernel kernels[2][HASH_ALGO_COUNT];
+    static int ready = 0;
+    if (!ready)
+    {
+#ifdef HASH_BATCH_SIMD
+        if (hash_batch_cpu_has_avx2())
+        {
+            djb2_build_short_init();
+            kernels[0][HASH_DJB2] = djb2_x8_avx2;
+            kernels[0][HASH_SDBM] = sdbm_x8_avx2;
+            kernels[0][HASH_ADLER32] = adler32_x8_avx2;
+            kernels[1][HASH_DJB2] = djb2_x8_short_avx2;
+            kernels[1][HASH_SDBM] = sdbm_x8_short_avx2;
+            kernels[1][HASH_ADLER32] = adler32_x8_short_avx2;
+        }
+#endif
+        ready = 1;
+    }
+    return kernels[short_keys != 0];
+}
+
+/**
+ * @brief ::hash_many with an explicit choice of the wide kernels
+ *
+ * Groups of eight keys go to the wide kernels. A group whose keys all have
+ * at most ::HASH_BATCH_SHORT bytes is transposed into words first, so its
+ * lanes run without masks. In other groups, keys shorter than 8 bytes are
+ * copied into zero-padded words.
+ * @param algo algorithm to use
+ * @param keys `n` keys
+ * @param lens their lengths
+ * @param n number of keys
+ * @param out `n` hashes
+ * @param wide nonzero to use the eight-key kernels where available
+ * @returns void
+ */
+static inline void hash_many_kernels(hash_algo algo, const char **keys,
+                                     const size_t *lens, size_t n,
+                                     uint64_t *out, int wide)
+{
+    hash_group_kernel wide_kernel =
+        wide ? hash_batch_wide_kernels(0)[algo] : NULL;
+    hash_group_kernel short_kernel =
+        wide ? hash_batch_wide_kernels(1)[algo] : NULL;
+    hash_group_kernel narrow_kernel = hash_batch_narrow_kernels[algo];
+    size_t i = 0;
+
+    if (wide_kernel)
+    {
+        for (; i + HASH_BATCH_WIDE <= n; i += HASH_BATCH_WIDE)
+        {
+            if (hash_batch_max_len(lens + i, HASH_BATCH_WIDE) <=
+                HASH_BATCH_SHORT)
+            {
+                short_kernel(keys + i, lens + i, out + i);
+            }
+            else if (hash_batch_min_len(lens + i, HASH_BATCH_WIDE) >= 8)
+            {
+                wide_kernel(keys + i, lens + i, out + i);
+            }
+            else
+            {
+                const char *padded[HASH_BATCH_WIDE];
+                char pad[HASH_BATCH_WIDE][8];
+
+                hash_batch_pad_short_keys(keys + i, lens + i, padded, pad);
+                wide_kernel(padded, lens + i, out + i);
+            }
+        }
+    }
+    if (narrow_kernel)
+    {
+        for (; i + HASH_BATCH_LANES <= n; i += HASH_BATCH_LANES)
+        {
+            narrow_kernel(keys + i, lens + i, out + i);
+        }
+    }
+    for (; i < n; i++)
+    {
+        out[i] = hash_one(algo, keys[i], lens[i]);
+    }
+}
+
+/**
+ * @brief hashes `n` keys with the same algorithm
+ *
+ * Keys of similar length hash fastest, since every group of keys takes as
+ * many steps as its longest key needs.
+ * @param algo algorithm to use
+ * @param keys `n` keys; they may contain NUL bytes
+ * @param lens the length of every key
+ * @param n number of keys
+ * @param out receives the `n` hashes, zero-extended to 64 bits
+ * @returns void
+ */
+static inline void hash_many(hash_algo algo, const char **keys,
+                             const size_t *lens, size_t n, uint64_t *out)
+{
+    if ((unsigned)algo >= HASH_ALGO_COUNT)
+    {
+        return;
+    }
+    hash_many_kernels(algo, keys, lens, n, out, 1);
+}
+
+#undef HASH_BATCH_BYTE
+#undef DJB2_STEP
+#undef SDBM_STEP
+#undef STATE_FINAL
+#undef DEFINE_NARROW_KERNEL
+#ifdef HASH_BATCH_SIMD
+#undef DJB2_AVX2
+#undef SDBM_AVX2
+#undef DEFINE_WIDE_KERNEL
+#undef DEFINE_SHORT_KERNEL
+#undef DJB2_SHORT_INIT
+#undef SDBM_SHORT_INIT
+#endif
+
+/** @} */
+
+#endif /* HASH_BATCH_H */
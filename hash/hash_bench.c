@@ -0,0 +1,695 @@
+/**
+ * @addtogroup hash Hash algorithms
+ * @{
+ * @file hash_bench.c
+ * @brief Speed and quality measurements of the hash algorithms of this
+ * directory
+ *
+ * Every algorithm (djb2, sdbm, xor8, Adler-32, CRC-32 and a 64-bit
+ * BLAKE2b) is run over a choice of key distributions:
+ * - `short`: printable ASCII keys of 4 to 16 bytes;
+ * - `binary`: random binary keys of 64 to 1024 bytes;
+ * - `ints`: the integers 0, 1, 2, ... as 8-byte little-endian keys;
+ * - `words`: the lines of a word list, by default the dictionary of
+ *   `data_structures/trie` when built with CMake.
+ *
+ * The measurements, selected with `-S`, are
+ * - `throughput`: MB/s and million keys/s over all keys of a distribution;
+ * - `latency`: ns per key of one random key of 1 to 1024 bytes, where every
+ *   hash feeds into the next key so that calls cannot overlap;
+ * - `avalanche`: how often flipping one of the first 64 input bits flips
+ *   each output bit (ideally half of the time), and how far each output bit
+ *   is from being set half of the time;
+ * - `buckets`: collisions when the keys are placed by the low bits of their
+ *   hash into power-of-two tables at load factor 1, next to the number
+ *   expected of a uniformly random hash.
+ *
+ * All results go to standard output as CSV rows
+ * `section,algorithm,distribution,parameter,metric,value`, where the
+ * parameter is the key size, the number of output bits or the table size,
+ * depending on the section. Usage:
+ *
+ *     hash_bench [-n keys] [-d short,binary,ints,words] [-w word_file]
+ *                [-S throughput,latency,avalanche,buckets] [-s seed]
+ *
+ * The algorithms are the ones of the headers of this directory, so the
+ * fastest kernel the processor supports is measured: PCLMULQDQ folding for
+ * CRC-32, SSE2 or AVX2 sums for Adler-32 and the AVX2 compression function
+ * of BLAKE2b. They are checked against the test vectors of the programs of
+ * this directory before measuring.
+ */
+#include <assert.h>    /// for assert
+#include <inttypes.h>  /// for fixed-width integer types
+#include <math.h>      /// for pow and fabs
+#include <stdio.h>     /// for IO
+#include <stdlib.h>    /// for malloc, strtoull and free
+#include <string.h>    /// for strlen, strchr and strcmp
+#include <time.h>      /// for clock
+
+#include "hash_adler32.h"  /// for adler32_buffer
+#include "hash_blake2b.h"  /// for blake2b_init, blake2b_update, blake2b_final
+#include "hash_crc32.h"    /// for crc32_buffer
+#include "hash_djb2.h"     /// for djb2_buffer
+#include "hash_sdbm.h"     /// for sdbm_buffer
+#include "hash_xor8.h"     /// for xor8_buffer
+
+#define BENCH_MIN_SECONDS 0.02  ///< shortest time every measurement runs
+#define AVALANCHE_KEYS 512      ///< keys sampled per avalanche measurement
+#define AVALANCHE_IN_BITS 64    ///< input bits flipped per key, at most
+#define LATENCY_MAX_SIZE 1024   ///< largest key of the latency section
+#define WORD_MAX_LENGTH 256     ///< longer lines of a word list are cut
+
+/**
+ * default word list: the dictionary of `data_structures/trie`, whose absolute
+ * path the CMake build passes as `HASH_BENCH_WORD_FILE`. Other builds have no
+ * default and need `-w` for the `words` keys.
+ */
+#ifdef HASH_BENCH_WORD_FILE
+#define DEFAULT_WORD_FILE HASH_BENCH_WORD_FILE
+#else
+#define DEFAULT_WORD_FILE NULL
+#endif
+
+/**
+ * @brief djb2 of hash_djb2.h
+ * @param key bytes to hash
+ * @param len number of bytes at key
+ * @returns 64-bit hash
+ */
+static uint64_t bench_djb2(const void *key, size_t len)
+{
+    return djb2_buffer(key, len);
+}
+
+/**
+ * @brief sdbm of hash_sdbm.h
+ * @param key bytes to hash
+ * @param len number of bytes at key
+ * @returns 64-bit hash
+ */
+static uint64_t bench_sdbm(const void *key, size_t len)
+{
+    return sdbm_buffer(key, len);
+}
+
+/**
+ * @brief xor8 of hash_xor8.h
+ * @param key bytes to hash
+ * @param len number of bytes at key
+ * @returns 8-bit hash
+ */
+static uint64_t bench_xor8(const void *key, size_t len)
+{
+    return xor8_buffer(key, len);
+}
+
+/**
+ * @brief Adler-32 of hash_adler32.h, with its SSE2 or AVX2 kernel
+ * @param key bytes to hash
+ * @param len number of bytes at key
+ * @returns 32-bit checksum
+ */
+static uint64_t bench_adler32(const void *key, size_t len)
+{
+    return adler32_buffer(key, len);
+}
+
+/**
+ * @brief CRC-32 of hash_crc32.h, folding with PCLMULQDQ from 64 bytes on
+ * @param key bytes to hash
+ * @param len number of bytes at key
+ * @returns 32-bit checksum
+ */
+static uint64_t bench_crc32(const void *key, size_t len)
+{
+    return crc32_buffer(key, len);
+}
+
+/**
+ * @brief unkeyed BLAKE2b of hash_blake2b.h with an 8-byte digest, with its
+ * AVX2 compression function
+ * @param key bytes to hash
+ * @param len number of bytes at key
+ * @returns the digest as a little-endian 64-bit word
+ */
+static uint64_t bench_blake2b(const void *key, size_t len)
+{
+    blake2b_ctx ctx;
+    uint8_t digest[8];
+    uint64_t h = 0;
+
+    blake2b_init(&ctx, NULL, 0, sizeof(digest));
+    blake2b_update(&ctx, key, len);
+    blake2b_final(&ctx, digest);
+    for (int i = 7; i >= 0; i--)
+    {
+        h = (h << 8) | digest[i];
+    }
+    return h;
+}
+
+/**
+ * @brief an algorithm under test
+ */
+typedef struct
+{
+    const char *name;                              ///< name in the CSV
+    int bits;                                      ///< bits of its output
+    uint64_t (*hash)(const void *key, size_t len); ///< the function
+} algorithm_t;
+
+/** every algorithm of this directory */
+static const algorithm_t algorithms[] = {
+    {"djb2", 64, bench_djb2},       {"sdbm", 64, bench_sdbm},
+    {"xor8", 8, bench_xor8},        {"adler32", 32, bench_adler32},
+    {"crc32", 32, bench_crc32},     {"blake2b", 64, bench_blake2b}};
+
+/** number of entries of ::algorithms */
+#define ALGORITHM_COUNT (sizeof(algorithms) / sizeof(algorithms[0]))
+
+/**
+ * @brief keys of one distribution, stored back to back in one arena
+ */
+typedef struct
+{
+    const char *name;      ///< name in the CSV
+    size_t count;          ///< number of keys
+    size_t *offsets;       ///< start of every key in the arena
+    size_t *lens;          ///< length of every key
+    uint8_t *arena;        ///< bytes of all keys
+    size_t bytes;          ///< total length of all keys
+} key_set;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15;  ///< state of ::next_random
+
+/**
+ * @brief xorshift64* generator, so that every platform sees the same keys
+ * @returns 64 random bits
+ */
+static uint64_t next_random(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1D;
+}
+
+/**
+ * @brief allocates the arrays of a key set
+ * @param set set to fill
+ * @param name name of the distribution
+ * @param count number of keys
+ * @param bytes total length of the keys
+ * @returns 0 on success, -1 if out of memory
+ */
+static int key_set_alloc(key_set *set, const char *name, size_t count,
+                         size_t bytes)
+{
+    set->name = name;
+    set->count = count;
+    set->bytes = bytes;
+    set->offsets = malloc(count * sizeof(size_t));
+    set->lens = malloc(count * sizeof(size_t));
+    set->arena = malloc(bytes ? bytes : 1);
+    return set->offsets && set->lens && set->arena ? 0 : -1;
+}
+
+/**
+ * @brief frees the arrays of a key set
+ * @param set set to free
+ * @returns void
+ */
+static void key_set_free(key_set *set)
+{
+    free(set->offsets);
+    free(set->lens);
+    free(set->arena);
+}
+
+/**
+ * @brief random keys with lengths in `[min_len, max_len]`
+ * @param set set to fill
+ * @param name name of the distribution
+ * @param count number of keys
+ * @param min_len shortest key
+ * @param max_len longest key
+ * @param ascii nonzero for printable ASCII, zero for any byte
+ * @returns 0 on success, -1 if out of memory
+ */
+static int make_random_keys(key_set *set, const char *name, size_t count,
+                            size_t min_len, size_t max_len, int ascii)
+{
+    size_t *lens = malloc(count * sizeof(size_t));
+    size_t bytes = 0;
+    if (!lens)
+    {
+        return -1;
+    }
+    for (size_t k = 0; k < count; k++)
+    {
+        lens[k] = min_len + next_random() % (max_len - min_len + 1);
+        bytes += lens[k];
+    }
+    if (key_set_alloc(set, name, count, bytes) != 0)
+    {
+        free(lens);
+        return -1;
+    }
+
+    size_t at = 0;
+    for (size_t k = 0; k < count; k++)
+    {
+        set->offsets[k] = at;
+        set->lens[k] = lens[k];
+        for (size_t i = 0; i < lens[k]; i++)
+        {
+            uint64_t r = next_random();
+            set->arena[at++] = ascii ? (uint8_t)(' ' + r % 95) : (uint8_t)r;
+        }
+    }
+    free(lens);
+    return 0;
+}
+
+/**
+ * @brief the integers `0 .. count - 1` as 8-byte little-endian keys
+ * @param set set to fill
+ * @param count number of keys
+ * @returns 0 on success, -1 if out of memory
+ */
+static int make_int_keys(key_set *set, size_t count)
+{
+    if (key_set_alloc(set, "ints", count, count * 8) != 0)
+    {
+        return -1;
+    }
+    for (size_t k = 0; k < count; k++)
+    {
+        set->offsets[k] = k * 8;
+        set->lens[k] = 8;
+        for (int i = 0; i < 8; i++)
+        {
+            set->arena[k * 8 + i] = (uint8_t)((uint64_t)k >> (8 * i));
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief the first `count` non-empty lines of a word list
+ * @param set set to fill
+ * @param path word list, one word per line
+ * @param count largest number of keys
+ * @returns 0 on success, -1 if the file cannot be read or out of memory
+ */
+static int load_word_keys(key_set *set, const char *path, size_t count)
+{
+    FILE *file = fopen(path, "r");
+    char line[WORD_MAX_LENGTH + 2];
+    if (!file || key_set_alloc(set, "words", count, count * WORD_MAX_LENGTH))
+    {
+        if (file)
+        {
+            fclose(file);
+            key_set_free(set);
+        }
+        return -1;
+    }
+
+    size_t k = 0, at = 0;
+    while (k < count && fgets(line, sizeof(line), file))
+    {
+        size_t len = strcspn(line, "\r\n");
+        if (len == 0)
+        {
+            continue;
+        }
+        len = len < WORD_MAX_LENGTH ? len : WORD_MAX_LENGTH;
+        set->offsets[k] = at;
+        set->lens[k] = len;
+        memcpy(set->arena + at, line, len);
+        at += len;
+        k++;
+    }
+    fclose(file);
+    set->count = k;
+    set->bytes = at;
+    return k > 0 ? 0 : -1;
+}
+
+/**
+ * @brief prints one CSV row
+ * @param section measurement
+ * @param algorithm algorithm name
+ * @param distribution key distribution, empty if none
+ * @param parameter key size, output bits or table size
+ * @param metric what the value is
+ * @param value the value
+ * @returns void
+ */
+static void emit(const char *section, const char *algorithm,
+                 const char *distribution, uint64_t parameter,
+                 const char *metric, double value)
+{
+    printf("%s,%s,%s,%" PRIu64 ",%s,%.6g\n", section, algorithm, distribution,
+           parameter, metric, value);
+}
+
+/**
+ * @brief hashes every key of a set until ::BENCH_MIN_SECONDS have passed
+ * @param algo algorithm to run
+ * @param set keys
+ * @returns void
+ */
+static void bench_throughput(const algorithm_t *algo, const key_set *set)
+{
+    volatile uint64_t sink = 0;
+    size_t passes = 0;
+    double seconds;
+    clock_t start = clock();
+
+    do
+    {
+        uint64_t acc = 0;
+        for (size_t k = 0; k < set->count; k++)
+        {
+            acc ^= algo->hash(set->arena + set->offsets[k], set->lens[k]);
+        }
+        sink ^= acc;
+        passes++;
+        seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    } while (seconds < BENCH_MIN_SECONDS);
+
+    emit("throughput", algo->name, set->name, 0, "mb_per_s",
+         passes * (double)set->bytes / 1e6 / seconds);
+    emit("throughput", algo->name, set->name, 0, "mkeys_per_s",
+         passes * (double)set->count / 1e6 / seconds);
+}
+
+/**
+ * @brief ns per key of dependent calls on keys of 1 to
+ * ::LATENCY_MAX_SIZE bytes
+ *
+ * Every hash is folded into the first byte of the next key, so each call
+ * waits for the previous one, as a lookup that depends on the last would.
+ * @param algo algorithm to run
+ * @returns void
+ */
+static void bench_latency(const algorithm_t *algo)
+{
+    uint8_t key[LATENCY_MAX_SIZE];
+    for (size_t i = 0; i < sizeof(key); i++)
+    {
+        key[i] = (uint8_t)next_random();
+    }
+
+    for (size_t size = 1; size <= LATENCY_MAX_SIZE; size <<= 1)
+    {
+        size_t calls = 0;
+        double seconds;
+        clock_t start = clock();
+
+        do
+        {
+            for (int r = 0; r < 1024; r++)
+            {
+                key[0] ^= (uint8_t)algo->hash(key, size);
+            }
+            calls += 1024;
+            seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        } while (seconds < BENCH_MIN_SECONDS);
+
+        emit("latency", algo->name, "binary", size, "ns_per_key",
+             seconds * 1e9 / calls);
+    }
+}
+
+/**
+ * @brief avalanche and output bit bias over a sample of the keys
+ *
+ * For up to ::AVALANCHE_KEYS keys, each of their first ::AVALANCHE_IN_BITS
+ * bits is flipped and the output bits that change are counted. A good hash
+ * flips every output bit with probability 1/2 for every input bit.
+ * @param algo algorithm to run
+ * @param set keys
+ * @returns void
+ */
+static void bench_avalanche(const algorithm_t *algo, const key_set *set)
+{
+    static uint32_t flips[AVALANCHE_IN_BITS][64];
+    uint32_t trials[AVALANCHE_IN_BITS] = {0};
+    uint32_t ones[64] = {0};
+    uint8_t key[WORD_MAX_LENGTH > LATENCY_MAX_SIZE ? WORD_MAX_LENGTH
+                                                   : LATENCY_MAX_SIZE];
+    size_t step = set->count > AVALANCHE_KEYS ? set->count / AVALANCHE_KEYS
+                                              : 1;
+    size_t sampled = 0;
+    int bits = algo->bits;
+
+    memset(flips, 0, sizeof(flips));
+    for (size_t k = 0; k < set->count && sampled < AVALANCHE_KEYS; k += step)
+    {
+        size_t len = set->lens[k] < sizeof(key) ? set->lens[k] : sizeof(key);
+        size_t in_bits = len * 8 < AVALANCHE_IN_BITS ? len * 8
+                                                     : AVALANCHE_IN_BITS;
+        memcpy(key, set->arena + set->offsets[k], len);
+        uint64_t base = algo->hash(key, len);
+
+        for (int b = 0; b < bits; b++)
+        {
+            ones[b] += (base >> b) & 1;
+        }
+        for (size_t i = 0; i < in_bits; i++)
+        {
+            key[i / 8] ^= (uint8_t)(1 << (i % 8));
+            uint64_t diff = base ^ algo->hash(key, len);
+            key[i / 8] ^= (uint8_t)(1 << (i % 8));
+
+            trials[i]++;
+            for (int b = 0; b < bits; b++)
+            {
+                flips[i][b] += (diff >> b) & 1;
+            }
+        }
+        sampled++;
+    }
+    if (sampled == 0)
+    {
+        return;
+    }
+
+    double sum = 0, worst = 0, worst_bit = 0;
+    size_t pairs = 0;
+    for (int i = 0; i < AVALANCHE_IN_BITS; i++)
+    {
+        for (int b = 0; trials[i] && b < bits; b++)
+        {
+            double p = (double)flips[i][b] / trials[i];
+            sum += p;
+            worst = fabs(p - 0.5) > worst ? fabs(p - 0.5) : worst;
+            pairs++;
+        }
+    }
+    for (int b = 0; b < bits; b++)
+    {
+        double p = (double)ones[b] / sampled;
+        worst_bit = fabs(p - 0.5) > worst_bit ? fabs(p - 0.5) : worst_bit;
+    }
+
+    emit("avalanche", algo->name, set->name, bits, "flip_probability_mean",
+         pairs ? sum / pairs : 0);
+    emit("avalanche", algo->name, set->name, bits, "flip_bias_max", worst);
+    emit("avalanche", algo->name, set->name, bits, "output_bit_bias_max",
+         worst_bit);
+}
+
+/**
+ * @brief collisions of the low hash bits in power-of-two tables
+ *
+ * The first `size` keys are placed into a table of `size` buckets by the low
+ * bits of their hash, as ::hash_set and ::Dictionary of `data_structures`
+ * do. A uniformly random hash would leave
+ * `size - size * (1 - (1 - 1/size)^size)` of them colliding.
+ * @param algo algorithm to run
+ * @param set keys
+ * @returns void
+ */
+static void bench_buckets(const algorithm_t *algo, const key_set *set)
+{
+    for (size_t size = 1 << 8; size <= (1 << 20) && size <= set->count;
+         size <<= 4)
+    {
+        uint32_t *buckets = calloc(size, sizeof(uint32_t));
+        size_t used = 0, longest = 0;
+        if (!buckets)
+        {
+            return;
+        }
+
+        for (size_t k = 0; k < size; k++)
+        {
+            uint64_t h = algo->hash(set->arena + set->offsets[k], set->lens[k]);
+            uint32_t *bucket = &buckets[h & (size - 1)];
+            used += *bucket == 0;
+            (*bucket)++;
+            longest = *bucket > longest ? *bucket : longest;
+        }
+        free(buckets);
+
+        double expected = size - size * (1 - pow(1 - 1.0 / size, (double)size));
+        emit("buckets", algo->name, set->name, size, "collisions",
+             (double)(size - used));
+        emit("buckets", algo->name, set->name, size, "expected_collisions",
+             expected);
+        emit("buckets", algo->name, set->name, size, "longest_chain",
+             (double)longest);
+    }
+}
+
+/**
+ * @brief checks the local implementations against the test vectors of the
+ * other programs of this directory
+ * \returns None
+ */
+static void test_algorithms()
+{
+    const char *s = "Hello World";
+    assert(bench_djb2(s, 11) == 13827776004929097857U);
+    assert(bench_sdbm(s, 11) == 12881824461405877380U);
+    assert(bench_xor8(s, 11) == 228);
+    assert(bench_adler32(s, 11) == 403375133);
+    assert(bench_crc32(s, 11) == 1243066710);
+    assert(bench_blake2b(s, 11) == 3011375363807037525U);
+    assert(bench_blake2b("", 0) == 13020603013274838756U);
+}
+
+/**
+ * @brief tells whether a comma-separated list names an item
+ * @param list comma-separated names
+ * @param name name to look for
+ * @returns 1 if `name` is in `list`, 0 otherwise
+ */
+static int list_has(const char *list, const char *name)
+{
+    size_t len = strlen(name);
+    for (const char *p = list; p; p = strchr(p, ','))
+    {
+        p += *p == ',';
+        if (strncmp(p, name, len) == 0 && (p[len] == ',' || p[len] == '\0'))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/** Main function */
+int main(int argc, char *argv[])
+{
+    size_t count = 1 << 16;
+    const char *distributions = "short,binary,ints,words";
+    const char *sections = "throughput,latency,avalanche,buckets";
+    const char *word_file = DEFAULT_WORD_FILE;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+        {
+            count = strtoul(argv[++i], NULL, 10);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-d") == 0)
+        {
+            distributions = argv[++i];
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-w") == 0)
+        {
+            word_file = argv[++i];
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-S") == 0)
+        {
+            sections = argv[++i];
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-s") == 0)
+        {
+            rng_state = strtoull(argv[++i], NULL, 10) | 1;
+        }
+        else
+        {
+            fprintf(stderr,
+                    "usage: %s [-n keys] [-d short,binary,ints,words] "
+                    "[-w word_file]\n"
+                    "       [-S throughput,latency,avalanche,buckets] "
+                    "[-s seed]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (count == 0)
+    {
+        count = 1;
+    }
+
+    test_algorithms();
+    printf("section,algorithm,distribution,parameter,metric,value\n");
+
+    if (list_has(sections, "latency"))
+    {
+        for (size_t a = 0; a < ALGORITHM_COUNT; a++)
+        {
+            bench_latency(&algorithms[a]);
+        }
+    }
+
+    const char *names[] = {"short", "binary", "ints", "words"};
+    for (size_t d = 0; d < sizeof(names) / sizeof(names[0]); d++)
+    {
+        key_set set;
+        int status;
+
+        if (!list_has(distributions, names[d]))
+        {
+            continue;
+        }
+        switch (d)
+        {
+        case 0:
+            status = make_random_keys(&set, "short", count, 4, 16, 1);
+            break;
+        case 1:
+            status = make_random_keys(&set, "binary", count, 64, 1024, 0);
+            break;
+        case 2:
+            status = make_int_keys(&set, count);
+            break;
+        default:
+            status = word_file ? load_word_keys(&set, word_file, count) : -1;
+            break;
+        }
+        if (status != 0)
+        {
+            fprintf(stderr, "skipping %s keys: %s\n", names[d],
+                    d != 3       ? "out of memory"
+                    : word_file ? "cannot read the word list"
+                                : "no word list, give one with -w");
+            continue;
+        }
+
+        for (size_t a = 0; a < ALGORITHM_COUNT; a++)
+        {
+            if (list_has(sections, "throughput"))
+            {
+                bench_throughput(&algorithms[a], &set);
+            }
+            if (list_has(sections, "avalanche"))
+            {
+                bench_avalanche(&algorithms[a], &set);
+            }
+            if (list_has(sections, "buckets"))
+            {
+                bench_buckets(&algorithms[a], &set);
+            }
+        }
+        key_set_free(&set);
+    }
+    return 0;
+}
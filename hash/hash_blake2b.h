@@ -0,0 +1,719 @@
+/**
+ * @addtogroup hash Hash algorithms
+ * @{
+ * @file
+ * @author [Daniel Murrow](https://github.com/dsmurrow)
+ * @brief [Blake2b cryptographic hash
+ * function](https://www.rfc-editor.org/rfc/rfc7693)
+ *
+ * The Blake2b cryptographic hash function provides
+ * hashes for data that are secure enough to be used in
+ * cryptographic applications. It is designed to perform
+ * optimally on 64-bit platforms. The algorithm can output
+ * digests between 1 and 64 bytes long, for messages up to
+ * 128 bits in length. Keyed hashing is also supported for
+ * keys up to 64 bytes in length.
+ *
+ * Messages can be hashed at once with blake2b() or piecewise with
+ * blake2b_init(), blake2b_update() and blake2b_final(), which only keep one
+ * block of the message in memory. On x86 processors with AVX2 the
+ * compression function ::blake2b_f works on four 64-bit words per
+ * instruction; the choice is made at runtime. blake2bp() implements the
+ * 4-way parallel tree mode [BLAKE2bp](https://www.blake2.net/blake2.pdf),
+ * hashing the four leaves on separate threads when OpenMP is available. It
+ * produces different digests than BLAKE2b.
+ *
+ * Every name the header defines starts with `blake2b_` or `BLAKE2B_`; the
+ * helper macros are undefined at its end.
+ *
+ * The tests and a throughput benchmark are in hash_blake2b.c.
+ */
+#ifndef HASH_BLAKE2B_H
+#define HASH_BLAKE2B_H
+
+#include <stddef.h>    /// for size_t
+#include <stdint.h>    /// for fixed-width integer types
+#include <stdlib.h>    /// for malloc
+#include <string.h>    /// for memcpy and memset
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BLAKE2B_AVX2 1  ///< the AVX2 compression function is compiled in
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define BLAKE2B_TARGET_AVX2
+#else
+/** enables AVX2 code generation for a single function */
+#define BLAKE2B_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+/**
+ * @brief the size of a data block in bytes
+ */
+#define BLAKE2B_BLOCK_BYTES 128
+
+/**
+ * @brief max key length for BLAKE2b
+ */
+#define BLAKE2B_KK_MAX 64
+
+/**
+ * @brief max length of BLAKE2b digest in bytes
+ */
+#define BLAKE2B_NN_MAX 64
+
+/**
+ * @brief returns minimum value
+ */
+#define BLAKE2B_MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/**
+ * @brief number of leaves of BLAKE2bp
+ */
+#define BLAKE2B_PARALLELISM 4
+
+/**
+ * @brief macro to rotate 64-bit ints to the right
+ * Ripped from RFC 7693
+ */
+#define BLAKE2B_ROTR64(n, offset) \
+    (((n) >> (offset)) ^ ((n) << (64 - (offset))))
+
+/**
+ * @brief zero-value initializer for blake2b_u128 type
+ */
+#define BLAKE2B_U128_ZERO \
+    {             \
+        0, 0      \
+    }
+
+/** 128-bit number represented as two uint64's */
+typedef uint64_t blake2b_u128[2];
+
+/** Padded input block containing BLAKE2B_BLOCK_BYTES bytes */
+typedef uint64_t blake2b_block_t[BLAKE2B_BLOCK_BYTES / sizeof(uint64_t)];
+
+static const uint8_t BLAKE2B_R1 = 32;  ///< Rotation constant 1 of ::blake2b_g
+static const uint8_t BLAKE2B_R2 = 24;  ///< Rotation constant 2 of ::blake2b_g
+static const uint8_t BLAKE2B_R3 = 16;  ///< Rotation constant 3 of ::blake2b_g
+static const uint8_t BLAKE2B_R4 = 63;  ///< Rotation constant 4 of ::blake2b_g
+
+static const uint64_t blake2b_iv[8] = {
+    0x6A09E667F3BCC908, 0xBB67AE8584CAA73B, 0x3C6EF372FE94F82B,
+    0xA54FF53A5F1D36F1, 0x510E527FADE682D1, 0x9B05688C2B3E6C1F,
+    0x1F83D9ABFB41BD6B, 0x5BE0CD19137E2179};  ///< BLAKE2b Initialization vector
+                                              ///< blake2b_iv[i] = floor(2**64 *
+                                              ///< frac(sqrt(prime(i+1)))),
+                                              ///< where prime(i) is the i:th
+                                              ///< prime number
+
+static const uint8_t blake2b_sigma[12][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+    {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+    {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+    {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+    {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+    {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+    {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+    {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+    {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5,
+     3}};  ///< word schedule permutations for each round of the algorithm
+
+/**
+ * @brief increment an 128-bit number by a given amount
+ *
+ * @param dest the value being incremented
+ * @param n what dest is being increased by
+ *
+ * @returns void
+ */
+static inline void blake2b_u128_increment(blake2b_u128 dest, uint64_t n)
+{
+    /* Check for overflow */
+    if (UINT64_MAX - dest[0] < n)
+    {
+        dest[1]++;
+    }
+
+    dest[0] += n;
+}
+
+/**
+ * @brief blake2b mixing function G
+ *
+ * Shuffles values in block v depending on
+ * provided indeces a, b, c, and d. x and y
+ * are also mixed into the block.
+ *
+ * @param v array of words to be mixed
+ * @param a first index
+ * @param b second index
+ * @param c third index
+ * @param d fourth index
+ * @param x first word being mixed into v
+ * @param y second word being mixed into y
+ *
+ * @returns void
+ */
+static inline void blake2b_g(blake2b_block_t v, uint8_t a, uint8_t b,
+                             uint8_t c, uint8_t d, uint64_t x, uint64_t y)
+{
+    v[a] += v[b] + x;
+    v[d] = BLAKE2B_ROTR64(v[d] ^ v[a], BLAKE2B_R1);
+    v[c] += v[d];
+    v[b] = BLAKE2B_ROTR64(v[b] ^ v[c], BLAKE2B_R2);
+    v[a] += v[b] + y;
+    v[d] = BLAKE2B_ROTR64(v[d] ^ v[a], BLAKE2B_R3);
+    v[c] += v[d];
+    v[b] = BLAKE2B_ROTR64(v[b] ^ v[c], BLAKE2B_R4);
+}
+
+/**
+ * @brief compression function F
+ *
+ * Securely mixes the values in block m into
+ * the state vector h. Value at v[14] is also
+ * inverted if this is the final block to be
+ * compressed.
+ *
+ * @param h the state vector
+ * @param m message vector to be compressed into h
+ * @param t 128-bit offset counter
+ * @param f flag to indicate whether this is the final block
+ * @param last_node flag to indicate the final block of the last node of a
+ * tree level (only used by the tree mode)
+ *
+ * @returns void
+ */
+static inline void blake2b_f(uint64_t h[8], blake2b_block_t m, blake2b_u128 t,
+                             int f, int last_node)
+{
+    int i;
+    blake2b_block_t v;
+
+    /* v[0..7] := h[0..7] */
+    for (i = 0; i < 8; i++)
+    {
+        v[i] = h[i];
+    }
+    /* v[8..15] := IV[0..7] */
+    for (; i < 16; i++)
+    {
+        v[i] = blake2b_iv[i - 8];
+    }
+
+    v[12] ^= t[0]; /* v[12] ^ (t mod 2**w) */
+    v[13] ^= t[1]; /* v[13] ^ (t >> w) */
+
+    if (f)
+    {
+        v[14] = ~v[14];
+    }
+    if (last_node)
+    {
+        v[15] = ~v[15];
+    }
+
+    for (i = 0; i < 12; i++)
+    {
+        const uint8_t *s = blake2b_sigma[i];
+
+        blake2b_g(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+        blake2b_g(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+        blake2b_g(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+        blake2b_g(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+
+        blake2b_g(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+        blake2b_g(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+        blake2b_g(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+        blake2b_g(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+    }
+
+    for (i = 0; i < 8; i++)
+    {
+        h[i] ^= v[i] ^ v[i + 8];
+    }
+}
+
+#ifdef BLAKE2B_AVX2
+/**
+ * @brief rotate every 64-bit lane of x right by 24 bits (a 3 byte shuffle)
+ */
+#define BLAKE2B_ROTR24_AVX2(x)                                                 \
+    _mm256_shuffle_epi8((x), _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, \
+                                              13, 14, 15, 8, 9, 10, 3, 4, 5,   \
+                                              6, 7, 0, 1, 2, 11, 12, 13, 14,   \
+                                              15, 8, 9, 10))
+/**
+ * @brief rotate every 64-bit lane of x right by 16 bits (a 2 byte shuffle)
+ */
+#define BLAKE2B_ROTR16_AVX2(x)                                                 \
+    _mm256_shuffle_epi8((x), _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, \
+                                              12, 13, 14, 15, 8, 9, 2, 3, 4,   \
+                                              5, 6, 7, 0, 1, 10, 11, 12, 13,   \
+                                              14, 15, 8, 9))
+
+/**
+ * @brief four mixing functions G at once, one per 64-bit lane
+ *
+ * Lane i of rows a, b, c and d holds the words G would take as indices a, b,
+ * c and d; x and y hold the message words of each lane.
+ */
+#define BLAKE2B_G_AVX2(a, b, c, d, x, y)                                    \
+    do                                                                      \
+    {                                                                       \
+        a = _mm256_add_epi64(_mm256_add_epi64(a, b), x);                    \
+        d = _mm256_shuffle_epi32(_mm256_xor_si256(d, a),                    \
+                                 _MM_SHUFFLE(2, 3, 0, 1));                  \
+        c = _mm256_add_epi64(c, d);                                         \
+        b = BLAKE2B_ROTR24_AVX2(_mm256_xor_si256(b, c));                    \
+        a = _mm256_add_epi64(_mm256_add_epi64(a, b), y);                    \
+        d = BLAKE2B_ROTR16_AVX2(_mm256_xor_si256(d, a));                    \
+        c = _mm256_add_epi64(c, d);                                         \
+        b = _mm256_xor_si256(b, c);                                         \
+        b = _mm256_xor_si256(_mm256_srli_epi64(b, 63),                      \
+                             _mm256_add_epi64(b, b));                       \
+    } while (0)
+
+/**
+ * @brief compression function F with the 16 words of v held in four AVX2
+ * registers, one row of the 4x4 matrix each
+ *
+ * The column step mixes the four columns in parallel. Rotating rows 2, 3
+ * and 4 by 1, 2 and 3 lanes turns the diagonals into columns for the
+ * diagonal step, and rotating them back restores the layout.
+ *
+ * @param h the state vector
+ * @param m message vector to be compressed into h
+ * @param t 128-bit offset counter
+ * @param f flag to indicate whether this is the final block
+ * @param last_node flag to indicate the final block of the last node
+ *
+ * @returns void
+ */
+BLAKE2B_TARGET_AVX2
+static inline void blake2b_f_avx2(uint64_t h[8], blake2b_block_t m,
+                                  blake2b_u128 t, int f, int last_node)
+{
+    __m256i row1 = _mm256_loadu_si256((const __m256i *)&h[0]);
+    __m256i row2 = _mm256_loadu_si256((const __m256i *)&h[4]);
+    __m256i row3 = _mm256_loadu_si256((const __m256i *)&blake2b_iv[0]);
+    __m256i row4 = _mm256_xor_si256(
+        _mm256_loadu_si256((const __m256i *)&blake2b_iv[4]),
+        _mm256_set_epi64x(last_node ? -1 : 0, f ? -1 : 0, (int64_t)t[1],
+                          (int64_t)t[0]));
+    const __m256i h1 = row1, h2 = row2;
+    int i;
+
+    for (i = 0; i < 12; i++)
+    {
+        const uint8_t *s = blake2b_sigma[i];
+        __m256i x, y;
+
+        x = _mm256_set_epi64x(m[s[6]], m[s[4]], m[s[2]], m[s[0]]);
+        y = _mm256_set_epi64x(m[s[7]], m[s[5]], m[s[3]], m[s[1]]);
+        BLAKE2B_G_AVX2(row1, row2, row3, row4, x, y);
+
+        row2 = _mm256_permute4x64_epi64(row2, _MM_SHUFFLE(0, 3, 2, 1));
+        row3 = _mm256_permute4x64_epi64(row3, _MM_SHUFFLE(1, 0, 3, 2));
+        row4 = _mm256_permute4x64_epi64(row4, _MM_SHUFFLE(2, 1, 0, 3));
+
+        x = _mm256_set_epi64x(m[s[14]], m[s[12]], m[s[10]], m[s[8]]);
+        y = _mm256_set_epi64x(m[s[15]], m[s[13]], m[s[11]], m[s[9]]);
+        BLAKE2B_G_AVX2(row1, row2, row3, row4, x, y);
+
+        row2 = _mm256_permute4x64_epi64(row2, _MM_SHUFFLE(2, 1, 0, 3));
+        row3 = _mm256_permute4x64_epi64(row3, _MM_SHUFFLE(1, 0, 3, 2));
+        row4 = _mm256_permute4x64_epi64(row4, _MM_SHUFFLE(0, 3, 2, 1));
+    }
+
+    _mm256_storeu_si256((__m256i *)&h[0],
+                        _mm256_xor_si256(h1, _mm256_xor_si256(row1, row3)));
+    _mm256_storeu_si256((__m256i *)&h[4],
+                        _mm256_xor_si256(h2, _mm256_xor_si256(row2, row4)));
+}
+
+/**
+ * @brief checks whether the processor and OS support AVX2
+ * @returns 1 if ::blake2b_f_avx2 may be used, 0 otherwise
+ */
+static inline int blake2b_cpu_has_avx2(void)
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+    {
+        return 0;
+    }
+    __cpuid(regs, 1);
+    /* bit 27: OSXSAVE, bit 28: AVX */
+    if ((regs[2] & (3 << 27)) != (3 << 27) || (_xgetbv(0) & 6) != 6)
+    {
+        return 0;
+    }
+    __cpuidex(regs, 7, 0);
+    return (regs[1] >> 5) & 1;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+/** signature shared by ::blake2b_f and ::blake2b_f_avx2 */
+typedef void (*blake2b_compress_fn)(uint64_t h[8], blake2b_block_t m,
+                                    blake2b_u128 t, int f, int last_node);
+
+/**
+ * compression function used by ::blake2b_update, see
+ * ::blake2b_select_compress
+ */
+static blake2b_compress_fn blake2b_compress_kernel = NULL;
+
+/**
+ * @brief picks the fastest compression function for this processor
+ * @returns void
+ */
+static inline void blake2b_select_compress(void)
+{
+    if (blake2b_compress_kernel == NULL)
+    {
+#ifdef BLAKE2B_AVX2
+        blake2b_compress_kernel =
+            blake2b_cpu_has_avx2() ? blake2b_f_avx2 : blake2b_f;
+#else
+        blake2b_compress_kernel = blake2b_f;
+#endif
+    }
+}
+
+/**
+ * @brief state of an incremental BLAKE2b computation
+ *
+ * The last block seen is kept in buf until more data arrives or
+ * blake2b_final() is called, because the final block is compressed with
+ * the finalization flag set.
+ */
+typedef struct
+{
+    uint64_t h[8];                     ///< chained state
+    blake2b_u128 t;                    ///< number of bytes compressed so far
+    uint8_t buf[BLAKE2B_BLOCK_BYTES];  ///< pending, not yet compressed, bytes
+    size_t buflen;                     ///< number of bytes in buf
+    uint8_t nn;                        ///< digest length in bytes
+    int last_node;                     ///< set for the last node of a level
+} blake2b_ctx;
+
+/**
+ * @brief compresses one block into the state
+ *
+ * @param ctx state
+ * @param block BLAKE2B_BLOCK_BYTES bytes of message
+ * @param f flag to indicate whether this is the final block
+ *
+ * @returns void
+ */
+static inline void blake2b_compress(blake2b_ctx *ctx, const uint8_t *block,
+                                    int f)
+{
+    blake2b_block_t m;
+    uint64_t i, j;
+
+    for (i = 0; i < BLAKE2B_BLOCK_BYTES / sizeof(uint64_t); i++)
+    {
+        m[i] = 0;
+        for (j = 0; j < sizeof(uint64_t); j++)
+        {
+            m[i] |= (uint64_t)block[8 * i + j] << (8 * j);
+        }
+    }
+
+    blake2b_compress_kernel(ctx->h, m, ctx->t, f, f && ctx->last_node);
+}
+
+/**
+ * @brief sets up the state from a parameter block
+ *
+ * The parameter block is XORed into the initialization vector:
+ * digest length, key length, fanout and depth in word 0, node offset in
+ * word 1, node depth and inner length in word 2.
+ *
+ * @param ctx state to initialize
+ * @param nn length of hash digest
+ * @param kk length of secret key
+ * @param fanout fanout of the tree (1 for sequential hashing)
+ * @param depth depth of the tree (1 for sequential hashing)
+ * @param node_offset position of the node in its level
+ * @param node_depth level of the node, 0 for leaves
+ * @param inner_length digest length of the inner nodes
+ *
+ * @returns void
+ */
+static inline void blake2b_init_param(blake2b_ctx *ctx, uint8_t nn, uint8_t kk,
+                                      uint8_t fanout, uint8_t depth,
+                                      uint64_t node_offset, uint8_t node_depth,
+                                      uint8_t inner_length)
+{
+    int i;
+
+    blake2b_select_compress();
+
+    for (i = 0; i < 8; i++)
+    {
+        ctx->h[i] = blake2b_iv[i];
+    }
+    ctx->h[0] ^= (uint64_t)nn | ((uint64_t)kk << 8) |
+                 ((uint64_t)fanout << 16) | ((uint64_t)depth << 24);
+    ctx->h[1] ^= node_offset;
+    ctx->h[2] ^= (uint64_t)node_depth | ((uint64_t)inner_length << 8);
+
+    ctx->t[0] = 0;
+    ctx->t[1] = 0;
+    ctx->buflen = 0;
+    ctx->nn = nn;
+    ctx->last_node = 0;
+}
+
+/**
+ * @brief pads the key to a full block and queues it as the first block
+ *
+ * @param ctx state
+ * @param key secret key
+ * @param kk length of secret key
+ *
+ * @returns void
+ */
+static inline void blake2b_queue_key(blake2b_ctx *ctx, const uint8_t *key,
+                                     uint8_t kk)
+{
+    memset(ctx->buf, 0, BLAKE2B_BLOCK_BYTES);
+    memcpy(ctx->buf, key, kk);
+    ctx->buflen = BLAKE2B_BLOCK_BYTES;
+}
+
+/**
+ * @brief starts an incremental BLAKE2b computation
+ *
+ * @param ctx state to initialize
+ * @param key optional secret key
+ * @param kk length of optional secret key (0 <= kk <= 64)
+ * @param nn length of output digest (1 <= nn <= 64)
+ *
+ * @returns void
+ */
+static inline void blake2b_init(blake2b_ctx *ctx, const uint8_t *key,
+                                uint8_t kk, uint8_t nn)
+{
+    if (key == NULL)
+    {
+        kk = 0;
+    }
+    kk = BLAKE2B_MIN(kk, BLAKE2B_KK_MAX);
+    nn = BLAKE2B_MIN(nn, BLAKE2B_NN_MAX);
+
+    blake2b_init_param(ctx, nn, kk, 1, 1, 0, 0, 0);
+    if (kk > 0)
+    {
+        blake2b_queue_key(ctx, key, kk);
+    }
+}
+
+/**
+ * @brief adds len bytes of message to the computation
+ *
+ * @param ctx state set up by blake2b_init()
+ * @param data message bytes
+ * @param len number of bytes at data
+ *
+ * @returns void
+ */
+static inline void blake2b_update(blake2b_ctx *ctx, const uint8_t *data,
+                                  size_t len)
+{
+    while (len > 0)
+    {
+        /* only compress a block once it is known not to be the last one */
+        if (ctx->buflen == BLAKE2B_BLOCK_BYTES)
+        {
+            blake2b_u128_increment(ctx->t, BLAKE2B_BLOCK_BYTES);
+            blake2b_compress(ctx, ctx->buf, 0);
+            ctx->buflen = 0;
+        }
+
+        /* compress whole blocks straight from the input */
+        while (ctx->buflen == 0 && len > BLAKE2B_BLOCK_BYTES)
+        {
+            blake2b_u128_increment(ctx->t, BLAKE2B_BLOCK_BYTES);
+            blake2b_compress(ctx, data, 0);
+            data += BLAKE2B_BLOCK_BYTES;
+            len -= BLAKE2B_BLOCK_BYTES;
+        }
+
+        size_t n = BLAKE2B_MIN(BLAKE2B_BLOCK_BYTES - ctx->buflen, len);
+        memcpy(ctx->buf + ctx->buflen, data, n);
+        ctx->buflen += n;
+        data += n;
+        len -= n;
+    }
+}
+
+/**
+ * @brief finishes the computation
+ *
+ * @param ctx state of the computation
+ * @param dest destination of the nn byte digest
+ *
+ * @returns void
+ */
+static inline void blake2b_final(blake2b_ctx *ctx, uint8_t *dest)
+{
+    uint64_t i;
+
+    blake2b_u128_increment(ctx->t, ctx->buflen);
+    memset(ctx->buf + ctx->buflen, 0, BLAKE2B_BLOCK_BYTES - ctx->buflen);
+    blake2b_compress(ctx, ctx->buf, 1);
+
+    /* little-endian output of the first nn bytes of h */
+    for (i = 0; i < ctx->nn; i++)
+    {
+        dest[i] = (uint8_t)(ctx->h[i / 8] >> (8 * (i % 8)));
+    }
+}
+
+/**
+ * @brief blake2b hash function
+ *
+ * This is the front-end function that hashes a whole message with
+ * blake2b_init(), blake2b_update() and blake2b_final().
+ *
+ * @param message the message to be hashed
+ * @param len length of message (0 <= len < 2**128) (depends on sizeof(size_t)
+ * for this implementation)
+ * @param key optional secret key
+ * @param kk length of optional secret key (0 <= kk <= 64)
+ * @param nn length of output digest (1 <= nn < 64)
+ *
+ * @returns NULL if heap memory couldn't be allocated. Otherwise heap allocated
+ * memory nn bytes large
+ */
+static inline uint8_t *blake2b(const uint8_t *message, size_t len,
+                               const uint8_t *key, uint8_t kk, uint8_t nn)
+{
+    blake2b_ctx ctx;
+    uint8_t *dest = NULL;
+
+    if (message == NULL)
+    {
+        len = 0;
+    }
+    nn = BLAKE2B_MIN(nn, BLAKE2B_NN_MAX);
+
+    dest = malloc(nn * sizeof(uint8_t));
+    if (dest == NULL)
+    {
+        return NULL;
+    }
+
+    blake2b_init(&ctx, key, kk, nn);
+    blake2b_update(&ctx, message, len);
+    blake2b_final(&ctx, dest);
+
+    return dest;
+}
+
+/**
+ * @brief BLAKE2bp hash function
+ *
+ * The message is cut into ::BLAKE2B_BLOCK_BYTES byte blocks which are dealt
+ * round-robin to four BLAKE2b leaves (block i goes to leaf i mod 4). Each
+ * leaf produces a 64 byte digest and the root hashes the concatenation of
+ * the four. With OpenMP the leaves are hashed on up to four threads.
+ *
+ * @param message the message to be hashed
+ * @param len length of message
+ * @param key optional secret key, fed to every leaf
+ * @param kk length of optional secret key (0 <= kk <= 64)
+ * @param nn length of output digest (1 <= nn <= 64)
+ *
+ * @returns NULL if heap memory couldn't be allocated. Otherwise heap allocated
+ * memory nn bytes large
+ */
+static inline uint8_t *blake2bp(const uint8_t *message, size_t len,
+                                const uint8_t *key, uint8_t kk, uint8_t nn)
+{
+    blake2b_ctx leaves[BLAKE2B_PARALLELISM], root;
+    uint8_t digests[BLAKE2B_PARALLELISM][BLAKE2B_NN_MAX];
+    uint8_t *dest = NULL;
+    int i;
+
+    if (message == NULL)
+    {
+        len = 0;
+    }
+    if (key == NULL)
+    {
+        kk = 0;
+    }
+    kk = BLAKE2B_MIN(kk, BLAKE2B_KK_MAX);
+    nn = BLAKE2B_MIN(nn, BLAKE2B_NN_MAX);
+
+    dest = malloc(nn * sizeof(uint8_t));
+    if (dest == NULL)
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < BLAKE2B_PARALLELISM; i++)
+    {
+        blake2b_init_param(&leaves[i], nn, kk, BLAKE2B_PARALLELISM, 2, i, 0,
+                           BLAKE2B_NN_MAX);
+        leaves[i].nn = BLAKE2B_NN_MAX;
+        if (kk > 0)
+        {
+            blake2b_queue_key(&leaves[i], key, kk);
+        }
+    }
+    leaves[BLAKE2B_PARALLELISM - 1].last_node = 1;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(BLAKE2B_PARALLELISM)
+#endif
+    for (i = 0; i < BLAKE2B_PARALLELISM; i++)
+    {
+        size_t offset = (size_t)i * BLAKE2B_BLOCK_BYTES;
+
+        while (offset < len)
+        {
+            blake2b_update(&leaves[i], message + offset,
+                           BLAKE2B_MIN(BLAKE2B_BLOCK_BYTES, len - offset));
+            offset += BLAKE2B_PARALLELISM * BLAKE2B_BLOCK_BYTES;
+        }
+        blake2b_final(&leaves[i], digests[i]);
+    }
+
+    /* the root only carries the key length, not the key block */
+    blake2b_init_param(&root, nn, kk, BLAKE2B_PARALLELISM, 2, 0, 1,
+                       BLAKE2B_NN_MAX);
+    root.last_node = 1;
+    blake2b_update(&root, &digests[0][0], sizeof(digests));
+    blake2b_final(&root, dest);
+
+    return dest;
+}
+
+#undef BLAKE2B_MIN
+#undef BLAKE2B_ROTR64
+#undef BLAKE2B_U128_ZERO
+#ifdef BLAKE2B_AVX2
+#undef BLAKE2B_ROTR24_AVX2
+#undef BLAKE2B_ROTR16_AVX2
+#undef BLAKE2B_G_AVX2
+#endif
+
+/** @} */
+
+#endif /* HASH_BLAKE2B_H */
@@ -1,58 +1,143 @@
 /**
- * @addtogroup hash Hash algorithms
- * @{
- * @file hash_crc32.c
- * @author [Christian Bender](https://github.com/christianbender)
- * @brief 32-bit [CRC
- * hash](https://en.wikipedia.org/wiki/Cyclic_redundancy_check#CRC-32_algorithm)
- * algorithm
+ * @file
+ * @brief Tests and kernel throughput of the CRC-32 of hash_crc32.h
  */
-#include <assert.h>
-#include <inttypes.h>
-#include <stdio.h>
+#include <assert.h>    /// for assert
+#include <inttypes.h>  /// for fixed-width integer types
+#include <stdio.h>     /// for IO
+#include <stdlib.h>    /// for malloc, rand and free
+#include <time.h>      /// for clock
+
+#include "hash_crc32.h"
 
 /**
- * @brief 32-bit CRC algorithm implementation
+ * @brief bit-at-a-time reference used to check the fast kernels
  *
- * @param s NULL terminated ASCII string to hash
- * @return 32-bit hash result
+ * @param p data to hash
+ * @param len number of bytes at p
+ * @return 32-bit CRC
  */
-uint32_t crc32(const char* s)
+static uint32_t crc32_bitwise(const uint8_t *p, size_t len)
 {
     uint32_t crc = 0xffffffff;
-    size_t i = 0;
-    while (s[i] != '\0')
+    for (size_t i = 0; i < len; i++)
     {
-        uint8_t byte = s[i];
-        crc = crc ^ byte;
+        crc ^= p[i];
         for (uint8_t j = 8; j > 0; --j)
         {
-            crc = (crc >> 1) ^ (0xEDB88320 & (-(crc & 1)));
+            crc = (crc >> 1) ^ (CRC32_POLY & (-(crc & 1)));
         }
-
-        i++;
     }
     return crc ^ 0xffffffff;
 }
 
+/**
+ * @brief rebuilds ::crc32_table from the polynomial and compares
+ * \returns None
+ */
+static void test_crc32_table()
+{
+    for (uint32_t b = 0; b < 256; b++)
+    {
+        uint32_t crc = b;
+        for (int j = 0; j < 8; j++)
+        {
+            crc = (crc >> 1) ^ (CRC32_POLY & (-(crc & 1)));
+        }
+        assert(crc32_table[0][b] == crc);
+        for (int k = 1; k < 8; k++)
+        {
+            crc = (crc >> 8) ^ crc32_table[0][crc & 0xff];
+            assert(crc32_table[k][b] == crc);
+        }
+    }
+}
+
 /**
  * @brief Test function for ::crc32
  * \returns None
  */
 void test_crc32()
 {
+    test_crc32_table();
+
     assert(crc32("Hello World") == 1243066710);
     assert(crc32("Hello World!") == 472456355);
     assert(crc32("Hello world") == 2346098258);
     assert(crc32("Hello world!") == 461707669);
+
+    /* binary data with NUL bytes, every length around the kernel limits,
+     * and the same data fed in two chunks */
+    uint8_t data[1024];
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (uint8_t)rand();
+    }
+    for (size_t len = 0; len <= sizeof(data); len += len < 300 ? 1 : 37)
+    {
+        uint32_t expected = crc32_bitwise(data, len);
+        assert(crc32_buffer(data, len) == expected);
+
+        crc32_ctx ctx;
+        crc32_init(&ctx);
+        crc32_update(&ctx, data, len / 3);
+        crc32_update(&ctx, data + len / 3, len - len / 3);
+        assert(crc32_final(&ctx) == expected);
+    }
     printf("Tests passed\n");
 }
 
-/** @} */
+/**
+ * @brief prints the throughput of each available kernel
+ * \returns None
+ */
+static void benchmark_crc32()
+{
+    const size_t len = 1 << 24;
+    const int rounds = 8;
+    uint8_t *data = malloc(len);
+    if (!data)
+    {
+        return;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        data[i] = (uint8_t)i;
+    }
+
+    /* every round continues from the CRC of the previous one, so the calls
+     * cannot be hoisted out of the loop */
+    clock_t start = clock();
+    uint32_t sliced = 0xffffffff;
+    for (int r = 0; r < rounds; r++)
+    {
+        sliced = crc32_slice8(sliced, data, len);
+    }
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("slicing-by-8: %8.1f MB/s\n", rounds * len / 1e6 / seconds);
+
+#ifdef CRC32_CLMUL
+    if (crc32_cpu_has_clmul())
+    {
+        uint32_t folded = 0xffffffff;
+        start = clock();
+        for (int r = 0; r < rounds; r++)
+        {
+            folded = crc32_clmul(folded, data, len);
+        }
+        seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        printf("pclmulqdq:    %8.1f MB/s\n", rounds * len / 1e6 / seconds);
+        assert(folded == sliced);
+    }
+#endif
+
+    free(data);
+}
 
 /** Main function */
 int main()
 {
     test_crc32();
+    benchmark_crc32();
     return 0;
 }
@@ -1,31 +1,12 @@
 /**
- * @addtogroup hash Hash algorithms
- * @{
- * @file hash_djb2.c
- * @author [Christian Bender](https://github.com/christianbender)
- * @brief [DJB2 hash algorithm](http://www.cse.yorku.ca/~oz/hash.html)
+ * @file
+ * @brief Tests of the DJB2 hash of hash_djb2.h
  */
 #include <assert.h>
 #include <inttypes.h>
 #include <stdio.h>
 
-/**
- * @brief DJB2 algorithm implementation
- *
- * @param s NULL terminated string to hash
- * @return 64-bit hash result
- */
-uint64_t djb2(const char* s)
-{
-    uint64_t hash = 5381; /* init value */
-    size_t i = 0;
-    while (s[i] != '\0')
-    {
-        hash = ((hash << 5) + hash) + s[i];
-        i++;
-    }
-    return hash;
-}
+#include "hash_djb2.h"
 
 /**
  * Test function for ::djb2
@@ -40,8 +21,6 @@ void test_djb2(void)
     printf("Tests passed\n");
 }
 
-/** @} */
-
 /** Main function */
 int main()
 {
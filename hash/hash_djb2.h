@@ -0,0 +1,46 @@
+/**
+ * @addtogroup hash Hash algorithms
+ * @{
+ * @file hash_djb2.h
+ * @author [Christian Bender](https://github.com/christianbender)
+ * @brief [DJB2 hash algorithm](http://www.cse.yorku.ca/~oz/hash.html)
+ *
+ * Bytes are added as `char`, so keys with bytes above 127 hash differently
+ * where `char` is signed. The tests are in hash_djb2.c.
+ */
+#ifndef HASH_DJB2_H
+#define HASH_DJB2_H
+
+#include <stddef.h>  /// for size_t
+#include <stdint.h>  /// for fixed-width integer types
+#include <string.h>  /// for strlen
+
+/**
+ * @brief DJB2 algorithm over a buffer
+ *
+ * @param data bytes to hash, may contain NUL bytes
+ * @param len number of bytes at data
+ * @return 64-bit hash result
+ */
+static inline uint64_t djb2_buffer(const void *data, size_t len)
+{
+    const char *s = data;
+    uint64_t hash = 5381; /* init value */
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = ((hash << 5) + hash) + s[i];
+    }
+    return hash;
+}
+
+/**
+ * @brief DJB2 algorithm implementation
+ *
+ * @param s NULL terminated string to hash
+ * @return 64-bit hash result
+ */
+static inline uint64_t djb2(const char* s) { return djb2_buffer(s, strlen(s)); }
+
+/** @} */
+
+#endif /* HASH_DJB2_H */
@@ -1,31 +1,12 @@
 /**
- * @addtogroup hash Hash algorithms
- * @{
- * @file hash_sdbm.c
- * @author [Christian Bender](https://github.com/christianbender)
- * @brief [SDBM hash algorithm](http://www.cse.yorku.ca/~oz/hash.html)
+ * @file
+ * @brief Tests of the SDBM hash of hash_sdbm.h
  */
 #include <assert.h>
 #include <inttypes.h>
 #include <stdio.h>
 
-/**
- * @brief SDBM algorithm implementation
- *
- * @param s NULL terminated string to hash
- * @return 64-bit hash result
- */
-uint64_t sdbm(const char* s)
-{
-    uint64_t hash = 0;
-    size_t i = 0;
-    while (s[i] != '\0')
-    {
-        hash = s[i] + (hash << 6) + (hash << 16) - hash;
-        i++;
-    }
-    return hash;
-}
+#include "hash_sdbm.h"
 
 /**
  * @brief Test function for ::sdbm
@@ -40,8 +21,6 @@ void test_sdbm()
     printf("Tests passed\n");
 }
 
-/** @} */
-
 /** Main function */
 int main()
 {
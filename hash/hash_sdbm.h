@@ -0,0 +1,46 @@
+/**
+ * @addtogroup hash Hash algorithms
+ * @{
+ * @file hash_sdbm.h
+ * @author [Christian Bender](https://github.com/christianbender)
+ * @brief [SDBM hash algorithm](http://www.cse.yorku.ca/~oz/hash.html)
+ *
+ * Bytes are added as `char`, so keys with bytes above 127 hash differently
+ * where `char` is signed. The tests are in hash_sdbm.c.
+ */
+#ifndef HASH_SDBM_H
+#define HASH_SDBM_H
+
+#include <stddef.h>  /// for size_t
+#include <stdint.h>  /// for fixed-width integer types
+#include <string.h>  /// for strlen
+
+/**
+ * @brief SDBM algorithm over a buffer
+ *
+ * @param data bytes to hash, may contain NUL bytes
+ * @param len number of bytes at data
+ * @return 64-bit hash result
+ */
+static inline uint64_t sdbm_buffer(const void *data, size_t len)
+{
+    const char *s = data;
+    uint64_t hash = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = s[i] + (hash << 6) + (hash << 16) - hash;
+    }
+    return hash;
+}
+
+/**
+ * @brief SDBM algorithm implementation
+ *
+ * @param s NULL terminated string to hash
+ * @return 64-bit hash result
+ */
+static inline uint64_t sdbm(const char* s) { return sdbm_buffer(s, strlen(s)); }
+
+/** @} */
+
+#endif /* HASH_SDBM_H */
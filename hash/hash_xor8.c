@@ -1,32 +1,12 @@
 /**
- * @addtogroup hash Hash algorithms
- * @{
- * @file hash_xor8.c
- * @author [Christian Bender](https://github.com/christianbender)
- * @brief 8-bit [XOR hash](https://en.wikipedia.org/wiki/XOR_cipher) algorithm
- * for ASCII characters
+ * @file
+ * @brief Tests of the 8-bit XOR hash of hash_xor8.h
  */
 #include <assert.h>
 #include <inttypes.h>
 #include <stdio.h>
 
-/**
- * @brief 8-bit XOR algorithm implementation
- *
- * @param s NULL terminated ASCII string to hash
- * @return 8-bit hash result
- */
-uint8_t xor8(const char* s)
-{
-    uint8_t hash = 0;
-    size_t i = 0;
-    while (s[i] != '\0')
-    {
-        hash = (hash + s[i]) & 0xff;
-        i++;
-    }
-    return (((hash ^ 0xff) + 1) & 0xff);
-}
+#include "hash_xor8.h"
 
 /**
  * @brief Test function for ::xor8
@@ -41,8 +21,6 @@ void test_xor8()
     printf("Tests passed\n");
 }
 
-/** @} */
-
 /** Main function */
 int main()
 {
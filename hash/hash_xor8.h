@@ -0,0 +1,46 @@
+/**
+ * @addtogroup hash Hash algorithms
+ * @{
+ * @file hash_xor8.h
+ * @author [Christian Bender](https://github.com/christianbender)
+ * @brief 8-bit [XOR hash](https://en.wikipedia.org/wiki/XOR_cipher) algorithm
+ * for ASCII characters
+ *
+ * The tests are in hash_xor8.c.
+ */
+#ifndef HASH_XOR8_H
+#define HASH_XOR8_H
+
+#include <stddef.h>  /// for size_t
+#include <stdint.h>  /// for fixed-width integer types
+#include <string.h>  /// for strlen
+
+/**
+ * @brief 8-bit XOR algorithm over a buffer
+ *
+ * @param data bytes to hash, may contain NUL bytes
+ * @param len number of bytes at data
+ * @return 8-bit hash result
+ */
+static inline uint8_t xor8_buffer(const void *data, size_t len)
+{
+    const char *s = data;
+    uint8_t hash = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash + s[i]) & 0xff;
+    }
+    return (((hash ^ 0xff) + 1) & 0xff);
+}
+
+/**
+ * @brief 8-bit XOR algorithm implementation
+ *
+ * @param s NULL terminated string to hash
+ * @return 8-bit hash result
+ */
+static inline uint8_t xor8(const char* s) { return xor8_buffer(s, strlen(s)); }
+
+/** @} */
+
+#endif /* HASH_XOR8_H */
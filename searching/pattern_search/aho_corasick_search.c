@@ -0,0 +1,1018 @@
+/**
+ * @file
+ * @brief [Aho–Corasick](https://en.wikipedia.org/wiki/Aho%E2%80%93Corasick_algorithm)
+ * search of many patterns in one pass over the text
+ *
+ * naive_search.c, rabin_karp_search.c and boyer_moore_search.c scan the
+ * text once per pattern. Aho–Corasick builds one automaton from all
+ * patterns: a trie of the patterns whose every state also has a failure
+ * link to the state of its longest proper suffix in the trie. The text is
+ * then read once, one transition per byte, whatever the number of patterns.
+ *
+ * ac_compile() builds the automaton in one of two layouts:
+ * - ::AC_DENSE: a full transition table. Failure links are resolved at
+ *   build time, so every byte costs exactly one table lookup. Bytes that
+ *   occur in no pattern share one column, so a row has one entry per
+ *   distinct pattern byte plus one, and states are numbered breadth first,
+ *   which keeps the rows of the shallow states, where most of the text is
+ *   matched, together in cache. The top bit of an entry marks target states
+ *   that end a pattern, so the scan loop needs no other memory.
+ * - ::AC_DOUBLE_ARRAY: the trie compressed into a [double
+ *   array](https://doi.org/10.1109/32.31365) `base`/`check`: the child of
+ *   state `s` by byte class `c` is `t = base[s] + c` if `check[t] == s`.
+ *   Failure links are followed while scanning, amortized O(1) per byte.
+ *   Memory is a few integers per state instead of one per state and class.
+ *
+ * Matches are reported to an ::ac_callback with the pattern number and the
+ * offset of the match in the whole stream. An ::ac_stream keeps the state
+ * between calls of ac_feed(), so matches that straddle two chunks are
+ * found, as in log lines read buffer by buffer.
+ *
+ * usage: ./aho_corasick_search [number of patterns] [megabytes of text]
+ * runs the self tests, then times both layouts against
+ * boyer_moore_search.c run once per pattern on random log lines.
+ */
+#include <assert.h>  /// for assert
+#include <stdint.h>  /// for fixed-width integer types
+#include <stdio.h>   /// for IO
+#include <stdlib.h>  /// for malloc, realloc and free
+#include <string.h>  /// for memcpy, memset and strlen
+#include <time.h>    /// for clock
+
+#define AC_NONE UINT32_MAX         ///< no state or no pattern
+#define AC_MATCH_FLAG 0x80000000u  ///< dense entry whose target ends a pattern
+
+/** layout of the automaton */
+typedef enum
+{
+    AC_DENSE,        ///< full transition table, one lookup per byte
+    AC_DOUBLE_ARRAY  ///< double-array trie and failure links
+} ac_layout;
+
+/** compiled automaton, see ac_compile() */
+typedef struct
+{
+    ac_layout layout;
+    uint32_t states;      ///< number of states (dense) or cells (double array)
+    uint32_t classes;     ///< byte classes, class 0 for bytes of no pattern
+    uint8_t byte_class[256];
+    uint32_t *delta;      ///< dense: states x classes transitions
+    uint32_t *base;       ///< double array: children of s are at base[s] + c
+    uint32_t *check;      ///< double array: parent of every cell, or AC_NONE
+    uint32_t *fail;       ///< double array: failure link of every state
+    uint32_t *output;     ///< first pattern ending at a state, or AC_NONE
+    uint32_t *dict;       ///< next state on the failure chain with an output
+    uint32_t *next_same;  ///< next pattern equal to a pattern, or AC_NONE
+    size_t *length;       ///< length of every pattern
+} ac_automaton;
+
+/**
+ * @brief receives a match
+ * @param pattern number of the pattern in the array given to ac_compile()
+ * @param offset offset of the first byte of the match in the stream
+ * @param user pointer given to ac_stream_init()
+ * @returns 0 to go on, anything else to stop ac_feed(), which returns it
+ */
+typedef int (*ac_callback)(uint32_t pattern, uint64_t offset, void *user);
+
+/** position of a search in a stream of chunks */
+typedef struct
+{
+    const ac_automaton *ac;
+    uint32_t state;     ///< state after the bytes fed so far
+    uint64_t offset;    ///< number of bytes fed so far
+    ac_callback report;
+    void *user;
+} ac_stream;
+
+/** trie under construction, children as sibling lists */
+typedef struct
+{
+    uint32_t *first_child;
+    uint32_t *next_sibling;
+    uint8_t *label;  ///< byte class of the edge into every node
+    uint32_t *fail;
+    uint32_t *output;
+    uint32_t *dict;
+    uint32_t *order;  ///< nodes in breadth-first order
+    uint32_t nodes;
+} ac_trie;
+
+/**
+ * @brief frees an automaton
+ * @param ac automaton from ac_compile(), or NULL
+ * @returns void
+ */
+void ac_free(ac_automaton *ac)
+{
+    if (!ac)
+    {
+        return;
+    }
+    free(ac->delta);
+    free(ac->base);
+    free(ac->check);
+    free(ac->fail);
+    free(ac->output);
+    free(ac->dict);
+    free(ac->next_same);
+    free(ac->length);
+    free(ac);
+}
+
+/**
+ * @brief frees the arrays of a trie
+ * @param t the trie
+ * @returns void
+ */
+static void trie_free(ac_trie *t)
+{
+    free(t->first_child);
+    free(t->next_sibling);
+    free(t->label);
+    free(t->fail);
+    free(t->output);
+    free(t->dict);
+    free(t->order);
+}
+
+/**
+ * @brief the child of a trie node
+ * @param t the trie
+ * @param node parent node
+ * @param c byte class of the edge
+ * @returns the child, or AC_NONE
+ */
+static uint32_t trie_child(const ac_trie *t, uint32_t node, uint8_t c)
+{
+    uint32_t child = t->first_child[node];
+    while (child != AC_NONE && t->label[child] != c)
+    {
+        child = t->next_sibling[child];
+    }
+    return child;
+}
+
+/**
+ * @brief builds the trie of the patterns, with failure and dictionary links
+ * @param t trie to fill
+ * @param ac automaton whose byte classes, outputs of patterns and lengths
+ * are already set
+ * @param patterns the patterns
+ * @param count number of patterns
+ * @param max_nodes total length of the patterns plus one
+ * @returns 0 on success, -1 if out of memory
+ */
+static int trie_build(ac_trie *t, ac_automaton *ac,
+                      const char *const *patterns, uint32_t count,
+                      size_t max_nodes)
+{
+    t->first_child = malloc(max_nodes * sizeof(uint32_t));
+    t->next_sibling = malloc(max_nodes * sizeof(uint32_t));
+    t->label = malloc(max_nodes);
+    t->fail = malloc(max_nodes * sizeof(uint32_t));
+    t->output = malloc(max_nodes * sizeof(uint32_t));
+    t->dict = malloc(max_nodes * sizeof(uint32_t));
+    t->order = malloc(max_nodes * sizeof(uint32_t));
+    if (!t->first_child || !t->next_sibling || !t->label || !t->fail ||
+        !t->output || !t->dict || !t->order)
+    {
+        return -1;
+    }
+
+    t->nodes = 1;
+    t->first_child[0] = t->output[0] = AC_NONE;
+    t->label[0] = 0;
+    for (uint32_t p = 0; p < count; p++)
+    {
+        uint32_t node = 0;
+        for (size_t i = 0; i < ac->length[p]; i++)
+        {
+            uint8_t c = ac->byte_class[(uint8_t)patterns[p][i]];
+            uint32_t child = trie_child(t, node, c);
+            if (child == AC_NONE)
+            {
+                child = t->nodes++;
+                t->first_child[child] = t->output[child] = AC_NONE;
+                t->label[child] = c;
+                t->next_sibling[child] = t->first_child[node];
+                t->first_child[node] = child;
+            }
+            node = child;
+        }
+        /* equal patterns are chained, the first one listed first */
+        ac->next_same[p] = AC_NONE;
+        if (t->output[node] == AC_NONE)
+        {
+            t->output[node] = p;
+        }
+        else
+        {
+            uint32_t q = t->output[node];
+            while (ac->next_same[q] != AC_NONE)
+            {
+                q = ac->next_same[q];
+            }
+            ac->next_same[q] = p;
+        }
+    }
+
+    /* breadth first, so the failure link of a node is always done first */
+    uint32_t head = 0, tail = 0;
+    t->order[tail++] = 0;
+    t->fail[0] = 0;
+    t->dict[0] = AC_NONE;
+    while (head < tail)
+    {
+        uint32_t node = t->order[head++];
+        for (uint32_t child = t->first_child[node]; child != AC_NONE;
+             child = t->next_sibling[child])
+        {
+            uint32_t f = t->fail[node], target = AC_NONE;
+            if (node != 0)
+            {
+                while ((target = trie_child(t, f, t->label[child])) ==
+                           AC_NONE &&
+                       f != 0)
+                {
+                    f = t->fail[f];
+                }
+            }
+            t->fail[child] = target == AC_NONE ? 0 : target;
+            f = t->fail[child];
+            t->dict[child] = t->output[f] != AC_NONE ? f : t->dict[f];
+            t->order[tail++] = child;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief lays a trie out as a full transition table
+ * @param ac automaton to fill
+ * @param t the trie
+ * @returns 0 on success, -1 if out of memory
+ */
+static int layout_dense(ac_automaton *ac, const ac_trie *t)
+{
+    uint32_t n = t->nodes, classes = ac->classes;
+    uint32_t *rank = malloc(n * sizeof(uint32_t));
+    ac->delta = malloc((size_t)n * classes * sizeof(uint32_t));
+    ac->output = malloc(n * sizeof(uint32_t));
+    ac->dict = malloc(n * sizeof(uint32_t));
+    if (!rank || !ac->delta || !ac->output || !ac->dict)
+    {
+        free(rank);
+        return -1;
+    }
+
+    /* states are numbered in breadth-first order */
+    for (uint32_t i = 0; i < n; i++)
+    {
+        rank[t->order[i]] = i;
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t node = t->order[i];
+        uint32_t *row = ac->delta + (size_t)i * classes;
+        ac->output[i] = t->output[node];
+        ac->dict[i] = t->dict[node] == AC_NONE ? AC_NONE : rank[t->dict[node]];
+        /* missing edges behave like those of the failure state, whose row
+           comes earlier; the root stays at the root */
+        if (i == 0)
+        {
+            memset(row, 0, classes * sizeof(uint32_t));
+        }
+        else
+        {
+            memcpy(row, ac->delta + (size_t)rank[t->fail[node]] * classes,
+                   classes * sizeof(uint32_t));
+        }
+        row[0] = 0;  // class 0 bytes occur in no pattern
+        for (uint32_t child = t->first_child[node]; child != AC_NONE;
+             child = t->next_sibling[child])
+        {
+            int ends = t->output[child] != AC_NONE ||
+                       t->dict[child] != AC_NONE;
+            row[t->label[child]] =
+                rank[child] | (ends ? AC_MATCH_FLAG : 0);
+        }
+    }
+    ac->states = n;
+    free(rank);
+    return 0;
+}
+
+/** double array under construction, with a list of its free cells */
+typedef struct
+{
+    ac_automaton *ac;
+    uint32_t *next_free;  ///< circular list of the cells whose check is free
+    uint32_t *prev_free;
+    uint32_t free_head;   ///< lowest free cell, or AC_NONE
+} double_array_builder;
+
+/**
+ * @brief grows the arrays of a double array to hold cell `needed`
+ * @param d the builder
+ * @param needed index of a cell
+ * @returns 0 on success, -1 if out of memory
+ */
+static int double_array_reserve(double_array_builder *d, uint32_t needed)
+{
+    ac_automaton *ac = d->ac;
+    if (needed < ac->states)
+    {
+        return 0;
+    }
+    uint32_t size = ac->states ? ac->states : 256;
+    while (size <= needed)
+    {
+        size *= 2;
+    }
+    uint32_t **arrays[] = {&ac->base,   &ac->check,     &ac->fail,
+                           &ac->output, &ac->dict,      &d->next_free,
+                           &d->prev_free};
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++)
+    {
+        uint32_t *grown = realloc(*arrays[i], size * sizeof(uint32_t));
+        if (!grown)
+        {
+            return -1;
+        }
+        *arrays[i] = grown;
+    }
+    for (uint32_t i = ac->states; i < size; i++)
+    {
+        ac->base[i] = 0;
+        ac->check[i] = ac->fail[i] = ac->output[i] = ac->dict[i] = AC_NONE;
+        /* append to the circular list of free cells */
+        if (d->free_head == AC_NONE)
+        {
+            d->free_head = d->next_free[i] = d->prev_free[i] = i;
+        }
+        else
+        {
+            uint32_t last = d->prev_free[d->free_head];
+            d->next_free[last] = i;
+            d->prev_free[i] = last;
+            d->next_free[i] = d->free_head;
+            d->prev_free[d->free_head] = i;
+        }
+    }
+    ac->states = size;
+    return 0;
+}
+
+/**
+ * @brief marks a cell of a double array as used by a child of `parent`
+ * @param d the builder
+ * @param cell a free cell
+ * @param parent state the cell is a child of
+ * @returns void
+ */
+static void double_array_take(double_array_builder *d, uint32_t cell,
+                              uint32_t parent)
+{
+    d->ac->check[cell] = parent;
+    if (d->next_free[cell] == cell)
+    {
+        d->free_head = AC_NONE;
+        return;
+    }
+    d->next_free[d->prev_free[cell]] = d->next_free[cell];
+    d->prev_free[d->next_free[cell]] = d->prev_free[cell];
+    if (d->free_head == cell)
+    {
+        d->free_head = d->next_free[cell];
+    }
+}
+
+/**
+ * @brief finds a base where all children of a trie node fit
+ * @details The smallest child class is tried at every free cell in turn, so
+ * occupied cells are never visited (first fit over the free list).
+ * @param d the builder
+ * @param t the trie
+ * @param node a node with children
+ * @returns the base, 0 if out of memory
+ */
+static uint32_t double_array_find_base(double_array_builder *d,
+                                       const ac_trie *t, uint32_t node)
+{
+    uint32_t first = t->first_child[node];
+    uint8_t smallest = 255;
+    for (uint32_t c = first; c != AC_NONE; c = t->next_sibling[c])
+    {
+        smallest = t->label[c] < smallest ? t->label[c] : smallest;
+    }
+
+    uint32_t f = d->free_head;
+    while (f != AC_NONE)
+    {
+        if (f > smallest)
+        {
+            uint32_t b = f - smallest;
+            if (double_array_reserve(d, b + d->ac->classes))
+            {
+                return 0;
+            }
+            uint32_t c = first;
+            while (c != AC_NONE && d->ac->check[b + t->label[c]] == AC_NONE)
+            {
+                c = t->next_sibling[c];
+            }
+            if (c == AC_NONE)
+            {
+                return b;
+            }
+        }
+        f = d->next_free[f];
+        if (f == d->free_head)
+        {
+            break;
+        }
+    }
+    /* no free cell fits: past the end, every cell is free */
+    uint32_t b = d->ac->states;
+    return double_array_reserve(d, b + d->ac->classes) ? 0 : b;
+}
+
+/**
+ * @brief lays a trie out as a double array
+ * @details The children of every node, visited breadth first, are placed at
+ * the first base where all their cells are free. Nodes may share a base:
+ * `check` tells their children apart.
+ * @param ac automaton to fill
+ * @param t the trie
+ * @returns 0 on success, -1 if out of memory
+ */
+static int layout_double_array(ac_automaton *ac, const ac_trie *t)
+{
+    double_array_builder d = {ac, NULL, NULL, AC_NONE};
+    uint32_t *cell = malloc(t->nodes * sizeof(uint32_t));
+    int status = -1;
+    ac->states = 0;
+    if (cell && !double_array_reserve(&d, 256))
+    {
+        cell[0] = 0;
+        double_array_take(&d, 0, 0);
+        status = 0;
+    }
+
+    for (uint32_t i = 0; i < t->nodes && !status; i++)
+    {
+        uint32_t node = t->order[i], s = cell[node];
+        if (t->first_child[node] == AC_NONE)
+        {
+            continue;
+        }
+        uint32_t b = double_array_find_base(&d, t, node);
+        if (!b)
+        {
+            status = -1;
+            break;
+        }
+        ac->base[s] = b;
+        for (uint32_t c = t->first_child[node]; c != AC_NONE;
+             c = t->next_sibling[c])
+        {
+            cell[c] = b + t->label[c];
+            double_array_take(&d, cell[c], s);
+        }
+    }
+
+    for (uint32_t node = 0; node < t->nodes && !status; node++)
+    {
+        uint32_t s = cell[node];
+        ac->fail[s] = cell[t->fail[node]];
+        ac->output[s] = t->output[node];
+        ac->dict[s] = t->dict[node] == AC_NONE ? AC_NONE : cell[t->dict[node]];
+    }
+    free(cell);
+    free(d.next_free);
+    free(d.prev_free);
+    return status;
+}
+
+/**
+ * @brief compiles patterns into an automaton
+ * @param patterns `count` NUL-terminated, non-empty patterns
+ * @param count number of patterns
+ * @param layout ::AC_DENSE or ::AC_DOUBLE_ARRAY
+ * @returns the automaton, to be freed by ac_free(), or NULL if a pattern is
+ * empty or memory runs out
+ */
+ac_automaton *ac_compile(const char *const *patterns, uint32_t count,
+                         ac_layout layout)
+{
+    ac_automaton *ac = calloc(1, sizeof(ac_automaton));
+    if (!ac)
+    {
+        return NULL;
+    }
+    ac->layout = layout;
+    ac->length = malloc((count ? count : 1) * sizeof(size_t));
+    ac->next_same = malloc((count ? count : 1) * sizeof(uint32_t));
+    if (!ac->length || !ac->next_same)
+    {
+        ac_free(ac);
+        return NULL;
+    }
+
+    /* every byte of a pattern gets a class of its own, the others share 0 */
+    size_t total = 1;
+    ac->classes = 1;
+    for (uint32_t p = 0; p < count; p++)
+    {
+        ac->length[p] = strlen(patterns[p]);
+        if (ac->length[p] == 0)
+        {
+            ac_free(ac);
+            return NULL;
+        }
+        total += ac->length[p];
+        for (size_t i = 0; i < ac->length[p]; i++)
+        {
+            uint8_t byte = (uint8_t)patterns[p][i];
+            if (!ac->byte_class[byte])
+            {
+                ac->byte_class[byte] = (uint8_t)ac->classes++;
+            }
+        }
+    }
+
+    ac_trie t = {0};
+    int status = total > AC_MATCH_FLAG / 2 ||
+                 trie_build(&t, ac, patterns, count, total);
+    if (!status)
+    {
+        status = layout == AC_DENSE ? layout_dense(ac, &t)
+                                    : layout_double_array(ac, &t);
+    }
+    trie_free(&t);
+    if (status)
+    {
+        ac_free(ac);
+        return NULL;
+    }
+    return ac;
+}
+
+/**
+ * @brief starts a search
+ * @param stream stream to initialize
+ * @param ac the automaton
+ * @param report function called for every match
+ * @param user passed to `report`
+ * @returns void
+ */
+void ac_stream_init(ac_stream *stream, const ac_automaton *ac,
+                    ac_callback report, void *user)
+{
+    stream->ac = ac;
+    stream->state = 0;
+    stream->offset = 0;
+    stream->report = report;
+    stream->user = user;
+}
+
+/**
+ * @brief reports the patterns ending at a state
+ * @param stream the stream
+ * @param state state reached
+ * @param end offset in the stream just past the last byte read
+ * @returns 0, or the first nonzero value returned by the callback
+ */
+static int report_matches(const ac_stream *stream, uint32_t state,
+                          uint64_t end)
+{
+    const ac_automaton *ac = stream->ac;
+    if (ac->output[state] == AC_NONE)
+    {
+        state = ac->dict[state];
+    }
+    for (; state != AC_NONE; state = ac->dict[state])
+    {
+        for (uint32_t p = ac->output[state]; p != AC_NONE;
+             p = ac->next_same[p])
+        {
+            int stop = stream->report(p, end - ac->length[p], stream->user);
+            if (stop)
+            {
+                return stop;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief searches the next chunk of a stream
+ * @details If the callback stops the search, the stream is left just after
+ * the byte that ended the match; matches ending at that byte and not
+ * reported yet are lost.
+ * @param stream stream from ac_stream_init()
+ * @param chunk next bytes of the stream
+ * @param size number of bytes
+ * @returns 0, or the first nonzero value returned by the callback
+ */
+int ac_feed(ac_stream *stream, const void *chunk, size_t size)
+{
+    const ac_automaton *ac = stream->ac;
+    const uint8_t *text = chunk;
+    uint32_t state = stream->state;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        uint8_t c = ac->byte_class[text[i]];
+        int ends;
+        if (ac->layout == AC_DENSE)
+        {
+            uint32_t next = ac->delta[(size_t)state * ac->classes + c];
+            state = next & ~AC_MATCH_FLAG;
+            ends = (next & AC_MATCH_FLAG) != 0;
+        }
+        else
+        {
+            while (state != 0 && ac->check[ac->base[state] + c] != state)
+            {
+                state = ac->fail[state];
+            }
+            if (c != 0 && ac->check[ac->base[state] + c] == state)
+            {
+                state = ac->base[state] + c;
+            }
+            ends = ac->output[state] != AC_NONE || ac->dict[state] != AC_NONE;
+        }
+        if (ends)
+        {
+            int stop = report_matches(stream, state, stream->offset + i + 1);
+            if (stop)
+            {
+                stream->state = state;
+                stream->offset += i + 1;
+                return stop;
+            }
+        }
+    }
+    stream->state = state;
+    stream->offset += size;
+    return 0;
+}
+
+/** @cond boyer_moore_search() of boyer_moore_search.c, counting matches */
+#define NUM_OF_CHARS 256
+
+static int max(int a, int b) { return (a > b) ? a : b; }
+
+static void computeArray(const char *pattern, int size, int arr[NUM_OF_CHARS])
+{
+    int i;
+
+    for (i = 0; i < NUM_OF_CHARS; i++) arr[i] = -1;
+    for (i = 0; i < size; i++) arr[(unsigned char)pattern[i]] = i;
+}
+
+static long boyer_moore_count(const char *str, int n, const char *pattern)
+{
+    int m = strlen(pattern);
+    int shift = 0;
+    int arr[NUM_OF_CHARS];
+    long found = 0;
+
+    computeArray(pattern, m, arr);
+    while (shift <= (n - m))
+    {
+        int j = m - 1;
+        while (j >= 0 && pattern[j] == str[shift + j]) j--;
+        if (j < 0)
+        {
+            found++;
+            shift += (shift + m < n)
+                         ? max(1, m - arr[(unsigned char)str[shift + m]])
+                         : 1;
+        }
+        else
+        {
+            shift += max(1, j - arr[(unsigned char)str[shift + j]]);
+        }
+    }
+    return found;
+}
+/** @endcond */
+
+/** one match, as collected by the tests */
+typedef struct
+{
+    uint32_t pattern;
+    uint64_t offset;
+} match;
+
+/** matches collected by ::collect */
+typedef struct
+{
+    match *items;
+    size_t count, capacity;
+} match_list;
+
+/**
+ * @brief ::ac_callback appending the match to a ::match_list
+ * @param pattern number of the pattern
+ * @param offset offset of the match
+ * @param user the ::match_list
+ * @returns 0
+ */
+static int collect(uint32_t pattern, uint64_t offset, void *user)
+{
+    match_list *list = user;
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? 2 * list->capacity : 64;
+        list->items = realloc(list->items, list->capacity * sizeof(match));
+        assert(list->items);
+    }
+    list->items[list->count].pattern = pattern;
+    list->items[list->count].offset = offset;
+    list->count++;
+    return 0;
+}
+
+/**
+ * @brief ::ac_callback counting the matches in a `long`
+ * @param pattern number of the pattern
+ * @param offset offset of the match
+ * @param user the counter
+ * @returns 0
+ */
+static int count_match(uint32_t pattern, uint64_t offset, void *user)
+{
+    (void)pattern;
+    (void)offset;
+    ++*(long *)user;
+    return 0;
+}
+
+/** qsort() order of matches, by offset then pattern */
+static int compare_matches(const void *a, const void *b)
+{
+    const match *x = a, *y = b;
+    if (x->offset != y->offset)
+    {
+        return x->offset < y->offset ? -1 : 1;
+    }
+    return (x->pattern > y->pattern) - (x->pattern < y->pattern);
+}
+
+/**
+ * @brief checks both layouts against a naive search, feeding the text in
+ * random chunks
+ * @param patterns the patterns
+ * @param count number of patterns
+ * @param text the text
+ * @param n length of the text
+ * @returns void
+ */
+static void test_search(const char *const *patterns, uint32_t count,
+                        const char *text, size_t n)
+{
+    match_list expected = {0};
+    for (size_t i = 0; i < n; i++)
+    {
+        for (uint32_t p = 0; p < count; p++)
+        {
+            size_t m = strlen(patterns[p]);
+            if (m <= n - i && memcmp(text + i, patterns[p], m) == 0)
+            {
+                collect(p, i, &expected);
+            }
+        }
+    }
+    if (expected.count)
+    {
+        qsort(expected.items, expected.count, sizeof(match), compare_matches);
+    }
+
+    for (int layout = AC_DENSE; layout <= AC_DOUBLE_ARRAY; layout++)
+    {
+        ac_automaton *ac = ac_compile(patterns, count, (ac_layout)layout);
+        assert(ac);
+        match_list found = {0};
+        ac_stream stream;
+        ac_stream_init(&stream, ac, collect, &found);
+        for (size_t i = 0; i < n;)
+        {
+            size_t chunk = (size_t)rand() % 8;
+            chunk = chunk < n - i ? chunk : n - i;
+            assert(ac_feed(&stream, text + i, chunk) == 0);
+            i += chunk;
+        }
+        assert(stream.offset == n);
+        assert(found.count == expected.count);
+        if (found.count)
+        {
+            qsort(found.items, found.count, sizeof(match), compare_matches);
+        }
+        for (size_t i = 0; i < found.count; i++)
+        {
+            assert(found.items[i].pattern == expected.items[i].pattern);
+            assert(found.items[i].offset == expected.items[i].offset);
+        }
+        free(found.items);
+        ac_free(ac);
+    }
+    free(expected.items);
+}
+
+/**
+ * @brief ::ac_callback stopping at the first match
+ * @param pattern number of the pattern
+ * @param offset offset of the match
+ * @param user unused
+ * @returns 1 + the number of the pattern
+ */
+static int stop_at_first(uint32_t pattern, uint64_t offset, void *user)
+{
+    (void)offset;
+    (void)user;
+    return (int)pattern + 1;
+}
+
+/**
+ * @brief Self-test implementations
+ * @returns void
+ */
+static void test()
+{
+    const char *const classic[] = {"he", "she", "his", "hers"};
+    test_search(classic, 4, "ushers", 6);
+    test_search(classic, 4, "ahishers his hehe", 17);
+
+    /* duplicates, patterns inside patterns, bytes above 127 */
+    const char *const nested[] = {"a", "aa", "aaa", "aa", "\xff\x80", "b"};
+    test_search(nested, 6, "aaaa\xff\x80\xff\x80 aab", 12);
+
+    /* no patterns at all, and a text matching nothing */
+    test_search(NULL, 0, "abc", 3);
+    test_search(classic, 4, "xyz", 3);
+
+    /* random patterns over a small alphabet, so they overlap a lot */
+    for (int round = 0; round < 50; round++)
+    {
+        char words[40][8], text[500];
+        const char *patterns[40];
+        uint32_t count = 1 + (uint32_t)(rand() % 40);
+        for (uint32_t p = 0; p < count; p++)
+        {
+            int length = 1 + rand() % 6;
+            for (int i = 0; i < length; i++)
+            {
+                words[p][i] = (char)('a' + rand() % 3);
+            }
+            words[p][length] = '\0';
+            patterns[p] = words[p];
+        }
+        for (size_t i = 0; i < sizeof(text); i++)
+        {
+            text[i] = (char)('a' + rand() % 4);
+        }
+        test_search(patterns, count, text, sizeof(text));
+    }
+
+    assert(ac_compile((const char *const[]){"ok", ""}, 2, AC_DENSE) == NULL);
+
+    /* a callback that stops the search, which resumes where it stopped */
+    ac_automaton *ac = ac_compile(classic, 4, AC_DOUBLE_ARRAY);
+    assert(ac);
+    ac_stream stream;
+    ac_stream_init(&stream, ac, stop_at_first, NULL);
+    assert(ac_feed(&stream, "ushers", 6) == 2);  // "she" ends first
+    assert(stream.offset == 4);
+    ac_free(ac);
+
+    printf("All tests passed\n\n");
+}
+
+/**
+ * @brief writes random log lines containing some of the keywords
+ * @param text buffer of `size` bytes
+ * @param size size of the text
+ * @param keywords the keywords
+ * @param count number of keywords
+ * @returns void
+ */
+static void make_log(char *text, size_t size, char **keywords, uint32_t count)
+{
+    static const char *const words[] = {"INFO", "WARN", "request", "GET",
+                                        "/api/v1/users", "200", "latency=",
+                                        "ms", "user_id=", "session"};
+    size_t n = 0;
+    while (n < size)
+    {
+        const char *word = rand() % 50 ? words[rand() % 10]
+                                       : keywords[rand() % count];
+        size_t m = strlen(word);
+        for (size_t i = 0; i < m && n < size; i++)
+        {
+            text[n++] = word[i];
+        }
+        if (n < size)
+        {
+            text[n++] = rand() % 12 ? ' ' : '\n';
+        }
+    }
+}
+
+/** @returns seconds elapsed since start */
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * @brief Main function
+ * @param argc number of arguments
+ * @param argv number of patterns and megabytes of text, both optional
+ * @returns 0 on exit
+ */
+int main(int argc, char *argv[])
+{
+    srand((unsigned)time(NULL));
+    test();
+
+    uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 1000;
+    size_t size = (argc > 2 ? strtoul(argv[2], NULL, 0) : 16) << 20;
+    char **keywords = malloc((count ? count : 1) * sizeof(char *));
+    char *text = malloc(size);
+    if (!count || !keywords || !text)
+    {
+        printf("Can't Malloc! Please try again.");
+        return 1;
+    }
+    for (uint32_t p = 0; p < count; p++)
+    {
+        int length = 5 + rand() % 8;
+        keywords[p] = malloc(length + 1);
+        assert(keywords[p]);
+        for (int i = 0; i < length; i++)
+        {
+            keywords[p][i] = (char)('a' + rand() % 26);
+        }
+        keywords[p][length] = '\0';
+    }
+    make_log(text, size, keywords, count);
+
+    printf("%u keywords, %zu MB of log lines\n", count, size >> 20);
+    for (int layout = AC_DENSE; layout <= AC_DOUBLE_ARRAY; layout++)
+    {
+        clock_t start = clock();
+        ac_automaton *ac = ac_compile((const char *const *)keywords, count,
+                                      (ac_layout)layout);
+        if (!ac)
+        {
+            printf("Can't Malloc! Please try again.");
+            return 1;
+        }
+        double build = seconds_since(start);
+        long found = 0;
+        ac_stream stream;
+        ac_stream_init(&stream, ac, count_match, &found);
+        start = clock();
+        for (size_t i = 0; i < size; i += 4096)
+        {
+            ac_feed(&stream, text + i, size - i < 4096 ? size - i : 4096);
+        }
+        double seconds = seconds_since(start);
+        printf("%-24s %8.3f s %8.1f MB/s %10ld matches (built in %.3f s, "
+               "%u states)\n",
+               layout == AC_DENSE ? "aho_corasick dense"
+                                  : "aho_corasick double array",
+               seconds, size / 1e6 / seconds, found, build, ac->states);
+        ac_free(ac);
+    }
+
+    /* Boyer-Moore once per keyword, stopped after a few seconds */
+    clock_t start = clock();
+    long found = 0;
+    uint32_t done = 0;
+    for (; done < count && seconds_since(start) < 5; done++)
+    {
+        found += boyer_moore_count(text, (int)size, keywords[done]);
+    }
+    double seconds = seconds_since(start) * count / done;
+    printf("%-24s %8.3f s %8.1f MB/s %10ld matches", "boyer_moore per keyword",
+           seconds, size / 1e6 / seconds, found);
+    if (done < count)
+    {
+        printf(" (%u keywords searched, time extrapolated)", done);
+    }
+    printf("\n");
+
+    for (uint32_t p = 0; p < count; p++)
+    {
+        free(keywords[p]);
+    }
+    free(keywords);
+    free(text);
+    return 0;
+}
@@ -1,45 +1,667 @@
-#include <stdio.h>
-#include <string.h>
+/**
+ * @file
+ * @brief [Boyer–Moore](https://en.wikipedia.org/wiki/Boyer%E2%80%93Moore_string-search_algorithm),
+ * Horspool and Two-Way substring search
+ *
+ * Every search reports each occurrence of a pattern of `m` bytes in a text
+ * of `n` bytes, overlapping ones included, to a ::match_callback. Texts and
+ * patterns are byte arrays with lengths, and bytes index their tables as
+ * `unsigned char`, so any byte value works.
+ * - boyer_moore_find(): the bad-character rule, the good-suffix rule and
+ *   Galil's rule, which after a match skips the part of the pattern already
+ *   known to match again. Linear time even on periodic patterns.
+ * - horspool_find(): the bad-character shift of the text byte under the
+ *   last pattern position only. The simplest loop, and the fastest when
+ *   the alphabet is large, since shifts are then usually close to `m`.
+ * - two_way_find(): Crochemore and Perrin's Two-Way algorithm. The pattern
+ *   is cut at a critical factorization; the right part is matched left to
+ *   right, then the left part right to left, and the period of the pattern
+ *   bounds the shifts. Linear time and O(1) extra space.
+ *
+ * string_search() picks one of them for the pattern: Horspool for short
+ * patterns or patterns of many distinct bytes, where bad-character shifts
+ * are long, Boyer–Moore for long patterns over a small alphabet such as
+ * DNA, and Two-Way for patterns too long for a good-suffix table.
+ *
+ * usage: ./boyer_moore_search [megabytes]
+ * runs the self tests and the original examples, then times every search
+ * on DNA, English text and binary data (default 32 MB each).
+ */
+#include <assert.h>  /// for assert
+#include <stddef.h>  /// for ptrdiff_t
+#include <stdint.h>  /// for fixed-width integer types
+#include <stdio.h>   /// for IO
+#include <stdlib.h>  /// for malloc and free
+#include <string.h>  /// for memcmp and strlen
+#include <time.h>    /// for clock
 
-#define NUM_OF_CHARS 256
+#define NUM_OF_CHARS 256  ///< size of the bad-character tables
+/** longest pattern string_search() builds a good-suffix table for */
+#define GOOD_SUFFIX_MAX_LENGTH (1 << 16)
+/** string_search() uses Horspool up to this many distinct pattern bytes... */
+#define SMALL_ALPHABET 8
+/** ...or for patterns shorter than this */
+#define SHORT_PATTERN 32
 
-int max(int a, int b) { return (a > b) ? a : b; }
+/**
+ * @brief receives a match
+ * @param offset offset of the match in the text
+ * @param user pointer given to the search
+ * @returns 0 to go on, anything else to stop the search, which returns it
+ */
+typedef int (*match_callback)(size_t offset, void *user);
 
-void computeArray(char *pattern, int size, int arr[NUM_OF_CHARS])
+/**
+ * @brief larger of two sizes
+ * @param a first size
+ * @param b second size
+ * @returns the larger
+ */
+static size_t max_size(size_t a, size_t b) { return (a > b) ? a : b; }
+
+/**
+ * @brief fills the bad-character table of a pattern
+ * @details `shift[c]` is the distance from the last occurrence of byte `c`
+ * in `pattern[0 .. m - 2]` to the end of the pattern, or `m` if `c` does
+ * not occur there.
+ * @param pattern the pattern
+ * @param m length of the pattern, at least 1
+ * @param shift the table
+ * @returns void
+ */
+static void compute_bad_character(const uint8_t *pattern, size_t m,
+                                  size_t shift[NUM_OF_CHARS])
+{
+    for (size_t c = 0; c < NUM_OF_CHARS; c++)
+    {
+        shift[c] = m;
+    }
+    for (size_t i = 0; i + 1 < m; i++)
+    {
+        shift[pattern[i]] = m - 1 - i;
+    }
+}
+
+/**
+ * @brief fills the good-suffix table of a pattern
+ * @details After a mismatch at position `i` of the pattern, with
+ * `pattern[i + 1 .. m - 1]` matched, the pattern may move by `shift[i]`:
+ * to the next occurrence of the matched suffix preceded by another byte,
+ * or to the longest prefix of the pattern that is a suffix of it.
+ * `shift[0]` after a full match is the period of the pattern.
+ * @param pattern the pattern
+ * @param m length of the pattern, at least 1
+ * @param shift table of `m` entries
+ * @param suffix scratch table of `m` entries
+ * @returns void
+ */
+static void compute_good_suffix(const uint8_t *pattern, size_t m,
+                                size_t *shift, size_t *suffix)
+{
+    /* suffix[i]: length of the longest common suffix of pattern[0 .. i]
+       and the whole pattern */
+    ptrdiff_t last = (ptrdiff_t)m - 1, f = last, g = last;
+    suffix[m - 1] = m;
+    for (ptrdiff_t i = last - 1; i >= 0; i--)
+    {
+        if (i > g && (ptrdiff_t)suffix[i + last - f] < i - g)
+        {
+            suffix[i] = suffix[i + last - f];
+        }
+        else
+        {
+            if (i < g)
+            {
+                g = i;
+            }
+            f = i;
+            while (g >= 0 && pattern[g] == pattern[g + last - f])
+            {
+                g--;
+            }
+            suffix[i] = (size_t)(f - g);
+        }
+    }
+
+    for (size_t i = 0; i < m; i++)
+    {
+        shift[i] = m;
+    }
+    /* prefixes of the pattern that are also suffixes */
+    size_t j = 0;
+    for (ptrdiff_t i = last; i >= 0; i--)
+    {
+        if (suffix[i] == (size_t)i + 1)
+        {
+            for (; j < m - 1 - (size_t)i; j++)
+            {
+                if (shift[j] == m)
+                {
+                    shift[j] = m - 1 - (size_t)i;
+                }
+            }
+        }
+    }
+    /* other occurrences of the suffixes */
+    for (size_t i = 0; i + 1 < m; i++)
+    {
+        shift[m - 1 - suffix[i]] = m - 1 - i;
+    }
+}
+
+/**
+ * @brief Boyer–Moore search with the bad-character, good-suffix and Galil
+ * rules
+ * @param text the text
+ * @param n length of the text
+ * @param pattern the pattern
+ * @param m length of the pattern
+ * @param report called with the offset of every match
+ * @param user passed to `report`
+ * @returns 0, or the first nonzero value returned by `report`; -1 if the
+ * good-suffix table cannot be allocated
+ */
+int boyer_moore_find(const uint8_t *text, size_t n, const uint8_t *pattern,
+                     size_t m, match_callback report, void *user)
 {
-    int i;
+    if (m == 0 || m > n)
+    {
+        return 0;
+    }
+    size_t bad[NUM_OF_CHARS];
+    size_t *good = malloc(2 * m * sizeof(size_t));
+    if (!good)
+    {
+        return -1;
+    }
+    compute_bad_character(pattern, m, bad);
+    compute_good_suffix(pattern, m, good, good + m);
 
-    for (i = 0; i < NUM_OF_CHARS; i++) arr[i] = -1;
-    /* Fill the actual value of last occurrence of a character */
-    for (i = 0; i < size; i++) arr[(int)pattern[i]] = i;
+    const size_t period = good[0];
+    size_t shift = 0, known = 0;  // pattern[0 .. known) matches already
+    int stop = 0;
+    while (!stop && shift <= n - m)
+    {
+        size_t i = m;
+        while (i > known && pattern[i - 1] == text[shift + i - 1])
+        {
+            i--;
+        }
+        if (i <= known)
+        {
+            stop = report(shift, user);
+            shift += period;
+            known = m - period;  // Galil: the overlap is already matched
+        }
+        else
+        {
+            /* mismatch at pattern[i - 1] */
+            size_t bc = bad[text[shift + i - 1]];
+            size_t by_bad = bc > m - i ? bc - (m - i) : 1;
+            shift += max_size(good[i - 1], by_bad);
+            known = 0;
+        }
+    }
+    free(good);
+    return stop;
+}
+
+/**
+ * @brief Horspool search
+ * @param text the text
+ * @param n length of the text
+ * @param pattern the pattern
+ * @param m length of the pattern
+ * @param report called with the offset of every match
+ * @param user passed to `report`
+ * @returns 0, or the first nonzero value returned by `report`
+ */
+int horspool_find(const uint8_t *text, size_t n, const uint8_t *pattern,
+                  size_t m, match_callback report, void *user)
+{
+    if (m == 0 || m > n)
+    {
+        return 0;
+    }
+    size_t shift[NUM_OF_CHARS];
+    compute_bad_character(pattern, m, shift);
+
+    const uint8_t last = pattern[m - 1];
+    for (size_t i = 0; i <= n - m;)
+    {
+        uint8_t c = text[i + m - 1];
+        if (c == last && memcmp(text + i, pattern, m - 1) == 0)
+        {
+            int stop = report(i, user);
+            if (stop)
+            {
+                return stop;
+            }
+        }
+        i += shift[c];
+    }
+    return 0;
+}
+
+/**
+ * @brief maximal suffix of a pattern for one of two orders of the bytes
+ * @param pattern the pattern
+ * @param m length of the pattern, at least 1
+ * @param reverse 0 for the order of the byte values, 1 for the reverse
+ * @param period receives the period of the maximal suffix
+ * @returns the position of the maximal suffix, minus one
+ */
+static ptrdiff_t maximal_suffix(const uint8_t *pattern, size_t m, int reverse,
+                                size_t *period)
+{
+    ptrdiff_t ms = -1, j = 0, k = 1, p = 1;
+    while (j + k < (ptrdiff_t)m)
+    {
+        uint8_t a = pattern[j + k], b = pattern[ms + k];
+        if (a == b)
+        {
+            if (k != p)
+            {
+                k++;
+            }
+            else
+            {
+                j += p;
+                k = 1;
+            }
+        }
+        else if ((a < b) != reverse)
+        {
+            j += k;
+            k = 1;
+            p = j - ms;
+        }
+        else
+        {
+            ms = j;
+            j = ms + 1;
+            k = p = 1;
+        }
+    }
+    *period = (size_t)p;
+    return ms;
+}
+
+/**
+ * @brief Two-Way search of Crochemore and Perrin
+ * @param text the text
+ * @param n length of the text
+ * @param pattern the pattern
+ * @param m length of the pattern
+ * @param report called with the offset of every match
+ * @param user passed to `report`
+ * @returns 0, or the first nonzero value returned by `report`
+ */
+int two_way_find(const uint8_t *text, size_t n, const uint8_t *pattern,
+                 size_t m, match_callback report, void *user)
+{
+    if (m == 0 || m > n)
+    {
+        return 0;
+    }
+
+    /* critical factorization: pattern[0 .. ell] and pattern[ell + 1 ..] */
+    size_t p, q;
+    ptrdiff_t i = maximal_suffix(pattern, m, 0, &p);
+    ptrdiff_t j = maximal_suffix(pattern, m, 1, &q);
+    ptrdiff_t ell = i > j ? i : j;
+    size_t period = i > j ? p : q;
+    const ptrdiff_t last = (ptrdiff_t)m - 1;
+
+    if (memcmp(pattern, pattern + period, (size_t)(ell + 1)) == 0)
+    {
+        /* periodic pattern: remember how much of the left part matched */
+        ptrdiff_t memory = -1;
+        for (size_t shift = 0; shift <= n - m;)
+        {
+            const uint8_t *t = text + shift;
+            ptrdiff_t k = (ell > memory ? ell : memory) + 1;
+            while (k < (ptrdiff_t)m && pattern[k] == t[k])
+            {
+                k++;
+            }
+            if (k < (ptrdiff_t)m)
+            {
+                shift += (size_t)(k - ell);
+                memory = -1;
+                continue;
+            }
+            k = ell;
+            while (k > memory && pattern[k] == t[k])
+            {
+                k--;
+            }
+            if (k <= memory)
+            {
+                int stop = report(shift, user);
+                if (stop)
+                {
+                    return stop;
+                }
+            }
+            shift += period;
+            memory = last - (ptrdiff_t)period;
+        }
+    }
+    else
+    {
+        /* no long repetition: shift past the larger part on a match */
+        period = max_size((size_t)(ell + 1), (size_t)(last - ell)) + 1;
+        for (size_t shift = 0; shift <= n - m;)
+        {
+            const uint8_t *t = text + shift;
+            ptrdiff_t k = ell + 1;
+            while (k < (ptrdiff_t)m && pattern[k] == t[k])
+            {
+                k++;
+            }
+            if (k < (ptrdiff_t)m)
+            {
+                shift += (size_t)(k - ell);
+                continue;
+            }
+            k = ell;
+            while (k >= 0 && pattern[k] == t[k])
+            {
+                k--;
+            }
+            if (k < 0)
+            {
+                int stop = report(shift, user);
+                if (stop)
+                {
+                    return stop;
+                }
+            }
+            shift += period;
+        }
+    }
+    return 0;
 }
+
+/**
+ * @brief searches with the algorithm that suits the pattern
+ * @details Patterns shorter than ::SHORT_PATTERN or with more than
+ * ::SMALL_ALPHABET distinct bytes go to Horspool: their bad-character
+ * shifts are long. Longer patterns over few bytes, such as DNA, go to
+ * Boyer–Moore, whose good-suffix rule still makes long shifts there, up to
+ * ::GOOD_SUFFIX_MAX_LENGTH bytes; longer ones go to Two-Way, which needs no
+ * table.
+ * @param text the text
+ * @param n length of the text
+ * @param pattern the pattern
+ * @param m length of the pattern; an empty pattern matches nowhere
+ * @param report called with the offset of every match, in increasing order
+ * @param user passed to `report`
+ * @returns 0, or the first nonzero value returned by `report`; -1 if a
+ * good-suffix table cannot be allocated
+ */
+int string_search(const uint8_t *text, size_t n, const uint8_t *pattern,
+                  size_t m, match_callback report, void *user)
+{
+    if (m < SHORT_PATTERN)
+    {
+        return horspool_find(text, n, pattern, m, report, user);
+    }
+    uint8_t seen[NUM_OF_CHARS] = {0};
+    size_t distinct = 0;
+    for (size_t i = 0; i < m && distinct <= SMALL_ALPHABET; i++)
+    {
+        distinct += !seen[pattern[i]];
+        seen[pattern[i]] = 1;
+    }
+    if (distinct > SMALL_ALPHABET)
+    {
+        return horspool_find(text, n, pattern, m, report, user);
+    }
+    if (m <= GOOD_SUFFIX_MAX_LENGTH)
+    {
+        return boyer_moore_find(text, n, pattern, m, report, user);
+    }
+    return two_way_find(text, n, pattern, m, report, user);
+}
+
+/**
+ * @brief ::match_callback printing the match like the original search
+ * @param offset offset of the match
+ * @param user unused
+ * @returns 0
+ */
+static int print_match(size_t offset, void *user)
+{
+    (void)user;
+    printf("--Pattern is found at: %zu\n", offset);
+    return 0;
+}
+
 /* Boyer Moore Search algorithm  */
 void boyer_moore_search(char *str, char *pattern)
 {
-    int n = strlen(str);
-    int m = strlen(pattern);
-    int shift = 0;
-    int arr[NUM_OF_CHARS];
+    boyer_moore_find((const uint8_t *)str, strlen(str),
+                     (const uint8_t *)pattern, strlen(pattern), print_match,
+                     NULL);
+}
+
+/** signature shared by the searches */
+typedef int (*search_function)(const uint8_t *text, size_t n,
+                               const uint8_t *pattern, size_t m,
+                               match_callback report, void *user);
+
+/** the searches, for the tests and the benchmark */
+static const struct
+{
+    const char *name;
+    search_function find;
+} searches[] = {{"boyer_moore", boyer_moore_find},
+                {"horspool", horspool_find},
+                {"two_way", two_way_find},
+                {"string_search", string_search}};
+
+/** number of entries of ::searches */
+#define NUM_SEARCHES (sizeof(searches) / sizeof(searches[0]))
+
+/** offsets collected by ::collect */
+typedef struct
+{
+    size_t *items;
+    size_t count, capacity;
+} offset_list;
+
+/**
+ * @brief ::match_callback appending the offset to an ::offset_list
+ * @param offset offset of the match
+ * @param user the ::offset_list
+ * @returns 0
+ */
+static int collect(size_t offset, void *user)
+{
+    offset_list *list = user;
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? 2 * list->capacity : 64;
+        list->items = realloc(list->items, list->capacity * sizeof(size_t));
+        assert(list->items);
+    }
+    list->items[list->count++] = offset;
+    return 0;
+}
+
+/**
+ * @brief ::match_callback counting the matches in a `size_t`
+ * @param offset offset of the match
+ * @param user the counter
+ * @returns 0
+ */
+static int count_match(size_t offset, void *user)
+{
+    (void)offset;
+    ++*(size_t *)user;
+    return 0;
+}
+
+/**
+ * @brief checks every search against a naive one
+ * @param t text
+ * @param n length of the text
+ * @param p pattern
+ * @param m length of the pattern
+ * @returns void
+ */
+static void test_search(const uint8_t *t, size_t n, const uint8_t *p, size_t m)
+{
+    offset_list expected = {0};
+    for (size_t i = 0; m > 0 && i + m <= n; i++)
+    {
+        if (memcmp(t + i, p, m) == 0)
+        {
+            collect(i, &expected);
+        }
+    }
+    for (size_t s = 0; s < NUM_SEARCHES; s++)
+    {
+        offset_list found = {0};
+        assert(searches[s].find(t, n, p, m, collect, &found) == 0);
+        assert(found.count == expected.count);
+        for (size_t i = 0; i < found.count; i++)
+        {
+            assert(found.items[i] == expected.items[i]);
+        }
+        free(found.items);
+    }
+    free(expected.items);
+}
+
+/**
+ * @brief Self-test implementations
+ * @returns void
+ */
+static void test()
+{
+    const uint8_t *text = (const uint8_t *)"AABCAB12AFAABCABFFEGABCAB";
+    test_search(text, 25, (const uint8_t *)"ABCAB", 5);
+    test_search(text, 25, (const uint8_t *)"FFF", 3);
+    test_search(text, 25, (const uint8_t *)"", 0);
+
+    /* bytes above 127, which a signed char index would take as negative */
+    const uint8_t high[] = {0xE9, 0x80, 0xFF, 0xE9, 0x80, 0xFF, 0x00, 0xE9};
+    test_search(high, 8, high, 2);
+    test_search(high, 8, high + 1, 5);
 
-    computeArray(pattern, m, arr);
-    while (shift <= (n - m))
+    /* periodic patterns and texts over tiny alphabets, with NULs */
+    uint8_t t[400], p[64];
+    for (int round = 0; round < 3000; round++)
     {
-        int j = m - 1;
-        while (j >= 0 && pattern[j] == str[shift + j]) j--;
-        if (j < 0)
+        size_t n = (size_t)rand() % sizeof(t);
+        size_t m = 1 + (size_t)rand() % 60;
+        int alphabet = 1 + rand() % 3;
+        size_t period = 1 + (size_t)rand() % 5;
+        for (size_t i = 0; i < n; i++)
+        {
+            t[i] = (uint8_t)(rand() % alphabet * 0x7F);  // 0x00, 0x7F, 0xFE
+        }
+        for (size_t i = 0; i < m; i++)
         {
-            printf("--Pattern is found at: %d\n", shift);
-            shift += (shift + m < n) ? m - arr[str[shift + m]] : 1;
+            p[i] = i < period || rand() % 8 == 0
+                       ? (uint8_t)(rand() % alphabet * 0x7F)
+                       : p[i - period];
+        }
+        if (n >= m && rand() % 4 == 0)
+        {
+            memcpy(t + (size_t)rand() % (n - m + 1), p, m);
+        }
+        test_search(t, n, p, m);
+    }
+    printf("All tests passed\n\n");
+}
+
+/** @returns seconds elapsed since start */
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * @brief fills a corpus for the benchmark
+ * @param text buffer of `n` bytes
+ * @param n size of the corpus
+ * @param kind 0 for DNA, 1 for English words, 2 for random bytes
+ * @returns void
+ */
+static void make_corpus(uint8_t *text, size_t n, int kind)
+{
+    static const char *const words[] = {
+        "the", "of", "and", "to", "in", "a", "is", "that", "for", "it",
+        "as", "was", "with", "be", "by", "on", "not", "he", "this", "are",
+        "or", "his", "from", "at", "which", "but", "have", "an", "had",
+        "they", "you", "were", "their", "one", "all", "we", "can", "her"};
+    size_t i = 0;
+    while (i < n)
+    {
+        if (kind == 0)
+        {
+            text[i++] = (uint8_t) "ACGT"[rand() % 4];
+        }
+        else if (kind == 1)
+        {
+            const char *word = words[rand() % 38];
+            for (size_t j = 0; word[j] && i < n; j++)
+            {
+                text[i++] = (uint8_t)word[j];
+            }
+            if (i < n)
+            {
+                text[i++] = rand() % 10 ? ' ' : '\n';
+            }
         }
         else
         {
-            shift += max(1, j - arr[str[shift + j]]);
+            text[i++] = (uint8_t)rand();
         }
     }
 }
 
-int main()
+/**
+ * @brief times every search on one corpus, with patterns taken from it
+ * @param text the corpus
+ * @param n its size
+ * @param name name of the corpus
+ * @returns void
+ */
+static void bench_corpus(const uint8_t *text, size_t n, const char *name)
 {
+    static const size_t lengths[] = {4, 8, 16, 64, 256};
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+    {
+        size_t m = lengths[l];
+        const uint8_t *pattern = text + (n / 2) % (n - m);
+        printf("%-8s %4zu", name, m);
+        for (size_t s = 0; s < NUM_SEARCHES; s++)
+        {
+            size_t found = 0;
+            clock_t start = clock();
+            searches[s].find(text, n, pattern, m, count_match, &found);
+            printf(" %9.0f", n / 1e6 / seconds_since(start));
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * @brief Main function
+ * @param argc number of arguments
+ * @param argv megabytes per corpus, optional
+ * @returns 0 on exit
+ */
+int main(int argc, char *argv[])
+{
+    srand((unsigned)time(NULL));
+    test();
+
     char str[] = "AABCAB12AFAABCABFFEGABCAB";
     char pat1[] = "ABCAB";
     char pat2[] = "FFF"; /* not found */
@@ -52,5 +674,26 @@ int main()
     boyer_moore_search(str, pat2);
     printf("Test3: search pattern %s\n", pat3);
     boyer_moore_search(str, pat3);
+
+    size_t n = (argc > 1 ? strtoul(argv[1], NULL, 0) : 32) << 20;
+    uint8_t *text = malloc(n);
+    if (n < 1024 || !text)
+    {
+        printf("Can't Malloc! Please try again.");
+        return 1;
+    }
+    printf("\nMB/s on %zu MB\ncorpus      m", n >> 20);
+    for (size_t s = 0; s < NUM_SEARCHES; s++)
+    {
+        printf(" %9.9s", searches[s].name);
+    }
+    printf("\n");
+    static const char *const corpora[] = {"DNA", "English", "binary"};
+    for (int kind = 0; kind < 3; kind++)
+    {
+        make_corpus(text, n, kind);
+        bench_corpus(text, n, corpora[kind]);
+    }
+    free(text);
     return 0;
 }
@@ -1,5 +1,44 @@
-#include <stdio.h>
-#include <string.h>
+/**
+ * @file
+ * @brief [Rabin–Karp](https://en.wikipedia.org/wiki/Rabin%E2%80%93Karp_algorithm)
+ * search, for one pattern or for many patterns of the same length at once
+ *
+ * rabin_karp_search() is the textbook version: an `int` hash modulo a small
+ * prime `q`, so with `q = 29` about one window in 29 has the hash of the
+ * pattern and is compared byte by byte, and every pattern needs its own
+ * pass over the text.
+ *
+ * rk_compile() and rk_find_all() search for any number of patterns of one
+ * length `m` in a single pass, e.g. to find which content blocks of a set
+ * reappear in a file. Windows are hashed as polynomials in a random base
+ * modulo the Mersenne prime 2^61 - 1, where reducing a 122-bit product is
+ * two shifts and adds. Two different windows share a hash with probability
+ * about m / 2^61, so nearly every candidate is a real match. The hashes of
+ * the patterns are kept in an open-addressing hash set; a bitmap of
+ * ::RK_FILTER_BITS_PER_PATTERN bits per pattern in front of it, small
+ * enough to stay in cache, rejects most windows without probing the set.
+ * Candidates are verified 16 bytes at a time with SSE2 on x86-64.
+ *
+ * usage: ./rabin_karp_search [number of blocks] [megabytes of text]
+ * runs the self tests and the original examples, then finds that many
+ * 64-byte blocks (default 10000), half of them taken from the text, in
+ * random data (default 64 MB).
+ */
+#include <assert.h>  /// for assert
+#include <stdint.h>  /// for fixed-width integer types
+#include <stdio.h>   /// for IO
+#include <stdlib.h>  /// for malloc, calloc and free
+#include <string.h>  /// for memcmp and strlen
+#include <time.h>    /// for clock
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define RK_SIMD 1  ///< candidates are verified with SSE2
+#include <emmintrin.h>
+#endif
+
+#define RK_PRIME ((UINT64_C(1) << 61) - 1)  ///< modulus of the rolling hash
+#define RK_NONE UINT32_MAX                 ///< empty slot or no pattern
+#define RK_FILTER_BITS_PER_PATTERN 16      ///< size of the prefilter bitmap
 
 /* Kabin-Karp algorithm for pattern searching
    d: radix-d notation. Ex. number from 0->9, d = 10
@@ -46,8 +85,457 @@ void rabin_karp_search(char *str, char *pattern, int d, int q)
     }
 }
 
-int main()
+/**
+ * @brief receives a match
+ * @param pattern number of the pattern in the array given to rk_compile()
+ * @param offset offset of the match in the text
+ * @param user pointer given to rk_find_all()
+ * @returns 0 to go on, anything else to stop rk_find_all(), which returns it
+ */
+typedef int (*rk_callback)(uint32_t pattern, size_t offset, void *user);
+
+/** compiled set of patterns of one length, see rk_compile() */
+typedef struct
+{
+    size_t length;        ///< length of every pattern
+    uint32_t count;       ///< number of patterns
+    const uint8_t **patterns;
+    uint64_t base;        ///< base of the polynomial hash
+    uint64_t top;         ///< base^(length - 1), weight of the oldest byte
+    uint64_t remove[256]; ///< minus the term of every byte leaving a window
+    uint64_t mask;        ///< slots of the hash set minus one
+    uint64_t *hashes;     ///< hash set: hash in every used slot
+    uint32_t *first;      ///< hash set: first pattern of every slot
+    uint32_t *next_same;  ///< next pattern with the same hash, or RK_NONE
+    uint64_t *filter;     ///< bitmap of the low hash bits of the patterns
+    uint64_t filter_mask; ///< bits of the bitmap minus one
+} rk_set;
+
+/**
+ * @brief product of two residues modulo 2^61 - 1
+ * @param a residue below 2^61 - 1
+ * @param b residue below 2^61 - 1
+ * @returns a * b mod 2^61 - 1
+ */
+static inline uint64_t mul_mod61(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 product = (unsigned __int128)a * b;
+    uint64_t lo = (uint64_t)product & RK_PRIME;
+    uint64_t hi = (uint64_t)(product >> 61);
+#else
+    /* 2^64 = 8 mod 2^61 - 1: multiply 32-bit halves and fold */
+    uint64_t a_hi = a >> 32, a_lo = (uint32_t)a;
+    uint64_t b_hi = b >> 32, b_lo = (uint32_t)b;
+    uint64_t mid = a_hi * b_lo + a_lo * b_hi;  // below 2^62
+    uint64_t lo_product = a_lo * b_lo;
+    uint64_t lo = (lo_product & RK_PRIME) + ((mid << 32) & RK_PRIME);
+    uint64_t hi = (lo_product >> 61) + (mid >> 29) + ((a_hi * b_hi) << 3);
+#endif
+    uint64_t r = lo + hi;
+    r = (r & RK_PRIME) + (r >> 61);
+    return r >= RK_PRIME ? r - RK_PRIME : r;
+}
+
+/**
+ * @brief sum of two residues modulo 2^61 - 1
+ * @param a residue
+ * @param b residue
+ * @returns a + b mod 2^61 - 1
+ */
+static inline uint64_t add_mod61(uint64_t a, uint64_t b)
+{
+    uint64_t r = a + b;
+    return r >= RK_PRIME ? r - RK_PRIME : r;
+}
+
+/**
+ * @brief polynomial hash of a block
+ * @param set the set, for its base
+ * @param p first byte
+ * @param m length of the block
+ * @returns the hash
+ */
+static uint64_t rk_hash(const rk_set *set, const uint8_t *p, size_t m)
+{
+    uint64_t h = 0;
+    for (size_t i = 0; i < m; i++)
+    {
+        h = add_mod61(mul_mod61(h, set->base), p[i] + 1);
+    }
+    return h;
+}
+
+/**
+ * @brief compares two blocks
+ * @param a first block
+ * @param b second block
+ * @param m length of the blocks
+ * @returns 1 if they are equal, 0 otherwise
+ */
+static inline int rk_equal(const uint8_t *a, const uint8_t *b, size_t m)
+{
+    size_t i = 0;
+#ifdef RK_SIMD
+    for (; i + 16 <= m; i += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF)
+        {
+            return 0;
+        }
+    }
+#endif
+    return memcmp(a + i, b + i, m - i) == 0;
+}
+
+/**
+ * @brief frees a set of patterns
+ * @param set set from rk_compile(), or NULL
+ * @returns void
+ */
+void rk_free(rk_set *set)
+{
+    if (!set)
+    {
+        return;
+    }
+    free(set->patterns);
+    free(set->hashes);
+    free(set->first);
+    free(set->next_same);
+    free(set->filter);
+    free(set);
+}
+
+/**
+ * @brief compiles patterns of one length into a set
+ * @details The patterns are not copied and must outlive the set.
+ * @param patterns `count` patterns of `m` bytes each, any bytes
+ * @param count number of patterns
+ * @param m length of every pattern, at least 1
+ * @param seed picks the base of the hash; any value works
+ * @returns the set, to be freed by rk_free(), or NULL if `m` is 0 or memory
+ * runs out
+ */
+rk_set *rk_compile(const void *const *patterns, uint32_t count, size_t m,
+                   uint64_t seed)
 {
+    if (m == 0)
+    {
+        return NULL;
+    }
+    rk_set *set = calloc(1, sizeof(rk_set));
+    if (!set)
+    {
+        return NULL;
+    }
+    set->length = m;
+    set->count = count;
+
+    /* a base in [256, 2^61 - 2] from the seed, by splitmix64 */
+    uint64_t z = seed + UINT64_C(0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    z ^= z >> 31;
+    set->base = 256 + z % (RK_PRIME - 257);
+    set->top = 1;
+    for (size_t i = 1; i < m; i++)
+    {
+        set->top = mul_mod61(set->top, set->base);
+    }
+    for (int c = 0; c < 256; c++)
+    {
+        set->remove[c] = mul_mod61(RK_PRIME - set->top, (uint64_t)c + 1);
+    }
+
+    /* at most half of the slots used */
+    uint64_t slots = 16, bits = 4096;
+    while (slots < 2 * (uint64_t)count)
+    {
+        slots *= 2;
+    }
+    while (bits < RK_FILTER_BITS_PER_PATTERN * (uint64_t)count)
+    {
+        bits *= 2;
+    }
+    set->mask = slots - 1;
+    set->filter_mask = bits - 1;
+    set->patterns = malloc((count ? count : 1) * sizeof(uint8_t *));
+    set->hashes = malloc(slots * sizeof(uint64_t));
+    set->first = malloc(slots * sizeof(uint32_t));
+    set->next_same = malloc((count ? count : 1) * sizeof(uint32_t));
+    set->filter = calloc(bits / 64, sizeof(uint64_t));
+    if (!set->patterns || !set->hashes || !set->first || !set->next_same ||
+        !set->filter)
+    {
+        rk_free(set);
+        return NULL;
+    }
+    for (uint64_t s = 0; s < slots; s++)
+    {
+        set->first[s] = RK_NONE;
+    }
+
+    for (uint32_t p = 0; p < count; p++)
+    {
+        set->patterns[p] = patterns[p];
+        uint64_t h = rk_hash(set, set->patterns[p], m);
+        set->filter[(h & set->filter_mask) >> 6] |= UINT64_C(1) << (h & 63);
+        /* the bits above the filter's pick the slot */
+        uint64_t s = (h >> 20) & set->mask;
+        while (set->first[s] != RK_NONE && set->hashes[s] != h)
+        {
+            s = (s + 1) & set->mask;
+        }
+        /* patterns of one hash are chained, the first one listed first */
+        set->next_same[p] = RK_NONE;
+        if (set->first[s] == RK_NONE)
+        {
+            set->hashes[s] = h;
+            set->first[s] = p;
+        }
+        else
+        {
+            uint32_t q = set->first[s];
+            while (set->next_same[q] != RK_NONE)
+            {
+                q = set->next_same[q];
+            }
+            set->next_same[q] = p;
+        }
+    }
+    return set;
+}
+
+/**
+ * @brief checks the window at `offset` against the patterns of its hash
+ * @param set the set
+ * @param text the text
+ * @param offset offset of the window
+ * @param h hash of the window
+ * @param report callback
+ * @param user passed to the callback
+ * @returns 0, or the first nonzero value returned by the callback
+ */
+static int rk_check(const rk_set *set, const uint8_t *text, size_t offset,
+                    uint64_t h, rk_callback report, void *user)
+{
+    uint64_t s = (h >> 20) & set->mask;
+    for (; set->first[s] != RK_NONE; s = (s + 1) & set->mask)
+    {
+        if (set->hashes[s] != h)
+        {
+            continue;
+        }
+        for (uint32_t p = set->first[s]; p != RK_NONE; p = set->next_same[p])
+        {
+            if (rk_equal(text + offset, set->patterns[p], set->length))
+            {
+                int stop = report(p, offset, user);
+                if (stop)
+                {
+                    return stop;
+                }
+            }
+        }
+        break;
+    }
+    return 0;
+}
+
+/**
+ * @brief reports every occurrence of every pattern of a set in a text
+ * @param set set from rk_compile()
+ * @param text the text, any bytes
+ * @param n length of the text
+ * @param report called for every match, by increasing offset
+ * @param user passed to `report`
+ * @returns 0, or the first nonzero value returned by `report`
+ */
+int rk_find_all(const rk_set *set, const void *text, size_t n,
+                rk_callback report, void *user)
+{
+    const uint8_t *t = text;
+    const size_t m = set->length;
+    if (m > n || set->count == 0)
+    {
+        return 0;
+    }
+    uint64_t h = rk_hash(set, t, m);
+    for (size_t i = 0;; i++)
+    {
+        if (set->filter[(h & set->filter_mask) >> 6] >> (h & 63) & 1)
+        {
+            int stop = rk_check(set, t, i, h, report, user);
+            if (stop)
+            {
+                return stop;
+            }
+        }
+        if (i + m >= n)
+        {
+            return 0;
+        }
+        h = add_mod61(h, set->remove[t[i]]);
+        h = add_mod61(mul_mod61(h, set->base), t[i + m] + 1);
+    }
+}
+
+/** one match, as collected by the tests */
+typedef struct
+{
+    uint32_t pattern;
+    size_t offset;
+} match;
+
+/** matches collected by ::collect */
+typedef struct
+{
+    match *items;
+    size_t count, capacity;
+} match_list;
+
+/**
+ * @brief ::rk_callback appending the match to a ::match_list
+ * @param pattern number of the pattern
+ * @param offset offset of the match
+ * @param user the ::match_list
+ * @returns 0
+ */
+static int collect(uint32_t pattern, size_t offset, void *user)
+{
+    match_list *list = user;
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? 2 * list->capacity : 64;
+        list->items = realloc(list->items, list->capacity * sizeof(match));
+        assert(list->items);
+    }
+    list->items[list->count].pattern = pattern;
+    list->items[list->count].offset = offset;
+    list->count++;
+    return 0;
+}
+
+/**
+ * @brief ::rk_callback counting the matches in a `size_t`
+ * @param pattern number of the pattern
+ * @param offset offset of the match
+ * @param user the counter
+ * @returns 0
+ */
+static int count_match(uint32_t pattern, size_t offset, void *user)
+{
+    (void)pattern;
+    (void)offset;
+    ++*(size_t *)user;
+    return 0;
+}
+
+/**
+ * @brief checks rk_find_all() against a naive search
+ * @param patterns the patterns
+ * @param count number of patterns
+ * @param m length of every pattern
+ * @param t text
+ * @param n length of the text
+ * @returns void
+ */
+static void test_search(const uint8_t *const *patterns, uint32_t count,
+                        size_t m, const uint8_t *t, size_t n)
+{
+    match_list expected = {0}, found = {0};
+    for (size_t i = 0; i + m <= n; i++)
+    {
+        for (uint32_t p = 0; p < count; p++)
+        {
+            if (memcmp(t + i, patterns[p], m) == 0)
+            {
+                collect(p, i, &expected);
+            }
+        }
+    }
+    rk_set *set = rk_compile((const void *const *)patterns, count, m,
+                             (uint64_t)rand());
+    assert(set);
+    assert(rk_find_all(set, t, n, collect, &found) == 0);
+    assert(found.count == expected.count);
+    for (size_t i = 0; i < found.count; i++)
+    {
+        assert(found.items[i].pattern == expected.items[i].pattern);
+        assert(found.items[i].offset == expected.items[i].offset);
+    }
+    rk_free(set);
+    free(expected.items);
+    free(found.items);
+}
+
+/**
+ * @brief Self-test implementations
+ * @returns void
+ */
+static void test()
+{
+    /* the modular product against exact arithmetic on small values */
+    assert(mul_mod61(RK_PRIME - 1, RK_PRIME - 1) == 1);  // (-1)^2
+    assert(mul_mod61(UINT64_C(1) << 60, 2) == 1);         // 2^61 = 1
+    assert(mul_mod61(123456789, 987654321) == UINT64_C(121932631112635269));
+
+    const uint8_t *text = (const uint8_t *)"AABCAB12AFAABCABFFEGABCAB";
+    const uint8_t *words[] = {(const uint8_t *)"ABCAB",
+                              (const uint8_t *)"FFEGA",
+                              (const uint8_t *)"ABCAB",
+                              (const uint8_t *)"ZZZZZ"};
+    test_search(words, 4, 5, text, 25);
+    test_search(words, 0, 5, text, 25);
+    test_search(words, 4, 5, text, 3);
+
+    /* many blocks over a small alphabet with NULs, so they overlap */
+    uint8_t t[600], blocks[200][20];
+    const uint8_t *patterns[200];
+    for (int round = 0; round < 200; round++)
+    {
+        size_t n = (size_t)rand() % sizeof(t);
+        size_t m = 1 + (size_t)rand() % 20;
+        uint32_t count = 1 + (uint32_t)(rand() % 200);
+        for (size_t i = 0; i < n; i++)
+        {
+            t[i] = (uint8_t)(rand() % 3 * 0x7F);  // 0x00, 0x7F, 0xFE
+        }
+        for (uint32_t p = 0; p < count; p++)
+        {
+            for (size_t i = 0; i < m; i++)
+            {
+                blocks[p][i] = n >= m && rand() % 2
+                                   ? t[(size_t)rand() % (n - m + 1) + i]
+                                   : (uint8_t)(rand() % 3 * 0x7F);
+            }
+            patterns[p] = blocks[p];
+        }
+        test_search(patterns, count, m, t, n);
+    }
+    printf("All tests passed\n\n");
+}
+
+/** @returns seconds elapsed since start */
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * @brief Main function
+ * @param argc number of arguments
+ * @param argv number of blocks and megabytes of text, both optional
+ * @returns 0 on exit
+ */
+int main(int argc, char *argv[])
+{
+    srand((unsigned)time(NULL));
+    test();
+
     char str[] = "AABCAB12AFAABCABFFEGABCAB";
     char pat1[] = "ABCAB";
     char pat2[] = "FFF"; /* not found */
@@ -60,5 +548,78 @@ int main()
     rabin_karp_search(str, pat2, 256, 29);
     printf("Test3: search pattern %s\n", pat3);
     rabin_karp_search(str, pat3, 256, 29);
+
+    const size_t m = 64;
+    uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 10000;
+    size_t n = (argc > 2 ? strtoul(argv[2], NULL, 0) : 64) << 20;
+    uint8_t *text = malloc(n), *blocks = malloc((size_t)count * m);
+    const uint8_t **patterns = malloc((count ? count : 1) * sizeof(uint8_t *));
+    if (n < m || !text || !blocks || !patterns)
+    {
+        printf("Can't Malloc! Please try again.");
+        return 1;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        text[i] = (uint8_t)rand();
+    }
+    for (uint32_t p = 0; p < count; p++)
+    {
+        uint8_t *block = blocks + (size_t)p * m;
+        if (p % 2)
+        {
+            memcpy(block, text + (size_t)rand() * 7919 % (n - m + 1), m);
+        }
+        else
+        {
+            for (size_t i = 0; i < m; i++) block[i] = (uint8_t)rand();
+        }
+        patterns[p] = block;
+    }
+
+    printf("\n%u blocks of %zu bytes in %zu MB\n", count, m, n >> 20);
+    clock_t start = clock();
+    rk_set *set = rk_compile((const void *const *)patterns, count, m, 1);
+    if (!set)
+    {
+        printf("Can't Malloc! Please try again.");
+        return 1;
+    }
+    double build = seconds_since(start);
+    size_t found = 0;
+    start = clock();
+    rk_find_all(set, text, n, count_match, &found);
+    double seconds = seconds_since(start);
+    printf("%-28s %8.3f s %8.1f MB/s %8zu matches (built in %.3f s)\n",
+           "rk_find_all, all blocks", seconds, n / 1e6 / seconds, found,
+           build);
+    rk_free(set);
+
+    /* the same blocks one pass each, stopped after a few seconds */
+    found = 0;
+    uint32_t done = 0;
+    start = clock();
+    for (; done < count && seconds_since(start) < 5; done++)
+    {
+        rk_set *one = rk_compile((const void *const *)&patterns[done], 1, m,
+                                 1);
+        if (one)
+        {
+            rk_find_all(one, text, n, count_match, &found);
+        }
+        rk_free(one);
+    }
+    seconds = seconds_since(start) * count / done;
+    printf("%-28s %8.3f s %8.1f MB/s %8zu matches",
+           "rk_find_all, one per block", seconds, n / 1e6 / seconds, found);
+    if (done < count)
+    {
+        printf(" (%u blocks searched, time extrapolated)", done);
+    }
+    printf("\n");
+
+    free(text);
+    free(blocks);
+    free(patterns);
     return 0;
 }
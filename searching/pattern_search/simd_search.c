@@ -0,0 +1,557 @@
+/**
+ * @file
+ * @brief Substring search filtering 16 or 32 positions at once by the first
+ * and last byte of the pattern, with SSE2 and AVX2
+ *
+ * find_all() reports every offset at which a pattern of `m` bytes occurs in
+ * a text of `n` bytes. Both are byte arrays with lengths, so binary data and
+ * NUL bytes are searched like any other; matches are passed to a callback
+ * instead of being printed as in naive_search.c.
+ *
+ * The search is the "generic SIMD" filter of Wojciech Muła: one register
+ * holds the text at positions `i .. i + 31`, another at positions
+ * `i + m - 1 .. i + m + 30`. Comparing the first against the first byte of
+ * the pattern and the second against its last byte, and combining both,
+ * gives a 32-bit mask of the positions where both ends match. Only those
+ * candidates are compared in full with memcmp(). On most texts a pair of
+ * bytes rarely matches by chance, so nearly all the work is two loads, two
+ * compares and an `and` per 32 positions. The AVX2 kernel is chosen at run
+ * time as in hash_batch.h, SSE2 handles 16 positions on any x86-64, and
+ * other processors and the last positions of the text use a scalar loop
+ * built on memchr().
+ *
+ * usage: ./simd_search [file] [pattern]
+ * runs the self tests, then searches a file, or 256 MB of random English
+ * text, for a pattern and times every kernel against memmem(), when the C
+ * library has it, and a naive search.
+ */
+#define _GNU_SOURCE  /// for memmem
+#include <assert.h>  /// for assert
+#include <stdint.h>  /// for fixed-width integer types
+#include <stdio.h>   /// for IO
+#include <stdlib.h>  /// for malloc and free
+#include <string.h>  /// for memchr, memcmp and memmem
+#include <time.h>    /// for clock
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FIND_SIMD 1  ///< the SSE2 and AVX2 kernels are compiled in
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define FIND_TARGET_AVX2
+#else
+/** enables AVX2 code generation for a single function */
+#define FIND_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+/**
+ * @brief receives a match
+ * @param offset offset of the match in the text
+ * @param user pointer given to find_all()
+ * @returns 0 to go on, anything else to stop find_all(), which returns it
+ */
+typedef int (*find_callback)(size_t offset, void *user);
+
+/** kernels of find_all(), for the tests and the benchmark */
+typedef enum
+{
+    FIND_AUTO,    ///< the fastest kernel of the processor
+    FIND_SCALAR,  ///< memchr() on the first byte, then memcmp()
+    FIND_SSE2,    ///< 16 positions per step
+    FIND_AVX2     ///< 32 positions per step
+} find_kernel;
+
+/**
+ * @brief scalar search of the positions `from .. n - m`
+ * @param t text
+ * @param n length of the text
+ * @param p pattern
+ * @param m length of the pattern, at least 1
+ * @param from first position to try
+ * @param report callback
+ * @param user passed to the callback
+ * @returns 0, or the first nonzero value returned by the callback
+ */
+static int find_scalar(const uint8_t *t, size_t n, const uint8_t *p, size_t m,
+                       size_t from, find_callback report, void *user)
+{
+    const uint8_t *end = t + n - m + 1;  // one past the last start
+    const uint8_t *s = t + from;
+    while (s < end && (s = memchr(s, p[0], (size_t)(end - s))) != NULL)
+    {
+        if (s[m - 1] == p[m - 1] && memcmp(s + 1, p + 1, m - 1) == 0)
+        {
+            int stop = report((size_t)(s - t), user);
+            if (stop)
+            {
+                return stop;
+            }
+        }
+        s++;
+    }
+    return 0;
+}
+
+#ifdef FIND_SIMD
+/**
+ * @brief index of the lowest set bit
+ * @param mask a nonzero mask
+ * @returns the index
+ */
+static inline size_t lowest_bit(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, mask);
+    return i;
+#else
+    return (size_t)__builtin_ctz(mask);
+#endif
+}
+
+/**
+ * @brief verifies the candidates of a mask and reports the matches
+ * @param t text
+ * @param i position of bit 0 of the mask
+ * @param mask candidates, bit `k` for position `i + k`
+ * @param p pattern
+ * @param m length of the pattern, at least 2
+ * @param report callback
+ * @param user passed to the callback
+ * @returns 0, or the first nonzero value returned by the callback
+ */
+static inline int find_candidates(const uint8_t *t, size_t i, uint32_t mask,
+                                  const uint8_t *p, size_t m,
+                                  find_callback report, void *user)
+{
+    while (mask)
+    {
+        size_t pos = i + lowest_bit(mask);
+        if (memcmp(t + pos + 1, p + 1, m - 2) == 0)
+        {
+            int stop = report(pos, user);
+            if (stop)
+            {
+                return stop;
+            }
+        }
+        mask &= mask - 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief checks whether the processor and OS support AVX2
+ * @returns 1 if the AVX2 kernel may be used, 0 otherwise
+ */
+static int find_cpu_has_avx2(void)
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+    {
+        return 0;
+    }
+    __cpuid(regs, 1);
+    /* bit 27: OSXSAVE, bit 28: AVX */
+    if ((regs[2] & (3 << 27)) != (3 << 27) || (_xgetbv(0) & 6) != 6)
+    {
+        return 0;
+    }
+    __cpuidex(regs, 7, 0);
+    return (regs[1] >> 5) & 1;
+#else
+    static int avx2 = -1;
+    if (avx2 < 0)
+    {
+        avx2 = __builtin_cpu_supports("avx2") != 0;
+    }
+    return avx2;
+#endif
+}
+
+/**
+ * @brief SSE2 search of the positions `0 .. n - m`, 16 at a time
+ * @param t text
+ * @param n length of the text
+ * @param p pattern
+ * @param m length of the pattern, at least 2
+ * @param report callback
+ * @param user passed to the callback
+ * @param done set to the first position not searched
+ * @returns 0, or the first nonzero value returned by the callback
+ */
+static int find_sse2(const uint8_t *t, size_t n, const uint8_t *p, size_t m,
+                     find_callback report, void *user, size_t *done)
+{
+    const __m128i first = _mm_set1_epi8((char)p[0]);
+    const __m128i last = _mm_set1_epi8((char)p[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(t + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(t + i + m - 1));
+        __m128i both = _mm_and_si128(_mm_cmpeq_epi8(a, first),
+                                     _mm_cmpeq_epi8(b, last));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(both);
+        if (mask)
+        {
+            int stop = find_candidates(t, i, mask, p, m, report, user);
+            if (stop)
+            {
+                return stop;
+            }
+        }
+    }
+    *done = i;
+    return 0;
+}
+
+/**
+ * @brief AVX2 search of the positions `0 .. n - m`, 32 at a time
+ * @param t text
+ * @param n length of the text
+ * @param p pattern
+ * @param m length of the pattern, at least 2
+ * @param report callback
+ * @param user passed to the callback
+ * @param done set to the first position not searched
+ * @returns 0, or the first nonzero value returned by the callback
+ */
+FIND_TARGET_AVX2
+static int find_avx2(const uint8_t *t, size_t n, const uint8_t *p, size_t m,
+                     find_callback report, void *user, size_t *done)
+{
+    const __m256i first = _mm256_set1_epi8((char)p[0]);
+    const __m256i last = _mm256_set1_epi8((char)p[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 32 <= n; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(t + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(t + i + m - 1));
+        __m256i both = _mm256_and_si256(_mm256_cmpeq_epi8(a, first),
+                                        _mm256_cmpeq_epi8(b, last));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(both);
+        if (mask)
+        {
+            int stop = find_candidates(t, i, mask, p, m, report, user);
+            if (stop)
+            {
+                return stop;
+            }
+        }
+    }
+    *done = i;
+    return 0;
+}
+#endif
+
+/**
+ * @brief reports every occurrence of a pattern in a text, with a chosen
+ * kernel
+ * @param text text to search
+ * @param n length of the text
+ * @param pattern pattern to find
+ * @param m length of the pattern; an empty pattern matches nowhere
+ * @param report called with the offset of every match, in increasing order
+ * @param user passed to `report`
+ * @param kernel kernel to use; one the processor lacks falls back to the
+ * next slower one
+ * @returns 0, or the first nonzero value returned by `report`
+ */
+int find_all_with(const void *text, size_t n, const void *pattern, size_t m,
+                  find_callback report, void *user, find_kernel kernel)
+{
+    const uint8_t *t = text, *p = pattern;
+    size_t done = 0;
+    if (m == 0 || m > n)
+    {
+        return 0;
+    }
+#ifdef FIND_SIMD
+    if (m >= 2 && kernel != FIND_SCALAR)
+    {
+        int stop;
+        if (kernel != FIND_SSE2 && find_cpu_has_avx2())
+        {
+            stop = find_avx2(t, n, p, m, report, user, &done);
+        }
+        else
+        {
+            stop = find_sse2(t, n, p, m, report, user, &done);
+        }
+        if (stop)
+        {
+            return stop;
+        }
+    }
+#else
+    (void)kernel;
+#endif
+    return find_scalar(t, n, p, m, done, report, user);
+}
+
+/**
+ * @brief reports every occurrence of a pattern in a text
+ * @param text text to search, which may hold any bytes
+ * @param n length of the text
+ * @param pattern pattern to find
+ * @param m length of the pattern; an empty pattern matches nowhere
+ * @param report called with the offset of every match, in increasing order;
+ * overlapping matches are all reported
+ * @param user passed to `report`
+ * @returns 0, or the first nonzero value returned by `report`
+ */
+int find_all(const void *text, size_t n, const void *pattern, size_t m,
+             find_callback report, void *user)
+{
+    return find_all_with(text, n, pattern, m, report, user, FIND_AUTO);
+}
+
+/** offsets collected by ::collect */
+typedef struct
+{
+    size_t *items;
+    size_t count, capacity;
+} offset_list;
+
+/**
+ * @brief ::find_callback appending the offset to an ::offset_list
+ * @param offset offset of the match
+ * @param user the ::offset_list
+ * @returns 0
+ */
+static int collect(size_t offset, void *user)
+{
+    offset_list *list = user;
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? 2 * list->capacity : 64;
+        list->items = realloc(list->items, list->capacity * sizeof(size_t));
+        assert(list->items);
+    }
+    list->items[list->count++] = offset;
+    return 0;
+}
+
+/**
+ * @brief ::find_callback counting the matches in a `size_t`
+ * @param offset offset of the match
+ * @param user the counter
+ * @returns 0
+ */
+static int count_match(size_t offset, void *user)
+{
+    (void)offset;
+    ++*(size_t *)user;
+    return 0;
+}
+
+/**
+ * @brief ::find_callback stopping at the first match
+ * @param offset offset of the match
+ * @param user receives the offset, as a `size_t`
+ * @returns 1
+ */
+static int stop_at_first(size_t offset, void *user)
+{
+    *(size_t *)user = offset;
+    return 1;
+}
+
+/**
+ * @brief checks every kernel against a naive search
+ * @param t text
+ * @param n length of the text
+ * @param p pattern
+ * @param m length of the pattern
+ * @returns void
+ */
+static void test_search(const uint8_t *t, size_t n, const uint8_t *p, size_t m)
+{
+    offset_list expected = {0};
+    for (size_t i = 0; m > 0 && i + m <= n; i++)
+    {
+        if (memcmp(t + i, p, m) == 0)
+        {
+            collect(i, &expected);
+        }
+    }
+    for (int kernel = FIND_AUTO; kernel <= FIND_AVX2; kernel++)
+    {
+        offset_list found = {0};
+        assert(find_all_with(t, n, p, m, collect, &found,
+                             (find_kernel)kernel) == 0);
+        assert(found.count == expected.count);
+        for (size_t i = 0; i < found.count; i++)
+        {
+            assert(found.items[i] == expected.items[i]);
+        }
+        free(found.items);
+
+        size_t first = SIZE_MAX;
+        int stop = find_all_with(t, n, p, m, stop_at_first, &first,
+                                 (find_kernel)kernel);
+        assert(stop == (expected.count > 0));
+        assert(!stop || first == expected.items[0]);
+    }
+    free(expected.items);
+}
+
+/**
+ * @brief Self-test implementations
+ * @returns void
+ */
+static void test()
+{
+    const char *text = "AABCAB12AFAABCABFFEGABCAB";
+    test_search((const uint8_t *)text, strlen(text), (const uint8_t *)"ABCAB",
+                5);
+    test_search((const uint8_t *)text, strlen(text), (const uint8_t *)"FFF", 3);
+    test_search((const uint8_t *)text, strlen(text), (const uint8_t *)"", 0);
+
+    /* binary text with NULs, over a small alphabet so candidates abound */
+    uint8_t t[300], p[80];
+    for (int round = 0; round < 2000; round++)
+    {
+        size_t n = (size_t)rand() % sizeof(t);
+        size_t m = 1 + (size_t)rand() % 70;
+        int alphabet = 1 + rand() % 4;
+        for (size_t i = 0; i < n; i++)
+        {
+            t[i] = (uint8_t)(rand() % alphabet * 0x55);  // 0x00, 0x55, ...
+        }
+        if (n >= m && rand() % 2)
+        {
+            memcpy(p, t + (size_t)rand() % (n - m + 1), m);
+        }
+        else
+        {
+            for (size_t i = 0; i < m; i++)
+            {
+                p[i] = (uint8_t)(rand() % alphabet * 0x55);
+            }
+        }
+        test_search(t, n, p, m);
+    }
+    printf("All tests passed\n\n");
+}
+
+/** @returns seconds elapsed since start */
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * @brief reads a whole file
+ * @param path path of the file
+ * @param size receives its size
+ * @returns the contents, to be freed, or NULL
+ */
+static uint8_t *read_file(const char *path, size_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *data = NULL;
+    long length;
+    if (f && fseek(f, 0, SEEK_END) == 0 && (length = ftell(f)) >= 0 &&
+        fseek(f, 0, SEEK_SET) == 0 && (data = malloc(length + 1)) != NULL)
+    {
+        *size = fread(data, 1, (size_t)length, f);
+    }
+    if (f)
+    {
+        fclose(f);
+    }
+    return data;
+}
+
+/**
+ * @brief Main function
+ * @param argc number of arguments
+ * @param argv a file and a pattern, both optional
+ * @returns 0 on exit
+ */
+int main(int argc, char *argv[])
+{
+    srand((unsigned)time(NULL));
+    test();
+
+    size_t n = (size_t)256 << 20;
+    uint8_t *text;
+    if (argc > 1)
+    {
+        text = read_file(argv[1], &n);
+    }
+    else if ((text = malloc(n)) != NULL)
+    {
+        static const char *const words[] = {
+            "the", "of", "and", "to", "in", "is", "was", "that", "for",
+            "search", "pattern", "text", "with", "as", "on", "by"};
+        size_t i = 0;
+        while (i < n)
+        {
+            const char *word = words[rand() % 16];
+            for (size_t j = 0; word[j] && i < n; j++)
+            {
+                text[i++] = (uint8_t)word[j];
+            }
+            if (i < n)
+            {
+                text[i++] = ' ';
+            }
+        }
+    }
+    if (!text)
+    {
+        printf("Can't read the text! Please try again.");
+        return 1;
+    }
+    const char *pattern = argc > 2 ? argv[2] : "pattern text with";
+    size_t m = strlen(pattern);
+
+    printf("%zu MB, pattern \"%s\"\n", n >> 20, pattern);
+    static const char *const names[] = {"find_all", "scalar (memchr)", "SSE2",
+                                        "AVX2"};
+    for (int kernel = FIND_AUTO; kernel <= FIND_AVX2 + 2; kernel++)
+    {
+        size_t found = 0;
+        const char *name = kernel <= FIND_AVX2 ? names[kernel] : "naive";
+        clock_t start = clock();
+        if (kernel <= FIND_AVX2)
+        {
+            find_all_with(text, n, pattern, m, count_match, &found,
+                          (find_kernel)kernel);
+        }
+        else if (kernel == FIND_AVX2 + 1)
+        {
+#ifdef __GLIBC__
+            name = "memmem";
+            const uint8_t *s = text, *end = text + n;
+            while ((s = memmem(s, (size_t)(end - s), pattern, m)) != NULL)
+            {
+                found++;
+                s++;
+            }
+#else
+            continue;
+#endif
+        }
+        else
+        {
+            for (size_t i = 0; i + m <= n; i++)
+            {
+                size_t j = 0;
+                while (j < m && text[i + j] == (uint8_t)pattern[j]) j++;
+                found += j == m;
+            }
+        }
+        double seconds = seconds_since(start);
+        printf("%-16s %8.3f s %8.1f MB/s %10zu matches\n", name, seconds,
+               n / 1e6 / seconds, found);
+    }
+    free(text);
+    return 0;
+}
@@ -0,0 +1,1105 @@
+/**
+ * @file
+ * @brief [Suffix array](https://en.wikipedia.org/wiki/Suffix_array) index
+ * of a corpus, for counting and locating any substring without rescanning
+ *
+ * The other searches of this directory read the whole text for every
+ * query. Here the text is indexed once, and each query then costs
+ * O(m + log n) for a pattern of `m` bytes in a text of `n` bytes, whatever
+ * the number of matches.
+ *
+ * - sa_index_build() sorts the suffixes with SA-IS (Nong, Zhang and Chan),
+ *   which runs in linear time. Suffixes are classified as S or L type by
+ *   comparing each with the next one. The leftmost S suffixes of every run
+ *   (LMS) are sorted approximately, and sorting them induces the order of
+ *   all other suffixes in two scans. When the LMS substrings are not all
+ *   different, they are renamed and the reduced string, at most half as
+ *   long, is sorted recursively. A virtual sentinel smaller than every
+ *   byte ends the text, so any byte, NUL included, may occur in it.
+ * - The LCP array, the length of the longest common prefix of every suffix
+ *   with the one before it in sorted order, is computed from the suffix
+ *   array with Kasai's algorithm in linear time.
+ * - The binary search over the suffix array keeps the common prefix of the
+ *   pattern with both ends of the interval (Manber and Myers). For every
+ *   midpoint, the common prefixes of its suffix with the suffixes at both
+ *   ends of the interval that leads to it (LCP-LR) are precomputed from the
+ *   LCP array. Most steps then decide the side without reading the text,
+ *   and no byte of the pattern is compared twice with a match: O(m + log n).
+ *   A plain binary search with memcmp() costs O(m log n) at worst, but both
+ *   miss the cache at about every step, so on ordinary text they run about
+ *   as fast; LCP-LR bounds the cost of long patterns in repetitive text.
+ *
+ * sa_index_save() writes the text and the arrays to one file, and
+ * sa_index_open() maps that file into memory with mmap() where available,
+ * so a service opens an index in constant time, and pages are only read
+ * when queries touch them. Indices are 32-bit, so a text is limited to just
+ * under 4 GiB; the index file takes 17 bytes per text byte.
+ *
+ * usage: ./suffix_array_search [megabytes] [index file]
+ * runs the self tests, then builds the index of random English text
+ * (default 16 MB), saves it, opens it again and times queries with and
+ * without LCP-LR. The index is kept in `index file` if one is given, and
+ * otherwise written to a temporary file that is removed at exit.
+ */
+#define _POSIX_C_SOURCE 200809L  ///< for mkstemp
+#include <assert.h>  /// for assert
+#include <stdint.h>  /// for fixed-width integer types
+#include <stdio.h>   /// for IO
+#include <stdlib.h>  /// for malloc, calloc and free
+#include <string.h>  /// for memcmp, memcpy and memset
+#include <time.h>    /// for clock
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SA_MMAP 1  ///< indices are mapped, not read
+#include <fcntl.h>     /// for open
+#include <sys/mman.h>  /// for mmap and munmap
+#include <sys/stat.h>  /// for fstat
+#include <unistd.h>    /// for close
+#endif
+
+#define SA_EMPTY UINT32_MAX  ///< empty slot of a suffix array being built
+#define SA_MAX_LENGTH (UINT32_MAX - 2)  ///< longest text that can be indexed
+#define SA_ALIGN 64  ///< alignment of the arrays in an index file
+
+/** first bytes of an index file, with a format version */
+static const char sa_magic[8] = {'S', 'A', 'I', 'D', 'X', 0, 0, 1};
+
+/** header of an index file; the arrays follow at the given offsets */
+typedef struct
+{
+    char magic[8];       ///< ::sa_magic
+    uint32_t byte_order; ///< 0x01020304 as written, to detect other machines
+    uint32_t length;     ///< length of the text
+    uint64_t offset[4];  ///< text, suffix array, LCP, LCP-LR
+} sa_file_header;
+
+/** a text with its suffix array, LCP and LCP-LR arrays */
+typedef struct
+{
+    const uint8_t *text;
+    uint32_t n;            ///< length of the text
+    const uint32_t *sa;    ///< start of the i-th smallest suffix
+    const uint32_t *lcp;   ///< common prefix of sa[i - 1] and sa[i]; lcp[0] = 0
+    /** common prefixes of midpoint i with its left end at 2i and with its
+        right end at 2i + 1, so that one cache line holds both */
+    const uint32_t *lcp_lr;
+    void *memory;          ///< what sa_index_close() releases
+    size_t mapped;         ///< size of the mapping, 0 if `memory` is malloc'd
+} sa_index;
+
+/** a string of the SA-IS recursion, bytes at the top level, then names */
+typedef struct
+{
+    const uint8_t *bytes;  ///< the text at the top level, else NULL
+    const uint32_t *names; ///< the reduced string below it
+    uint32_t n;            ///< length, the sentinel included
+} sais_string;
+
+/**
+ * @brief character `i` of a string of the recursion
+ * @details At the top level the bytes are shifted up by one and the virtual
+ * sentinel at `n - 1` is 0; a reduced string ends with its own sentinel.
+ * @param s the string
+ * @param i position
+ * @returns the character
+ */
+static inline uint32_t sais_char(const sais_string *s, uint32_t i)
+{
+    if (s->bytes)
+    {
+        return i == s->n - 1 ? 0 : (uint32_t)s->bytes[i] + 1;
+    }
+    return s->names[i];
+}
+
+/**
+ * @brief the type of suffix `i`, 1 for S (smaller than the next) or 0 for L
+ * @param types bit array
+ * @param i position
+ * @returns the type
+ */
+static inline int sais_type(const uint8_t *types, uint32_t i)
+{
+    return (types[i >> 3] >> (i & 7)) & 1;
+}
+
+/**
+ * @brief whether suffix `i` is a leftmost S suffix
+ * @param types bit array of the types
+ * @param i position
+ * @returns 1 if it is, 0 otherwise
+ */
+static inline int sais_is_lms(const uint8_t *types, uint32_t i)
+{
+    return i > 0 && sais_type(types, i) && !sais_type(types, i - 1);
+}
+
+/**
+ * @brief computes the start or the end of every bucket
+ * @param s the string
+ * @param bucket `k + 1` counters
+ * @param k largest character
+ * @param end 1 for the ends, 0 for the starts
+ * @returns void
+ */
+static void sais_buckets(const sais_string *s, uint32_t *bucket, uint32_t k,
+                         int end)
+{
+    memset(bucket, 0, ((size_t)k + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < s->n; i++)
+    {
+        bucket[sais_char(s, i)]++;
+    }
+    uint32_t sum = 0;
+    for (uint32_t c = 0; c <= k; c++)
+    {
+        sum += bucket[c];
+        bucket[c] = end ? sum : sum - bucket[c];
+    }
+}
+
+/**
+ * @brief induces the order of the L suffixes, then of the S suffixes, from
+ * the sorted LMS suffixes at the ends of their buckets
+ * @param s the string
+ * @param sa the suffix array being built
+ * @param types bit array of the types
+ * @param bucket `k + 1` counters
+ * @param k largest character
+ * @returns void
+ */
+static void sais_induce(const sais_string *s, uint32_t *sa,
+                        const uint8_t *types, uint32_t *bucket, uint32_t k)
+{
+    sais_buckets(s, bucket, k, 0);
+    for (uint32_t i = 0; i < s->n; i++)
+    {
+        uint32_t j = sa[i];
+        if (j != SA_EMPTY && j > 0 && !sais_type(types, j - 1))
+        {
+            sa[bucket[sais_char(s, j - 1)]++] = j - 1;
+        }
+    }
+    sais_buckets(s, bucket, k, 1);
+    for (uint32_t i = s->n; i-- > 0;)
+    {
+        uint32_t j = sa[i];
+        if (j != SA_EMPTY && j > 0 && sais_type(types, j - 1))
+        {
+            sa[--bucket[sais_char(s, j - 1)]] = j - 1;
+        }
+    }
+}
+
+/**
+ * @brief SA-IS: the suffix array of a string ending with a unique smallest
+ * sentinel
+ * @param s the string, at least 2 characters
+ * @param sa receives the suffix array, `s->n` entries
+ * @param k largest character
+ * @returns 0 on success, -1 if out of memory
+ */
+static int sais(const sais_string *s, uint32_t *sa, uint32_t k)
+{
+    const uint32_t n = s->n;
+    uint8_t *types = calloc((size_t)n / 8 + 1, 1);
+    uint32_t *bucket = malloc(((size_t)k + 1) * sizeof(uint32_t));
+    if (!types || !bucket)
+    {
+        free(types);
+        free(bucket);
+        return -1;
+    }
+
+    /* classify: the sentinel is S, the character before it L */
+    types[(n - 1) >> 3] |= 1 << ((n - 1) & 7);
+    for (uint32_t i = n - 1; i-- > 0;)
+    {
+        uint32_t a = sais_char(s, i), b = sais_char(s, i + 1);
+        if (a < b || (a == b && sais_type(types, i + 1)))
+        {
+            types[i >> 3] |= 1 << (i & 7);
+        }
+    }
+
+    /* stage 1: sort the LMS substrings by inducing from their buckets */
+    sais_buckets(s, bucket, k, 1);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        sa[i] = SA_EMPTY;
+    }
+    for (uint32_t i = 1; i < n; i++)
+    {
+        if (sais_is_lms(types, i))
+        {
+            sa[--bucket[sais_char(s, i)]] = i;
+        }
+    }
+    sais_induce(s, sa, types, bucket, k);
+
+    /* name them, equal substrings alike, in the order they are sorted */
+    uint32_t n1 = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (sais_is_lms(types, sa[i]))
+        {
+            sa[n1++] = sa[i];
+        }
+    }
+    for (uint32_t i = n1; i < n; i++)
+    {
+        sa[i] = SA_EMPTY;
+    }
+    uint32_t names = 0, prev = SA_EMPTY;
+    for (uint32_t i = 0; i < n1; i++)
+    {
+        uint32_t pos = sa[i];
+        int differ = prev == SA_EMPTY;
+        for (uint32_t d = 0; !differ; d++)
+        {
+            if (sais_char(s, pos + d) != sais_char(s, prev + d) ||
+                sais_type(types, pos + d) != sais_type(types, prev + d))
+            {
+                differ = 1;
+            }
+            else if (d > 0 && (sais_is_lms(types, pos + d) ||
+                               sais_is_lms(types, prev + d)))
+            {
+                break;  // both LMS substrings ended together
+            }
+        }
+        if (differ)
+        {
+            names++;
+            prev = pos;
+        }
+        /* LMS positions are at least 2 apart, so pos / 2 is unique */
+        sa[n1 + pos / 2] = names - 1;
+    }
+    for (uint32_t i = n, j = n; i-- > n1;)
+    {
+        if (sa[i] != SA_EMPTY)
+        {
+            sa[--j] = sa[i];
+        }
+    }
+
+    /* stage 2: the suffix array of the reduced string */
+    uint32_t *sa1 = sa, *s1 = sa + n - n1;
+    if (names < n1)
+    {
+        sais_string reduced = {NULL, s1, n1};
+        if (sais(&reduced, sa1, names - 1))
+        {
+            free(types);
+            free(bucket);
+            return -1;
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < n1; i++)
+        {
+            sa1[s1[i]] = i;
+        }
+    }
+
+    /* stage 3: put the sorted LMS suffixes in place, induce the rest */
+    for (uint32_t i = 1, j = 0; i < n; i++)
+    {
+        if (sais_is_lms(types, i))
+        {
+            s1[j++] = i;
+        }
+    }
+    for (uint32_t i = 0; i < n1; i++)
+    {
+        sa1[i] = s1[sa1[i]];
+    }
+    for (uint32_t i = n1; i < n; i++)
+    {
+        sa[i] = SA_EMPTY;
+    }
+    sais_buckets(s, bucket, k, 1);
+    for (uint32_t i = n1; i-- > 0;)
+    {
+        uint32_t j = sa[i];
+        sa[i] = SA_EMPTY;
+        sa[--bucket[sais_char(s, j)]] = j;
+    }
+    sais_induce(s, sa, types, bucket, k);
+
+    free(types);
+    free(bucket);
+    return 0;
+}
+
+/**
+ * @brief Kasai's algorithm: the LCP array of a suffix array
+ * @param text the text
+ * @param n length of the text
+ * @param sa its suffix array
+ * @param lcp receives the LCP array
+ * @param rank scratch array of `n` entries
+ * @returns void
+ */
+static void kasai(const uint8_t *text, uint32_t n, const uint32_t *sa,
+                  uint32_t *lcp, uint32_t *rank)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        rank[sa[i]] = i;
+    }
+    /* going through the text in order, the common prefix drops by at most
+       one from one suffix to the next */
+    uint32_t h = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (rank[i] == 0)
+        {
+            lcp[0] = 0;
+            h = 0;
+            continue;
+        }
+        uint32_t j = sa[rank[i] - 1];
+        while (i + h < n && j + h < n && text[i + h] == text[j + h])
+        {
+            h++;
+        }
+        lcp[rank[i]] = h;
+        if (h > 0)
+        {
+            h--;
+        }
+    }
+}
+
+/**
+ * @brief fills LCP-LR for the midpoints of the search interval (left, right)
+ * @details `left` = -1 and `right` = n stand for the empty ends of the
+ * search, whose common prefix with anything is 0.
+ * @param idx index whose `lcp` is set
+ * @param lcp_lr receives the LCP-LR of the midpoints
+ * @param left left end, exclusive
+ * @param right right end, exclusive
+ * @returns the common prefix of the suffixes at both ends
+ */
+static uint32_t fill_lcp_lr(const sa_index *idx, uint32_t *lcp_lr,
+                            int64_t left, int64_t right)
+{
+    if (right - left <= 1)
+    {
+        return left >= 0 && right < (int64_t)idx->n ? idx->lcp[right] : 0;
+    }
+    int64_t mid = left + (right - left) / 2;
+    uint32_t l = lcp_lr[2 * mid] = fill_lcp_lr(idx, lcp_lr, left, mid);
+    uint32_t r = lcp_lr[2 * mid + 1] = fill_lcp_lr(idx, lcp_lr, mid, right);
+    if (left < 0 || right >= (int64_t)idx->n)
+    {
+        return 0;
+    }
+    return l < r ? l : r;
+}
+
+/**
+ * @brief builds the index of a text
+ * @details The text is not copied and must outlive the index.
+ * @param text the text, any bytes
+ * @param n its length, at most ::SA_MAX_LENGTH
+ * @param idx receives the index, to be released by sa_index_close()
+ * @returns 0 on success, -1 if the text is too long or memory runs out
+ */
+int sa_index_build(const uint8_t *text, uint32_t n, sa_index *idx)
+{
+    memset(idx, 0, sizeof(*idx));
+    if (n > SA_MAX_LENGTH)
+    {
+        return -1;
+    }
+    /* one block: the suffix array with the sentinel's entry, then LCP,
+       LCP-LR */
+    uint32_t *memory = malloc(((size_t)n + 1 + 3 * (size_t)n) *
+                              sizeof(uint32_t));
+    if (!memory)
+    {
+        return -1;
+    }
+    uint32_t *sa = memory, *lcp = memory + n + 1;
+    uint32_t *lcp_lr = lcp + n;
+
+    sais_string s = {text, NULL, n + 1};
+    if (n > 0 && sais(&s, sa, 256))
+    {
+        free(memory);
+        return -1;
+    }
+    /* sa[0] is the sentinel */
+    memmove(sa, sa + 1, (size_t)n * sizeof(uint32_t));
+    kasai(text, n, sa, lcp, lcp_lr);  // free scratch until filled
+
+    idx->text = text;
+    idx->n = n;
+    idx->sa = sa;
+    idx->lcp = lcp;
+    idx->lcp_lr = lcp_lr;
+    idx->memory = memory;
+    if (n > 0)
+    {
+        fill_lcp_lr(idx, lcp_lr, -1, n);
+    }
+    return 0;
+}
+
+/**
+ * @brief releases an index from sa_index_build() or sa_index_open()
+ * @param idx the index
+ * @returns void
+ */
+void sa_index_close(sa_index *idx)
+{
+#ifdef SA_MMAP
+    if (idx->mapped)
+    {
+        munmap(idx->memory, idx->mapped);
+        idx->memory = NULL;
+    }
+#endif
+    free(idx->memory);
+    memset(idx, 0, sizeof(*idx));
+}
+
+/**
+ * @brief compares a pattern with a suffix, from a known common prefix on
+ * @param idx the index
+ * @param suffix start of the suffix
+ * @param pattern the pattern
+ * @param m length of the pattern
+ * @param k length of their known common prefix
+ * @param cmp receives <0, 0 or >0 as the suffix, cut to `m` bytes, is less
+ * than, equal to or greater than the pattern
+ * @returns the length of their common prefix, at most `m`
+ */
+static uint32_t compare_suffix(const sa_index *idx, uint32_t suffix,
+                               const uint8_t *pattern, uint32_t m, uint32_t k,
+                               int *cmp)
+{
+    const uint8_t *s = idx->text + suffix;
+    uint32_t available = idx->n - suffix;
+    while (k < m && k < available && s[k] == pattern[k])
+    {
+        k++;
+    }
+    if (k == m)
+    {
+        *cmp = 0;
+    }
+    else if (k == available)
+    {
+        *cmp = -1;  // the suffix is a proper prefix of the pattern
+    }
+    else
+    {
+        *cmp = s[k] < pattern[k] ? -1 : 1;
+    }
+    return k;
+}
+
+/**
+ * @brief first suffix not below the pattern, or, for `upper`, the first one
+ * above every string the pattern is a prefix of
+ * @param idx the index
+ * @param pattern the pattern
+ * @param m length of the pattern
+ * @param upper 0 or 1
+ * @returns a position of the suffix array, `n` if there is none
+ */
+static uint32_t search_bound(const sa_index *idx, const uint8_t *pattern,
+                             uint32_t m, int upper)
+{
+    /* suffixes at left are below, at right above; l and r are their
+       common prefixes with the pattern */
+    int64_t left = -1, right = idx->n;
+    uint32_t l = 0, r = 0;
+    while (right - left > 1)
+    {
+        int64_t mid = left + (right - left) / 2;
+        uint32_t known, k;
+        int cmp, go_right;
+        if (l >= r)
+        {
+            known = idx->lcp_lr[2 * mid];
+            if (known != l)
+            {
+                /* mid shares more with left than the pattern does: it is
+                   below too; or less: it is above where left meets it */
+                go_right = known > l;
+                if (go_right)
+                {
+                    left = mid;
+                }
+                else
+                {
+                    right = mid;
+                    r = known;
+                }
+                continue;
+            }
+            k = compare_suffix(idx, idx->sa[mid], pattern, m, l, &cmp);
+        }
+        else
+        {
+            known = idx->lcp_lr[2 * mid + 1];
+            if (known != r)
+            {
+                go_right = known < r;
+                if (go_right)
+                {
+                    left = mid;
+                    l = known;
+                }
+                else
+                {
+                    right = mid;
+                }
+                continue;
+            }
+            k = compare_suffix(idx, idx->sa[mid], pattern, m, r, &cmp);
+        }
+        go_right = cmp < 0 || (cmp == 0 && upper);
+        if (go_right)
+        {
+            left = mid;
+            l = k;
+        }
+        else
+        {
+            right = mid;
+            r = k;
+        }
+    }
+    return (uint32_t)right;
+}
+
+/**
+ * @brief counts the occurrences of a pattern
+ * @param idx the index
+ * @param pattern the pattern, any bytes
+ * @param m its length; the empty pattern starts every suffix
+ * @param first receives the position in `idx->sa` of the first occurrence:
+ * the occurrences start at `idx->sa[*first]` to `idx->sa[*first + count -
+ * 1]`, in no particular order
+ * @returns the number of occurrences
+ */
+uint32_t sa_index_count(const sa_index *idx, const void *pattern, uint32_t m,
+                        uint32_t *first)
+{
+    uint32_t lo = search_bound(idx, pattern, m, 0);
+    uint32_t hi = lo < idx->n ? search_bound(idx, pattern, m, 1) : lo;
+    *first = lo;
+    return hi - lo;
+}
+
+/**
+ * @brief the longest substring occurring at least twice, from the LCP array
+ * @param idx the index
+ * @param position receives the start of one of its occurrences
+ * @returns its length, 0 if no byte repeats
+ */
+uint32_t sa_index_longest_repeat(const sa_index *idx, uint32_t *position)
+{
+    uint32_t best = 0;
+    *position = 0;
+    for (uint32_t i = 1; i < idx->n; i++)
+    {
+        if (idx->lcp[i] > best)
+        {
+            best = idx->lcp[i];
+            *position = idx->sa[i];
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief rounds an offset up to ::SA_ALIGN
+ * @param offset an offset
+ * @returns the aligned offset
+ */
+static uint64_t sa_align(uint64_t offset)
+{
+    return (offset + SA_ALIGN - 1) / SA_ALIGN * SA_ALIGN;
+}
+
+/**
+ * @brief writes an index, its text included, to a file
+ * @param idx the index
+ * @param path path of the file
+ * @returns 0 on success, -1 if the file cannot be written
+ */
+int sa_index_save(const sa_index *idx, const char *path)
+{
+    sa_file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, sa_magic, sizeof(sa_magic));
+    header.byte_order = 0x01020304;
+    header.length = idx->n;
+    const void *parts[4] = {idx->text, idx->sa, idx->lcp, idx->lcp_lr};
+    uint64_t sizes[4] = {idx->n, 4 * (uint64_t)idx->n, 4 * (uint64_t)idx->n,
+                         8 * (uint64_t)idx->n};
+    uint64_t offset = sa_align(sizeof(header));
+    for (int i = 0; i < 4; i++)
+    {
+        header.offset[i] = offset;
+        offset = sa_align(offset + sizes[i]);
+    }
+
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        return -1;
+    }
+    static const uint8_t zeros[SA_ALIGN] = {0};
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    uint64_t written = sizeof(header);
+    for (int i = 0; i < 4 && ok; i++)
+    {
+        ok = fwrite(zeros, 1, header.offset[i] - written, f) ==
+                 header.offset[i] - written &&
+             (sizes[i] == 0 || fwrite(parts[i], sizes[i], 1, f) == 1);
+        written = header.offset[i] + sizes[i];
+    }
+    ok = fclose(f) == 0 && ok;
+    return ok ? 0 : -1;
+}
+
+/**
+ * @brief sets the arrays of an index from the contents of an index file
+ * @param idx the index
+ * @param data contents of the file
+ * @param size size of the file
+ * @returns 0 on success, -1 if the file is not a valid index
+ */
+static int sa_index_from_file(sa_index *idx, const uint8_t *data, size_t size)
+{
+    sa_file_header header;
+    if (size < sizeof(header))
+    {
+        return -1;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, sa_magic, sizeof(sa_magic)) != 0 ||
+        header.byte_order != 0x01020304)
+    {
+        return -1;
+    }
+    uint64_t n = header.length;
+    for (int i = 0; i < 4; i++)
+    {
+        uint64_t bytes = i == 0 ? n : i == 3 ? 8 * n : 4 * n;
+        if (header.offset[i] % SA_ALIGN || header.offset[i] > size ||
+            bytes > size - header.offset[i])
+        {
+            return -1;
+        }
+    }
+    idx->n = (uint32_t)n;
+    idx->text = data + header.offset[0];
+    idx->sa = (const uint32_t *)(data + header.offset[1]);
+    idx->lcp = (const uint32_t *)(data + header.offset[2]);
+    idx->lcp_lr = (const uint32_t *)(data + header.offset[3]);
+    return 0;
+}
+
+/**
+ * @brief opens an index file written by sa_index_save()
+ * @details The file is mapped read-only where mmap() exists, so opening
+ * takes constant time; elsewhere it is read into memory.
+ * @param path path of the file
+ * @param idx receives the index, to be released by sa_index_close()
+ * @returns 0 on success, -1 if the file cannot be read or is not an index
+ * of this machine's byte order
+ */
+int sa_index_open(const char *path, sa_index *idx)
+{
+    memset(idx, 0, sizeof(*idx));
+#ifdef SA_MMAP
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    void *data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // the mapping stays valid
+    if (data == MAP_FAILED)
+    {
+        return -1;
+    }
+    idx->memory = data;
+    idx->mapped = size;
+#else
+    FILE *f = fopen(path, "rb");
+    long length;
+    if (!f)
+    {
+        return -1;
+    }
+    if (fseek(f, 0, SEEK_END) != 0 || (length = ftell(f)) <= 0 ||
+        fseek(f, 0, SEEK_SET) != 0 ||
+        (idx->memory = malloc((size_t)length)) == NULL ||
+        fread(idx->memory, 1, (size_t)length, f) != (size_t)length)
+    {
+        fclose(f);
+        free(idx->memory);
+        idx->memory = NULL;
+        return -1;
+    }
+    fclose(f);
+    size_t size = (size_t)length;
+#endif
+    if (sa_index_from_file(idx, idx->memory, size))
+    {
+        sa_index_close(idx);
+        return -1;
+    }
+    return 0;
+}
+
+/** @cond plain binary search over the suffix array, for the benchmark */
+static int compare_at(const sa_index *idx, uint32_t suffix,
+                      const uint8_t *pattern, uint32_t m)
+{
+    uint32_t available = idx->n - suffix;
+    int c = memcmp(idx->text + suffix, pattern,
+                   available < m ? available : m);
+    return c ? c : (available < m ? -1 : 0);
+}
+
+static uint32_t plain_count(const sa_index *idx, const uint8_t *pattern,
+                            uint32_t m)
+{
+    uint32_t lo = 0, hi = idx->n;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (compare_at(idx, idx->sa[mid], pattern, m) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    uint32_t first = lo;
+    hi = idx->n;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (compare_at(idx, idx->sa[mid], pattern, m) <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo - first;
+}
+/** @endcond */
+
+/** text of the suffix comparison of ::check_order */
+static const uint8_t *sort_text;
+/** length of ::sort_text */
+static uint32_t sort_length;
+
+/** qsort() order of suffixes, for the tests */
+static int compare_suffixes(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    uint32_t lx = sort_length - x, ly = sort_length - y;
+    int c = memcmp(sort_text + x, sort_text + y, lx < ly ? lx : ly);
+    return c ? c : (lx > ly) - (lx < ly);
+}
+
+/**
+ * @brief checks an index against naive computations
+ * @param idx the index
+ * @returns void
+ */
+static void check_index(const sa_index *idx)
+{
+    const uint32_t n = idx->n;
+    uint32_t *expected = malloc(((size_t)n + 1) * sizeof(uint32_t));
+    assert(expected);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        expected[i] = i;
+    }
+    sort_text = idx->text;
+    sort_length = n;
+    qsort(expected, n, sizeof(uint32_t), compare_suffixes);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        assert(idx->sa[i] == expected[i]);
+        uint32_t h = 0;
+        while (i > 0 && idx->sa[i] + h < n && idx->sa[i - 1] + h < n &&
+               idx->text[idx->sa[i] + h] == idx->text[idx->sa[i - 1] + h])
+        {
+            h++;
+        }
+        assert(idx->lcp[i] == h);
+    }
+
+    /* every query against a scan: substrings of the text, and others */
+    for (int q = 0; q < 40; q++)
+    {
+        uint8_t pattern[12];
+        uint32_t m = (uint32_t)(rand() % 12);
+        if (n > m && q % 2)
+        {
+            memcpy(pattern, idx->text + (uint32_t)rand() % (n - m + 1), m);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < m; i++)
+            {
+                pattern[i] = (uint8_t)(rand() % 3);
+            }
+        }
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < n && i + m <= n; i++)
+        {
+            count += memcmp(idx->text + i, pattern, m) == 0;
+        }
+        uint32_t first;
+        assert(sa_index_count(idx, pattern, m, &first) == count);
+        assert(plain_count(idx, pattern, m) == count);
+        for (uint32_t i = first; i < first + count; i++)
+        {
+            assert(memcmp(idx->text + idx->sa[i], pattern, m) == 0);
+        }
+    }
+    free(expected);
+}
+
+/**
+ * @brief Self-test implementations
+ * @param path index file to write and remove
+ * @returns void
+ */
+static void test(const char *path)
+{
+    sa_index idx;
+    const uint8_t *banana = (const uint8_t *)"banana";
+    assert(sa_index_build(banana, 6, &idx) == 0);
+    const uint32_t banana_sa[] = {5, 3, 1, 0, 4, 2};
+    const uint32_t banana_lcp[] = {0, 1, 3, 0, 0, 2};
+    assert(memcmp(idx.sa, banana_sa, sizeof(banana_sa)) == 0);
+    assert(memcmp(idx.lcp, banana_lcp, sizeof(banana_lcp)) == 0);
+    uint32_t first, position;
+    assert(sa_index_count(&idx, "ana", 3, &first) == 2);
+    assert(sa_index_count(&idx, "nab", 3, &first) == 0);
+    assert(sa_index_longest_repeat(&idx, &position) == 3);
+    assert(memcmp(banana + position, "ana", 3) == 0);
+    check_index(&idx);
+    sa_index_close(&idx);
+
+    assert(sa_index_build(banana, 0, &idx) == 0);
+    assert(sa_index_count(&idx, "a", 1, &first) == 0);
+    assert(sa_index_count(&idx, "", 0, &first) == 0);
+    sa_index_close(&idx);
+
+    /* small alphabets with NULs and long repeats, which recurse deeply */
+    uint8_t text[3000];
+    for (int round = 0; round < 200; round++)
+    {
+        uint32_t n = 1 + (uint32_t)rand() % (round < 150 ? 40 : 3000);
+        int alphabet = 1 + rand() % 3;
+        uint32_t period = 1 + (uint32_t)rand() % 7;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            text[i] = i >= period && rand() % 10
+                          ? text[i - period]
+                          : (uint8_t)(rand() % alphabet);
+        }
+        assert(sa_index_build(text, n, &idx) == 0);
+        check_index(&idx);
+
+        if (round % 20 == 0)
+        {
+            sa_index opened;
+            assert(sa_index_save(&idx, path) == 0);
+            assert(sa_index_open(path, &opened) == 0);
+            assert(opened.n == n && memcmp(opened.text, text, n) == 0);
+            assert(memcmp(opened.sa, idx.sa, n * sizeof(uint32_t)) == 0);
+            check_index(&opened);
+            sa_index_close(&opened);
+        }
+        sa_index_close(&idx);
+    }
+    remove(path);
+
+    sa_index opened;
+    assert(sa_index_open(path, &opened) == -1);
+    printf("All tests passed\n\n");
+}
+
+/** @returns seconds elapsed since start */
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/** path of the temporary index file of main(), if it made one */
+static char temporary_path[FILENAME_MAX];
+
+/** removes the temporary index file at exit */
+static void remove_temporary_index(void) { remove(temporary_path); }
+
+/**
+ * @brief creates an empty temporary file to hold the index
+ * @returns 0 with its name in ::temporary_path, -1 if it can't be created
+ */
+static int create_temporary_index(void)
+{
+#ifdef SA_MMAP
+    const char *dir = getenv("TMPDIR");
+    if (!dir || !*dir)
+    {
+        dir = "/tmp";
+    }
+    int length = snprintf(temporary_path, sizeof(temporary_path),
+                          "%s/suffix_array_search.XXXXXX", dir);
+    if (length < 0 || (size_t)length >= sizeof(temporary_path))
+    {
+        return -1;
+    }
+    int fd = mkstemp(temporary_path);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    close(fd);
+#else
+    if (!tmpnam(temporary_path))
+    {
+        return -1;
+    }
+#endif
+    atexit(remove_temporary_index);
+    return 0;
+}
+
+/**
+ * @brief Main function
+ * @param argc number of arguments
+ * @param argv megabytes of text and path of the index file, both optional;
+ * without a path the index goes to a temporary file
+ * @returns 0 on exit
+ */
+int main(int argc, char *argv[])
+{
+    const char *path = argc > 2 ? argv[2] : temporary_path;
+    if (argc <= 2 && create_temporary_index())
+    {
+        printf("Can't create a temporary file\n");
+        return 1;
+    }
+    srand((unsigned)time(NULL));
+    test(path);
+
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 0) : 16;
+    if (megabytes == 0 || megabytes >= 4096)
+    {
+        printf("The text must have 1 to 4095 megabytes\n");
+        return 1;
+    }
+    uint32_t n = (uint32_t)(megabytes << 20);
+    uint8_t *text = malloc(n);
+    if (!text)
+    {
+        printf("Can't Malloc! Please try again.");
+        return 1;
+    }
+    static const char *const words[] = {
+        "the", "of", "and", "to", "in", "a", "is", "that", "for", "it",
+        "as", "was", "with", "be", "by", "on", "not", "he", "this", "are",
+        "or", "his", "from", "at", "which", "but", "have", "an", "had",
+        "they", "you", "were", "their", "one", "all", "we", "can", "her",
+        "suffix", "array", "index", "corpus", "query", "search", "pattern"};
+    for (uint32_t i = 0; i < n;)
+    {
+        const char *word = words[rand() % 45];
+        for (size_t j = 0; word[j] && i < n; j++)
+        {
+            text[i++] = (uint8_t)word[j];
+        }
+        if (i < n)
+        {
+            text[i++] = ' ';
+        }
+    }
+
+    sa_index idx;
+    clock_t start = clock();
+    if (sa_index_build(text, n, &idx))
+    {
+        printf("Can't Malloc! Please try again.");
+        return 1;
+    }
+    printf("%u MB of English-like text indexed in %.3f s\n", n >> 20,
+           seconds_since(start));
+    start = clock();
+    if (sa_index_save(&idx, path))
+    {
+        printf("Can't write %s\n", path);
+        return 1;
+    }
+    printf("index saved to %s in %.3f s\n", path, seconds_since(start));
+    sa_index_close(&idx);
+    free(text);
+
+    start = clock();
+    if (sa_index_open(path, &idx))
+    {
+        printf("Can't open %s\n", path);
+        return 1;
+    }
+    printf("index opened in %.6f s\n", seconds_since(start));
+
+    /* queries: phrases of the text, of 8 to 64 bytes */
+    const uint32_t queries = 200000;
+    uint32_t *starts = malloc(queries * sizeof(uint32_t));
+    uint8_t *lengths = malloc(queries);
+    if (!starts || !lengths)
+    {
+        printf("Can't Malloc! Please try again.");
+        return 1;
+    }
+    for (uint32_t q = 0; q < queries; q++)
+    {
+        lengths[q] = (uint8_t)(8 + rand() % 57);
+        starts[q] = (uint32_t)(((uint64_t)rand() * RAND_MAX + rand()) %
+                               (n - lengths[q]));
+    }
+    for (int lr = 1; lr >= 0; lr--)
+    {
+        uint64_t total = 0;
+        start = clock();
+        for (uint32_t q = 0; q < queries; q++)
+        {
+            const uint8_t *pattern = idx.text + starts[q];
+            uint32_t first;
+            total += lr ? sa_index_count(&idx, pattern, lengths[q], &first)
+                        : plain_count(&idx, pattern, lengths[q]);
+        }
+        double seconds = seconds_since(start);
+        printf("%-28s %10.0f queries/s, %llu occurrences\n",
+               lr ? "binary search with LCP-LR" : "plain binary search",
+               queries / seconds, (unsigned long long)total);
+    }
+    free(starts);
+    free(lengths);
+    sa_index_close(&idx);
+    return 0;
+}
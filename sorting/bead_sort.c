@@ -2,19 +2,18 @@
  * @file
  * @brief Sorting of array list using [bead
  * sort](https://en.wikipedia.org/wiki/Bead_sort)
+ *
+ * The sort lives in bead_sort.h.
  */
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "bead_sort.h"
+
 /**
  * @addtogroup sorting Sorting algorithms
  * @{
  */
-/** Create easy access of elements from a 2D matrix stored in memory as a 1D
- * array
- */
-#define BEAD(i, j) beads[i * max + j]
-
 /**
  * Displays the array, passed to this method
  * @param [in] arr array to display
@@ -30,45 +29,6 @@ void display(const int *arr, int n)
     printf("\n");
 }
 
-/** This is where the sorting of the array takes place
- * @param [in,out] a array to be sorted
- * @param [in] len Array Size
- */
-void bead_sort(int *a, size_t len)
-{
-    int i, j, max, sum;
-    unsigned char *beads;
-
-    for (i = 1, max = a[0]; i < len; i++)
-        if (a[i] > max)
-            max = a[i];
-
-    beads = calloc(1, max * len);
-
-    /* mark the beads */
-    for (i = 0; i < len; i++)
-        for (j = 0; j < a[i]; j++) BEAD(i, j) = 1;
-
-    for (j = 0; j < max; j++)
-    {
-        /* count how many beads are on each post */
-        for (sum = i = 0; i < len; i++)
-        {
-            sum += BEAD(i, j);
-            BEAD(i, j) = 0;
-        }
-        /* mark bottom sum beads */
-        for (i = len - sum; i < len; i++) BEAD(i, j) = 1;
-    }
-
-    for (i = 0; i < len; i++)
-    {
-        for (j = 0; j < max && BEAD(i, j); j++)
-            ;
-        a[i] = j;
-    }
-    free(beads);
-}
 /** @} */
 
 /** Main function */
@@ -89,7 +49,12 @@ int main(int argc, const char *argv[])
     printf("Original array: ");
     display(arr, n);
 
-    bead_sort(arr, n);
+    if (bead_sort(arr, n) != 0)
+    {
+        printf("Can't Malloc! Please try again.");
+        free(arr);
+        return 1;
+    }
 
     printf("Sorted array: ");
     display(arr, n);
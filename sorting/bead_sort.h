@@ -0,0 +1,56 @@
+/**
+ * @file
+ * @brief [Bead sort](https://en.wikipedia.org/wiki/Bead_sort) of
+ * non-negative integers
+ *
+ * bead_sort() lays every key out as a row of beads on an abacus of
+ * `n` rows and `max` poles, lets the beads fall on every pole, and reads
+ * the keys back from the rows. O(n · max) time and memory, so it suits
+ * small keys only.
+ */
+#ifndef BEAD_SORT_H
+#define BEAD_SORT_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+/**
+ * Sorts n non-negative ints.
+ * @returns 0 on success, -1 if the abacus cannot be allocated, in which case
+ * `a` is left unchanged
+ */
+static inline int bead_sort(int *a, size_t n)
+{
+    int max = 0;
+    for (size_t i = 0; i < n; i++) max = a[i] > max ? a[i] : max;
+    if (max == 0)
+        return 0;
+    unsigned char *beads = (unsigned char *)calloc(n, (size_t)max);
+    if (!beads)
+        return -1;
+
+    /* row i holds a[i] beads; bead (i, j) is beads[i * max + j] */
+    for (size_t i = 0; i < n; i++)
+        for (int j = 0; j < a[i]; j++) beads[i * (size_t)max + j] = 1;
+    for (int j = 0; j < max; j++)
+    {
+        /* count the beads on pole j and let them fall to the bottom rows */
+        size_t sum = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            sum += beads[i * (size_t)max + j];
+            beads[i * (size_t)max + j] = 0;
+        }
+        for (size_t i = n - sum; i < n; i++) beads[i * (size_t)max + j] = 1;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        int j = 0;
+        while (j < max && beads[i * (size_t)max + j]) j++;
+        a[i] = j;
+    }
+    free(beads);
+    return 0;
+}
+
+#endif /* BEAD_SORT_H */
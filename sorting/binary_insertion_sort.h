@@ -0,0 +1,44 @@
+/**
+ * @file
+ * @brief Binary [insertion sort](https://en.wikipedia.org/wiki/Insertion_sort)
+ *
+ * `DEFINE_BINARY_INSERTION_SORT(name, type, less)` defines
+ * `static inline void name(type *a, size_t n)` with the ordering hook of
+ * sort_hooks.h. `binary_insertion_sort_int` is provided for `int`.
+ *
+ * Each element is inserted into the sorted prefix before it at the place
+ * found by binary search, after the last element not greater than it, so
+ * the sort is stable. O(n log n) comparisons but O(n²) moves.
+ */
+#ifndef BINARY_INSERTION_SORT_H
+#define BINARY_INSERTION_SORT_H
+
+#include <stddef.h>
+#include <string.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`. */
+#define DEFINE_BINARY_INSERTION_SORT(name, type, less)                         \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        for (size_t i = 1; i < n; i++)                                         \
+        {                                                                      \
+            type key = a[i];                                                   \
+            size_t low = 0, high = i;                                          \
+            while (low < high)                                                 \
+            {                                                                  \
+                size_t mid = low + (high - low) / 2;                           \
+                if (less(&key, &a[mid]))                                       \
+                    high = mid;                                                \
+                else                                                           \
+                    low = mid + 1;                                             \
+            }                                                                  \
+            memmove(a + low + 1, a + low, (i - low) * sizeof(type));           \
+            a[low] = key;                                                      \
+        }                                                                      \
+    }
+
+DEFINE_BINARY_INSERTION_SORT(binary_insertion_sort_int, int, SORT_LESS)
+
+#endif /* BINARY_INSERTION_SORT_H */
@@ -1,33 +1,10 @@
-#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-bool check_sorted(int *a, int n)
-{
-    while (--n >= 1)
-    {
-        if (a[n] < a[n - 1])
-            return false;
-    }
-    return true;
-}
+#include "bogo_sort.h"
 
-void shuffle(int *a, int n)
-{
-    int i, t, r;
-    for (i = 0; i < n; i++)
-    {
-        t = a[i];
-        r = rand() % n;
-        a[i] = a[r];
-        a[r] = t;
-    }
-}
-
-void sort(int *a, int n)
-{
-    while (!check_sorted(a, n)) shuffle(a, n);
-}
+/* shuffles a until it is sorted, by the bogosort of bogo_sort.h */
+void sort(int *a, int n) { bogo_sort_int(a, (size_t)n); }
 
 int main()
 {
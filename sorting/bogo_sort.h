@@ -0,0 +1,41 @@
+/**
+ * @file
+ * @brief [Bogosort](https://en.wikipedia.org/wiki/Bogosort)
+ *
+ * `DEFINE_BOGO_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `bogo_sort_int` is provided for `int`.
+ *
+ * The array is shuffled with rand() until it happens to be sorted, which
+ * takes O(n · n!) expected time: only for the smallest inputs.
+ */
+#ifndef BOGO_SORT_H
+#define BOGO_SORT_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`, a bogosort. */
+#define DEFINE_BOGO_SORT(name, type, less, swap)                               \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        for (;;)                                                               \
+        {                                                                      \
+            size_t i = 1;                                                      \
+            while (i < n && !less(&a[i], &a[i - 1])) i++;                      \
+            if (i >= n)                                                        \
+                return;                                                        \
+            /* Fisher-Yates shuffle */                                         \
+            for (i = n; i > 1; i--)                                            \
+            {                                                                  \
+                size_t j = (size_t)rand() % i;                                 \
+                swap(type, &a[i - 1], &a[j]);                                  \
+            }                                                                  \
+        }                                                                      \
+    }
+
+DEFINE_BOGO_SORT(bogo_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* BOGO_SORT_H */
@@ -0,0 +1,42 @@
+/**
+ * @file
+ * @brief [Bubble sort](https://en.wikipedia.org/wiki/Bubble_sort)
+ *
+ * `DEFINE_BUBBLE_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `bubble_sort_int` is provided for `int`.
+ *
+ * Every pass swaps neighbours that are out of order, which moves the largest
+ * element of the unsorted prefix to its end. The sort stops after a pass
+ * without swaps, so sorted input takes one pass. O(n²) comparisons.
+ */
+#ifndef BUBBLE_SORT_H
+#define BUBBLE_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`, a bubble sort. */
+#define DEFINE_BUBBLE_SORT(name, type, less, swap)                             \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        for (size_t end = n; end > 1; end--)                                   \
+        {                                                                      \
+            int swapped = 0;                                                   \
+            for (size_t j = 0; j + 1 < end; j++)                               \
+            {                                                                  \
+                if (less(&a[j + 1], &a[j]))                                    \
+                {                                                              \
+                    swap(type, &a[j], &a[j + 1]);                              \
+                    swapped = 1;                                               \
+                }                                                              \
+            }                                                                  \
+            if (!swapped)                                                      \
+                break;                                                         \
+        }                                                                      \
+    }
+
+DEFINE_BUBBLE_SORT(bubble_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* BUBBLE_SORT_H */
@@ -1,197 +1,162 @@
-/*
- * Algorithm : Bucket Sort
- * Time-Complexity : O(n)
+/**
+ * @file
+ * @brief [Bucket sort](https://en.wikipedia.org/wiki/Bucket_sort) by
+ * sampling: a parallel sample sort of doubles and integers
+ *
+ * The sort itself lives in sample_sort.h. Instead of buckets of fixed key
+ * ranges, the bucket boundaries are drawn from a sample of the input, so
+ * the buckets are about equally full for any distribution and any range of
+ * keys. Each bucket is sorted by the introsort of introsort.h.
+ *
+ * usage: ./bucket_sort [number of values]
+ * runs the self tests, then times bucket_sort_double(), the introsort alone
+ * and qsort() on that many random doubles.
  */
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
-#define NARRAY 8    /* array size */
-#define NBUCKET 5   /* bucket size */
-#define INTERVAL 10 /* bucket range */
+#include "introsort.h"
+#include "sample_sort.h"
 
-struct Node
+/**
+ * @addtogroup sorting Sorting algorithms
+ * @{
+ */
+DEFINE_INTROSORT(introsort_double, double, INTROSORT_LESS)
+DEFINE_SAMPLE_SORT(bucket_sort_double, double, SAMPLE_SORT_LESS,
+                   introsort_double)
+DEFINE_SAMPLE_SORT(bucket_sort_int, int, SAMPLE_SORT_LESS, introsort_int)
+/** @} */
+
+/** comparison of doubles for qsort() */
+static int compare_double(const void *a, const void *b)
 {
-    int data;
-    struct Node *next;
-};
-
-void BucketSort(int arr[]);
-struct Node *InsertionSort(struct Node *list);
-void print(int arr[]);
-void printBuckets(struct Node *list);
-int getBucketIndex(int value);
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
 
-void BucketSort(int arr[])
+/** comparison of integers for qsort() */
+static int compare_int(const void *a, const void *b)
 {
-    int i, j;
-    struct Node **buckets;
-
-    /* allocate memory for array of pointers to the buckets */
-    buckets = (struct Node **)malloc(sizeof(struct Node *) * NBUCKET);
-
-    /* initialize pointers to the buckets */
-    for (i = 0; i < NBUCKET; ++i)
-    {
-        buckets[i] = NULL;
-    }
-
-    /* put items into the buckets */
-    /* creates a link list in each bucket slot */
-    for (i = 0; i < NARRAY; ++i)
-    {
-        struct Node *current;
-        int pos = getBucketIndex(arr[i]);
-        current = (struct Node *)malloc(sizeof(struct Node));
-        current->data = arr[i];
-        current->next = buckets[pos];
-        buckets[pos] = current;
-    }
-
-    /* check what's in each bucket */
-    for (i = 0; i < NBUCKET; i++)
-    {
-        printf("Bucket[\"%d\"] : ", i);
-        printBuckets(buckets[i]);
-        printf("\n");
-    }
-
-    /* sorting bucket using Insertion Sort */
-    for (i = 0; i < NBUCKET; ++i)
-    {
-        buckets[i] = InsertionSort(buckets[i]);
-    }
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
 
-    /* check what's in each bucket */
-    printf("--------------\n");
-    printf("Buckets after sorted\n");
-    for (i = 0; i < NBUCKET; i++)
-    {
-        printf("Bucket[\"%d\"] : ", i);
-        printBuckets(buckets[i]);
-        printf("\n");
-    }
+/** Test function
+ * @param n number of values to sort
+ * @param kind 0 for uniform values, 1 for sorted, 2 for reversed, 3 for few
+ * distinct values, 4 for all equal, 5 for a skewed distribution
+ */
+static void test(size_t n, int kind)
+{
+    double *a = (double *)malloc(n * sizeof(double));
+    double *b = (double *)malloc(n * sizeof(double));
+    int *c = (int *)malloc(n * sizeof(int)), *d = (int *)malloc(n * sizeof(int));
+    assert(n == 0 || (a && b && c && d));
 
-    /* put items back to original array */
-    for (j = 0, i = 0; i < NBUCKET; ++i)
+    for (size_t i = 0; i < n; i++)
     {
-        struct Node *node;
-        node = buckets[i];
-        while (node)
+        double x = (double)rand() / RAND_MAX;
+        switch (kind)
         {
-            // precondition for avoiding out of bounds by the array
-            assert(j < NARRAY);
-            arr[j++] = node->data;
-            node = node->next;
+        case 0:
+            a[i] = x * 2e6 - 1e6;
+            break;
+        case 1:
+            a[i] = (double)i;
+            break;
+        case 2:
+            a[i] = (double)(n - i);
+            break;
+        case 3:
+            a[i] = (double)(rand() % 5);
+            break;
+        case 4:
+            a[i] = 42.0;
+            break;
+        default:
+            a[i] = x * x * x * x * 1e6; /* crowded near 0 */
+            break;
         }
+        b[i] = a[i];
+        c[i] = d[i] = (int)a[i];
     }
 
-    /* free memory */
-    for (i = 0; i < NBUCKET; ++i)
-    {
-        struct Node *node;
-        node = buckets[i];
-        while (node)
-        {
-            struct Node *tmp;
-            tmp = node;
-            node = node->next;
-            free(tmp);
-        }
-    }
-    free(buckets);
-    return;
+    assert(bucket_sort_double(a, n) == 0);
+    assert(bucket_sort_int(c, n) == 0);
+    qsort(b, n, sizeof(double), compare_double);
+    qsort(d, n, sizeof(int), compare_int);
+    assert(n == 0 || memcmp(a, b, n * sizeof(double)) == 0);
+    assert(n == 0 || memcmp(c, d, n * sizeof(int)) == 0);
+
+    free(a);
+    free(b);
+    free(c);
+    free(d);
 }
 
-/* Insertion Sort */
-struct Node *InsertionSort(struct Node *list)
+/** @returns a wall clock time in seconds */
+static double now(void)
 {
-    struct Node *k, *nodeList;
-    /* need at least two items to sort */
-    if (list == NULL || list->next == NULL)
-    {
-        return list;
-    }
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
 
-    nodeList = list;
-    k = list->next;
-    nodeList->next = NULL; /* 1st node is new list */
-    while (k != NULL)
+/** Main function */
+int main(int argc, char *argv[])
+{
+    srand(time(NULL));
+
+    const size_t sizes[] = {0,       1,         2,      100,
+                            SAMPLE_SORT_CUTOFF - 1, SAMPLE_SORT_CUTOFF,
+                            200000,  1 << 20};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
     {
-        struct Node *ptr;
-        /* check if insert before first */
-        if (nodeList->data > k->data)
+        for (int kind = 0; kind < 6; kind++)
         {
-            struct Node *tmp;
-            tmp = k;
-            k = k->next;  // important for the while
-            tmp->next = nodeList;
-            nodeList = tmp;
-            continue;
+            test(sizes[i], kind);
         }
+    }
+    printf("All tests passed\n\n");
 
-        // from begin up to end
-        // finds [i] > [i+1]
-        for (ptr = nodeList; ptr->next != NULL; ptr = ptr->next)
+    if (argc > 1)
+    {
+        size_t n = strtoul(argv[1], NULL, 0);
+        double *input = (double *)malloc(n * sizeof(double));
+        double *a = (double *)malloc(n * sizeof(double));
+        if (n == 0 || !input || !a)
         {
-            if (ptr->next->data > k->data)
-                break;
+            printf("Can't Malloc! Please try again.");
+            return 1;
         }
-
-        // if found (above)
-        if (ptr->next != NULL)
+        for (size_t i = 0; i < n; i++)
         {
-            struct Node *tmp;
-            tmp = k;
-            k = k->next;  // important for the while
-            tmp->next = ptr->next;
-            ptr->next = tmp;
-            continue;
+            input[i] = (double)rand() / RAND_MAX;
         }
-        else
+
+        printf("%zu doubles, %d threads\n", n, sample_sort_max_threads());
+        for (int sort = 0; sort < 3; sort++)
         {
-            ptr->next = k;
-            k = k->next;  // important for the while
-            ptr->next->next = NULL;
-            continue;
+            static const char *const names[] = {"bucket_sort_double",
+                                                "introsort_double", "qsort"};
+            memcpy(a, input, n * sizeof(double));
+            double start = now();
+            if (sort == 0)
+                bucket_sort_double(a, n);
+            else if (sort == 1)
+                introsort_double(a, n);
+            else
+                qsort(a, n, sizeof(double), compare_double);
+            printf("%-20s %.3f s\n", names[sort], now() - start);
         }
+        free(input);
+        free(a);
     }
-    return nodeList;
-}
-
-int getBucketIndex(int value) { return value / INTERVAL; }
-
-void print(int ar[])
-{
-    int i;
-    for (i = 0; i < NARRAY; ++i)
-    {
-        printf("%d ", ar[i]);
-    }
-    printf("\n");
-}
-
-void printBuckets(struct Node *list)
-{
-    struct Node *cur = list;
-    while (cur)
-    {
-        printf("%d ", cur->data);
-        cur = cur->next;
-    }
-}
-
-int main(void)
-{
-    int array[NARRAY] = {29, 25, -1, 49, 9, 37, 21, 43};
-
-    printf("Initial array\n");
-    print(array);
-    printf("------------\n");
-
-    BucketSort(array);
-    printf("------------\n");
-    printf("Sorted array\n");
-    print(array);
     return 0;
 }
@@ -1,47 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-#define TRUE 1
-#define FALSE 0
+#include "cocktail_sort.h"
 
-void cocktailSort(int arr[], int size)
-{
-    int i, changed = TRUE, temp, start = 0, end = size - 1;
-
-    while (changed)
-    {
-        changed = FALSE;
-        for (i = start; i < end; i++)
-        {
-            if (arr[i] > arr[i + 1])
-            {
-                temp = arr[i];
-                arr[i] = arr[i + 1];
-                arr[i + 1] = temp;
-                changed = TRUE;
-            }
-        }
-        end--;
-
-        if (changed == FALSE)
-        {
-            break;
-        }
-        changed = FALSE;
-
-        for (i = end - 1; i >= start; i--)
-        {
-            if (arr[i + 1] < arr[i])
-            {
-                temp = arr[i + 1];
-                arr[i + 1] = arr[i];
-                arr[i] = temp;
-                changed = TRUE;
-            }
-        }
-        start++;
-    }
-}
+/* sorts arr by the cocktail shaker sort of cocktail_sort.h */
+void cocktailSort(int arr[], int size) { cocktail_sort_int(arr, (size_t)size); }
 
 int main()
 {
@@ -0,0 +1,51 @@
+/**
+ * @file
+ * @brief [Cocktail shaker
+ * sort](https://en.wikipedia.org/wiki/Cocktail_shaker_sort)
+ *
+ * `DEFINE_COCKTAIL_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `cocktail_sort_int` is provided for `int`.
+ *
+ * A bubble sort whose passes alternate direction: a forward pass moves the
+ * largest element of the range to its end and a backward pass moves the
+ * smallest to its start. It stops after a forward pass without swaps.
+ * O(n²) comparisons.
+ */
+#ifndef COCKTAIL_SORT_H
+#define COCKTAIL_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`. */
+#define DEFINE_COCKTAIL_SORT(name, type, less, swap)                           \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        size_t start = 0, end = n;                                             \
+        int swapped = 1;                                                       \
+        while (swapped && end - start > 1)                                     \
+        {                                                                      \
+            swapped = 0;                                                       \
+            for (size_t i = start; i + 1 < end; i++)                           \
+            {                                                                  \
+                if (less(&a[i + 1], &a[i]))                                    \
+                {                                                              \
+                    swap(type, &a[i], &a[i + 1]);                              \
+                    swapped = 1;                                               \
+                }                                                              \
+            }                                                                  \
+            end--;                                                             \
+            for (size_t i = end - 1; swapped && i > start; i--)                \
+            {                                                                  \
+                if (less(&a[i], &a[i - 1]))                                    \
+                    swap(type, &a[i], &a[i - 1]);                              \
+            }                                                                  \
+            start++;                                                           \
+        }                                                                      \
+    }
+
+DEFINE_COCKTAIL_SORT(cocktail_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* COCKTAIL_SORT_H */
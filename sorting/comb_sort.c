@@ -1,26 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
-#define SHRINK 1.3  // suggested shrink factor value
 
-void sort(int *numbers, int size)
-{
-    int gap = size;
-    while (gap > 1)  // gap = 1 means that the array is sorted
-    {
-        gap = gap / SHRINK;
-        int i = 0;
-        while ((i + gap) < size)
-        {  // similiar to the Shell Sort
-            if (numbers[i] > numbers[i + gap])
-            {
-                int tmp = numbers[i];
-                numbers[i] = numbers[i + gap];
-                numbers[i + gap] = tmp;
-            }
-            i++;
-        }
-    }
-}
+#include "comb_sort.h"
+
+/* sorts numbers by the comb sort of comb_sort.h */
+void sort(int *numbers, int size) { comb_sort_int(numbers, (size_t)size); }
 
 void display(int *array, int n)
 {
@@ -0,0 +1,50 @@
+/**
+ * @file
+ * @brief [Comb sort](https://en.wikipedia.org/wiki/Comb_sort)
+ *
+ * `DEFINE_COMB_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `comb_sort_int` is provided for `int`.
+ *
+ * A bubble sort over elements a gap apart. The gap starts at n and shrinks
+ * by a factor of 1.3 with every pass, which moves small elements near the
+ * end forward quickly. Once the gap is 1, passes repeat until one makes no
+ * swap.
+ */
+#ifndef COMB_SORT_H
+#define COMB_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** @{ the gap shrinks by a factor of 1.3 per pass */
+#define COMB_SORT_SHRINK_NUM 10
+#define COMB_SORT_SHRINK_DEN 13
+/** @} */
+
+/** Defines `static inline void name(type *a, size_t n)`, a comb sort. */
+#define DEFINE_COMB_SORT(name, type, less, swap)                               \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        size_t gap = n;                                                        \
+        int swapped = 1;                                                       \
+        while (gap > 1 || swapped)                                             \
+        {                                                                      \
+            gap = gap * COMB_SORT_SHRINK_NUM / COMB_SORT_SHRINK_DEN;           \
+            gap = gap ? gap : 1;                                               \
+            swapped = 0;                                                       \
+            for (size_t i = 0; i + gap < n; i++)                               \
+            {                                                                  \
+                if (less(&a[i + gap], &a[i]))                                  \
+                {                                                              \
+                    swap(type, &a[i], &a[i + gap]);                            \
+                    swapped = 1;                                               \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+    }
+
+DEFINE_COMB_SORT(comb_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* COMB_SORT_H */
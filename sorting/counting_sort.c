@@ -3,15 +3,17 @@
   > integer sorting algorithm
   > Worst-case performance O(n+k)
   > Stabilized by prefix sum array
+  > The sort lives in counting_sort.h
 */
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
+
+#include "counting_sort.h"
 
 int main()
 {
-    int i, n, l = 0;
+    int i, n;
 
     printf("Enter size of array = ");
     scanf("%d", &n);
@@ -21,28 +23,19 @@ int main()
     for (i = 0; i < n; i++)
     {
         scanf("%d", &a[i]);
-        if (a[i] > l)
-            l = a[i];
     }
 
-    int *b = (int *)malloc((l + 1) * sizeof(int));
-    memset(b, 0, (l + 1) * sizeof(b[0]));
-
-    for (i = 0; i < n; i++) b[a[i]]++;  // hashing number to array index
-
-    for (i = 0; i < (l + 1); i++)  // unstable , stabilized by prefix sum array
+    if (counting_sort(a, (size_t)n) != 0)
+    {
+        printf("Can't Malloc! Please try again.");
+        free(a);
+        return 1;
+    }
+    for (i = 0; i < n; i++)
     {
-        if (b[i] > 0)
-        {
-            while (b[i] != 0)  // for case when number exists more than once
-            {
-                printf("%d ", i);
-                b[i]--;
-            }
-        }
+        printf("%d ", a[i]);
     }
 
     free(a);
-    free(b);
     return 0;
 }
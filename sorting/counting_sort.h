@@ -0,0 +1,35 @@
+/**
+ * @file
+ * @brief [Counting sort](https://en.wikipedia.org/wiki/Counting_sort) of
+ * non-negative integers
+ *
+ * counting_sort() counts how often every key from 0 to the largest occurs
+ * and rewrites the array from the counts. O(n + k) time and O(k) memory for
+ * keys up to k, so it suits small key ranges only.
+ */
+#ifndef COUNTING_SORT_H
+#define COUNTING_SORT_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+/**
+ * Sorts n non-negative ints.
+ * @returns 0 on success, -1 if the counts cannot be allocated, in which case
+ * `a` is left unchanged
+ */
+static inline int counting_sort(int *a, size_t n)
+{
+    int max = 0;
+    for (size_t i = 0; i < n; i++) max = a[i] > max ? a[i] : max;
+    size_t *count = (size_t *)calloc((size_t)max + 1, sizeof(size_t));
+    if (!count)
+        return -1;
+    for (size_t i = 0; i < n; i++) count[a[i]]++;
+    for (size_t key = 0, i = 0; key <= (size_t)max; key++)
+        while (count[key]--) a[i++] = (int)key;
+    free(count);
+    return 0;
+}
+
+#endif /* COUNTING_SORT_H */
@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "cycle_sort.h"
+
 // Displays the array, passed to this method
 void display(int *arr, int n)
 {
@@ -14,70 +16,8 @@ void display(int *arr, int n)
     printf("\n");
 }
 
-// Swap function to swap two values
-void swap(int *first, int *second)
-{
-    int temp = *first;
-    *first = *second;
-    *second = temp;
-}
-
-// Function sort the array using Cycle sort
-void cycleSort(int *arr, int n)
-{
-    // count number of memory writes
-    int writes = 0;
-
-    // traverse array elements and put it to on
-    // the right place
-    for (int cycle_start = 0; cycle_start <= n - 2; cycle_start++)
-    {
-        // initialize item as starting point
-        int item = arr[cycle_start];
-
-        // Find position where we put the item. We basically
-        // count all smaller elements on right side of item.
-        int pos = cycle_start;
-        for (int i = cycle_start + 1; i < n; i++)
-            if (arr[i] < item)
-                pos++;
-
-        // If item is already in correct position
-        if (pos == cycle_start)
-            continue;
-
-        // ignore all duplicate elements
-        while (item == arr[pos]) pos += 1;
-
-        // put the item to it's right position
-        if (pos != cycle_start)
-        {
-            swap(&item, &arr[pos]);
-            writes++;
-        }
-
-        // Rotate rest of the cycle
-        while (pos != cycle_start)
-        {
-            pos = cycle_start;
-
-            // Find position where we put the element
-            for (int i = cycle_start + 1; i < n; i++)
-                if (arr[i] < item)
-                    pos += 1;
-
-            // ignore all duplicate elements
-            while (item == arr[pos]) pos += 1;
-
-            // put the item to it's right position
-            if (item != arr[pos])
-            {
-                swap(&item, &arr[pos]);
-                writes++;
-            }
-        }
-    }
-}
+// Function sort the array using the Cycle sort of cycle_sort.h
+void cycleSort(int *arr, int n) { cycle_sort_int(arr, (size_t)n); }
 
 // Driver program to test above function
 int main()
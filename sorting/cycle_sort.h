@@ -0,0 +1,55 @@
+/**
+ * @file
+ * @brief [Cycle sort](https://en.wikipedia.org/wiki/Cycle_sort)
+ *
+ * `DEFINE_CYCLE_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `cycle_sort_int` is provided for `int`.
+ *
+ * Every element is written straight to its final place, found by counting
+ * the elements less than it, and the element it displaces is placed next,
+ * until the cycle closes. Each element is written at most once, which is
+ * the point of the sort where writes are expensive; it makes O(n²)
+ * comparisons.
+ */
+#ifndef CYCLE_SORT_H
+#define CYCLE_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`, a cycle sort. */
+#define DEFINE_CYCLE_SORT(name, type, less, swap)                              \
+    static inline size_t name##_place(const type *a, size_t n, size_t start,   \
+                                      const type *item)                        \
+    {                                                                          \
+        size_t pos = start;                                                    \
+        for (size_t i = start + 1; i < n; i++) pos += less(&a[i], item);       \
+        /* after the elements equal to item */                                 \
+        while (!less(item, &a[pos]) && !less(&a[pos], item)) pos++;            \
+        return pos;                                                            \
+    }                                                                          \
+                                                                               \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        for (size_t start = 0; start + 1 < n; start++)                         \
+        {                                                                      \
+            type item = a[start];                                              \
+            size_t pos = start;                                                \
+            for (size_t i = start + 1; i < n; i++) pos += less(&a[i], &item);  \
+            if (pos == start)                                                  \
+                continue;                                                      \
+            while (!less(&item, &a[pos]) && !less(&a[pos], &item)) pos++;      \
+            swap(type, &item, &a[pos]);                                        \
+            while (pos != start)                                               \
+            {                                                                  \
+                pos = name##_place(a, n, start, &item);                        \
+                swap(type, &item, &a[pos]);                                    \
+            }                                                                  \
+        }                                                                      \
+    }
+
+DEFINE_CYCLE_SORT(cycle_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* CYCLE_SORT_H */
@@ -0,0 +1,630 @@
+/**
+ * @file
+ * @brief [External merge sort](https://en.wikipedia.org/wiki/External_sorting)
+ * of binary files of fixed-width records larger than memory.
+ *
+ * usage: ./external_sort [-m megabytes] [-r record bytes] [-k key offset]
+ *                        [-t u32|i32|u64|i64|f32|f64] input output
+ * sorts the records of `input` by their key into `output` within a memory
+ * budget of `megabytes` (default 256). Records default to 8 bytes holding
+ * one u64 key. Without arguments the self tests run instead.
+ *
+ * The input is read in chunks that fit in the budget. Each chunk is sorted
+ * in memory by record_sort() and written to a temporary file as one run.
+ * All runs of a pass share one temporary file, so only three files are
+ * ever open. Every merge pass then merges groups of runs with a loser
+ * tree: the tree holds the losers of the matches between the current
+ * records of the runs, so replacing the winner costs one match per level,
+ * log2(fan-in) comparisons per record. The fan-in is as large as the
+ * budget allows with ::READ_BLOCK bytes of buffer per run, and runs are
+ * refilled with reads of that size. The last pass writes the output.
+ * Bytes read and written are reported for every pass. The sort is stable.
+ */
+#define _POSIX_C_SOURCE 200112L
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "record_sort.h"
+
+#ifdef _WIN32
+#define fseeko _fseeki64
+#define ftello _ftelli64
+typedef long long file_offset;
+#else
+#include <fcntl.h>
+#include <sys/types.h>
+typedef off_t file_offset;
+#endif
+
+/** bytes of input buffer per run while merging */
+#define READ_BLOCK (1 << 20)
+/** extra bytes record_sort() needs per record besides the record itself */
+#define SORT_OVERHEAD 32
+
+/** a sorted run inside a temporary file */
+typedef struct
+{
+    file_offset offset; /**< first byte */
+    file_offset length; /**< bytes */
+} run;
+
+/** counters of one pass */
+typedef struct
+{
+    unsigned long long bytes_read;
+    unsigned long long bytes_written;
+    size_t runs; /**< runs written by the pass */
+    double seconds;
+} pass_stats;
+
+/** counters of a whole sort */
+typedef struct
+{
+    unsigned passes;
+    pass_stats pass[64];
+} external_sort_stats;
+
+/** buffered reader of one run */
+typedef struct
+{
+    char *buffer;
+    size_t length; /**< valid bytes in buffer */
+    size_t position;
+    file_offset next; /**< next byte of the run to read */
+    file_offset end;
+} run_reader;
+
+/** tells the kernel a file is read front to back, where supported */
+static void advise_sequential(FILE *file)
+{
+#if defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fileno(file), 0, 0, POSIX_FADV_SEQUENTIAL);
+#else
+    (void)file;
+#endif
+}
+
+/**
+ * refills a reader with up to `block` bytes of its run.
+ * @returns 0 on success or at the end of the run, -1 on a read error
+ */
+static int refill(run_reader *reader, FILE *file, size_t block,
+                  pass_stats *stats)
+{
+    file_offset left = reader->end - reader->next;
+    size_t want = left < (file_offset)block ? (size_t)left : block;
+
+    reader->position = 0;
+    reader->length = 0;
+    if (want == 0)
+    {
+        return 0;
+    }
+    if (fseeko(file, reader->next, SEEK_SET) != 0 ||
+        fread(reader->buffer, 1, want, file) != want)
+    {
+        return -1;
+    }
+    reader->length = want;
+    reader->next += (file_offset)want;
+    stats->bytes_read += want;
+    return 0;
+}
+
+/**
+ * Loser tree over k sources. tree[0] holds the overall winner, tree[1..k)
+ * the loser of the match at each internal node; the leaf of source s is
+ * node k + s. Source k is a virtual source that beats every other one and
+ * only fills the tree while it is built.
+ */
+typedef struct
+{
+    size_t k;
+    size_t *tree;
+    uint64_t *key; /**< key of the current record of every source */
+    char *done;    /**< source exhausted: loses to every live one */
+} loser_tree;
+
+/** @returns nonzero if source a's record goes out before source b's */
+static int beats(const loser_tree *t, size_t a, size_t b)
+{
+    if (a == t->k || b == t->k)
+    {
+        return a == t->k;
+    }
+    if (t->done[a] != t->done[b])
+    {
+        return t->done[b];
+    }
+    if (!t->done[a] && t->key[a] != t->key[b])
+    {
+        return t->key[a] < t->key[b];
+    }
+    return a < b; /* earlier runs first keeps the sort stable */
+}
+
+/** replays the matches from the leaf of source s to the root */
+static void replay(loser_tree *t, size_t s)
+{
+    size_t winner = s;
+    for (size_t node = (s + t->k) / 2; node > 0; node /= 2)
+    {
+        if (beats(t, t->tree[node], winner))
+        {
+            size_t loser = winner;
+            winner = t->tree[node];
+            t->tree[node] = loser;
+        }
+    }
+    t->tree[0] = winner;
+}
+
+/** the key of a record as an unsigned integer ordered like the key */
+static uint64_t key_of(const char *record, const record_layout *layout)
+{
+    return record_unsigned_key(record + layout->key_offset, layout->key_type);
+}
+
+/**
+ * merges the runs read by readers[0..k) into `out`, through an output
+ * buffer of `block` bytes.
+ * @returns 0 on success, -1 on an I/O error
+ */
+static int merge_readers(run_reader *readers, loser_tree *t, FILE *in,
+                         FILE *out, const record_layout *layout, size_t block,
+                         char *output, pass_stats *stats)
+{
+    size_t size = layout->size, k = t->k, used = 0;
+
+    for (size_t s = 0; s < k; s++)
+    {
+        if (refill(&readers[s], in, block, stats) != 0)
+        {
+            return -1;
+        }
+        t->done[s] = readers[s].length == 0;
+        if (!t->done[s])
+        {
+            t->key[s] = key_of(readers[s].buffer, layout);
+        }
+    }
+    for (size_t node = 0; node < k; node++)
+    {
+        t->tree[node] = k;
+    }
+    for (size_t s = k; s-- > 0;)
+    {
+        replay(t, s);
+    }
+
+    while (!t->done[t->tree[0]])
+    {
+        size_t s = t->tree[0];
+        run_reader *reader = &readers[s];
+
+        memcpy(output + used, reader->buffer + reader->position, size);
+        used += size;
+        if (used + size > block)
+        {
+            if (fwrite(output, 1, used, out) != used)
+            {
+                return -1;
+            }
+            stats->bytes_written += used;
+            used = 0;
+        }
+
+        reader->position += size;
+        if (reader->position == reader->length &&
+            refill(reader, in, block, stats) != 0)
+        {
+            return -1;
+        }
+        t->done[s] = reader->length == 0;
+        if (!t->done[s])
+        {
+            t->key[s] = key_of(reader->buffer + reader->position, layout);
+        }
+        replay(t, s);
+    }
+
+    if (fwrite(output, 1, used, out) != used)
+    {
+        return -1;
+    }
+    stats->bytes_written += used;
+    return 0;
+}
+
+/**
+ * merges runs[0..k) of `in` into `out`, through k readers with buffers of
+ * `block` bytes and an output buffer of the same size.
+ * @returns 0 on success, -1 on an I/O or allocation error
+ */
+static int merge_group(FILE *in, const run *runs, size_t k, FILE *out,
+                       const record_layout *layout, size_t block,
+                       pass_stats *stats)
+{
+    run_reader *readers = calloc(k, sizeof(run_reader));
+    loser_tree t = {k, calloc(k + 1, sizeof(size_t)),
+                    calloc(k + 1, sizeof(uint64_t)), calloc(k + 1, 1)};
+    char *output = malloc(block);
+    int ready = readers && t.tree && t.key && t.done && output;
+
+    for (size_t s = 0; ready && s < k; s++)
+    {
+        readers[s].buffer = malloc(block);
+        readers[s].next = runs[s].offset;
+        readers[s].end = runs[s].offset + runs[s].length;
+        ready = readers[s].buffer != NULL;
+    }
+
+    int result = ready ? merge_readers(readers, &t, in, out, layout, block,
+                                       output, stats)
+                       : -1;
+
+    for (size_t s = 0; readers && s < k; s++)
+    {
+        free(readers[s].buffer);
+    }
+    free(readers);
+    free(t.tree);
+    free(t.key);
+    free(t.done);
+    free(output);
+    return result;
+}
+
+/** growable array of runs */
+typedef struct
+{
+    run *items;
+    size_t count;
+    size_t capacity;
+} run_list;
+
+/** @returns 0 on success, -1 out of memory */
+static int push_run(run_list *list, file_offset offset, file_offset length)
+{
+    if (list->count == list->capacity)
+    {
+        size_t capacity = list->capacity ? 2 * list->capacity : 16;
+        run *items = realloc(list->items, capacity * sizeof(run));
+        if (!items)
+        {
+            return -1;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count].offset = offset;
+    list->items[list->count].length = length;
+    list->count++;
+    return 0;
+}
+
+/**
+ * pass 0: sorts chunks of `chunk` records of `in` into runs of `temp`, or
+ * straight into `out` when the first chunk holds the whole input.
+ * @returns 0 on success, -1 on an I/O or allocation error or an input that
+ * is not a whole number of records
+ */
+static int make_runs(FILE *in, FILE *out, FILE *temp,
+                     const record_layout *layout, size_t chunk,
+                     run_list *runs, pass_stats *stats)
+{
+    size_t size = layout->size;
+    char *records = malloc(chunk * size);
+    int result = records ? 0 : -1;
+
+    while (result == 0)
+    {
+        size_t got = fread(records, size, chunk, in);
+        if (got == 0)
+        {
+            break;
+        }
+        stats->bytes_read += got * size;
+
+        /* a first chunk that ends the input is the whole output */
+        int last = runs->count == 0 && got < chunk;
+        if (runs->count == 0 && !last)
+        {
+            int c = fgetc(in);
+            last = c == EOF;
+            if (!last)
+            {
+                ungetc(c, in);
+            }
+        }
+        FILE *target = last ? out : temp;
+
+        if (record_sort(records, got, layout) != 0 ||
+            push_run(runs, ftello(target), (file_offset)(got * size)) != 0 ||
+            fwrite(records, size, got, target) != got)
+        {
+            result = -1;
+        }
+        stats->bytes_written += got * size;
+        if (last)
+        {
+            break;
+        }
+    }
+
+    /* fread drops a partial record at the end; refuse such inputs */
+    if (ferror(in) ||
+        (fseeko(in, 0, SEEK_END) == 0 && ftello(in) % (file_offset)size))
+    {
+        result = -1;
+    }
+    stats->runs = runs->count;
+    free(records);
+    return result;
+}
+
+/**
+ * merge passes: merges groups of `fan_in` runs of `*temp` until one run
+ * is left, which the last pass writes to `out`.
+ * @returns 0 on success, -1 on an I/O or allocation error
+ */
+static int merge_passes(FILE **temp, FILE *out, run_list *runs,
+                        const record_layout *layout, size_t fan_in,
+                        size_t block, external_sort_stats *stats)
+{
+    run_list next = {NULL, 0, 0};
+    int result = 0;
+
+    while (result == 0 && runs->count > 1)
+    {
+        if (stats->passes == sizeof(stats->pass) / sizeof(stats->pass[0]))
+        {
+            result = -1;
+            break;
+        }
+        pass_stats *pass = &stats->pass[stats->passes++];
+        clock_t start = clock();
+
+        int final = runs->count <= fan_in;
+        FILE *target = final ? out : tmpfile();
+        if (!target)
+        {
+            result = -1;
+            break;
+        }
+
+        next.count = 0;
+        for (size_t first = 0; result == 0 && first < runs->count;
+             first += fan_in)
+        {
+            size_t k = runs->count - first;
+            k = k < fan_in ? k : fan_in;
+            file_offset offset = ftello(target);
+            result = merge_group(*temp, runs->items + first, k, target,
+                                 layout, block, pass);
+            if (result == 0)
+            {
+                result = push_run(&next, offset, ftello(target) - offset);
+            }
+        }
+
+        fclose(*temp);
+        *temp = final ? NULL : target;
+        run_list swap = *runs;
+        *runs = next;
+        next = swap;
+        pass->runs = runs->count;
+        pass->seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+    free(next.items);
+    return result;
+}
+
+/**
+ * Sorts the records of `in` into `out` using about `memory` bytes.
+ * @returns 0 on success, -1 on an invalid layout, an input whose size is
+ * not a multiple of the record size, or an I/O or allocation error
+ */
+int external_sort(FILE *in, FILE *out, const record_layout *layout,
+                  size_t memory, external_sort_stats *stats)
+{
+    size_t size = layout->size;
+    size_t chunk = size ? memory / (2 * size + SORT_OVERHEAD) : 0;
+
+    memset(stats, 0, sizeof(*stats));
+    if (chunk == 0 || layout->key_type == RECORD_KEY_CUSTOM)
+    {
+        return -1;
+    }
+
+    /* as many runs per merge as the budget has blocks, one for output */
+    size_t block = memory / 3 < READ_BLOCK ? memory / 3 : READ_BLOCK;
+    size_t fan_in = memory / block - 1;
+    block = block < size ? size : block / size * size;
+
+    run_list runs = {NULL, 0, 0};
+    FILE *temp = tmpfile();
+    int result = -1;
+
+    if (temp)
+    {
+        advise_sequential(in);
+        clock_t start = clock();
+        result = make_runs(in, out, temp, layout, chunk, &runs,
+                           &stats->pass[0]);
+        stats->pass[0].seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        stats->passes = 1;
+    }
+    if (result == 0)
+    {
+        result = merge_passes(&temp, out, &runs, layout, fan_in, block, stats);
+    }
+    if (result == 0 && fflush(out) != 0)
+    {
+        result = -1;
+    }
+
+    if (temp)
+    {
+        fclose(temp);
+    }
+    free(runs.items);
+    return result;
+}
+
+/** prints the counters of every pass */
+static void print_stats(const external_sort_stats *stats)
+{
+    for (unsigned p = 0; p < stats->passes; p++)
+    {
+        const pass_stats *pass = &stats->pass[p];
+        printf("pass %u (%s): read %.1f MB, wrote %.1f MB, %zu runs, %.2f s\n",
+               p, p == 0 ? "runs" : "merge", pass->bytes_read / 1e6,
+               pass->bytes_written / 1e6, pass->runs, pass->seconds);
+    }
+}
+
+/** 64 random bits */
+static uint64_t random64(void)
+{
+    uint64_t x = 0;
+    for (int i = 0; i < 4; i++) x = x << 16 ^ (uint64_t)(rand() & 0xffff);
+    return x;
+}
+
+/** record of the self tests */
+typedef struct
+{
+    uint64_t position; /**< index in the input, to check stability */
+    int32_t key;
+    uint32_t padding;
+} test_record;
+
+/** Test function
+ * @param n number of records
+ * @param memory budget of the sort
+ * @param min_passes passes the budget must force
+ */
+static void test(size_t n, size_t memory, unsigned min_passes)
+{
+    FILE *in = tmpfile(), *out = tmpfile();
+    record_layout layout = {sizeof(test_record), offsetof(test_record, key),
+                            RECORD_KEY_INT32, NULL};
+    external_sort_stats stats;
+    assert(in && out);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        test_record r = {i, (int32_t)(random64() % 1000) - 500, 0};
+        fwrite(&r, sizeof(r), 1, in);
+    }
+    rewind(in);
+
+    assert(external_sort(in, out, &layout, memory, &stats) == 0);
+    assert(stats.passes >= min_passes);
+    assert(stats.pass[stats.passes - 1].bytes_written ==
+           n * sizeof(test_record));
+
+    rewind(out);
+    test_record previous, current;
+    size_t count = 0;
+    while (fread(&current, sizeof(current), 1, out) == 1)
+    {
+        if (count > 0)
+        {
+            assert(previous.key < current.key ||
+                   (previous.key == current.key &&
+                    previous.position < current.position));
+        }
+        previous = current;
+        count++;
+    }
+    assert(count == n);
+
+    fclose(in);
+    fclose(out);
+}
+
+/** @returns the record_key_type named `name`, or RECORD_KEY_CUSTOM */
+static record_key_type parse_key_type(const char *name)
+{
+    const char *const names[] = {"u32", "i32", "u64", "i64", "f32", "f64"};
+    const record_key_type types[] = {RECORD_KEY_UINT32, RECORD_KEY_INT32,
+                                     RECORD_KEY_UINT64, RECORD_KEY_INT64,
+                                     RECORD_KEY_FLOAT,  RECORD_KEY_DOUBLE};
+    for (int i = 0; i < 6; i++)
+    {
+        if (strcmp(name, names[i]) == 0)
+        {
+            return types[i];
+        }
+    }
+    return RECORD_KEY_CUSTOM;
+}
+
+/** Main function */
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        srand(time(NULL));
+        test(0, 1 << 16, 1);
+        test(1000, 1 << 16, 1);             /* a single run */
+        test(100000, 1 << 16, 3);           /* many runs, fan-in of 2 */
+        test(300000, 4 << 20, 2);           /* runs merged in one pass */
+        printf("All tests passed\n");
+        return 0;
+    }
+
+    size_t megabytes = 256;
+    record_layout layout = {8, 0, RECORD_KEY_UINT64, NULL};
+    int i = 1;
+    for (; i + 1 < argc && argv[i][0] == '-'; i += 2)
+    {
+        if (strcmp(argv[i], "-m") == 0)
+            megabytes = strtoul(argv[i + 1], NULL, 0);
+        else if (strcmp(argv[i], "-r") == 0)
+            layout.size = strtoul(argv[i + 1], NULL, 0);
+        else if (strcmp(argv[i], "-k") == 0)
+            layout.key_offset = strtoul(argv[i + 1], NULL, 0);
+        else if (strcmp(argv[i], "-t") == 0)
+            layout.key_type = parse_key_type(argv[i + 1]);
+        else
+            break;
+    }
+
+    int wide = layout.key_type == RECORD_KEY_UINT64 ||
+               layout.key_type == RECORD_KEY_INT64 ||
+               layout.key_type == RECORD_KEY_DOUBLE;
+    if (argc - i != 2 || layout.key_type == RECORD_KEY_CUSTOM ||
+        layout.key_offset + (wide ? 8 : 4) > layout.size)
+    {
+        fprintf(stderr,
+                "usage: %s [-m megabytes] [-r record bytes] [-k key offset]\n"
+                "       [-t u32|i32|u64|i64|f32|f64] input output\n",
+                argv[0]);
+        return 1;
+    }
+
+    FILE *in = fopen(argv[i], "rb"), *out = fopen(argv[i + 1], "wb");
+    if (!in || !out)
+    {
+        perror("external_sort");
+        return 1;
+    }
+
+    external_sort_stats stats;
+    int result = external_sort(in, out, &layout, megabytes << 20, &stats);
+    print_stats(&stats);
+    fclose(in);
+    if (fclose(out) != 0 || result != 0)
+    {
+        fprintf(stderr, "external_sort: sort failed\n");
+        return 1;
+    }
+    return 0;
+}
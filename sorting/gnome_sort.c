@@ -1,25 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-void sort(int *numbers, int size)
-{
-    int pos = 0;
-    while (pos < size)
-    {
-        if (numbers[pos] >= numbers[pos - 1])
-            pos++;
-        else
-        {
-            int tmp = numbers[pos - 1];
-            numbers[pos - 1] = numbers[pos];
-            numbers[pos] = tmp;
-            pos--;
+#include "gnome_sort.h"
 
-            if (pos == 0)
-                pos = 1;
-        }
-    }
-}
+/* sorts numbers by the gnome sort of gnome_sort.h */
+void sort(int *numbers, int size) { gnome_sort_int(numbers, (size_t)size); }
 
 void display(int *array, int n)
 {
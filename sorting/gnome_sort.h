@@ -0,0 +1,40 @@
+/**
+ * @file
+ * @brief [Gnome sort](https://en.wikipedia.org/wiki/Gnome_sort)
+ *
+ * `DEFINE_GNOME_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `gnome_sort_int` is provided for `int`.
+ *
+ * The gnome steps forward while neighbours are in order and otherwise swaps
+ * them and steps back: an insertion sort by swaps. O(n²) comparisons.
+ */
+#ifndef GNOME_SORT_H
+#define GNOME_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`, a gnome sort. */
+#define DEFINE_GNOME_SORT(name, type, less, swap)                              \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        size_t pos = 1;                                                        \
+        while (pos < n)                                                        \
+        {                                                                      \
+            if (!less(&a[pos], &a[pos - 1]))                                   \
+            {                                                                  \
+                pos++;                                                         \
+            }                                                                  \
+            else                                                               \
+            {                                                                  \
+                swap(type, &a[pos - 1], &a[pos]);                              \
+                pos = pos > 1 ? pos - 1 : 1;                                   \
+            }                                                                  \
+        }                                                                      \
+    }
+
+DEFINE_GNOME_SORT(gnome_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* GNOME_SORT_H */
@@ -0,0 +1,49 @@
+/**
+ * @file
+ * @brief [Heapsort](https://en.wikipedia.org/wiki/Heapsort)
+ *
+ * `DEFINE_HEAP_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `heap_sort_int` is provided for `int`.
+ *
+ * The array is made a binary max-heap bottom up, then the root is swapped
+ * behind the heap and sifted down again until the heap is empty.
+ * O(n log n) comparisons on every input, in place; not stable.
+ */
+#ifndef HEAP_SORT_H
+#define HEAP_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`, a heapsort. */
+#define DEFINE_HEAP_SORT(name, type, less, swap)                               \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        for (size_t start = n / 2, end = n; end > 1;)                          \
+        {                                                                      \
+            if (start > 0)                                                     \
+            {                                                                  \
+                start--; /* building the heap */                               \
+            }                                                                  \
+            else                                                               \
+            {                                                                  \
+                end--; /* moving the root behind the heap */                   \
+                swap(type, &a[0], &a[end]);                                    \
+            }                                                                  \
+            for (size_t i = start, child; (child = 2 * i + 1) < end;           \
+                 i = child)                                                    \
+            {                                                                  \
+                if (child + 1 < end && less(&a[child], &a[child + 1]))         \
+                    child++;                                                   \
+                if (!less(&a[i], &a[child]))                                   \
+                    break;                                                     \
+                swap(type, &a[i], &a[child]);                                  \
+            }                                                                  \
+        }                                                                      \
+    }
+
+DEFINE_HEAP_SORT(heap_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* HEAP_SORT_H */
@@ -2,32 +2,24 @@
  * @file
  * @brief [Insertion sort](https://en.wikipedia.org/wiki/Insertion_sort)
  * algorithm implementation.
+ *
+ * The sort lives in insertion_sort.h; this program tests it.
  */
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 
+#include "insertion_sort.h"
+
 /**
- * Insertion sort algorithm implements
+ * Sorts arr with the insertion sort of insertion_sort.h
  * @param arr array to be sorted
  * @param size size of array
  */
 void insertionSort(int *arr, int size)
 {
-    for (int i = 1; i < size; i++)
-    {
-        int j = i - 1;
-        int key = arr[i];
-        /* Move all elements greater than key to one position */
-        while (j >= 0 && key < arr[j])
-        {
-            arr[j + 1] = arr[j];
-            j = j - 1;
-        }
-        /* Find a correct position for key */
-        arr[j + 1] = key;
-    }
+    insertion_sort_int(arr, (size_t)size);
 }
 
 /** Test function
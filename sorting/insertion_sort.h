@@ -0,0 +1,35 @@
+/**
+ * @file
+ * @brief [Insertion sort](https://en.wikipedia.org/wiki/Insertion_sort)
+ *
+ * `DEFINE_INSERTION_SORT(name, type, less)` defines
+ * `static inline void name(type *a, size_t n)` with the ordering hook of
+ * sort_hooks.h. `insertion_sort_int` is provided for `int`.
+ *
+ * Each element is shifted left past the larger elements of the sorted
+ * prefix before it. Stable, O(n²) comparisons, but O(n + d) for an input
+ * with d inversions, so nearly sorted input is fast.
+ */
+#ifndef INSERTION_SORT_H
+#define INSERTION_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`. */
+#define DEFINE_INSERTION_SORT(name, type, less)                                \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        for (size_t i = 1; i < n; i++)                                         \
+        {                                                                      \
+            type key = a[i];                                                   \
+            size_t j = i;                                                      \
+            for (; j > 0 && less(&key, &a[j - 1]); j--) a[j] = a[j - 1];       \
+            a[j] = key;                                                        \
+        }                                                                      \
+    }
+
+DEFINE_INSERTION_SORT(insertion_sort_int, int, SORT_LESS)
+
+#endif /* INSERTION_SORT_H */
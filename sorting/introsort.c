@@ -0,0 +1,229 @@
+/**
+ * @file
+ * @brief Tests and benchmark of the introsort of introsort.h.
+ *
+ * usage: ./introsort [number of values]
+ * runs the self tests, then prints the nanoseconds per element taken by
+ * introsort, qsort(), the merge sort of merge_sort.h and the last-element
+ * pivot quicksort of quick_sort.c on random, sorted, reversed, organ-pipe
+ * and many-duplicates inputs of that size (default 1000000). The
+ * quicksort is quadratic on all but random input and is only run on those
+ * above ::QUADRATIC_LIMIT elements.
+ */
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "introsort.h"
+#include "merge_sort.h"
+
+/** larger non-random inputs are not given to the quadratic quicksort */
+#define QUADRATIC_LIMIT 20000
+
+/** input distributions */
+typedef enum
+{
+    RANDOM,
+    SORTED,
+    REVERSED,
+    ORGAN_PIPE,
+    DUPLICATES,
+    DISTRIBUTIONS
+} distribution;
+
+static const char *const distribution_names[] = {
+    "random", "sorted", "reversed", "organ pipe", "duplicates"};
+
+/** fills a with n values of the given distribution */
+static void fill(int *a, size_t n, distribution d)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        switch (d)
+        {
+        case RANDOM:
+            a[i] = rand() - RAND_MAX / 2;
+            break;
+        case SORTED:
+            a[i] = (int)i;
+            break;
+        case REVERSED:
+            a[i] = (int)(n - i);
+            break;
+        case ORGAN_PIPE:
+            a[i] = (int)(i < n / 2 ? i : n - i);
+            break;
+        default:
+            a[i] = rand() % 16;
+            break;
+        }
+    }
+}
+
+/** @cond the quicksort of quick_sort.c */
+static void swap(int *first, int *second)
+{
+    int temp = *first;
+    *first = *second;
+    *second = temp;
+}
+
+static int partition(int arr[], int lower, int upper)
+{
+    int i = (lower - 1);
+    int pivot = arr[upper];
+    for (int j = lower; j < upper; j++)
+    {
+        if (arr[j] <= pivot)
+        {
+            i++;
+            swap(&arr[i], &arr[j]);
+        }
+    }
+    swap(&arr[i + 1], &arr[upper]);
+    return (i + 1);
+}
+
+static void quickSort(int arr[], int lower, int upper)
+{
+    if (upper > lower)
+    {
+        int partitionIndex = partition(arr, lower, upper);
+        quickSort(arr, lower, partitionIndex - 1);
+        quickSort(arr, partitionIndex + 1, upper);
+    }
+}
+/** @endcond */
+
+DEFINE_MERGE_SORT(merge_sort_int, int, MERGE_SORT_LESS)
+
+/** comparison for qsort() */
+static int compare_int(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/** Test function
+ * @param n number of values of every distribution to sort
+ */
+static void test(size_t n)
+{
+    int *a = malloc(n * sizeof(int)), *b = malloc(n * sizeof(int));
+    int *c = malloc(n * sizeof(int));
+    assert(n == 0 || (a && b && c));
+
+    for (int d = 0; d < DISTRIBUTIONS; d++)
+    {
+        fill(a, n, (distribution)d);
+        memcpy(b, a, n * sizeof(int));
+        memcpy(c, a, n * sizeof(int));
+        introsort_int(a, n);
+        qsort(b, n, sizeof(int), compare_int);
+        assert(n == 0 || memcmp(a, b, n * sizeof(int)) == 0);
+        /* the depth-limit fallback, with its sorting network leaf */
+        introsort_int_heapsort(c, n);
+        assert(n == 0 || memcmp(c, b, n * sizeof(int)) == 0);
+    }
+
+    free(a);
+    free(b);
+    free(c);
+}
+
+/** builds an input that sends a median-of-3 quicksort to its worst case */
+static void test_depth_limit(void)
+{
+    const size_t n = 100000;
+    int *a = malloc(n * sizeof(int));
+    assert(a);
+
+    /* every partition of a sawtooth-with-spikes input splits unevenly */
+    for (size_t i = 0; i < n; i++)
+    {
+        a[i] = (int)(i % 2 ? i : n - i) * (i % 3 ? 1 : -1);
+    }
+    introsort_int(a, n);
+    for (size_t i = 1; i < n; i++)
+    {
+        assert(a[i - 1] <= a[i]);
+    }
+    free(a);
+}
+
+/** @returns seconds elapsed since start */
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/** Main function */
+int main(int argc, char *argv[])
+{
+    srand(time(NULL));
+
+    const size_t sizes[] = {0, 1, 2, 3, 24, 25, 64, 65, 128, 129, 1000, 100000};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        test(sizes[i]);
+    }
+    test_depth_limit();
+    printf("All tests passed\n\n");
+
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+    int *input = malloc(n * sizeof(int)), *a = malloc(n * sizeof(int));
+    if (n == 0 || !input || !a)
+    {
+        printf("Can't Malloc! Please try again.");
+        return 1;
+    }
+
+    printf("ns per element, %zu elements\n", n);
+    printf("%-12s %10s %10s %10s %10s\n", "input", "introsort", "qsort",
+           "merge sort", "quickSort");
+    for (int d = 0; d < DISTRIBUTIONS; d++)
+    {
+        double ns[4];
+        fill(input, n, (distribution)d);
+
+        for (int sort = 0; sort < 4; sort++)
+        {
+            if (sort == 3 && d != RANDOM && n > QUADRATIC_LIMIT)
+            {
+                ns[sort] = -1;
+                continue;
+            }
+            memcpy(a, input, n * sizeof(int));
+            clock_t start = clock();
+            switch (sort)
+            {
+            case 0:
+                introsort_int(a, n);
+                break;
+            case 1:
+                qsort(a, n, sizeof(int), compare_int);
+                break;
+            case 2:
+                merge_sort_int(a, n);
+                break;
+            default:
+                quickSort(a, 0, (int)n - 1);
+                break;
+            }
+            ns[sort] = seconds_since(start) * 1e9 / n;
+        }
+
+        printf("%-12s %10.1f %10.1f %10.1f ", distribution_names[d], ns[0],
+               ns[1], ns[2]);
+        if (ns[3] < 0)
+            printf("%10s\n", "skipped");
+        else
+            printf("%10.1f\n", ns[3]);
+    }
+
+    free(input);
+    free(a);
+    return 0;
+}
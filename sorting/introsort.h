@@ -0,0 +1,368 @@
+/**
+ * @file
+ * @brief [Introsort](https://en.wikipedia.org/wiki/Introsort) with ninther
+ * pivots and branchless block partitioning.
+ *
+ * `DEFINE_INTROSORT(name, type, less)` defines
+ * `static inline void name(type *a, size_t n)` sorting `n` elements of
+ * `type` by the strict ordering `less(x, y)`, which receives two
+ * `const type *`. `introsort_int` is provided for `int`.
+ * `DEFINE_INTROSORT_LEAF` takes the sort of small ranges as well;
+ * `introsort_int` sorts them with the sorting networks of sort_small.h.
+ * `DEFINE_INTROSORT_HOOKS` also takes the `swap` hook of sort_hooks.h,
+ * through which every exchange of two elements goes; the cyclic
+ * permutations of block partitioning move elements without it.
+ *
+ * Quicksort picks the median of three elements as pivot, or for more than
+ * ::INTROSORT_NINTHER elements the median of three such medians (Tukey's
+ * ninther), so sorted and reversed inputs split evenly.
+ * Partitioning follows BlockQuicksort (Edelkamp and Weiss): blocks of
+ * ::INTROSORT_BLOCK elements from each end are compared against the pivot
+ * and the offsets of misplaced ones are recorded without branching, then
+ * swapped pairwise, so comparisons cause no mispredictions. When a range's
+ * pivot equals the pivot just left of it, the elements equal to it are
+ * split off in one pass, which makes many duplicates cheap. After a split
+ * worse than 1 to 7, a few elements of both sides are swapped to break up
+ * the input's pattern, as in pdqsort. The smaller side is recursed into,
+ * ranges of at most ::INTROSORT_CUTOFF elements are insertion sorted (or
+ * given to the leaf sort), and a range still being partitioned at a depth
+ * of 2 log2 n is heapsorted, bounding the worst case at O(n log n). The
+ * heapsort stops when the heap is small enough for the leaf sort.
+ *
+ * The sort is not stable.
+ */
+#ifndef INTROSORT_H
+#define INTROSORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sort_hooks.h"
+#include "sort_small.h"
+
+/** ranges of at most this many elements are insertion sorted */
+#define INTROSORT_CUTOFF 24
+/** ranges larger than this pick a ninther pivot */
+#define INTROSORT_NINTHER 128
+/** introsort_int sorts ranges of at most this many by sort_small_int32() */
+#define INTROSORT_NETWORK_CUTOFF SORT_SMALL_MAX
+/** elements examined per side before swapping misplaced ones */
+#define INTROSORT_BLOCK 64
+
+/** ascending order of plain arithmetic types, for `DEFINE_INTROSORT` */
+#define INTROSORT_LESS(x, y) (*(x) < *(y))
+
+/** @returns 2 floor(log2 n), the partitioning depth before heapsort */
+static inline int introsort_depth_limit(size_t n)
+{
+    int depth = 0;
+    while (n > 1)
+    {
+        n >>= 1;
+        depth += 2;
+    }
+    return depth;
+}
+
+/** Defines `static inline void name(type *a, size_t n)`, an introsort. */
+#define DEFINE_INTROSORT(name, type, less)                                     \
+    DEFINE_INTROSORT_LEAF(name, type, less, name##_insertion, INTROSORT_CUTOFF)
+
+/**
+ * Defines the introsort `name` like `DEFINE_INTROSORT`, but with ranges of
+ * at most `cutoff` elements sorted by `leaf(type *a, size_t n)`, e.g. a
+ * sorting network of sort_small.h.
+ */
+#define DEFINE_INTROSORT_LEAF(name, type, less, leaf, cutoff)                  \
+    DEFINE_INTROSORT_HOOKS(name, type, less, SORT_SWAP, leaf, cutoff)
+
+/**
+ * Defines the introsort `name` like `DEFINE_INTROSORT_LEAF`, with two
+ * elements exchanged by `swap(type, x, y)`.
+ */
+#define DEFINE_INTROSORT_HOOKS(name, type, less, swap, leaf, cutoff)           \
+    static inline void name##_swap(type *x, type *y) { swap(type, x, y); }     \
+                                                                               \
+    /* orders *x <= *y <= *z */                                                \
+    static inline void name##_sort3(type *x, type *y, type *z)                 \
+    {                                                                          \
+        if (less(y, x))                                                        \
+            name##_swap(x, y);                                                 \
+        if (less(z, y))                                                        \
+        {                                                                      \
+            name##_swap(y, z);                                                 \
+            if (less(y, x))                                                    \
+                name##_swap(x, y);                                             \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void name##_insertion(type *a, size_t n)                     \
+    {                                                                          \
+        for (size_t i = 1; i < n; i++)                                         \
+        {                                                                      \
+            type key = a[i];                                                   \
+            size_t j = i;                                                      \
+            for (; j > 0 && less(&key, &a[j - 1]); j--) a[j] = a[j - 1];       \
+            a[j] = key;                                                        \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void name##_sift_down(type *a, size_t root, size_t n)        \
+    {                                                                          \
+        type value = a[root];                                                  \
+        for (size_t child; (child = 2 * root + 1) < n; root = child)           \
+        {                                                                      \
+            if (child + 1 < n && less(&a[child], &a[child + 1]))               \
+                child++;                                                       \
+            if (!less(&value, &a[child]))                                      \
+                break;                                                         \
+            a[root] = a[child];                                                \
+        }                                                                      \
+        a[root] = value;                                                       \
+    }                                                                          \
+                                                                               \
+    /* the last `cutoff` elements left in the heap are sorted by leaf */       \
+    static inline void name##_heapsort(type *a, size_t n)                      \
+    {                                                                          \
+        for (size_t i = n / 2; i-- > 0;) name##_sift_down(a, i, n);            \
+        for (size_t i = n; i-- > (cutoff);)                                    \
+        {                                                                      \
+            name##_swap(&a[0], &a[i]);                                         \
+            name##_sift_down(a, 0, i);                                         \
+        }                                                                      \
+        leaf(a, n < (cutoff) ? n : (cutoff));                                  \
+    }                                                                          \
+                                                                               \
+    /* moves the pivot to a[0]; leaves an element >= it among the last 3 */    \
+    static inline void name##_choose_pivot(type *a, size_t n)                  \
+    {                                                                          \
+        size_t mid = n / 2;                                                    \
+        if (n > INTROSORT_NINTHER)                                             \
+        {                                                                      \
+            name##_sort3(&a[0], &a[mid], &a[n - 1]);                           \
+            name##_sort3(&a[1], &a[mid - 1], &a[n - 2]);                       \
+            name##_sort3(&a[2], &a[mid + 1], &a[n - 3]);                       \
+            name##_sort3(&a[mid - 1], &a[mid], &a[mid + 1]);                   \
+            name##_swap(&a[0], &a[mid]);                                       \
+        }                                                                      \
+        else                                                                   \
+            name##_sort3(&a[mid], &a[0], &a[n - 1]);                           \
+    }                                                                          \
+                                                                               \
+    /*                                                                         \
+     * partitions a[1..n) around the pivot a[0] into elements less than it     \
+     * and elements not less, then puts the pivot between them.                \
+     * returns the final position of the pivot                                 \
+     */                                                                        \
+    static inline size_t name##_partition(type *a, size_t n)                   \
+    {                                                                          \
+        type pivot = a[0];                                                     \
+        type *first = a, *last = a + n;                                        \
+                                                                               \
+        /* choose_pivot left a sentinel that stops this scan */                \
+        while ((++first, less(first, &pivot)))                                 \
+            ;                                                                  \
+        if (first - 1 == a)                                                    \
+            while (first < last && (--last, !less(last, &pivot)))              \
+                ;                                                              \
+        else                                                                   \
+            while ((--last, !less(last, &pivot)))                              \
+                ;                                                              \
+                                                                               \
+        if (first < last)                                                      \
+        {                                                                      \
+            unsigned char offsets_l[INTROSORT_BLOCK];                          \
+            unsigned char offsets_r[INTROSORT_BLOCK];                          \
+            type *base_l, *base_r;                                             \
+            size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;             \
+                                                                               \
+            name##_swap(first, last);                                          \
+            base_l = ++first;                                                  \
+            base_r = last;                                                     \
+            while (first < last)                                               \
+            {                                                                  \
+                /* refill whichever offset buffers are empty */                \
+                size_t unknown = (size_t)(last - first);                       \
+                size_t split_l =                                               \
+                    num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;     \
+                size_t split_r = num_r == 0 ? unknown - split_l : 0;           \
+                if (split_l > INTROSORT_BLOCK)                                 \
+                    split_l = INTROSORT_BLOCK;                                 \
+                if (split_r > INTROSORT_BLOCK)                                 \
+                    split_r = INTROSORT_BLOCK;                                 \
+                                                                               \
+                for (size_t i = 0; i < split_l; i++, first++)                  \
+                {                                                              \
+                    offsets_l[num_l] = (unsigned char)i;                       \
+                    num_l += !less(first, &pivot);                             \
+                }                                                              \
+                for (size_t i = 1; i <= split_r; i++)                          \
+                {                                                              \
+                    offsets_r[num_r] = (unsigned char)i;                       \
+                    last--;                                                    \
+                    num_r += less(last, &pivot);                               \
+                }                                                              \
+                                                                               \
+                /* swap misplaced pairs through a cyclic permutation */        \
+                size_t num = num_l < num_r ? num_l : num_r;                    \
+                if (num > 0)                                                   \
+                {                                                              \
+                    const unsigned char *ol = offsets_l + start_l;             \
+                    const unsigned char *orr = offsets_r + start_r;            \
+                    type *l = base_l + ol[0], *r = base_r - orr[0];            \
+                    type tmp = *l;                                             \
+                    *l = *r;                                                   \
+                    for (size_t i = 1; i < num; i++)                           \
+                    {                                                          \
+                        l = base_l + ol[i];                                    \
+                        *r = *l;                                               \
+                        r = base_r - orr[i];                                   \
+                        *l = *r;                                               \
+                    }                                                          \
+                    *r = tmp;                                                  \
+                }                                                              \
+                num_l -= num;                                                  \
+                num_r -= num;                                                  \
+                start_l += num;                                                \
+                start_r += num;                                                \
+                if (num_l == 0)                                                \
+                {                                                              \
+                    start_l = 0;                                               \
+                    base_l = first;                                            \
+                }                                                              \
+                if (num_r == 0)                                                \
+                {                                                              \
+                    start_r = 0;                                               \
+                    base_r = last;                                             \
+                }                                                              \
+            }                                                                  \
+                                                                               \
+            /* one side still has misplaced elements: move them across */      \
+            if (num_l)                                                         \
+            {                                                                  \
+                while (num_l--)                                                \
+                    name##_swap(base_l + offsets_l[start_l + num_l], --last);  \
+                first = last;                                                  \
+            }                                                                  \
+            if (num_r)                                                         \
+            {                                                                  \
+                while (num_r--)                                                \
+                    name##_swap(base_r - offsets_r[start_r + num_r], first++); \
+                last = first;                                                  \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        type *pivot_pos = first - 1;                                           \
+        a[0] = *pivot_pos;                                                     \
+        *pivot_pos = pivot;                                                    \
+        return (size_t)(pivot_pos - a);                                        \
+    }                                                                          \
+                                                                               \
+    /*                                                                         \
+     * a[-1] equals the pivot a[0] and no element is less: moves elements      \
+     * equal to the pivot to the front. returns the last position holding one  \
+     */                                                                        \
+    static inline size_t name##_partition_equal(type *a, size_t n)             \
+    {                                                                          \
+        type pivot = a[0];                                                     \
+        type *first = a, *last = a + n;                                        \
+                                                                               \
+        while ((--last, less(&pivot, last)))                                   \
+            ;                                                                  \
+        if (last + 1 == a + n)                                                 \
+            while (first < last && (++first, !less(&pivot, first)))            \
+                ;                                                              \
+        else                                                                   \
+            while ((++first, !less(&pivot, first)))                            \
+                ;                                                              \
+        while (first < last)                                                   \
+        {                                                                      \
+            name##_swap(first, last);                                          \
+            while ((--last, less(&pivot, last)))                               \
+                ;                                                              \
+            while ((++first, !less(&pivot, first)))                            \
+                ;                                                              \
+        }                                                                      \
+        a[0] = *last;                                                          \
+        *last = pivot;                                                         \
+        return (size_t)(last - a);                                             \
+    }                                                                          \
+                                                                               \
+    /* swaps a few elements of a[0..n) to new places, as pdqsort does */       \
+    static inline void name##_break_pattern(type *a, size_t n)                 \
+    {                                                                          \
+        if (n < INTROSORT_CUTOFF)                                              \
+            return;                                                            \
+        size_t q = n / 4;                                                      \
+        name##_swap(&a[0], &a[q]);                                             \
+        name##_swap(&a[n - 1], &a[n - q]);                                     \
+        if (n > INTROSORT_NINTHER)                                             \
+        {                                                                      \
+            name##_swap(&a[1], &a[q + 1]);                                     \
+            name##_swap(&a[2], &a[q + 2]);                                     \
+            name##_swap(&a[n - 2], &a[n - q - 1]);                             \
+            name##_swap(&a[n - 3], &a[n - q - 2]);                             \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static void name##_loop(type *a, size_t n, int depth, int leftmost)        \
+    {                                                                          \
+        while (n > (cutoff))                                                   \
+        {                                                                      \
+            if (depth == 0)                                                    \
+            {                                                                  \
+                name##_heapsort(a, n);                                         \
+                return;                                                        \
+            }                                                                  \
+            depth--;                                                           \
+                                                                               \
+            name##_choose_pivot(a, n);                                         \
+            /* a[-1] was a pivot no greater than anything here */              \
+            if (!leftmost && !less(&a[-1], &a[0]))                             \
+            {                                                                  \
+                size_t p = name##_partition_equal(a, n) + 1;                   \
+                a += p;                                                        \
+                n -= p;                                                        \
+                continue;                                                      \
+            }                                                                  \
+                                                                               \
+            size_t p = name##_partition(a, n);                                 \
+            size_t l = p, r = n - p - 1;                                       \
+            /* an uneven split: move elements to break up the pattern */       \
+            if (l < n / 8 || r < n / 8)                                        \
+            {                                                                  \
+                name##_break_pattern(a, l);                                    \
+                name##_break_pattern(a + p + 1, r);                            \
+            }                                                                  \
+            if (l < r)                                                         \
+            {                                                                  \
+                name##_loop(a, p, depth, leftmost);                            \
+                a += p + 1;                                                    \
+                n -= p + 1;                                                    \
+                leftmost = 0;                                                  \
+            }                                                                  \
+            else                                                               \
+            {                                                                  \
+                name##_loop(a + p + 1, n - p - 1, depth, 0);                   \
+                n = p;                                                         \
+            }                                                                  \
+        }                                                                      \
+        leaf(a, n);                                                            \
+    }                                                                          \
+                                                                               \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        name##_loop(a, n, introsort_depth_limit(n), 1);                        \
+    }
+
+/** @cond leaf of introsort_int; int is int32_t wherever this compiles */
+static inline void introsort_int_leaf(int *a, size_t n)
+{
+    sort_small_int32((int32_t *)a, n);
+}
+/** @endcond */
+
+DEFINE_INTROSORT_LEAF(introsort_int, int, INTROSORT_LESS, introsort_int_leaf,
+                      INTROSORT_NETWORK_CUTOFF)
+
+#endif /* INTROSORT_H */
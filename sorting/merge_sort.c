@@ -2,138 +2,139 @@
  * @file
  * @brief Implementation of [merge
  * sort](https://en.wikipedia.org/wiki/Merge_sort) algorithm
+ *
+ * The sort itself lives in merge_sort.h: one scratch buffer for the whole
+ * sort, OpenMP tasks and merge-path merges. Here runs of up to 64 integers
+ * are sorted by the sorting networks of sort_small.h.
+ *
+ * usage: ./merge_sort [number of values]
+ * runs the self tests, then times the sort of that many random integers.
  */
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+
+#include "merge_sort.h"
+#include "sort_small.h"
+
+/** runs of at most this many values are sorted by a sorting network */
+#define MERGE_SORT_NETWORK_CUTOFF SORT_SMALL_MAX
 
 /**
  * @addtogroup sorting Sorting algorithms
  * @{
  */
-/** Swap two integer variables
- * @param [in,out] a pointer to first variable
- * @param [in,out] b pointer to second variable
- */
-void swap(int *a, int *b)
+/** sorts runs of merge_sort_int; int is int32_t wherever this compiles */
+static inline void merge_sort_int_leaf(int *a, size_t n)
 {
-    int t;
-    t = *a;
-    *a = *b;
-    *b = t;
+    sort_small_int32((int32_t *)a, n);
 }
+DEFINE_MERGE_SORT_LEAF(merge_sort_int, int, MERGE_SORT_LESS,
+                       merge_sort_int_leaf, MERGE_SORT_NETWORK_CUTOFF)
 
-/**
- * @brief Perform merge of segments.
- *
+/** Merge sort algorithm implementation
  * @param a array to sort
- * @param l left index for merge
- * @param r right index for merge
- * @param n total number of elements in the array
+ * @param n number of elements in the array
+ * @param l index to sort from
+ * @param r index to sort till
  */
-void merge(int *a, int l, int r, int n)
+void merge_sort(int *a, int n, int l, int r)
 {
-    int *b = (int *)malloc(n * sizeof(int)); /* dynamic memory must be freed */
-    if (b == NULL)
+    (void)n;
+    if (l < r && merge_sort_int(a + l, (size_t)(r - l) + 1) != 0)
     {
         printf("Can't Malloc! Please try again.");
         exit(EXIT_FAILURE);
     }
-    int c = l;
-    int p1, p2;
-    p1 = l;
-    p2 = ((l + r) / 2) + 1;
-    while ((p1 < ((l + r) / 2) + 1) && (p2 < r + 1))
-    {
-        if (a[p1] <= a[p2])
-        {
-            b[c++] = a[p1];
-            p1++;
-        }
-        else
-        {
-            b[c++] = a[p2];
-            p2++;
-        }
-    }
-
-    if (p2 == r + 1)
-    {
-        while ((p1 < ((l + r) / 2) + 1))
-        {
-            b[c++] = a[p1];
-            p1++;
-        }
-    }
-    else
-    {
-        while ((p2 < r + 1))
-        {
-            b[c++] = a[p2];
-            p2++;
-        }
-    }
+}
+/** @} */
 
-    for (c = l; c < r + 1; c++) a[c] = b[c];
+/** record sorted by key only, to check stability */
+typedef struct
+{
+    int key;
+    int position; /**< index before sorting */
+} record;
 
-    free(b);
-}
+/** orders records by key */
+#define RECORD_LESS(x, y) ((x)->key < (y)->key)
+DEFINE_MERGE_SORT(merge_sort_record, record, RECORD_LESS)
 
-/** Merge sort algorithm implementation
- * @param a array to sort
- * @param n number of elements in the array
- * @param l index to sort from
- * @param r index to sort till
+/** Test function
+ * @param size number of random values to sort
  */
-void merge_sort(int *a, int n, int l, int r)
+static void test(size_t size)
 {
-    if (r - l == 1)
+    int *arr = (int *)malloc(size * sizeof(int));
+    record *records = (record *)malloc(size * sizeof(record));
+    assert(size == 0 || (arr && records));
+
+    for (size_t i = 0; i < size; i++)
     {
-        if (a[l] > a[r])
-            swap(&a[l], &a[r]);
+        arr[i] = rand() - RAND_MAX / 2; /* signed random numbers */
+        records[i].key = rand() % 100;  /* many equal keys */
+        records[i].position = (int)i;
     }
-    else if (l != r)
+
+    assert(merge_sort_int(arr, size) == 0);
+    assert(merge_sort_record(records, size) == 0);
+    for (size_t i = 1; i < size; ++i)
     {
-        merge_sort(a, n, l, (l + r) / 2);
-        merge_sort(a, n, ((l + r) / 2) + 1, r);
-        merge(a, l, r, n);
+        assert(arr[i - 1] <= arr[i]);
+        assert(records[i - 1].key <= records[i].key);
+        /* equal keys keep their original order */
+        assert(records[i - 1].key < records[i].key ||
+               records[i - 1].position < records[i].position);
     }
 
-    /* no change if l == r */
+    free(arr);
+    free(records);
 }
-/** @} */
 
 /** Main function */
-int main(void)
+int main(int argc, char *argv[])
 {
-    int *a, n, i;
-    printf("Enter Array size: ");
-    scanf("%d", &n);
-    if (n <= 0) /* exit program if arraysize is not greater than 0 */
-    {
-        printf("Array size must be Greater than 0!\n");
-        return 1;
-    }
-    a = (int *)malloc(n * sizeof(int));
-    if (a == NULL) /* exit program if can't malloc memory */
-    {
-        printf("Can't Malloc! Please try again.");
-        return 1;
-    }
-    for (i = 0; i < n; i++)
+    srand(time(NULL));
+
+    const size_t sizes[] = {0,     1,     2,      24,     25, 64, 65, 1000,
+                            16383, 16384, 100000, 1 << 20};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
     {
-        printf("Enter number[%d]: ", i);
-        scanf("%d", &a[i]);
+        test(sizes[i]);
     }
 
-    merge_sort(a, n, 0, n - 1);
-    printf("Sorted Array: ");
-    for (i = 0; i < n; i++)
+    int a[] = {5, -1, 3, 3, 0, 9, -7};
+    merge_sort(a, 7, 1, 5); /* sorts only a[1..5] */
+    assert(a[0] == 5 && a[1] == -1 && a[2] == 0 && a[5] == 9 && a[6] == -7);
+    printf("All tests passed\n");
+
+    if (argc > 1)
     {
-        printf("%d ", a[i]);
-    }
-    printf("\n");
+        size_t n = strtoul(argv[1], NULL, 0);
+        int *arr = (int *)malloc(n * sizeof(int));
+        if (!arr)
+        {
+            printf("Can't Malloc! Please try again.");
+            return 1;
+        }
+        for (size_t i = 0; i < n; i++) arr[i] = rand();
 
-    free(a);
+#ifdef _OPENMP
+        double start = omp_get_wtime();
+        merge_sort_int(arr, n);
+        double seconds = omp_get_wtime() - start;
+        int threads = omp_get_max_threads();
+#else
+        clock_t start = clock();
+        merge_sort_int(arr, n);
+        double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        int threads = 1;
+#endif
+        printf("%zu integers sorted in %.3f s with %d threads\n", n, seconds,
+               threads);
+        free(arr);
+    }
 
     return 0;
 }
@@ -0,0 +1,206 @@
+/**
+ * @file
+ * @brief Stable, allocation-free [merge
+ * sort](https://en.wikipedia.org/wiki/Merge_sort) with OpenMP tasks.
+ *
+ * `DEFINE_MERGE_SORT(name, type, less)` defines
+ * `static inline int name(type *a, size_t n)` sorting `n` elements of `type`
+ * by the strict ordering `less(x, y)`, which receives two `const type *`.
+ *
+ * The sort allocates one scratch buffer of `n` elements up front. Every
+ * level of the recursion merges from one buffer into the other, so no
+ * element is copied back. Runs of at most ::MERGE_SORT_CUTOFF elements are
+ * insertion sorted, or sorted by the leaf sort of `DEFINE_MERGE_SORT_LEAF`,
+ * such as a sorting network of sort_small.h. With OpenMP the two halves of
+ * large ranges are sorted as tasks, and the merges of the top levels are
+ * split into independent pieces by binary searching the merge path. Equal
+ * elements keep their order: a merge takes from the right run only when it
+ * is strictly less.
+ */
+#ifndef MERGE_SORT_H
+#define MERGE_SORT_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/** runs of at most this many elements are insertion sorted */
+#define MERGE_SORT_CUTOFF 24
+/** ranges smaller than this are sorted by the task that reaches them */
+#define MERGE_SORT_TASK_CUTOFF (1 << 14)
+/** merges smaller than this are not split between threads */
+#define MERGE_SORT_PARALLEL_MERGE_CUTOFF (1 << 16)
+
+#ifdef _OPENMP
+#define MERGE_SORT_PRAGMA(x) _Pragma(x)
+#else
+#define MERGE_SORT_PRAGMA(x)
+#endif
+
+/** ascending order of plain arithmetic types, for `DEFINE_MERGE_SORT` */
+#define MERGE_SORT_LESS(x, y) (*(x) < *(y))
+
+/** number of threads a parallel merge is split for */
+static inline int merge_sort_threads(void)
+{
+#ifdef _OPENMP
+    return omp_get_num_threads();
+#else
+    return 1;
+#endif
+}
+
+/**
+ * Defines `static inline int name(type *a, size_t n)`, a stable merge sort.
+ * @returns 0 on success, -1 if the scratch buffer cannot be allocated, in
+ * which case `a` is left unchanged
+ */
+#define DEFINE_MERGE_SORT(name, type, less)                                    \
+    DEFINE_MERGE_SORT_LEAF(name, type, less, name##_insertion,                 \
+                           MERGE_SORT_CUTOFF)
+
+/**
+ * Defines the merge sort `name` like `DEFINE_MERGE_SORT`, but with runs of at
+ * most `cutoff` elements sorted by `leaf(type *a, size_t n)`. The sort is only
+ * stable if `leaf` is, or if equal elements cannot be told apart, as with the
+ * sorting networks of sort_small.h on plain integers.
+ */
+#define DEFINE_MERGE_SORT_LEAF(name, type, less, leaf, cutoff)                 \
+    static inline void name##_insertion(type *a, size_t n)                     \
+    {                                                                          \
+        for (size_t i = 1; i < n; i++)                                         \
+        {                                                                      \
+            type key = a[i];                                                   \
+            size_t j = i;                                                      \
+            for (; j > 0 && less(&key, &a[j - 1]); j--) a[j] = a[j - 1];       \
+            a[j] = key;                                                        \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    /* merges a[0..na) and b[0..nb) into out, a first on ties */               \
+    static inline void name##_merge(const type *a, size_t na, const type *b,   \
+                                    size_t nb, type *out)                      \
+    {                                                                          \
+        const type *a_end = a + na, *b_end = b + nb;                           \
+        if (na && nb)                                                          \
+        {                                                                      \
+            for (;;)                                                           \
+            {                                                                  \
+                if (less(b, a))                                                \
+                {                                                              \
+                    *out++ = *b++;                                             \
+                    if (b == b_end)                                            \
+                        break;                                                 \
+                }                                                              \
+                else                                                           \
+                {                                                              \
+                    *out++ = *a++;                                             \
+                    if (a == a_end)                                            \
+                        break;                                                 \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+        memcpy(out, a, (size_t)(a_end - a) * sizeof(type));                    \
+        out += a_end - a;                                                      \
+        memcpy(out, b, (size_t)(b_end - b) * sizeof(type));                    \
+    }                                                                          \
+                                                                               \
+    /* how many of the first k merged elements come from a */                  \
+    static inline size_t name##_merge_path(const type *a, size_t na,           \
+                                           const type *b, size_t nb,           \
+                                           size_t k)                           \
+    {                                                                          \
+        size_t lo = k > nb ? k - nb : 0, hi = k < na ? k : na;                 \
+        while (lo < hi)                                                        \
+        {                                                                      \
+            size_t mid = lo + (hi - lo) / 2;                                   \
+            /* a[mid] is taken first unless b[k - mid - 1] is less */          \
+            if (!less(&b[k - mid - 1], &a[mid]))                               \
+                lo = mid + 1;                                                  \
+            else                                                               \
+                hi = mid;                                                      \
+        }                                                                      \
+        return lo;                                                             \
+    }                                                                          \
+                                                                               \
+    static inline void name##_parallel_merge(const type *a, size_t na,         \
+                                             const type *b, size_t nb,         \
+                                             type *out)                        \
+    {                                                                          \
+        size_t n = na + nb;                                                    \
+        size_t parts = (size_t)merge_sort_threads();                           \
+        if (parts < 2 || n < MERGE_SORT_PARALLEL_MERGE_CUTOFF)                 \
+        {                                                                      \
+            name##_merge(a, na, b, nb, out);                                   \
+            return;                                                            \
+        }                                                                      \
+        for (size_t p = 0; p < parts; p++)                                     \
+        {                                                                      \
+            MERGE_SORT_PRAGMA("omp task firstprivate(p)")                      \
+            {                                                                  \
+                size_t k0 = n * p / parts, k1 = n * (p + 1) / parts;           \
+                size_t i0 = name##_merge_path(a, na, b, nb, k0);               \
+                size_t i1 = name##_merge_path(a, na, b, nb, k1);               \
+                name##_merge(a + i0, i1 - i0, b + (k0 - i0),                   \
+                             (k1 - i1) - (k0 - i0), out + k0);                 \
+            }                                                                  \
+        }                                                                      \
+        MERGE_SORT_PRAGMA("omp taskwait")                                      \
+    }                                                                          \
+                                                                               \
+    /* sorts the elements of a; they end in b if in_b, else in a */            \
+    static inline void name##_sort_to(type *a, type *b, size_t n, int in_b)    \
+    {                                                                          \
+        if (n <= (cutoff))                                                     \
+        {                                                                      \
+            leaf(a, n);                                                        \
+            if (in_b)                                                          \
+                memcpy(b, a, n * sizeof(type));                                \
+            return;                                                            \
+        }                                                                      \
+                                                                               \
+        size_t half = n / 2;                                                   \
+        if (n >= MERGE_SORT_TASK_CUTOFF)                                       \
+        {                                                                      \
+            MERGE_SORT_PRAGMA("omp task") name##_sort_to(a, b, half, !in_b);   \
+            name##_sort_to(a + half, b + half, n - half, !in_b);               \
+            MERGE_SORT_PRAGMA("omp taskwait")                                  \
+            /* the sorted halves are in the buffer not receiving them */       \
+            type *from = in_b ? a : b, *to = in_b ? b : a;                     \
+            name##_parallel_merge(from, half, from + half, n - half, to);      \
+        }                                                                      \
+        else                                                                   \
+        {                                                                      \
+            name##_sort_to(a, b, half, !in_b);                                 \
+            name##_sort_to(a + half, b + half, n - half, !in_b);               \
+            type *from = in_b ? a : b, *to = in_b ? b : a;                     \
+            name##_merge(from, half, from + half, n - half, to);               \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int name(type *a, size_t n)                                  \
+    {                                                                          \
+        if (n <= (cutoff))                                                     \
+        {                                                                      \
+            leaf(a, n);                                                        \
+            return 0;                                                          \
+        }                                                                      \
+        type *scratch = (type *)malloc(n * sizeof(type));                      \
+        if (!scratch)                                                          \
+            return -1;                                                         \
+        if (n < MERGE_SORT_TASK_CUTOFF)                                        \
+            name##_sort_to(a, scratch, n, 0);                                  \
+        else                                                                   \
+        {                                                                      \
+            MERGE_SORT_PRAGMA("omp parallel")                                  \
+            MERGE_SORT_PRAGMA("omp single")                                    \
+            name##_sort_to(a, scratch, n, 0);                                  \
+        }                                                                      \
+        free(scratch);                                                         \
+        return 0;                                                              \
+    }
+
+#endif /* MERGE_SORT_H */
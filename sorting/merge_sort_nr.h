@@ -0,0 +1,56 @@
+/**
+ * @file
+ * @brief Bottom-up, non-recursive [merge
+ * sort](https://en.wikipedia.org/wiki/Merge_sort#Bottom-up_implementation)
+ *
+ * `DEFINE_MERGE_SORT_NR(name, type, less)` defines
+ * `static inline int name(type *a, size_t n)` with the ordering hook of
+ * sort_hooks.h. `merge_sort_nr_int` is provided for `int`.
+ *
+ * Runs of 1, 2, 4, ... elements are merged pairwise into a scratch buffer
+ * of `n` elements, which is copied back after every level. Stable,
+ * O(n log n) comparisons. merge_sort.h is the recursive, parallel one.
+ */
+#ifndef MERGE_SORT_NR_H
+#define MERGE_SORT_NR_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sort_hooks.h"
+
+/**
+ * Defines `static inline int name(type *a, size_t n)`.
+ * @returns 0 on success, -1 if the scratch buffer cannot be allocated, in
+ * which case `a` is left unchanged
+ */
+#define DEFINE_MERGE_SORT_NR(name, type, less)                                 \
+    static inline int name(type *a, size_t n)                                  \
+    {                                                                          \
+        if (n < 2)                                                             \
+            return 0;                                                          \
+        type *temp = (type *)malloc(n * sizeof(type));                         \
+        if (!temp)                                                             \
+            return -1;                                                         \
+        for (size_t width = 1; width < n; width *= 2)                          \
+        {                                                                      \
+            for (size_t left = 0; left < n; left += 2 * width)                 \
+            {                                                                  \
+                size_t mid = left + width < n ? left + width : n;              \
+                size_t right = mid + width < n ? mid + width : n;              \
+                size_t i = left, j = mid, k = left;                            \
+                while (i < mid && j < right)                                   \
+                    temp[k++] = less(&a[j], &a[i]) ? a[j++] : a[i++];          \
+                while (i < mid) temp[k++] = a[i++];                            \
+                while (j < right) temp[k++] = a[j++];                          \
+            }                                                                  \
+            memcpy(a, temp, n * sizeof(type));                                 \
+        }                                                                      \
+        free(temp);                                                            \
+        return 0;                                                              \
+    }
+
+DEFINE_MERGE_SORT_NR(merge_sort_nr_int, int, SORT_LESS)
+
+#endif /* MERGE_SORT_NR_H */
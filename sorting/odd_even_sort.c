@@ -17,67 +17,21 @@
 #include <time.h>       /// for random number generation
 #include <inttypes.h>   /// for int32_t types
 
-/**
- * @brief Swap numbers by reference(using pointers)
- * @param first pointer to first number
- * @param second pointer to second number
- * @returns void
- */
-void swap(int32_t *first, int32_t *second)
-{
-    int32_t temp = *first;
-    *first = *second;
-    *second = temp;
-}
+#include "odd_even_sort.h"  /// for odd_even_sort_int
 
 /**
- * @brief oddEvenSort sorts the array using the algorithm described above.
- * @details 
- * A boolean varaible(isSorted) is declared and initialised to "false".
- * In the while loop, the variable(isSorted) is then set to "true".
- * During even phase the for loop loops through the array, touching just the even indexes.
- * i.e arr[0], arr[2], arr[4] and so on.
- * While during the odd phase, the for loop loops through the array, touching just the odd indexes.
- * i.e arr[1], arr[3], arr[5] and so on.
- * During these phases, if the if statement check if the interger at the current position in the array
- * is greater than the interger at the next array index (i.e arr[index + 2], to make sure the index is odd
- * during the odd phase and even during the even phase).
- * If the condition is true, the function "swap" is called and address of the intergers in question are passed as
- * parameters. After the swap is completed, "isSorted" is set to "false".
- * The while loop will keep running till the array is propertly sorted.
+ * @brief oddEvenSort sorts the array with the odd-even sort of
+ * odd_even_sort.h
+ * @details
+ * Every pass has an even phase, which compares arr[0] with arr[1], arr[2]
+ * with arr[3] and so on, and an odd phase, which compares arr[1] with
+ * arr[2], arr[3] with arr[4] and so on, swapping the pairs out of order.
+ * The passes repeat until neither phase swaps.
  * @param arr array to be sorted
  * @param size the size of the array
  * @returns void
  */
-void oddEvenSort(int *arr, int size)
-{
-    bool isSorted = false;
-    while(!isSorted)
-    {
-        isSorted = true;
-        int32_t i;
-
-        // Even phase
-        for(i = 0; i <= size - 2; i += 2)
-        {
-            if(arr[i] > arr[i + 1])
-            {
-                swap(&arr[i], &arr[i + 1]);
-                isSorted = false;
-            }
-        }
-
-        // Odd phase
-        for(i = 1; i <= size - 2; i += 2)
-        {
-            if(arr[i] > arr[i + 1])
-            {
-                swap(&arr[i], &arr[i + 1]);
-                isSorted = false;
-            }
-        }
-    }
-}
+void oddEvenSort(int *arr, int size) { odd_even_sort_int(arr, (size_t)size); }
 
 /**
  * @brief Self-test implementations
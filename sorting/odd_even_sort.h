@@ -0,0 +1,45 @@
+/**
+ * @file
+ * @brief [Odd-even sort](https://en.wikipedia.org/wiki/Odd%E2%80%93even_sort)
+ *
+ * `DEFINE_ODD_EVEN_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `odd_even_sort_int` is provided for `int`.
+ *
+ * Passes alternately compare the pairs that start at even and at odd
+ * indices, swapping those out of order, until neither phase swaps. The
+ * pairs of one phase are independent, which suits parallel hardware; run
+ * sequentially it makes O(n²) comparisons.
+ */
+#ifndef ODD_EVEN_SORT_H
+#define ODD_EVEN_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`. */
+#define DEFINE_ODD_EVEN_SORT(name, type, less, swap)                           \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        int sorted = 0;                                                        \
+        while (!sorted)                                                        \
+        {                                                                      \
+            sorted = 1;                                                        \
+            for (size_t phase = 0; phase < 2; phase++)                         \
+            {                                                                  \
+                for (size_t i = phase; i + 1 < n; i += 2)                      \
+                {                                                              \
+                    if (less(&a[i + 1], &a[i]))                                \
+                    {                                                          \
+                        swap(type, &a[i], &a[i + 1]);                          \
+                        sorted = 0;                                            \
+                    }                                                          \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+    }
+
+DEFINE_ODD_EVEN_SORT(odd_even_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* ODD_EVEN_SORT_H */
@@ -0,0 +1,47 @@
+/**
+ * @file
+ * @brief [Pancake sort](https://en.wikipedia.org/wiki/Pancake_sorting)
+ *
+ * `DEFINE_PANCAKE_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `pancake_sort_int` is provided for `int`.
+ *
+ * The only operation that moves elements is a flip, which reverses a
+ * prefix. The largest element of the unsorted prefix is flipped to the
+ * front and then flipped to the end of that prefix. At most 2n flips and
+ * O(n²) comparisons.
+ */
+#ifndef PANCAKE_SORT_H
+#define PANCAKE_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`. */
+#define DEFINE_PANCAKE_SORT(name, type, less, swap)                            \
+    /* reverses a[0..last] */                                                  \
+    static inline void name##_flip(type *a, size_t last)                       \
+    {                                                                          \
+        for (size_t i = 0, j = last; i < j; i++, j--)                          \
+            swap(type, &a[i], &a[j]);                                          \
+    }                                                                          \
+                                                                               \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        for (size_t size = n; size > 1; size--)                                \
+        {                                                                      \
+            size_t max = 0;                                                    \
+            for (size_t i = 1; i < size; i++)                                  \
+                if (less(&a[max], &a[i]))                                      \
+                    max = i;                                                   \
+            if (max == size - 1)                                               \
+                continue;                                                      \
+            name##_flip(a, max);                                               \
+            name##_flip(a, size - 1);                                          \
+        }                                                                      \
+    }
+
+DEFINE_PANCAKE_SORT(pancake_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* PANCAKE_SORT_H */
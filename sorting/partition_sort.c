@@ -1,48 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-void swap(int *a, int *b)
-{
-    int tmp = *a;
-    *a = *b;
-    *b = tmp;
-}
-
-int partition(int arr[], int low, int high)
-{
-    int pivot = arr[low];
-    int i = low - 1, j = high + 1;
-
-    while (1)
-    {
-        /* Find leftmost element >= pivot */
-        do
-        {
-            i++;
-        } while (arr[i] < pivot);
-
-        /* Find rightmost element <= pivot */
-        do
-        {
-            j--;
-        } while (arr[j] > pivot);
-
-        /* if two pointers met */
-        if (i >= j)
-            return j;
-
-        swap(&arr[i], &arr[j]);
-    }
-}
+#include "partition_sort.h"
 
+/* sorts arr[low..high] with the Hoare partitioning quicksort of
+ * partition_sort.h */
 void partitionSort(int arr[], int low, int high)
 {
     if (low < high)
-    {
-        int value = partition(arr, low, high);
-        partitionSort(arr, low, value);
-        partitionSort(arr, value + 1, high);
-    }
+        partition_sort_int(arr + low, (size_t)(high - low + 1));
 }
 
 void printArray(int arr[], int n)
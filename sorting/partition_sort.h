@@ -0,0 +1,63 @@
+/**
+ * @file
+ * @brief Quicksort with [Hoare's partition
+ * scheme](https://en.wikipedia.org/wiki/Quicksort#Hoare_partition_scheme)
+ *
+ * `DEFINE_PARTITION_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `partition_sort_int` is provided for `int`.
+ *
+ * The first element of a range is the pivot. Two indices move towards each
+ * other and swap the pairs on the wrong sides, so equal keys split evenly.
+ * The smaller part is recursed into and the larger one looped on, which
+ * bounds the stack at O(log n). The fixed pivot makes sorted input O(n²).
+ */
+#ifndef PARTITION_SORT_H
+#define PARTITION_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`. */
+#define DEFINE_PARTITION_SORT(name, type, less, swap)                          \
+    /* sorts a[low..high] */                                                   \
+    static void name##_range(type *a, size_t low, size_t high)                 \
+    {                                                                          \
+        while (low < high)                                                     \
+        {                                                                      \
+            type pivot = a[low];                                               \
+            size_t i = low, j = high;                                          \
+            for (;;)                                                           \
+            {                                                                  \
+                while (less(&a[i], &pivot)) i++;                               \
+                while (less(&pivot, &a[j])) j--;                               \
+                if (i >= j)                                                    \
+                    break;                                                     \
+                swap(type, &a[i], &a[j]);                                      \
+                i++;                                                           \
+                j--;                                                           \
+            }                                                                  \
+            /* a[low..j] <= pivot <= a[j + 1..high] */                         \
+            if (j - low < high - j)                                            \
+            {                                                                  \
+                name##_range(a, low, j);                                       \
+                low = j + 1;                                                   \
+            }                                                                  \
+            else                                                               \
+            {                                                                  \
+                name##_range(a, j + 1, high);                                  \
+                high = j;                                                      \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        if (n > 1)                                                             \
+            name##_range(a, 0, n - 1);                                         \
+    }
+
+DEFINE_PARTITION_SORT(partition_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* PARTITION_SORT_H */
@@ -12,87 +12,26 @@
 #include <assert.h> /// for assertions
 #include <stdio.h> /// for IO operations
 #include <stdlib.h> /// for memory management
+#include <string.h> /// for memcpy
+#include <time.h> /// for seeding the random tests
+
+#include "patience_sort.h" /// for patience_sort_int
 
 /**
- * @brief Sorts the target array by dividing it into a variable number of internally sorted piles then merge the piles
+ * @brief Sorts the target array by dealing it onto internally sorted piles, then merging the piles
+ * @details The sort is patience_sort_int() of patience_sort.h. Descending
+ * runs are reversed first, then every element is appended to the leftmost
+ * pile whose last element does not exceed it, found by binary search over
+ * the pile tails. The piles are laid out one after the other in a single
+ * arena and merged back through a binary min-heap of piles. O(n log p) time
+ * for p piles and O(n) memory.
  * @param array pointer to the array to be sorted
  * @param length length of the target array
- * @returns void
+ * @returns 0 on success, -1 if out of memory (the array is then left
+ * unsorted)
  */
-void patienceSort(int *array, int length) {
-    // An array of pointers used to store each pile
-    int* *piles = (int* *) malloc(sizeof(int*) * length);
-    for (int i = 0; i < length; ++i) {
-        piles[i] = malloc(sizeof(int) * length);
-    }
-
-    // pileSizes keep track of the indices of each pile's topmost element, hence 0 means only one element
-    // Note how calloc() is used to initialize the sizes of all piles to zero
-    int *pileSizes = (int*) calloc(length,sizeof(int));
-
-    // This initializes the first pile, note how using an array of pointers allowed us to access elements through two subscripts
-    // The first subscript indicates which pile we are accessing, the second subscript indicates the location being accessed in that pile
-    piles[0][0] = array[0];
-    int pileCount = 1;
-
-    for (int i = 1; i < length; ++i) {
-        // This will be used to keep track whether an element has been added to an existing pile
-        int flag = 1;
-
-        for (int j = 0; j < pileCount; ++j) {
-            if(piles[j][pileSizes[j]] > array[i]) {
-                // We have found a pile this element can be added to
-                piles[j][pileSizes[j] + 1] = array[i];
-                pileSizes[j]++;
-                flag--;
-                break;
-            }
-        }
-
-        if(flag) {
-            // The element in question can not be added to any existing piles, creating a new pile
-            piles[pileCount][0] = array[i];
-            pileCount++;
-        }
-    }
-
-    // This will keep track of the minimum value of all 'exposed' elements and which pile that value is from
-    int min, minLocation;
-
-    for (int i = 0; i < length; ++i) {
-        // Since there's no guarantee the first pile will be depleted slower than other piles,
-        // Example: when all elements are equal, in that case the first pile will be depleted immediately
-        // We can't simply initialize min to the top most element of the first pile,
-        // this loop finds a value to initialize min to.
-        for (int j = 0; j < pileCount; ++j) {
-            if(pileSizes[j] < 0) {
-                continue;
-            }
-            min = piles[j][pileSizes[j]];
-            minLocation = j;
-            break;
-        }
-
-        for (int j = 0; j < pileCount; ++j) {
-            if(pileSizes[j] < 0) {
-                continue;
-            }
-            if(piles[j][pileSizes[j]] < min) {
-                min = piles[j][pileSizes[j]];
-                minLocation = j;
-            }
-        }
-
-        array[i] = min;
-        pileSizes[minLocation]--;
-    }
-
-    // Deallocate memory
-    free(pileSizes);
-    for (int i = 0; i < length; ++i) {
-        free(piles[i]);
-    }
-    free(piles);
+int patienceSort(int *array, int length) {
+    return length < 2 ? 0 : patience_sort_int(array, (size_t) length);
 }
 
 /**
@@ -132,6 +71,48 @@ void testArray(int *array,int length) {
     printf("All assertions have passed!\n\n");
 }
 
+/**
+ * @brief Comparison function for qsort
+ * @param a pointer to the first integer
+ * @param b pointer to the second integer
+ * @returns negative, zero or positive as a is below, equal to or above b
+ */
+static int compare(const void *a, const void *b) {
+    int x = *(const int *) a, y = *(const int *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Checks patienceSort against qsort on a large generated array
+ * @param length length of the array
+ * @param kind 0 random, 1 nearly sorted, 2 reversed, 3 few distinct values,
+ * 4 ascending and descending runs
+ * @returns void
+ */
+static void testLarge(int length, int kind) {
+    int *array = (int *) malloc(sizeof(int) * length);
+    int *expected = (int *) malloc(sizeof(int) * length);
+    assert(array && expected);
+
+    for (int i = 0; i < length; ++i) {
+        switch (kind) {
+            case 0: array[i] = rand() - RAND_MAX / 2; break;
+            case 1: array[i] = rand() % 100 ? i : rand() % length; break;
+            case 2: array[i] = length - i; break;
+            case 3: array[i] = rand() % 4; break;
+            default: array[i] = i / 100 % 2 ? -i : i; break;
+        }
+    }
+    memcpy(expected, array, sizeof(int) * length);
+
+    assert(patienceSort(array, length) == 0);
+    qsort(expected, length, sizeof(int), compare);
+    assert(memcmp(array, expected, sizeof(int) * length) == 0);
+
+    free(array);
+    free(expected);
+}
+
 /**
  * @brief Self-test implementations
  * @returns void
@@ -141,11 +122,19 @@ static void test() {
     int testArray2[] = {2,2,5,1,3,5,6,4};
     int testArray3[] = {1,2,3,4,5,6,7,8};
     int testArray4[] = {8,7,6,5,4,3,2,1};
+    int testArray5[] = {3,3,2,2,1,1,5,4};
 
     testArray(testArray1,8);
     testArray(testArray2,8);
     testArray(testArray3,8);
     testArray(testArray4,8);
+    testArray(testArray5,8);
+    testArray(testArray1,1);
+    testArray(testArray1,0);
+
+    for (int kind = 0; kind < 5; ++kind) {
+        testLarge(100000, kind);
+    }
 
     printf("Testing successfully completed!\n");
 }
@@ -155,6 +144,7 @@ static void test() {
  * @returns 0 on exit
  */
 int main() {
+    srand(time(NULL));
     test();  // run self-test implementations
     return 0;
 }
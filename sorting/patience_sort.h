@@ -0,0 +1,149 @@
+/**
+ * @file
+ * @brief [Patience sort](https://en.wikipedia.org/wiki/Patience_sorting)
+ * with binary-searched piles and a heap merge
+ *
+ * `DEFINE_PATIENCE_SORT(name, type, less, swap)` defines
+ * `static inline int name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `patience_sort_int` is provided for `int`.
+ *
+ * Strictly descending runs are reversed first, so reversed input deals onto
+ * a single pile. Every element is then dealt onto the leftmost pile whose
+ * tail is not greater than it; the tails never increase from the first pile
+ * to the last, so the pile is found by binary search, after checking the
+ * pile dealt onto last, which makes sorted runs O(1) per element. The piles
+ * are laid out one after another in one arena of `n` elements and merged
+ * back through a binary min-heap of piles. O(n log p) time for p piles and
+ * O(n) memory; an input that is one run is left as it is after one pass.
+ */
+#ifndef PATIENCE_SORT_H
+#define PATIENCE_SORT_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "sort_hooks.h"
+
+/**
+ * Defines `static inline int name(type *a, size_t n)`, a patience sort.
+ * @returns 0 on success, -1 if out of memory, in which case `a` holds the
+ * same elements in an unspecified order
+ */
+#define DEFINE_PATIENCE_SORT(name, type, less, swap)                           \
+    /* leftmost pile whose tail is at most x, piles if there is none */        \
+    static inline size_t name##_pile(const type *tails, size_t piles,          \
+                                     size_t last, const type *x)               \
+    {                                                                          \
+        if (last < piles && !less(x, &tails[last]) &&                          \
+            (last == 0 || less(x, &tails[last - 1])))                          \
+            return last;                                                       \
+        size_t low = 0, high = piles;                                          \
+        while (low < high)                                                     \
+        {                                                                      \
+            size_t mid = low + (high - low) / 2;                               \
+            if (less(x, &tails[mid]))                                          \
+                low = mid + 1;                                                 \
+            else                                                               \
+                high = mid;                                                    \
+        }                                                                      \
+        return low;                                                            \
+    }                                                                          \
+                                                                               \
+    /* sifts heap[root] down, piles ordered by their next element */           \
+    static inline void name##_sift(size_t *heap, size_t size, size_t root,     \
+                                   const type *arena, const size_t *next)      \
+    {                                                                          \
+        size_t pile = heap[root];                                              \
+        for (size_t child; (child = 2 * root + 1) < size; root = child)        \
+        {                                                                      \
+            if (child + 1 < size && less(&arena[next[heap[child + 1]]],        \
+                                         &arena[next[heap[child]]]))           \
+                child++;                                                       \
+            if (!less(&arena[next[heap[child]]], &arena[next[pile]]))          \
+                break;                                                         \
+            heap[root] = heap[child];                                          \
+        }                                                                      \
+        heap[root] = pile;                                                     \
+    }                                                                          \
+                                                                               \
+    static inline int name(type *a, size_t n)                                  \
+    {                                                                          \
+        if (n < 2)                                                             \
+            return 0;                                                          \
+        for (size_t lo = 0, hi; lo + 1 < n; lo = hi > lo + 1 ? hi : lo + 1)    \
+        {                                                                      \
+            for (hi = lo + 1; hi < n && less(&a[hi], &a[hi - 1]); hi++)        \
+            {                                                                  \
+            }                                                                  \
+            for (size_t i = lo, j = hi - 1; i < j; i++, j--)                   \
+                swap(type, &a[i], &a[j]);                                      \
+        }                                                                      \
+                                                                               \
+        /* deal, remembering the pile of every element */                      \
+        size_t *pile_of = (size_t *)malloc(n * sizeof(size_t));                \
+        type *arena = (type *)malloc(n * sizeof(type));                        \
+        if (!pile_of || !arena)                                                \
+        {                                                                      \
+            free(pile_of);                                                     \
+            free(arena);                                                       \
+            return -1;                                                         \
+        }                                                                      \
+        size_t piles = 0, last = 0;                                            \
+        for (size_t i = 0; i < n; i++)                                         \
+        {                                                                      \
+            size_t p = name##_pile(arena, piles, last, &a[i]);                 \
+            piles += p == piles;                                               \
+            arena[p] = a[i]; /* the arena holds the tails for now */           \
+            pile_of[i] = last = p;                                             \
+        }                                                                      \
+        if (piles == 1)                                                        \
+        {                                                                      \
+            free(pile_of);                                                     \
+            free(arena);                                                       \
+            return 0;                                                          \
+        }                                                                      \
+                                                                               \
+        /* pile p occupies arena[start[p]..start[p + 1]) */                    \
+        size_t *start = (size_t *)calloc(piles + 1, sizeof(size_t));           \
+        size_t *next = (size_t *)malloc(piles * sizeof(size_t));               \
+        size_t *heap = (size_t *)malloc(piles * sizeof(size_t));               \
+        int result = -1;                                                       \
+        if (start && next && heap)                                             \
+        {                                                                      \
+            for (size_t i = 0; i < n; i++) start[pile_of[i] + 1]++;            \
+            for (size_t p = 0; p < piles; p++)                                 \
+            {                                                                  \
+                start[p + 1] += start[p];                                      \
+                next[p] = start[p];                                            \
+            }                                                                  \
+            for (size_t i = 0; i < n; i++) arena[next[pile_of[i]]++] = a[i];   \
+            for (size_t p = 0; p < piles; p++)                                 \
+            {                                                                  \
+                next[p] = start[p];                                            \
+                heap[p] = p;                                                   \
+            }                                                                  \
+            size_t size = piles;                                               \
+            for (size_t root = size / 2; root-- > 0;)                          \
+                name##_sift(heap, size, root, arena, next);                    \
+            for (size_t i = 0; i < n; i++)                                     \
+            {                                                                  \
+                size_t p = heap[0];                                            \
+                a[i] = arena[next[p]++];                                       \
+                if (next[p] == start[p + 1])                                   \
+                    heap[0] = heap[--size];                                    \
+                if (size > 0)                                                  \
+                    name##_sift(heap, size, 0, arena, next);                   \
+            }                                                                  \
+            result = 0;                                                        \
+        }                                                                      \
+        free(pile_of);                                                         \
+        free(arena);                                                           \
+        free(start);                                                           \
+        free(next);                                                            \
+        free(heap);                                                            \
+        return result;                                                         \
+    }
+
+DEFINE_PATIENCE_SORT(patience_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* PATIENCE_SORT_H */
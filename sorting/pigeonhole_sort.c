@@ -1,44 +1,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "pigeonhole_sort.h"
+
+/* the sort lives in pigeonhole_sort.h */
 void pigeonholeSort(int arr[], int size)
 {
-    int i, j, min = arr[0], max = arr[0], range;
-
-    // Getting range of the array using max and min
-    for (i = 1; i < size; i++)
-    {
-        if (arr[i] < min)
-            min = arr[i];
-        if (arr[i] > max)
-            max = arr[i];
-    }
-    range = max - min + 1;
-
-    // Make 'holes' and put array's numbers in holes
-    int *holes = (int *)malloc(sizeof(int) * range);
-    for (i = 0; i < range; i++)
+    if (size > 0 && pigeonhole_sort(arr, (size_t)size) != 0)
     {
-        holes[i] = 0;
+        printf("Can't Malloc! Please try again.");
+        exit(EXIT_FAILURE);
     }
-    for (i = 0; i < size; i++)
-    {
-        holes[arr[i] - min]++;
-    }
-
-    // Copy the numbers back to the original array
-    j = 0;
-    for (i = 0; i < range; i++)
-    {
-        while (holes[i] > 0)
-        {
-            arr[j] = i + min;
-            holes[i]--;
-            j++;
-        }
-    }
-
-    free(holes);
 }
 
 int main()
@@ -0,0 +1,43 @@
+/**
+ * @file
+ * @brief [Pigeonhole sort](https://en.wikipedia.org/wiki/Pigeonhole_sort) of
+ * integers
+ *
+ * pigeonhole_sort() counts the keys into one hole per value from the
+ * smallest key to the largest and rewrites the array from the holes. Unlike
+ * counting_sort.h it takes negative keys. O(n + k) time and O(k) memory for
+ * a range of k values, so it suits small key ranges only.
+ */
+#ifndef PIGEONHOLE_SORT_H
+#define PIGEONHOLE_SORT_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+/**
+ * Sorts n ints.
+ * @returns 0 on success, -1 if the holes cannot be allocated, in which case
+ * `a` is left unchanged
+ */
+static inline int pigeonhole_sort(int *a, size_t n)
+{
+    if (n < 2)
+        return 0;
+    int min = a[0], max = a[0];
+    for (size_t i = 1; i < n; i++)
+    {
+        min = a[i] < min ? a[i] : min;
+        max = a[i] > max ? a[i] : max;
+    }
+    size_t range = (size_t)((long long)max - min) + 1;
+    size_t *holes = (size_t *)calloc(range, sizeof(size_t));
+    if (!holes)
+        return -1;
+    for (size_t i = 0; i < n; i++) holes[(size_t)((long long)a[i] - min)]++;
+    for (size_t h = 0, i = 0; h < range; h++)
+        while (holes[h]--) a[i++] = (int)((long long)min + (long long)h);
+    free(holes);
+    return 0;
+}
+
+#endif /* PIGEONHOLE_SORT_H */
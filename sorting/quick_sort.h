@@ -0,0 +1,59 @@
+/**
+ * @file
+ * @brief [Quicksort](https://en.wikipedia.org/wiki/Quicksort) with Lomuto's
+ * partition scheme
+ *
+ * `DEFINE_QUICK_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `quick_sort_int` is provided for `int`.
+ *
+ * The last element of a range is the pivot. One scan swaps every element
+ * not greater than it to the front, then the pivot behind them. The
+ * smaller part is recursed into and the larger one looped on, which bounds
+ * the stack at O(log n). Sorted input and many equal keys make it O(n²);
+ * introsort.h is the sort to use.
+ */
+#ifndef QUICK_SORT_H
+#define QUICK_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`, a quicksort. */
+#define DEFINE_QUICK_SORT(name, type, less, swap)                              \
+    /* sorts a[0..n) */                                                        \
+    static void name##_range(type *a, size_t n)                                \
+    {                                                                          \
+        while (n > 1)                                                          \
+        {                                                                      \
+            /* a[0..p) <= pivot < a[p..j) */                                   \
+            size_t p = 0;                                                      \
+            for (size_t j = 0; j + 1 < n; j++)                                 \
+            {                                                                  \
+                if (!less(&a[n - 1], &a[j]))                                   \
+                {                                                              \
+                    swap(type, &a[p], &a[j]);                                  \
+                    p++;                                                       \
+                }                                                              \
+            }                                                                  \
+            swap(type, &a[p], &a[n - 1]);                                      \
+            if (p < n - 1 - p)                                                 \
+            {                                                                  \
+                name##_range(a, p);                                            \
+                a += p + 1;                                                    \
+                n -= p + 1;                                                    \
+            }                                                                  \
+            else                                                               \
+            {                                                                  \
+                name##_range(a + p + 1, n - p - 1);                            \
+                n = p;                                                         \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void name(type *a, size_t n) { name##_range(a, n); }
+
+DEFINE_QUICK_SORT(quick_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* QUICK_SORT_H */
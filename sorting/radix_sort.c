@@ -1,55 +1,15 @@
 #include <stdio.h>
+#include <stdlib.h>
 
-int largest(int a[], int n)
-{
-    int large = a[0], i;
-    for (i = 1; i < n; i++)
-    {
-        if (large < a[i])
-            large = a[i];
-    }
-    return large;
-}
+#include "radix_sort.h"
 
+/* sorts a by decimal digits with radix_sort_decimal() of radix_sort.h */
 void RadixSort(int a[], int n)
 {
-    int bucket[10][10], bucket_count[10];
-    int i, j, k, remainder, NOP = 0, divisor = 1, large, pass;
-
-    large = largest(a, n);
-    printf("The large element %d\n", large);
-    while (large > 0)
+    if (radix_sort_decimal(a, (size_t)n) != 0)
     {
-        NOP++;
-        large /= 10;
-    }
-
-    for (pass = 0; pass < NOP; pass++)
-    {
-        for (i = 0; i < 10; i++)
-        {
-            bucket_count[i] = 0;
-        }
-        for (i = 0; i < n; i++)
-        {
-            remainder = (a[i] / divisor) % 10;
-            bucket[remainder][bucket_count[remainder]] = a[i];
-            bucket_count[remainder] += 1;
-        }
-
-        i = 0;
-        for (k = 0; k < 10; k++)
-        {
-            for (j = 0; j < bucket_count[k]; j++)
-            {
-                a[i] = bucket[k][j];
-                i++;
-            }
-        }
-        divisor *= 10;
-
-        for (i = 0; i < n; i++) printf("%d  ", a[i]);
-        printf("\n");
+        printf("Can't Malloc! Please try again.");
+        exit(EXIT_FAILURE);
     }
 }
 
@@ -0,0 +1,263 @@
+/**
+ * @file
+ * @brief Byte-wise LSD [radix sort](https://en.wikipedia.org/wiki/Radix_sort)
+ * for 32 and 64-bit keys.
+ *
+ * `DEFINE_RADIX_SORT(name, type, key_type, key)` defines
+ * `int name(type *a, size_t n)`, a stable sort of `n` elements of `type`
+ * by `key(const type *)`, an unsigned `key_type` (`uint32_t` or `uint64_t`)
+ * ordered like the elements should be. Instances are provided for
+ * `uint32_t`, `int32_t`, `uint64_t`, `int64_t`, `float` and `double`:
+ * signed integers have their sign bit flipped, IEEE values also have all
+ * other bits flipped when negative, so -0.0 sorts before 0.0 and NaNs
+ * sort to the ends by their sign.
+ *
+ * The counts of every digit of every pass are taken in a single read of
+ * the input, and a pass where all keys share the digit is skipped. The
+ * elements ping-pong between the input and one scratch buffer. With OpenMP
+ * and at least ::RADIX_SORT_PARALLEL_CUTOFF elements, every thread counts
+ * and scatters its own contiguous chunk; chunks get their offsets in
+ * thread order, which keeps the sort stable.
+ *
+ * radix_sort_decimal() is the textbook variant of radix_sort.c, by decimal
+ * digits of non-negative ints, one pass per digit of the largest key. It
+ * is kept to show what the byte-wise passes gain.
+ */
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/** inputs smaller than this are sorted by a single thread */
+#define RADIX_SORT_PARALLEL_CUTOFF (1 << 17)
+/** values of one digit */
+#define RADIX_SORT_BUCKETS 256
+
+#ifdef _OPENMP
+#define RADIX_SORT_PRAGMA(x) _Pragma(x)
+#define RADIX_SORT_THREADS() omp_get_max_threads()
+#define RADIX_SORT_THREAD_ID() omp_get_thread_num()
+#define RADIX_SORT_THREAD_COUNT() omp_get_num_threads()
+#else
+#define RADIX_SORT_PRAGMA(x)
+#define RADIX_SORT_THREADS() 1
+#define RADIX_SORT_THREAD_ID() 0
+#define RADIX_SORT_THREAD_COUNT() 1
+#endif
+
+/**
+ * Defines `int name(type *a, size_t n)`.
+ * @returns 0 on success, -1 if the scratch buffer cannot be allocated, in
+ * which case `a` is left unchanged
+ */
+#define DEFINE_RADIX_SORT(name, type, key_type, key)                           \
+    enum                                                                       \
+    {                                                                          \
+        name##_passes = sizeof(key_type)                                       \
+    };                                                                         \
+                                                                               \
+    static inline unsigned name##_digit(const type *x, unsigned pass)          \
+    {                                                                          \
+        return (unsigned)(key(x) >> (8 * pass)) & (RADIX_SORT_BUCKETS - 1);   \
+    }                                                                          \
+                                                                               \
+    /* adds the digit counts of every pass over a[0..n) to counts */           \
+    static inline void name##_count_all(const type *a, size_t n,               \
+                                        size_t *counts)                        \
+    {                                                                          \
+        for (size_t i = 0; i < n; i++)                                         \
+        {                                                                      \
+            key_type k = key(&a[i]);                                           \
+            for (unsigned p = 0; p < name##_passes; p++)                       \
+                counts[p * RADIX_SORT_BUCKETS +                                \
+                       ((unsigned)(k >> (8 * p)) & (RADIX_SORT_BUCKETS - 1))]++; \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    /* a pass is useless when every key has the same digit */                  \
+    static inline int name##_trivial(const size_t *counts, const type *a,      \
+                                     size_t n, unsigned pass)                  \
+    {                                                                          \
+        return counts[pass * RADIX_SORT_BUCKETS + name##_digit(a, pass)] == n; \
+    }                                                                          \
+                                                                               \
+    static inline void name##_serial(type *a, type *buffer, size_t n)          \
+    {                                                                          \
+        size_t counts[name##_passes * RADIX_SORT_BUCKETS] = {0};               \
+        type *src = a, *dst = buffer;                                          \
+                                                                               \
+        name##_count_all(a, n, counts);                                        \
+        for (unsigned p = 0; p < name##_passes; p++)                           \
+        {                                                                      \
+            if (name##_trivial(counts, a, n, p))                               \
+                continue;                                                      \
+            size_t *offset = counts + p * RADIX_SORT_BUCKETS, sum = 0;         \
+            for (unsigned d = 0; d < RADIX_SORT_BUCKETS; d++)                  \
+            {                                                                  \
+                size_t c = offset[d];                                          \
+                offset[d] = sum;                                               \
+                sum += c;                                                      \
+            }                                                                  \
+            for (size_t i = 0; i < n; i++)                                     \
+                dst[offset[name##_digit(&src[i], p)]++] = src[i];              \
+            type *t = src;                                                     \
+            src = dst;                                                         \
+            dst = t;                                                           \
+        }                                                                      \
+        if (src != a)                                                          \
+            memcpy(a, src, n * sizeof(type));                                  \
+    }                                                                          \
+                                                                               \
+    /* local holds threads * passes * RADIX_SORT_BUCKETS counters */           \
+    static inline void name##_parallel(type *a, type *buffer, size_t n,        \
+                                       size_t *local)                          \
+    {                                                                          \
+        size_t counts[name##_passes * RADIX_SORT_BUCKETS] = {0};               \
+        type *result = a;                                                      \
+                                                                               \
+        RADIX_SORT_PRAGMA("omp parallel")                                      \
+        {                                                                      \
+            size_t t = (size_t)RADIX_SORT_THREAD_ID();                         \
+            size_t threads = (size_t)RADIX_SORT_THREAD_COUNT();                \
+            size_t lo = n * t / threads, hi = n * (t + 1) / threads;           \
+            size_t *mine = local + t * name##_passes * RADIX_SORT_BUCKETS;     \
+            type *src = a, *dst = buffer;                                      \
+            int counted = 1; /* mine holds the counts of src */                \
+                                                                               \
+            memset(mine, 0,                                                    \
+                   name##_passes * RADIX_SORT_BUCKETS * sizeof(size_t));       \
+            name##_count_all(a + lo, hi - lo, mine);                           \
+            RADIX_SORT_PRAGMA("omp critical")                                  \
+            for (size_t i = 0; i < name##_passes * RADIX_SORT_BUCKETS; i++)    \
+                counts[i] += mine[i];                                          \
+            RADIX_SORT_PRAGMA("omp barrier")                                   \
+                                                                               \
+            for (unsigned p = 0; p < name##_passes; p++)                       \
+            {                                                                  \
+                if (name##_trivial(counts, a, n, p))                           \
+                    continue;                                                  \
+                size_t *count = mine + p * RADIX_SORT_BUCKETS;                 \
+                if (!counted)                                                  \
+                {                                                              \
+                    memset(count, 0, RADIX_SORT_BUCKETS * sizeof(size_t));     \
+                    for (size_t i = lo; i < hi; i++)                           \
+                        count[name##_digit(&src[i], p)]++;                     \
+                }                                                              \
+                RADIX_SORT_PRAGMA("omp barrier")                               \
+                RADIX_SORT_PRAGMA("omp single")                                \
+                {                                                              \
+                    /* digit major, thread minor: chunks stay in order */      \
+                    size_t sum = 0;                                            \
+                    for (unsigned d = 0; d < RADIX_SORT_BUCKETS; d++)          \
+                        for (size_t u = 0; u < threads; u++)                   \
+                        {                                                      \
+                            size_t *c = local +                                \
+                                        (u * name##_passes + p) *              \
+                                            RADIX_SORT_BUCKETS +               \
+                                        d;                                     \
+                            size_t v = *c;                                     \
+                            *c = sum;                                          \
+                            sum += v;                                          \
+                        }                                                      \
+                }                                                              \
+                for (size_t i = lo; i < hi; i++)                               \
+                    dst[count[name##_digit(&src[i], p)]++] = src[i];           \
+                RADIX_SORT_PRAGMA("omp barrier")                               \
+                type *swap = src;                                              \
+                src = dst;                                                     \
+                dst = swap;                                                    \
+                counted = 0;                                                   \
+            }                                                                  \
+            if (t == 0)                                                        \
+                result = src;                                                  \
+        }                                                                      \
+        if (result != a)                                                       \
+            memcpy(a, result, n * sizeof(type));                               \
+    }                                                                          \
+                                                                               \
+    static inline int name(type *a, size_t n)                                  \
+    {                                                                          \
+        if (n < 2)                                                             \
+            return 0;                                                          \
+        type *buffer = (type *)malloc(n * sizeof(type));                       \
+        if (!buffer)                                                           \
+            return -1;                                                         \
+        int threads = RADIX_SORT_THREADS();                                    \
+        size_t *local = NULL;                                                  \
+        if (threads > 1 && n >= RADIX_SORT_PARALLEL_CUTOFF)                    \
+            local = (size_t *)malloc((size_t)threads * name##_passes *         \
+                                     RADIX_SORT_BUCKETS * sizeof(size_t));     \
+        if (local)                                                             \
+            name##_parallel(a, buffer, n, local);                              \
+        else                                                                   \
+            name##_serial(a, buffer, n);                                       \
+        free(local);                                                           \
+        free(buffer);                                                          \
+        return 0;                                                              \
+    }
+
+/** @cond keys of the provided instances */
+static inline uint32_t radix_key_uint32(const uint32_t *x) { return *x; }
+static inline uint32_t radix_key_int32(const int32_t *x)
+{
+    return (uint32_t)*x ^ 0x80000000u;
+}
+static inline uint64_t radix_key_uint64(const uint64_t *x) { return *x; }
+static inline uint64_t radix_key_int64(const int64_t *x)
+{
+    return (uint64_t)*x ^ 0x8000000000000000u;
+}
+static inline uint32_t radix_key_float(const float *x)
+{
+    uint32_t bits;
+    memcpy(&bits, x, sizeof(bits));
+    return bits ^ ((uint32_t)-(int32_t)(bits >> 31) | 0x80000000u);
+}
+static inline uint64_t radix_key_double(const double *x)
+{
+    uint64_t bits;
+    memcpy(&bits, x, sizeof(bits));
+    return bits ^ ((uint64_t)-(int64_t)(bits >> 63) | 0x8000000000000000u);
+}
+/** @endcond */
+
+DEFINE_RADIX_SORT(radix_sort_uint32, uint32_t, uint32_t, radix_key_uint32)
+DEFINE_RADIX_SORT(radix_sort_int32, int32_t, uint32_t, radix_key_int32)
+DEFINE_RADIX_SORT(radix_sort_uint64, uint64_t, uint64_t, radix_key_uint64)
+DEFINE_RADIX_SORT(radix_sort_int64, int64_t, uint64_t, radix_key_int64)
+DEFINE_RADIX_SORT(radix_sort_float, float, uint32_t, radix_key_float)
+DEFINE_RADIX_SORT(radix_sort_double, double, uint64_t, radix_key_double)
+
+/**
+ * Sorts n non-negative ints by their decimal digits, least significant
+ * first, each pass a stable counting sort into a scratch buffer.
+ * @returns 0 on success, -1 if the scratch buffer cannot be allocated, in
+ * which case `a` is left unchanged
+ */
+static inline int radix_sort_decimal(int *a, size_t n)
+{
+    if (n < 2)
+        return 0;
+    int *out = (int *)malloc(n * sizeof(int)), max = 0;
+    if (!out)
+        return -1;
+    for (size_t i = 0; i < n; i++) max = a[i] > max ? a[i] : max;
+    for (long divisor = 1; max / divisor > 0; divisor *= 10)
+    {
+        size_t count[11] = {0};
+        for (size_t i = 0; i < n; i++) count[a[i] / divisor % 10 + 1]++;
+        for (int d = 0; d < 10; d++) count[d + 1] += count[d];
+        for (size_t i = 0; i < n; i++) out[count[a[i] / divisor % 10]++] = a[i];
+        memcpy(a, out, n * sizeof(int));
+    }
+    free(out);
+    return 0;
+}
+
+#endif /* RADIX_SORT_H */
@@ -1,95 +1,185 @@
-// sorting of array list using Radix sort
-#include <stdio.h>
-#include <stdlib.h>
-
-#define range 10  // Range for integers is 10 as digits range from 0-9
-
-// Utility function to get the maximum value in ar[]
-int MAX(int *ar, int size)
-{
-    int i, max = ar[0];
-    for (i = 0; i < size; i++)
-    {
-        if (ar[i] > max)
-            max = ar[i];
-    }
-    return max;
-}
-
-// Counting sort according to the digit represented by place
-void countSort(int *arr, int n, int place)
-{
-    int i, freq[range] = {0};
-    int *output = (int *)malloc(n * sizeof(int));
-
-    // Store count of occurrences in freq[]
-    for (i = 0; i < n; i++) freq[(arr[i] / place) % range]++;
-
-    // Change freq[i] so that it contains the actual position of the digit in
-    // output[]
-    for (i = 1; i < range; i++) freq[i] += freq[i - 1];
-
-    // Build the output array
-    for (i = n - 1; i >= 0; i--)
-    {
-        output[freq[(arr[i] / place) % range] - 1] = arr[i];
-        freq[(arr[i] / place) % range]--;
-    }
-
-    // Copy the output array to arr[], so it contains numbers according to the
-    // current digit
-    for (i = 0; i < n; i++) arr[i] = output[i];
-    free(output);
-}
-
-/*This is where the sorting of the array takes place
- arr[] --- Array to be sorted
- n --- Array Size
- max --- Maximum element in Array
- */
-void radixsort2(int *arr, int n,
-                int max)  // max is the maximum element in the array
-{
-    int mul = 1;
-    while (max)
-    {
-        countSort(arr, n, mul);
-        mul *= 10;
-        max /= 10;
-    }
-}
-
-void display(int *arr, int N)
-{
-    for (int i = 0; i < N; i++) printf("%d, ", arr[i]);
-    putchar('\n');
-}
-
-int main(int argc, const char *argv[])
-{
-    int n;
-    printf("Enter size of array:\n");
-    scanf("%d", &n);  // E.g. 8
-
-    printf("Enter the elements of the array\n");
-    int i;
-    int *arr = (int *)malloc(n * sizeof(int));
-    for (i = 0; i < n; i++)
-    {
-        scanf("%d", &arr[i]);
-    }
-
-    printf("Original array: ");
-    display(arr, n);  // Original array : 10 11 9 8 4 7 3 8
-
-    int max;
-    max = MAX(arr, n);
-
-    radixsort2(arr, n, max);
-
-    printf("Sorted array: ");
-    display(arr, n);  // Sorted array : 3 4 7 8 8 9 10 11
-
-    free(arr);
-    return 0;
-}
+/**
+ * @file
+ * @brief Sorting of arrays using byte-wise LSD [radix
+ * sort](https://en.wikipedia.org/wiki/Radix_sort)
+ *
+ * The sort lives in radix_sort.h; this program tests it on every provided
+ * key type.
+ *
+ * usage: ./radix_sort_2 [number of values]
+ * runs the self tests, then times radix sort and qsort() on that many
+ * random integers.
+ */
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "radix_sort.h"
+
+/**
+ * Sorts arr[0..n) in ascending order, negative numbers included.
+ * @param arr array to sort
+ * @param n array size
+ * @param max unused, kept for existing callers
+ */
+void radixsort2(int *arr, int n, int max)
+{
+    (void)max;
+    if (n > 0 && radix_sort_int32((int32_t *)arr, (size_t)n) != 0)
+    {
+        printf("Can't Malloc! Please try again.");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void display(int *arr, int N)
+{
+    for (int i = 0; i < N; i++) printf("%d, ", arr[i]);
+    putchar('\n');
+}
+
+/** 64 random bits */
+static uint64_t random64(void)
+{
+    uint64_t x = 0;
+    for (int i = 0; i < 4; i++) x = x << 16 ^ (uint64_t)(rand() & 0xffff);
+    return x;
+}
+
+/** checks that a sorted array of the given comparison type is in order */
+#define CHECK_SORTED(a, n)                                    \
+    for (size_t i = 1; i < (n); i++) assert(!((a)[i] < (a)[i - 1]))
+
+/** record sorted by key only, to check stability */
+typedef struct
+{
+    uint32_t key;
+    uint32_t position; /**< index before sorting */
+} record;
+
+static inline uint32_t record_key(const record *x) { return x->key; }
+DEFINE_RADIX_SORT(radix_sort_record, record, uint32_t, record_key)
+
+/** Test function
+ * @param n number of random values of each type to sort
+ */
+static void test(size_t n)
+{
+    uint32_t *u32 = malloc(n * sizeof(uint32_t));
+    int32_t *i32 = malloc(n * sizeof(int32_t));
+    uint64_t *u64 = malloc(n * sizeof(uint64_t));
+    int64_t *i64 = malloc(n * sizeof(int64_t));
+    float *f32 = malloc(n * sizeof(float));
+    double *f64 = malloc(n * sizeof(double));
+    record *records = malloc(n * sizeof(record));
+    assert(n == 0 ||
+           (u32 && i32 && u64 && i64 && f32 && f64 && records));
+
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t r = random64();
+        u32[i] = (uint32_t)r;
+        /* small magnitudes leave the high bytes constant */
+        i32[i] = i % 2 ? (int32_t)r : (int32_t)(r % 2001) - 1000;
+        u64[i] = r;
+        i64[i] = (int64_t)r;
+        f32[i] = (float)((int32_t)r) / 1024.0f;
+        f64[i] = i % 7 == 0 ? -0.0 : (double)(int64_t)r * 1e-12;
+        records[i].key = (uint32_t)(r % 50);
+        records[i].position = (uint32_t)i;
+    }
+    if (n > 3)
+    {
+        f64[1] = -INFINITY;
+        f64[2] = INFINITY;
+        f32[3] = -0.0f;
+    }
+
+    assert(radix_sort_uint32(u32, n) == 0);
+    assert(radix_sort_int32(i32, n) == 0);
+    assert(radix_sort_uint64(u64, n) == 0);
+    assert(radix_sort_int64(i64, n) == 0);
+    assert(radix_sort_float(f32, n) == 0);
+    assert(radix_sort_double(f64, n) == 0);
+    assert(radix_sort_record(records, n) == 0);
+
+    CHECK_SORTED(u32, n);
+    CHECK_SORTED(i32, n);
+    CHECK_SORTED(u64, n);
+    CHECK_SORTED(i64, n);
+    CHECK_SORTED(f32, n);
+    CHECK_SORTED(f64, n);
+    for (size_t i = 1; i < n; i++)
+    {
+        /* -0.0 is ordered before 0.0 */
+        assert(!(f64[i] == 0 && signbit(f64[i]) && !signbit(f64[i - 1]) &&
+                 f64[i - 1] == 0));
+        assert(records[i - 1].key < records[i].key ||
+               (records[i - 1].key == records[i].key &&
+                records[i - 1].position < records[i].position));
+    }
+
+    free(u32);
+    free(i32);
+    free(u64);
+    free(i64);
+    free(f32);
+    free(f64);
+    free(records);
+}
+
+/** comparison for qsort() */
+static int compare_int(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, const char *argv[])
+{
+    srand(time(NULL));
+
+    const size_t sizes[] = {0, 1, 2, 100, 1000, 100000, 1 << 18};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        test(sizes[i]);
+    }
+
+    int arr[] = {10, 11, 9, 8, 4, 7, 3, 8, -5, -100};
+    radixsort2(arr, 10, 11);
+    printf("Sorted array: ");
+    display(arr, 10);
+    printf("All tests passed\n");
+
+    if (argc > 1)
+    {
+        size_t n = strtoul(argv[1], NULL, 0);
+        int *a = malloc(n * sizeof(int)), *b = malloc(n * sizeof(int));
+        if (!a || !b)
+        {
+            printf("Can't Malloc! Please try again.");
+            return 1;
+        }
+        for (size_t i = 0; i < n; i++) a[i] = (int)random64();
+        memcpy(b, a, n * sizeof(int));
+
+        clock_t start = clock();
+        radix_sort_int32((int32_t *)a, n);
+        double radix_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        start = clock();
+        qsort(b, n, sizeof(int), compare_int);
+        double qsort_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        assert(memcmp(a, b, n * sizeof(int)) == 0);
+        printf("%zu integers: radix sort %.3f s, qsort %.3f s (cpu time)\n",
+               n, radix_seconds, qsort_seconds);
+        free(a);
+        free(b);
+    }
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file
+ * @brief Randomized [quicksort](https://en.wikipedia.org/wiki/Quicksort)
+ *
+ * `DEFINE_RANDOM_QUICK_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `random_quick_sort_int` is provided for `int`.
+ *
+ * The pivot of every range is an element picked with rand(), so no input
+ * is slow every time: O(n log n) expected comparisons. Ranges are split by
+ * Hoare's scheme, which splits equal keys evenly. The smaller part is
+ * recursed into and the larger one looped on, which bounds the stack at
+ * O(log n).
+ */
+#ifndef RANDOM_QUICK_SORT_H
+#define RANDOM_QUICK_SORT_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "sort_hooks.h"
+
+/** a random index below n, also for n above RAND_MAX */
+static inline size_t random_quick_sort_index(size_t n)
+{
+    size_t r = (size_t)rand();
+    if (n > (size_t)RAND_MAX)
+        r = r * ((size_t)RAND_MAX + 1) + (size_t)rand();
+    return r % n;
+}
+
+/** Defines `static inline void name(type *a, size_t n)`. */
+#define DEFINE_RANDOM_QUICK_SORT(name, type, less, swap)                       \
+    /* sorts a[low..high] */                                                   \
+    static void name##_range(type *a, size_t low, size_t high)                 \
+    {                                                                          \
+        while (low < high)                                                     \
+        {                                                                      \
+            /* the pivot goes first, so the right part is never empty */       \
+            size_t p = low + random_quick_sort_index(high - low + 1);          \
+            swap(type, &a[low], &a[p]);                                        \
+            type pivot = a[low];                                               \
+            size_t i = low, j = high;                                          \
+            for (;;)                                                           \
+            {                                                                  \
+                while (less(&a[i], &pivot)) i++;                               \
+                while (less(&pivot, &a[j])) j--;                               \
+                if (i >= j)                                                    \
+                    break;                                                     \
+                swap(type, &a[i], &a[j]);                                      \
+                i++;                                                           \
+                j--;                                                           \
+            }                                                                  \
+            if (j - low < high - j)                                            \
+            {                                                                  \
+                name##_range(a, low, j);                                       \
+                low = j + 1;                                                   \
+            }                                                                  \
+            else                                                               \
+            {                                                                  \
+                name##_range(a, j + 1, high);                                  \
+                high = j;                                                      \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        if (n > 1)                                                             \
+            name##_range(a, 0, n - 1);                                         \
+    }
+
+DEFINE_RANDOM_QUICK_SORT(random_quick_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* RANDOM_QUICK_SORT_H */
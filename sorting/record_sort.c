@@ -0,0 +1,219 @@
+/**
+ * @file
+ * @brief Tests and timing of the record sorting API of record_sort.h.
+ *
+ * usage: ./record_sort [number of records]
+ * runs the self tests, then times record_sort(), sort_key_value_pairs()
+ * and qsort() on that many random records.
+ */
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "record_sort.h"
+
+/** a record with one field of every key type and a payload */
+typedef struct
+{
+    char name[12];
+    uint32_t u32;
+    int32_t i32;
+    float f32;
+    uint64_t u64;
+    int64_t i64;
+    double f64;
+    uint32_t position; /**< index before sorting, to check stability */
+} item;
+
+/** 64 random bits */
+static uint64_t random64(void)
+{
+    uint64_t x = 0;
+    for (int i = 0; i < 4; i++) x = x << 16 ^ (uint64_t)(rand() & 0xffff);
+    return x;
+}
+
+/** orders items by name */
+static int compare_name(const void *a, const void *b)
+{
+    return strcmp(((const item *)a)->name, ((const item *)b)->name);
+}
+
+/** orders items by u64, for qsort() */
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = ((const item *)a)->u64, y = ((const item *)b)->u64;
+    return (x > y) - (x < y);
+}
+
+/** compares the field of a key type in two items like record_sort does */
+static int compare_field(const item *a, const item *b, record_key_type type)
+{
+#define CMP(f) ((a->f > b->f) - (a->f < b->f))
+    switch (type)
+    {
+    case RECORD_KEY_UINT32:
+        return CMP(u32);
+    case RECORD_KEY_INT32:
+        return CMP(i32);
+    case RECORD_KEY_FLOAT:
+        return CMP(f32);
+    case RECORD_KEY_UINT64:
+        return CMP(u64);
+    case RECORD_KEY_INT64:
+        return CMP(i64);
+    case RECORD_KEY_DOUBLE:
+        return CMP(f64);
+    default:
+        return compare_name(a, b);
+    }
+#undef CMP
+}
+
+/** fills n random items, with few distinct keys when `duplicates` */
+static void fill(item *items, size_t n, int duplicates)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t r = random64();
+        if (duplicates)
+        {
+            r %= 16;
+        }
+        snprintf(items[i].name, sizeof(items[i].name), "n%u",
+                 (unsigned)(r % 1000));
+        items[i].u32 = (uint32_t)r;
+        items[i].i32 = (int32_t)(r ^ r >> 40) - (duplicates ? 8 : 0);
+        items[i].f32 = (float)(int32_t)r / 64.0f;
+        items[i].u64 = r;
+        items[i].i64 = (int64_t)r - (duplicates ? 8 : 0);
+        items[i].f64 = (double)(int64_t)(r * 0x9E3779B97F4A7C15ULL) * 1e-9;
+        items[i].position = (uint32_t)i;
+    }
+}
+
+/** Test function
+ * @param n number of records to sort by every key type
+ */
+static void test(size_t n)
+{
+    const struct
+    {
+        record_key_type type;
+        size_t offset;
+    } keys[] = {
+        {RECORD_KEY_UINT32, offsetof(item, u32)},
+        {RECORD_KEY_INT32, offsetof(item, i32)},
+        {RECORD_KEY_FLOAT, offsetof(item, f32)},
+        {RECORD_KEY_UINT64, offsetof(item, u64)},
+        {RECORD_KEY_INT64, offsetof(item, i64)},
+        {RECORD_KEY_DOUBLE, offsetof(item, f64)},
+        {RECORD_KEY_CUSTOM, 0},
+    };
+    item *items = malloc(n * sizeof(item));
+    assert(n == 0 || items);
+
+    for (int duplicates = 0; duplicates < 2; duplicates++)
+    {
+        for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++)
+        {
+            record_layout layout = {sizeof(item), keys[k].offset,
+                                    keys[k].type, compare_name};
+            fill(items, n, duplicates);
+            assert(record_sort(items, n, &layout) == 0);
+
+            for (size_t i = 1; i < n; i++)
+            {
+                int c = compare_field(&items[i - 1], &items[i], keys[k].type);
+                assert(c < 0 ||
+                       (c == 0 && items[i - 1].position < items[i].position));
+            }
+        }
+    }
+
+    key_value_pair *pairs = malloc(n * sizeof(key_value_pair));
+    assert(n == 0 || pairs);
+    for (size_t i = 0; i < n; i++)
+    {
+        pairs[i].key = random64() % (n / 4 + 1);
+        pairs[i].value = i;
+    }
+    assert(sort_key_value_pairs(pairs, n) == 0);
+    for (size_t i = 1; i < n; i++)
+    {
+        assert(pairs[i - 1].key < pairs[i].key ||
+               (pairs[i - 1].key == pairs[i].key &&
+                pairs[i - 1].value < pairs[i].value));
+    }
+
+    record_layout invalid = {sizeof(item), 0, RECORD_KEY_CUSTOM, NULL};
+    assert(record_sort(items, n, &invalid) == -1);
+
+    free(items);
+    free(pairs);
+}
+
+/** @returns seconds of processor time since start */
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/** Main function */
+int main(int argc, char *argv[])
+{
+    srand(time(NULL));
+
+    const size_t sizes[] = {0, 1, 2, 30, 511, 512, 5000, 100000};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        test(sizes[i]);
+    }
+    printf("All tests passed\n");
+
+    if (argc > 1)
+    {
+        size_t n = strtoul(argv[1], NULL, 0);
+        item *items = malloc(n * sizeof(item));
+        key_value_pair *pairs = malloc(n * sizeof(key_value_pair));
+        if (!items || !pairs)
+        {
+            printf("Can't Malloc! Please try again.");
+            return 1;
+        }
+        record_layout layout = {sizeof(item), offsetof(item, u64),
+                                RECORD_KEY_UINT64, NULL};
+
+        fill(items, n, 0);
+        clock_t start = clock();
+        record_sort(items, n, &layout);
+        double record_time = seconds_since(start);
+
+        fill(items, n, 0);
+        start = clock();
+        qsort(items, n, sizeof(item), compare_u64);
+        double qsort_time = seconds_since(start);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            pairs[i].key = random64();
+            pairs[i].value = i;
+        }
+        start = clock();
+        sort_key_value_pairs(pairs, n);
+        double pairs_time = seconds_since(start);
+
+        printf("%zu records of %zu bytes by uint64 key: record_sort %.3f s, "
+               "qsort %.3f s\n",
+               n, sizeof(item), record_time, qsort_time);
+        printf("%zu key/value pairs: sort_key_value_pairs %.3f s\n", n,
+               pairs_time);
+        free(items);
+        free(pairs);
+    }
+
+    return 0;
+}
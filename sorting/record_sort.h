@@ -0,0 +1,304 @@
+/**
+ * @file
+ * @brief Stable sorting of records (structs) by a key field.
+ *
+ * record_sort() sorts `n` records of `size` bytes described by a
+ * ::record_layout: either a typed key at `key_offset` or a comparator over
+ * whole records. Typed keys are copied with the record's index into an
+ * array of (key, index) pairs. That array is sorted by radix sort
+ * (radix_sort.h) from ::RECORD_SORT_RADIX_CUTOFF keys on, and by merge sort
+ * (merge_sort.h) below. The records are then gathered once into their
+ * final order, so large records are moved only once. Records compared by a
+ * comparator are merge sorted through an array of indices.
+ *
+ * sort_key_value_pairs() is the fast path for (uint64 key, uint64 value)
+ * records: they are sorted in place with no index array or gather.
+ *
+ * Every path is stable: records with equal keys keep their order.
+ */
+#ifndef RECORD_SORT_H
+#define RECORD_SORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "merge_sort.h"
+#include "radix_sort.h"
+
+/**
+ * typed keys sort by radix from this many records on, comparison sorts
+ * win below (fewer passes over the data than radix sort's 4 or 8)
+ */
+#define RECORD_SORT_RADIX_CUTOFF 512
+
+/** type of the key field of a record */
+typedef enum
+{
+    RECORD_KEY_UINT32,
+    RECORD_KEY_INT32,
+    RECORD_KEY_UINT64,
+    RECORD_KEY_INT64,
+    RECORD_KEY_FLOAT,
+    RECORD_KEY_DOUBLE,
+    RECORD_KEY_CUSTOM /**< ordered by record_layout::compare */
+} record_key_type;
+
+/** how to find and order the key of a record */
+typedef struct
+{
+    size_t size;              /**< bytes per record */
+    size_t key_offset;        /**< offset of a typed key in the record */
+    record_key_type key_type; /**< type of that key */
+    /** for ::RECORD_KEY_CUSTOM, qsort()-style comparison of two records */
+    int (*compare)(const void *, const void *);
+} record_layout;
+
+/** a 64-bit key with the position of its record */
+typedef struct
+{
+    uint64_t key;
+    uint64_t index;
+} record_key_index;
+
+/** record of the fast path */
+typedef struct
+{
+    uint64_t key;
+    uint64_t value;
+} key_value_pair;
+
+/** @cond instances used by record_sort() */
+/* 32-bit keys are packed with their index: key in the high half */
+static inline uint32_t record_packed_key(const uint64_t *x)
+{
+    return (uint32_t)(*x >> 32);
+}
+static inline uint64_t record_pair_key(const record_key_index *x)
+{
+    return x->key;
+}
+static inline uint64_t key_value_key(const key_value_pair *x)
+{
+    return x->key;
+}
+/* packed keys are unique, so comparing them whole is stable */
+#define RECORD_PAIR_LESS(x, y) ((x)->key < (y)->key)
+#define KEY_VALUE_LESS(x, y) ((x)->key < (y)->key)
+
+DEFINE_RADIX_SORT(record_radix_packed, uint64_t, uint32_t, record_packed_key)
+DEFINE_RADIX_SORT(record_radix_pairs, record_key_index, uint64_t,
+                  record_pair_key)
+DEFINE_RADIX_SORT(key_value_radix, key_value_pair, uint64_t, key_value_key)
+DEFINE_MERGE_SORT(record_merge_packed, uint64_t, MERGE_SORT_LESS)
+DEFINE_MERGE_SORT(record_merge_pairs, record_key_index, RECORD_PAIR_LESS)
+DEFINE_MERGE_SORT(key_value_merge, key_value_pair, KEY_VALUE_LESS)
+/** @endcond */
+
+/**
+ * Sorts (key, value) pairs by key, keeping equal keys in order.
+ * @returns 0 on success, -1 out of memory (`a` is then unchanged)
+ */
+static inline int sort_key_value_pairs(key_value_pair *a, size_t n)
+{
+    return n >= RECORD_SORT_RADIX_CUTOFF ? key_value_radix(a, n)
+                                         : key_value_merge(a, n);
+}
+
+/**
+ * @returns the key of a record as an unsigned integer ordered like the key
+ */
+static inline uint64_t record_unsigned_key(const char *record,
+                                           record_key_type type)
+{
+    union
+    {
+        uint32_t u32;
+        int32_t i32;
+        uint64_t u64;
+        int64_t i64;
+        float f32;
+        double f64;
+    } key;
+    memcpy(&key, record,
+           type == RECORD_KEY_UINT64 || type == RECORD_KEY_INT64 ||
+                   type == RECORD_KEY_DOUBLE
+               ? 8
+               : 4);
+
+    switch (type)
+    {
+    case RECORD_KEY_UINT32:
+        return radix_key_uint32(&key.u32);
+    case RECORD_KEY_INT32:
+        return radix_key_int32(&key.i32);
+    case RECORD_KEY_UINT64:
+        return radix_key_uint64(&key.u64);
+    case RECORD_KEY_INT64:
+        return radix_key_int64(&key.i64);
+    case RECORD_KEY_FLOAT:
+        return radix_key_float(&key.f32);
+    default:
+        return radix_key_double(&key.f64);
+    }
+}
+
+/**
+ * moves the records of `base` into the order of `index` (read with
+ * `stride` bytes between entries) through a buffer of n records
+ */
+static inline int record_gather(char *base, size_t n, size_t size,
+                                const uint64_t *index, size_t stride)
+{
+    char *out = (char *)malloc(n * size);
+    if (!out)
+    {
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t from = *(const uint64_t *)((const char *)index + i * stride);
+        memcpy(out + i * size, base + from * size, size);
+    }
+    memcpy(base, out, n * size);
+    free(out);
+    return 0;
+}
+
+/** @cond stable merge sort of record indices by a comparator */
+static void record_compare_sort(uint64_t *index, uint64_t *scratch, size_t n,
+                                const char *base,
+                                const record_layout *layout)
+{
+#define RECORD_AT(i) (base + (i) * layout->size)
+    if (n <= MERGE_SORT_CUTOFF)
+    {
+        for (size_t i = 1; i < n; i++)
+        {
+            uint64_t key = index[i];
+            size_t j = i;
+            for (; j > 0 && layout->compare(RECORD_AT(key),
+                                            RECORD_AT(index[j - 1])) < 0;
+                 j--)
+            {
+                index[j] = index[j - 1];
+            }
+            index[j] = key;
+        }
+        return;
+    }
+
+    size_t half = n / 2, i = 0, j = half, k = 0;
+    record_compare_sort(index, scratch, half, base, layout);
+    record_compare_sort(index + half, scratch, n - half, base, layout);
+    memcpy(scratch, index, n * sizeof(uint64_t));
+    while (i < half && j < n)
+    {
+        /* the right run wins only when strictly less */
+        if (layout->compare(RECORD_AT(scratch[j]), RECORD_AT(scratch[i])) < 0)
+            index[k++] = scratch[j++];
+        else
+            index[k++] = scratch[i++];
+    }
+    while (i < half) index[k++] = scratch[i++];
+    while (j < n) index[k++] = scratch[j++];
+#undef RECORD_AT
+}
+/** @endcond */
+
+/**
+ * Sorts n records at `base` by the key described in `layout`, keeping
+ * records with equal keys in their order.
+ * @returns 0 on success, -1 on an invalid layout or out of memory, in
+ * which case the records are unchanged
+ */
+static inline int record_sort(void *base, size_t n,
+                              const record_layout *layout)
+{
+    char *records = (char *)base;
+    int result = -1;
+
+    if (layout->size == 0 ||
+        (layout->key_type == RECORD_KEY_CUSTOM && !layout->compare))
+    {
+        return -1;
+    }
+    if (n < 2)
+    {
+        return 0;
+    }
+
+    if (layout->key_type == RECORD_KEY_CUSTOM)
+    {
+        uint64_t *index = (uint64_t *)malloc(2 * n * sizeof(uint64_t));
+        if (!index)
+        {
+            return -1;
+        }
+        for (size_t i = 0; i < n; i++) index[i] = i;
+        record_compare_sort(index, index + n, n, records, layout);
+        result = record_gather(records, n, layout->size, index,
+                               sizeof(uint64_t));
+        free(index);
+        return result;
+    }
+
+    int wide = layout->key_type == RECORD_KEY_UINT64 ||
+               layout->key_type == RECORD_KEY_INT64 ||
+               layout->key_type == RECORD_KEY_DOUBLE;
+
+    if (!wide && n <= UINT32_MAX)
+    {
+        /* key in the high half, index in the low half of one word */
+        uint64_t *packed = (uint64_t *)malloc(n * sizeof(uint64_t));
+        if (!packed)
+        {
+            return -1;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t key = record_unsigned_key(
+                records + i * layout->size + layout->key_offset,
+                layout->key_type);
+            packed[i] = key << 32 | i;
+        }
+        result = n >= RECORD_SORT_RADIX_CUTOFF ? record_radix_packed(packed, n)
+                                               : record_merge_packed(packed, n);
+        for (size_t i = 0; i < n && result == 0; i++)
+        {
+            packed[i] &= 0xffffffffu;
+        }
+        if (result == 0)
+        {
+            result = record_gather(records, n, layout->size, packed,
+                                   sizeof(uint64_t));
+        }
+        free(packed);
+        return result;
+    }
+
+    record_key_index *pairs =
+        (record_key_index *)malloc(n * sizeof(record_key_index));
+    if (!pairs)
+    {
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        pairs[i].key = record_unsigned_key(
+            records + i * layout->size + layout->key_offset, layout->key_type);
+        pairs[i].index = i;
+    }
+    result = n >= RECORD_SORT_RADIX_CUTOFF ? record_radix_pairs(pairs, n)
+                                           : record_merge_pairs(pairs, n);
+    if (result == 0)
+    {
+        result = record_gather(records, n, layout->size, &pairs[0].index,
+                               sizeof(record_key_index));
+    }
+    free(pairs);
+    return result;
+}
+
+#endif /* RECORD_SORT_H */
@@ -0,0 +1,222 @@
+/**
+ * @file
+ * @brief Parallel [sample sort](https://en.wikipedia.org/wiki/Samplesort), a
+ * bucket sort whose bucket boundaries are drawn from the data.
+ *
+ * `DEFINE_SAMPLE_SORT(name, type, less, base)` defines
+ * `static inline int name(type *a, size_t n)` sorting `n` elements of `type`
+ * by the strict ordering `less(x, y)`, which receives two `const type *`.
+ * `base(type *a, size_t n)` sorts the sample, the buckets and whole inputs
+ * below ::SAMPLE_SORT_CUTOFF elements, e.g. an introsort of introsort.h.
+ *
+ * A random sample of ::SAMPLE_SORT_OVERSAMPLING elements per bucket is
+ * sorted, and one in every ::SAMPLE_SORT_OVERSAMPLING of its elements
+ * becomes a splitter, so the ::SAMPLE_SORT_BUCKETS buckets get about equal
+ * shares of the input whatever its distribution. The splitters are stored as an
+ * implicit binary search tree, and each element descends it in
+ * ::SAMPLE_SORT_LOG_BUCKETS steps of the form `j = 2 * j + !less(x, s)`,
+ * which compile to no branches. An element equal to the splitter below it
+ * goes to an equality bucket of its own, which is never sorted, so inputs
+ * with few distinct values still make balanced buckets.
+ *
+ * With OpenMP, each thread classifies one slice of the input, counting the
+ * elements of each bucket and remembering the bucket of every element. A
+ * prefix sum of the counts, bucket by bucket and thread by thread, gives
+ * every thread its own range of every bucket in one contiguous output
+ * array, which the threads then fill without synchronisation. Finally the
+ * buckets are sorted in parallel, dynamically scheduled, and copied back.
+ * The sort needs `n` elements and `n` 16-bit bucket numbers of memory.
+ *
+ * The sort is not stable.
+ */
+#ifndef SAMPLE_SORT_H
+#define SAMPLE_SORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/** log2 of the number of buckets */
+#define SAMPLE_SORT_LOG_BUCKETS 8
+/** number of buckets, one less splitter */
+#define SAMPLE_SORT_BUCKETS (1 << SAMPLE_SORT_LOG_BUCKETS)
+/** buckets and equality buckets */
+#define SAMPLE_SORT_SLOTS (2 * SAMPLE_SORT_BUCKETS)
+/** sample elements drawn per bucket */
+#define SAMPLE_SORT_OVERSAMPLING 16
+/** inputs smaller than this are sorted by the base sort alone */
+#define SAMPLE_SORT_CUTOFF (1 << 16)
+
+#ifdef _OPENMP
+#define SAMPLE_SORT_PRAGMA(x) _Pragma(x)
+#else
+#define SAMPLE_SORT_PRAGMA(x)
+#endif
+
+/** ascending order of plain arithmetic types, for `DEFINE_SAMPLE_SORT` */
+#define SAMPLE_SORT_LESS(x, y) (*(x) < *(y))
+
+/** @cond OpenMP queries that also compile without it */
+static inline int sample_sort_thread(void)
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+static inline int sample_sort_threads(void)
+{
+#ifdef _OPENMP
+    return omp_get_num_threads();
+#else
+    return 1;
+#endif
+}
+
+static inline int sample_sort_max_threads(void)
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+/** @endcond */
+
+/**
+ * Defines `static inline int name(type *a, size_t n)`, a sample sort whose
+ * sample and buckets are sorted by `base(type *a, size_t n)`.
+ * @returns 0 on success, -1 if the buffers cannot be allocated, in which
+ * case `a` is left unchanged
+ */
+#define DEFINE_SAMPLE_SORT(name, type, less, base)                             \
+    /* sorts the sample of a and picks its splitters: sorted[1..k) in          \
+       order, and the same values in tree[1..k) as an implicit search tree     \
+       whose node j has children 2j and 2j + 1 */                              \
+    static inline void name##_splitters(const type *a, size_t n,               \
+                                        type *sample, type *sorted,            \
+                                        type *tree)                            \
+    {                                                                          \
+        const size_t k = SAMPLE_SORT_BUCKETS;                                  \
+        const size_t m = k * SAMPLE_SORT_OVERSAMPLING;                         \
+        uint64_t state = n * 0x9E3779B97F4A7C15u + 1;                          \
+        for (size_t i = 0; i < m; i++)                                         \
+        {                                                                      \
+            state ^= state << 13;                                              \
+            state ^= state >> 7;                                               \
+            state ^= state << 17;                                              \
+            sample[i] = a[state % n];                                          \
+        }                                                                      \
+        base(sample, m);                                                       \
+        for (size_t b = 1; b < k; b++)                                         \
+            sorted[b] = sample[b * SAMPLE_SORT_OVERSAMPLING - 1];              \
+        /* an in-order walk of the tree visits the splitters in order */       \
+        for (size_t step = k / 2, level = 1; step > 0; step /= 2, level *= 2)  \
+        {                                                                      \
+            for (size_t j = 0; j < level; j++)                                 \
+                tree[level + j] = sorted[step * (2 * j + 1)];                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    /* slot of x: 2b + 1 for the bucket b between sorted[b] and                \
+       sorted[b + 1], 2b if x equals sorted[b], which needs no sorting */      \
+    static inline unsigned name##_classify(const type *x, const type *sorted,  \
+                                           const type *tree)                   \
+    {                                                                          \
+        size_t j = 1;                                                          \
+        for (int level = 0; level < SAMPLE_SORT_LOG_BUCKETS; level++)          \
+            j = 2 * j + !less(x, &tree[j]);                                    \
+        size_t b = j - SAMPLE_SORT_BUCKETS;                                    \
+        return (unsigned)(2 * b + 1 - (b > 0 && !less(&sorted[b], x)));        \
+    }                                                                          \
+                                                                               \
+    static inline void name##_parallel(type *a, size_t n, type *out,           \
+                                       uint16_t *slot_of, size_t *count,       \
+                                       size_t *start, const type *sorted,      \
+                                       const type *tree)                       \
+    {                                                                          \
+        const size_t slots = SAMPLE_SORT_SLOTS;                                \
+        SAMPLE_SORT_PRAGMA("omp parallel")                                     \
+        {                                                                      \
+            size_t t = (size_t)sample_sort_thread();                           \
+            size_t threads = (size_t)sample_sort_threads();                    \
+            size_t first = n * t / threads, last = n * (t + 1) / threads;      \
+            size_t *mine = count + t * slots;                                  \
+                                                                               \
+            for (size_t i = first; i < last; i++)                              \
+            {                                                                  \
+                unsigned s = name##_classify(&a[i], sorted, tree);             \
+                slot_of[i] = (uint16_t)s;                                      \
+                mine[s]++;                                                     \
+            }                                                                  \
+            SAMPLE_SORT_PRAGMA("omp barrier")                                  \
+            SAMPLE_SORT_PRAGMA("omp single")                                   \
+            {                                                                  \
+                /* slot by slot, thread by thread: the output position of      \
+                   the first element of each thread in each slot */            \
+                size_t sum = 0;                                                \
+                for (size_t s = 0; s < slots; s++)                             \
+                {                                                              \
+                    start[s] = sum;                                            \
+                    for (size_t u = 0; u < threads; u++)                       \
+                    {                                                          \
+                        size_t c = count[u * slots + s];                       \
+                        count[u * slots + s] = sum;                            \
+                        sum += c;                                              \
+                    }                                                          \
+                }                                                              \
+                start[slots] = sum;                                            \
+            }                                                                  \
+            for (size_t i = first; i < last; i++)                              \
+                out[mine[slot_of[i]]++] = a[i];                                \
+            SAMPLE_SORT_PRAGMA("omp barrier")                                  \
+            SAMPLE_SORT_PRAGMA("omp for schedule(dynamic, 1)")                 \
+            for (size_t s = 0; s < slots; s++)                                 \
+            {                                                                  \
+                size_t size = start[s + 1] - start[s];                         \
+                if (s % 2)                                                     \
+                    base(out + start[s], size);                                \
+                memcpy(a + start[s], out + start[s], size * sizeof(type));     \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int name(type *a, size_t n)                                  \
+    {                                                                          \
+        if (n < SAMPLE_SORT_CUTOFF)                                            \
+        {                                                                      \
+            base(a, n);                                                        \
+            return 0;                                                          \
+        }                                                                      \
+        const size_t k = SAMPLE_SORT_BUCKETS, slots = SAMPLE_SORT_SLOTS;       \
+        size_t threads = (size_t)sample_sort_max_threads();                    \
+        type *out = (type *)malloc(n * sizeof(type));                          \
+        type *sample =                                                         \
+            (type *)malloc((k * SAMPLE_SORT_OVERSAMPLING + 2 * k) *            \
+                           sizeof(type));                                      \
+        uint16_t *slot_of = (uint16_t *)malloc(n * sizeof(uint16_t));          \
+        size_t *count = (size_t *)calloc(threads * slots + slots + 1,          \
+                                         sizeof(size_t));                      \
+        int status = -1;                                                       \
+        if (out && sample && slot_of && count)                                 \
+        {                                                                      \
+            type *sorted = sample + k * SAMPLE_SORT_OVERSAMPLING;              \
+            name##_splitters(a, n, sample, sorted, sorted + k);                \
+            name##_parallel(a, n, out, slot_of, count,                         \
+                            count + threads * slots, sorted, sorted + k);      \
+            status = 0;                                                        \
+        }                                                                      \
+        free(out);                                                             \
+        free(sample);                                                          \
+        free(slot_of);                                                         \
+        free(count);                                                           \
+        return status;                                                         \
+    }
+
+#endif /* SAMPLE_SORT_H */
@@ -2,46 +2,24 @@
  * @file
  * @brief [Selection sort](https://en.wikipedia.org/wiki/Selection_sort)
  * algorithm implementation.
+ *
+ * The sort lives in selection_sort.h; this program tests it.
  */
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 
-/**
- * Swapped two numbers using pointer
- * @param first first pointer of first number
- * @param second second pointer of second number
- */
-void swap(int *first, int *second)
-{
-    int temp = *first;
-    *first = *second;
-    *second = temp;
-}
+#include "selection_sort.h"
 
 /**
- * Selection sort algorithm implements
+ * Sorts arr with the selection sort of selection_sort.h
  * @param arr array to be sorted
  * @param size size of array
  */
 void selectionSort(int *arr, int size)
 {
-    for (int i = 0; i < size - 1; i++)
-    {
-        int min_index = i;
-        for (int j = i + 1; j < size; j++)
-        {
-            if (arr[min_index] > arr[j])
-            {
-                min_index = j;
-            }
-        }
-        if (min_index != i)
-        {
-            swap(arr + i, arr + min_index);
-        }
-    }
+    selection_sort_int(arr, (size_t)size);
 }
 
 /** Test function
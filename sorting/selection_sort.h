@@ -0,0 +1,37 @@
+/**
+ * @file
+ * @brief [Selection sort](https://en.wikipedia.org/wiki/Selection_sort)
+ *
+ * `DEFINE_SELECTION_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `selection_sort_int` is provided for `int`.
+ *
+ * The smallest element of the unsorted suffix is swapped to its front,
+ * one position at a time. O(n²) comparisons on every input but at most
+ * n - 1 swaps.
+ */
+#ifndef SELECTION_SORT_H
+#define SELECTION_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`. */
+#define DEFINE_SELECTION_SORT(name, type, less, swap)                          \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        for (size_t i = 0; i + 1 < n; i++)                                     \
+        {                                                                      \
+            size_t min = i;                                                    \
+            for (size_t j = i + 1; j < n; j++)                                 \
+                if (less(&a[j], &a[min]))                                      \
+                    min = j;                                                   \
+            if (min != i)                                                      \
+                swap(type, &a[i], &a[min]);                                    \
+        }                                                                      \
+    }
+
+DEFINE_SELECTION_SORT(selection_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* SELECTION_SORT_H */
@@ -0,0 +1,67 @@
+/**
+ * @file
+ * @brief [Shell sort](https://en.wikipedia.org/wiki/Shellsort)
+ *
+ * `DEFINE_SHELL_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h, using Shell's gaps n/2, n/4, ..., 1 and swaps, as in
+ * shell_sort.c. `DEFINE_SHELL_SORT_CIURA(name, type, less)` uses Ciura's
+ * gaps 1, 4, 10, 23, 57, 132, 301, 701, extended by factors of 2.25 for
+ * large n, and shifts instead of swapping, as in shell_sort2.c.
+ * `shell_sort_int` and `shell_sort_ciura_int` are provided for `int`.
+ *
+ * Every pass insertion sorts the elements a gap apart, so elements travel
+ * far in few moves before the final pass with gap 1. Shell's gaps take
+ * O(n²) comparisons in the worst case; Ciura's are much faster in practice.
+ */
+#ifndef SHELL_SORT_H
+#define SHELL_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** most gaps of `DEFINE_SHELL_SORT_CIURA`, enough for any size_t n */
+#define SHELL_SORT_MAX_GAPS 64
+
+/** Defines `static inline void name(type *a, size_t n)` with Shell's gaps. */
+#define DEFINE_SHELL_SORT(name, type, less, swap)                              \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        for (size_t gap = n / 2; gap > 0; gap /= 2)                            \
+            for (size_t i = gap; i < n; i++)                                   \
+                for (size_t j = i; j >= gap && less(&a[j], &a[j - gap]);       \
+                     j -= gap)                                                 \
+                    swap(type, &a[j], &a[j - gap]);                            \
+    }
+
+/** Defines `static inline void name(type *a, size_t n)` with Ciura's gaps. */
+#define DEFINE_SHELL_SORT_CIURA(name, type, less)                              \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        size_t gaps[SHELL_SORT_MAX_GAPS] = {1, 4, 10, 23, 57, 132, 301, 701};  \
+        size_t count = 8;                                                      \
+        while (count < SHELL_SORT_MAX_GAPS &&                                  \
+               gaps[count - 1] * 9 / 4 < n / 2)                                \
+        {                                                                      \
+            gaps[count] = gaps[count - 1] * 9 / 4;                             \
+            count++;                                                           \
+        }                                                                      \
+        while (count-- > 0)                                                    \
+        {                                                                      \
+            size_t gap = gaps[count];                                          \
+            for (size_t i = gap; i < n; i++)                                   \
+            {                                                                  \
+                type key = a[i];                                               \
+                size_t j = i;                                                  \
+                for (; j >= gap && less(&key, &a[j - gap]); j -= gap)          \
+                    a[j] = a[j - gap];                                         \
+                a[j] = key;                                                    \
+            }                                                                  \
+        }                                                                      \
+    }
+
+DEFINE_SHELL_SORT(shell_sort_int, int, SORT_LESS, SORT_SWAP)
+DEFINE_SHELL_SORT_CIURA(shell_sort_ciura_int, int, SORT_LESS)
+
+#endif /* SHELL_SORT_H */
@@ -8,6 +8,8 @@
 #include <stdlib.h>
 #include <time.h>
 
+#include "shell_sort.h"
+
 /**
  * @addtogroup sorting Sorting algorithms
  * @{
@@ -19,46 +21,16 @@ void show_data(int *arr, long len)
     printf("\n");
 }
 
-/** Function to swap values of two integers
- * @param [in,out] a reference to first variable
- * @param [in,out] b reference to second variable
- */
-inline void swap(int *a, int *b)
-{
-    int tmp;
-
-    tmp = *a;
-    *a = *b;
-    *b = tmp;
-}
-
 /**
- * Shell sort algorithm.\n
+ * Shell sort algorithm with Ciura's gaps, by shell_sort_ciura_int() of
+ * shell_sort.h.\n
  * Optimized algorithm - takes half the time as other
  * @param [in,out] array array to sort
  * @param [in] LEN length of the array
  */
 void shell_sort(int *array, long LEN)
 {
-    const int gaps[] = {701, 301, 132, 57, 23, 10, 4, 1};
-    const int gap_len = 8;
-    long i, j, g;
-
-    for (g = 0; g < gap_len; g++)
-    {  // for each gap
-        int gap = gaps[g];
-        for (i = gap; i < LEN; i++)
-        {  // from gap position to the end
-            int tmp = array[i];
-
-            for (j = i; j >= gap && (array[j - gap] - tmp) > 0; j -= gap)
-                array[j] = array[j - gap];
-            array[j] = tmp;
-        }
-    }
-#ifdef DEBUG
-    for (i = 0; i < LEN; i++) printf("%s\t", data[i]);
-#endif
+    shell_sort_ciura_int(array, (size_t)LEN);
 }
 /** @} */
 
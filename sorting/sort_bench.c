@@ -0,0 +1,745 @@
+/**
+ * @file
+ * @brief Benchmark of the sorting algorithms of this directory on standard
+ * input distributions, with comparison, swap and hardware counters.
+ *
+ * usage: ./sort_bench [-n sizes] [-d distributions] [-a algorithms]
+ *                     [-q quadratic limit] [-s seed]
+ * sizes, distributions and algorithms are comma-separated lists, e.g.
+ * `./sort_bench -n 1e3,1e6 -d uniform,zipf -a heap,introsort`. Sizes default
+ * to 1e3,1e4,1e5,1e6 and may go up to 1e9. The distributions are uniform,
+ * sorted, reverse, sawtooth, few-unique and zipf. All keys are in [0, n), so
+ * the counting sorts apply to every input.
+ *
+ * Every sort of this directory is registered in ::algorithms behind the
+ * common ::sort_function signature, from the header its program uses, so the
+ * code timed is the code the programs run. Variants of one algorithm share
+ * the entry of its header: bubble_sort_2.c and bubble_sort_recursion.c that
+ * of bubble, shaker_sort.c that of cocktail, radix_sort_2.c that of
+ * radix_bytes and multikey_quick_sort.c that of string. The bucket entry is
+ * the sample sort of sample_sort.h that bucket_sort.c runs. string_sort
+ * sorts the keys as zero-padded decimal strings and its time includes
+ * writing and parsing them; external_sort.c sorts files and is not
+ * registered.
+ *
+ * The sorts of the headers compare and exchange elements through the hooks
+ * of sort_hooks.h. Each is instantiated twice: a plain instance, which is
+ * timed, and one whose hooks count their calls in ::comparisons and
+ * ::swaps, which is run separately on the same input, so the counting never
+ * shows in the times. Sorts without the hooks show a dash.
+ *
+ * For every run the table shows ns per element, comparisons, swaps and, on
+ * Linux where perf_event_open(2) is permitted, CPU cycles, cache misses and
+ * branch misses of the timed run. O(n²) sorts are skipped above the
+ * quadratic limit (default 10000 elements), slower ones well below it.
+ * Sorts that are only O(n²) on some inputs, like a last-element pivot
+ * quicksort, are skipped above it on every distribution but uniform. Every
+ * result is checked; a wrong one is reported and makes the exit status
+ * nonzero. With OpenMP every sort runs on one thread, so counts are exact
+ * and sorts compare like for like.
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "bead_sort.h"
+#include "binary_insertion_sort.h"
+#include "bogo_sort.h"
+#include "bubble_sort.h"
+#include "cocktail_sort.h"
+#include "comb_sort.h"
+#include "counting_sort.h"
+#include "cycle_sort.h"
+#include "gnome_sort.h"
+#include "heap_sort.h"
+#include "insertion_sort.h"
+#include "introsort.h"
+#include "merge_sort.h"
+#include "merge_sort_nr.h"
+#include "odd_even_sort.h"
+#include "pancake_sort.h"
+#include "partition_sort.h"
+#include "patience_sort.h"
+#include "pigeonhole_sort.h"
+#include "quick_sort.h"
+#include "radix_sort.h"
+#include "random_quick_sort.h"
+#include "record_sort.h"
+#include "sample_sort.h"
+#include "selection_sort.h"
+#include "shell_sort.h"
+#include "sort_hooks.h"
+#include "sort_small.h"
+#include "stooge_sort.h"
+#include "string_sort.h"
+
+/** comparisons made by the current counted sort */
+static unsigned long long comparisons;
+/** swaps made by the current counted sort */
+static unsigned long long swaps;
+
+/** counted ::SORT_LESS */
+#define COUNTED_LESS(x, y) (comparisons++, SORT_LESS(x, y))
+/** counted ::SORT_SWAP */
+#define COUNTED_SWAP(type, x, y)                                               \
+    do                                                                         \
+    {                                                                          \
+        swaps++;                                                               \
+        SORT_SWAP(type, x, y);                                                 \
+    } while (0)
+
+/** @cond counted instances of the headers, and plain ones they lack */
+DEFINE_BINARY_INSERTION_SORT(binary_insertion_counted, int, COUNTED_LESS)
+DEFINE_BOGO_SORT(bogo_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_BUBBLE_SORT(bubble_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_COCKTAIL_SORT(cocktail_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_COMB_SORT(comb_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_CYCLE_SORT(cycle_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_GNOME_SORT(gnome_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_HEAP_SORT(heap_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_INSERTION_SORT(insertion_counted, int, COUNTED_LESS)
+DEFINE_INTROSORT(introsort_plain, int, SORT_LESS)
+DEFINE_INTROSORT_HOOKS(introsort_counted, int, COUNTED_LESS, COUNTED_SWAP,
+                       introsort_counted_insertion, INTROSORT_CUTOFF)
+DEFINE_MERGE_SORT(merge_plain, int, SORT_LESS)
+DEFINE_MERGE_SORT(merge_counted, int, COUNTED_LESS)
+DEFINE_MERGE_SORT_NR(merge_nr_counted, int, COUNTED_LESS)
+DEFINE_ODD_EVEN_SORT(odd_even_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_PANCAKE_SORT(pancake_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_PARTITION_SORT(partition_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_PATIENCE_SORT(patience_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_QUICK_SORT(quick_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_RANDOM_QUICK_SORT(random_quick_counted, int, COUNTED_LESS,
+                         COUNTED_SWAP)
+DEFINE_SAMPLE_SORT(sample_plain, int, SORT_LESS, introsort_plain)
+DEFINE_SAMPLE_SORT(sample_counted, int, COUNTED_LESS, introsort_counted)
+DEFINE_SELECTION_SORT(selection_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_SHELL_SORT(shell_counted, int, COUNTED_LESS, COUNTED_SWAP)
+DEFINE_SHELL_SORT_CIURA(shell_ciura_counted, int, COUNTED_LESS)
+DEFINE_STOOGE_SORT(stooge_counted, int, COUNTED_LESS, COUNTED_SWAP)
+/** @endcond */
+
+/**
+ * common signature of the benchmarked sorts
+ * @returns 0 on success, -1 if the sort could not allocate its buffers
+ */
+typedef int (*sort_function)(int *a, size_t n);
+
+/* -------------------------------------------------------------------------
+ * The sorts, adapted to ::sort_function
+ * ---------------------------------------------------------------------- */
+
+/** defines `name`, the ::sort_function of `void sort(int *a, size_t n)` */
+#define VOID_SORT(name, sort)                                                  \
+    static int name(int *a, size_t n)                                          \
+    {                                                                          \
+        sort(a, n);                                                            \
+        return 0;                                                              \
+    }
+
+/** @cond adapters */
+VOID_SORT(binary_insertion, binary_insertion_sort_int)
+VOID_SORT(binary_insertion_c, binary_insertion_counted)
+VOID_SORT(bogo, bogo_sort_int)
+VOID_SORT(bogo_c, bogo_counted)
+VOID_SORT(bubble, bubble_sort_int)
+VOID_SORT(bubble_c, bubble_counted)
+VOID_SORT(cocktail, cocktail_sort_int)
+VOID_SORT(cocktail_c, cocktail_counted)
+VOID_SORT(comb, comb_sort_int)
+VOID_SORT(comb_c, comb_counted)
+VOID_SORT(cycle, cycle_sort_int)
+VOID_SORT(cycle_c, cycle_counted)
+VOID_SORT(gnome, gnome_sort_int)
+VOID_SORT(gnome_c, gnome_counted)
+VOID_SORT(heap, heap_sort_int)
+VOID_SORT(heap_c, heap_counted)
+VOID_SORT(insertion, insertion_sort_int)
+VOID_SORT(insertion_c, insertion_counted)
+VOID_SORT(intro, introsort_plain)
+VOID_SORT(intro_c, introsort_counted)
+VOID_SORT(intro_network, introsort_int)
+VOID_SORT(odd_even, odd_even_sort_int)
+VOID_SORT(odd_even_c, odd_even_counted)
+VOID_SORT(pancake, pancake_sort_int)
+VOID_SORT(pancake_c, pancake_counted)
+VOID_SORT(partition, partition_sort_int)
+VOID_SORT(partition_c, partition_counted)
+VOID_SORT(quick, quick_sort_int)
+VOID_SORT(quick_c, quick_counted)
+VOID_SORT(random_quick, random_quick_sort_int)
+VOID_SORT(random_quick_c, random_quick_counted)
+VOID_SORT(selection, selection_sort_int)
+VOID_SORT(selection_c, selection_counted)
+VOID_SORT(shell, shell_sort_int)
+VOID_SORT(shell_c, shell_counted)
+VOID_SORT(shell_ciura, shell_sort_ciura_int)
+VOID_SORT(shell_ciura_c, shell_ciura_counted)
+VOID_SORT(stooge, stooge_sort_int)
+VOID_SORT(stooge_c, stooge_counted)
+
+static int radix_bytes(int *a, size_t n)
+{
+    return radix_sort_int32((int32_t *)a, n);
+}
+static int small(int *a, size_t n)
+{
+    sort_small_int32((int32_t *)a, n);
+    return 0;
+}
+
+/* the ints themselves are the records, keyed by all their 4 bytes */
+static int records(int *a, size_t n)
+{
+    const record_layout layout = {sizeof(int), 0, RECORD_KEY_INT32, NULL};
+    return record_sort(a, n, &layout);
+}
+
+/** digits of the strings string_sort() sorts, enough for any key below 1e10 */
+#define STRING_DIGITS 10
+
+/* keys as zero-padded decimal strings, whose strcmp() order is numeric */
+static int strings(int *a, size_t n)
+{
+    char *text = malloc(n * (STRING_DIGITS + 1));
+    char **s = malloc(n * sizeof(char *));
+    int result = -1;
+    if (text && s)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            s[i] = text + i * (STRING_DIGITS + 1);
+            s[i][STRING_DIGITS] = '\0';
+            for (int d = STRING_DIGITS - 1, x = a[i]; d >= 0; d--, x /= 10)
+                s[i][d] = (char)('0' + x % 10);
+        }
+        result = string_sort(s, n);
+        for (size_t i = 0; i < n && result == 0; i++)
+        {
+            int x = 0;
+            for (int d = 0; d < STRING_DIGITS; d++) x = x * 10 + s[i][d] - '0';
+            a[i] = x;
+        }
+    }
+    free(text);
+    free(s);
+    return result;
+}
+
+static int compare_int(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+static int compare_int_counted(const void *a, const void *b)
+{
+    comparisons++;
+    return compare_int(a, b);
+}
+static int libc_qsort(int *a, size_t n)
+{
+    qsort(a, n, sizeof(int), compare_int);
+    return 0;
+}
+static int libc_qsort_c(int *a, size_t n)
+{
+    qsort(a, n, sizeof(int), compare_int_counted);
+    return 0;
+}
+/** @endcond */
+
+/* -------------------------------------------------------------------------
+ * Registry
+ * ---------------------------------------------------------------------- */
+
+/** growth of the running time, which decides the sizes an entry runs at */
+typedef enum
+{
+    N_LOG_N,   /**< no limit */
+    QUADRATIC, /**< skipped above the quadratic limit */
+    SLOWER,    /**< skipped above a sixteenth of the quadratic limit */
+    FACTORIAL  /**< skipped above ::FACTORIAL_LIMIT elements */
+} complexity;
+
+/** largest input given to factorial-time sorts */
+#define FACTORIAL_LIMIT 10
+
+/** what the counted instance of an entry counts */
+typedef enum
+{
+    COUNTS_NOTHING,     /**< there is no counted instance */
+    COUNTS_COMPARISONS, /**< it has no swap hook */
+    COUNTS_BOTH
+} counts;
+
+/** a benchmarked sort */
+typedef struct
+{
+    const char *name;
+    sort_function sort;    /**< the timed instance */
+    sort_function counted; /**< the counted instance, or NULL */
+    counts counting;       /**< what `counted` counts */
+    complexity cost;       /**< on uniform input */
+    complexity worst_cost; /**< on the other distributions */
+} sort_algorithm;
+
+/** every registered sort */
+static const sort_algorithm algorithms[] = {
+    {"bead", bead_sort, NULL, COUNTS_NOTHING, SLOWER, SLOWER},
+    {"binary_insertion", binary_insertion, binary_insertion_c,
+     COUNTS_COMPARISONS, QUADRATIC, QUADRATIC},
+    {"bogo", bogo, bogo_c, COUNTS_BOTH, FACTORIAL, FACTORIAL},
+    {"bubble", bubble, bubble_c, COUNTS_BOTH, QUADRATIC, QUADRATIC},
+    /* bucket_sort.c, whose sample sort only swaps in its buckets' introsorts */
+    {"bucket", sample_plain, sample_counted, COUNTS_COMPARISONS, N_LOG_N,
+     N_LOG_N},
+    {"cocktail", cocktail, cocktail_c, COUNTS_BOTH, QUADRATIC, QUADRATIC},
+    {"comb", comb, comb_c, COUNTS_BOTH, N_LOG_N, N_LOG_N},
+    {"counting", counting_sort, NULL, COUNTS_NOTHING, N_LOG_N, N_LOG_N},
+    {"cycle", cycle, cycle_c, COUNTS_BOTH, QUADRATIC, QUADRATIC},
+    {"gnome", gnome, gnome_c, COUNTS_BOTH, QUADRATIC, QUADRATIC},
+    {"heap", heap, heap_c, COUNTS_BOTH, N_LOG_N, N_LOG_N},
+    {"insertion", insertion, insertion_c, COUNTS_COMPARISONS, QUADRATIC,
+     QUADRATIC},
+    {"introsort", intro, intro_c, COUNTS_BOTH, N_LOG_N, N_LOG_N},
+    /* its sorting networks compare without the hooks */
+    {"introsort_int", intro_network, NULL, COUNTS_NOTHING, N_LOG_N, N_LOG_N},
+    {"merge", merge_plain, merge_counted, COUNTS_COMPARISONS, N_LOG_N,
+     N_LOG_N},
+    {"merge_bottom_up", merge_sort_nr_int, merge_nr_counted,
+     COUNTS_COMPARISONS, N_LOG_N, N_LOG_N},
+    {"odd_even", odd_even, odd_even_c, COUNTS_BOTH, QUADRATIC, QUADRATIC},
+    {"pancake", pancake, pancake_c, COUNTS_BOTH, QUADRATIC, QUADRATIC},
+    {"partition", partition, partition_c, COUNTS_BOTH, N_LOG_N, QUADRATIC},
+    {"patience", patience_sort_int, patience_counted, COUNTS_BOTH, N_LOG_N,
+     N_LOG_N},
+    {"pigeonhole", pigeonhole_sort, NULL, COUNTS_NOTHING, N_LOG_N, N_LOG_N},
+    {"quick", quick, quick_c, COUNTS_BOTH, N_LOG_N, QUADRATIC},
+    {"radix_decimal", radix_sort_decimal, NULL, COUNTS_NOTHING, N_LOG_N,
+     N_LOG_N},
+    {"radix_bytes", radix_bytes, NULL, COUNTS_NOTHING, N_LOG_N, N_LOG_N},
+    {"random_quick", random_quick, random_quick_c, COUNTS_BOTH, N_LOG_N,
+     N_LOG_N},
+    {"record", records, NULL, COUNTS_NOTHING, N_LOG_N, N_LOG_N},
+    {"selection", selection, selection_c, COUNTS_BOTH, QUADRATIC, QUADRATIC},
+    {"shell", shell, shell_c, COUNTS_BOTH, N_LOG_N, N_LOG_N},
+    {"shell_ciura", shell_ciura, shell_ciura_c, COUNTS_COMPARISONS, N_LOG_N,
+     N_LOG_N},
+    /* networks up to SORT_SMALL_MAX elements, insertion sort above */
+    {"small", small, NULL, COUNTS_NOTHING, QUADRATIC, QUADRATIC},
+    {"stooge", stooge, stooge_c, COUNTS_BOTH, SLOWER, SLOWER},
+    {"string", strings, NULL, COUNTS_NOTHING, N_LOG_N, N_LOG_N},
+    {"qsort", libc_qsort, libc_qsort_c, COUNTS_COMPARISONS, N_LOG_N,
+     N_LOG_N},
+};
+#define ALGORITHMS (sizeof(algorithms) / sizeof(algorithms[0]))
+
+/** @returns the largest n an entry of this complexity runs at */
+static size_t size_limit(complexity cost, size_t quadratic_limit)
+{
+    switch (cost)
+    {
+    case N_LOG_N:
+        return SIZE_MAX;
+    case QUADRATIC:
+        return quadratic_limit;
+    case SLOWER:
+        return quadratic_limit / 16;
+    default:
+        return FACTORIAL_LIMIT;
+    }
+}
+
+/* -------------------------------------------------------------------------
+ * Inputs
+ * ---------------------------------------------------------------------- */
+
+/** 64 random bits (xorshift64*) */
+static uint64_t random_state = 88172645463325252ULL;
+static uint64_t random64(void)
+{
+    random_state ^= random_state >> 12;
+    random_state ^= random_state << 25;
+    random_state ^= random_state >> 27;
+    return random_state * 2685821657736338717ULL;
+}
+
+/** input distributions */
+typedef enum
+{
+    UNIFORM,
+    SORTED,
+    REVERSE,
+    SAWTOOTH,
+    FEW_UNIQUE,
+    ZIPF,
+    DISTRIBUTIONS
+} distribution;
+
+static const char *const distribution_names[] = {
+    "uniform", "sorted", "reverse", "sawtooth", "few-unique", "zipf"};
+
+/** fills a with n keys in [0, n) of the given distribution */
+static void fill(int *a, size_t n, distribution d)
+{
+    size_t tooth = n / 8 + 1;
+    double log_range = log((double)n + 1);
+    for (size_t i = 0; i < n; i++)
+    {
+        switch (d)
+        {
+        case UNIFORM:
+            a[i] = (int)(random64() % n);
+            break;
+        case SORTED:
+            a[i] = (int)i;
+            break;
+        case REVERSE:
+            a[i] = (int)(n - 1 - i);
+            break;
+        case SAWTOOTH:
+            a[i] = (int)(i % tooth * 8);
+            break;
+        case FEW_UNIQUE:
+            a[i] = (int)(random64() % 16 * (n / 16));
+            break;
+        default:
+        {
+            /* P(k) ~ 1/k for ranks k in [1, n], by inverting the CDF */
+            double u = (double)(random64() >> 11) / 9007199254740992.0;
+            size_t rank = (size_t)exp(u * log_range);
+            a[i] = (int)(rank > n ? n - 1 : rank - 1);
+            break;
+        }
+        }
+    }
+}
+
+/** sum and sum of squares of the keys, to check a sort kept them all */
+static void checksum(const int *a, size_t n, uint64_t sums[2])
+{
+    sums[0] = sums[1] = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        sums[0] += (uint64_t)a[i];
+        sums[1] += (uint64_t)a[i] * (uint64_t)a[i];
+    }
+}
+
+/* -------------------------------------------------------------------------
+ * Hardware counters
+ * ---------------------------------------------------------------------- */
+
+/** hardware events counted around every sort */
+enum
+{
+    CYCLES,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    EVENTS
+};
+
+/** file descriptors of the events, -1 where unavailable */
+static int perf_fd[EVENTS] = {-1, -1, -1};
+
+/** opens the events as one group, if the system allows it */
+static void perf_open(void)
+{
+#ifdef __linux__
+    const uint64_t configs[EVENTS] = {PERF_COUNT_HW_CPU_CYCLES,
+                                      PERF_COUNT_HW_CACHE_MISSES,
+                                      PERF_COUNT_HW_BRANCH_MISSES};
+    for (int e = 0; e < EVENTS; e++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[e];
+        attr.disabled = e == 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        perf_fd[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1,
+                                  e == 0 ? -1 : perf_fd[0], 0);
+        if (perf_fd[0] < 0)
+            return;
+    }
+#endif
+}
+
+/** resets and starts the events */
+static void perf_start(void)
+{
+#ifdef __linux__
+    if (perf_fd[0] >= 0)
+    {
+        ioctl(perf_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(perf_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+/** stops the events and reads them into counts, -1 where unavailable */
+static void perf_stop(long long counts[EVENTS])
+{
+    for (int e = 0; e < EVENTS; e++) counts[e] = -1;
+#ifdef __linux__
+    if (perf_fd[0] >= 0)
+    {
+        uint64_t values[1 + EVENTS];
+        ioctl(perf_fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (read(perf_fd[0], values, sizeof(values)) > 0)
+        {
+            /* the group lists the events that opened, in order */
+            for (int e = 0, k = 0; e < EVENTS && k < (int)values[0]; e++)
+                if (perf_fd[e] >= 0)
+                    counts[e] = (long long)values[1 + k++];
+        }
+    }
+#endif
+}
+
+/** closes the events */
+static void perf_close(void)
+{
+#ifdef __linux__
+    for (int e = EVENTS - 1; e >= 0; e--)
+    {
+        if (perf_fd[e] >= 0)
+            close(perf_fd[e]);
+        perf_fd[e] = -1;
+    }
+#endif
+}
+
+/** prints a counter, or a dash where unavailable */
+static void print_count(long long count, int width)
+{
+    if (count < 0)
+        printf(" %*s", width, "-");
+    else
+        printf(" %*lld", width, count);
+}
+
+/* -------------------------------------------------------------------------
+ * Driver
+ * ---------------------------------------------------------------------- */
+
+/**
+ * splits a comma-separated list, calling add(item) for every item.
+ * @returns 0, or -1 as soon as add rejects an item
+ */
+static int parse_list(char *list, int (*add)(const char *))
+{
+    for (char *item = strtok(list, ","); item; item = strtok(NULL, ","))
+    {
+        if (add(item) != 0)
+        {
+            fprintf(stderr, "unknown item: %s\n", item);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/** @cond options */
+static size_t sizes[64];
+static size_t nsizes;
+static int distribution_chosen[DISTRIBUTIONS];
+static int algorithm_chosen[ALGORITHMS];
+
+static int add_size(const char *item)
+{
+    double n = strtod(item, NULL);
+    if (n < 1 || nsizes == sizeof(sizes) / sizeof(sizes[0]))
+        return -1;
+    sizes[nsizes++] = (size_t)n;
+    return 0;
+}
+static int add_distribution(const char *item)
+{
+    for (int d = 0; d < DISTRIBUTIONS; d++)
+        if (strcmp(item, distribution_names[d]) == 0)
+            return distribution_chosen[d] = 1, 0;
+    return -1;
+}
+static int add_algorithm(const char *item)
+{
+    for (size_t i = 0; i < ALGORITHMS; i++)
+        if (strcmp(item, algorithms[i].name) == 0)
+            return algorithm_chosen[i] = 1, 0;
+    return -1;
+}
+/** @endcond */
+
+/** prints how to call the program */
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [-n sizes] [-d distributions] [-a algorithms] "
+            "[-q quadratic limit] [-s seed]\ndistributions:",
+            program);
+    for (int d = 0; d < DISTRIBUTIONS; d++)
+        fprintf(stderr, " %s", distribution_names[d]);
+    fprintf(stderr, "\nalgorithms:");
+    for (size_t i = 0; i < ALGORITHMS; i++)
+        fprintf(stderr, " %s", algorithms[i].name);
+    fprintf(stderr, "\n");
+}
+
+/** Main function */
+int main(int argc, char *argv[])
+{
+    int any_distribution = 0, any_algorithm = 0, wrong = 0;
+    size_t quadratic_limit = 10000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        int ok = i + 1 < argc && argv[i][0] == '-' && argv[i][1] != '\0' &&
+                 argv[i][2] == '\0';
+        switch (ok ? argv[i][1] : '?')
+        {
+        case 'n':
+            ok = parse_list(argv[++i], add_size) == 0;
+            break;
+        case 'd':
+            ok = parse_list(argv[++i], add_distribution) == 0;
+            any_distribution = 1;
+            break;
+        case 'a':
+            ok = parse_list(argv[++i], add_algorithm) == 0;
+            any_algorithm = 1;
+            break;
+        case 'q':
+            quadratic_limit = (size_t)strtod(argv[++i], NULL);
+            break;
+        case 's':
+            random_state = strtoull(argv[++i], NULL, 0) | 1;
+            break;
+        default:
+            ok = 0;
+        }
+        if (!ok)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (nsizes == 0)
+    {
+        add_size("1e3");
+        add_size("1e4");
+        add_size("1e5");
+        add_size("1e6");
+    }
+    for (int d = 0; d < DISTRIBUTIONS && !any_distribution; d++)
+        distribution_chosen[d] = 1;
+    for (size_t i = 0; i < ALGORITHMS && !any_algorithm; i++)
+        algorithm_chosen[i] = 1;
+
+#ifdef _OPENMP
+    omp_set_num_threads(1);
+#endif
+    perf_open();
+    if (perf_fd[0] < 0)
+        printf("hardware counters unavailable (perf_event_open)\n");
+    printf("%-16s %-10s %10s %9s %14s %14s %14s %12s %12s\n", "algorithm",
+           "input", "n", "ns/elem", "comparisons", "swaps", "cycles",
+           "cache-miss", "branch-miss");
+
+    for (size_t s = 0; s < nsizes; s++)
+    {
+        size_t n = sizes[s];
+        int *input = malloc(n * sizeof(int)), *a = malloc(n * sizeof(int));
+        int *b = malloc(n * sizeof(int));
+        if (!input || !a || !b)
+        {
+            printf("Can't Malloc %zu elements! Please try again.\n", n);
+            return 1;
+        }
+
+        for (int d = 0; d < DISTRIBUTIONS; d++)
+        {
+            if (!distribution_chosen[d])
+                continue;
+            uint64_t expected[2], got[2];
+            fill(input, n, (distribution)d);
+            checksum(input, n, expected);
+
+            for (size_t i = 0; i < ALGORITHMS; i++)
+            {
+                const sort_algorithm *algorithm = &algorithms[i];
+                complexity cost =
+                    d == UNIFORM ? algorithm->cost : algorithm->worst_cost;
+                if (!algorithm_chosen[i] ||
+                    n > size_limit(cost, quadratic_limit))
+                    continue;
+
+                memcpy(a, input, n * sizeof(int));
+                long long counts[EVENTS];
+                struct timespec start, end;
+                perf_start();
+                timespec_get(&start, TIME_UTC);
+                int failed = algorithm->sort(a, n);
+                timespec_get(&end, TIME_UTC);
+                perf_stop(counts);
+
+                double ns = (end.tv_sec - start.tv_sec) * 1e9 +
+                            (end.tv_nsec - start.tv_nsec);
+                printf("%-16s %-10s %10zu %9.1f", algorithm->name,
+                       distribution_names[d], n, ns / n);
+
+                /* counted separately, on the same input */
+                long long compared = -1, swapped = -1;
+                if (algorithm->counted && !failed)
+                {
+                    memcpy(b, input, n * sizeof(int));
+                    comparisons = swaps = 0;
+                    failed = algorithm->counted(b, n);
+                    compared = (long long)comparisons;
+                    if (algorithm->counting == COUNTS_BOTH)
+                        swapped = (long long)swaps;
+                }
+                print_count(compared, 14);
+                print_count(swapped, 14);
+                for (int e = 0; e < EVENTS; e++)
+                    print_count(counts[e], e == CYCLES ? 14 : 12);
+
+                int sorted = 1;
+                for (size_t k = 1; k < n && sorted; k++)
+                    sorted = a[k - 1] <= a[k];
+                checksum(a, n, got);
+                if (failed)
+                {
+                    printf("  FAILED");
+                    wrong = 1;
+                }
+                else if (!sorted || got[0] != expected[0] ||
+                         got[1] != expected[1])
+                {
+                    printf("  WRONG");
+                    wrong = 1;
+                }
+                printf("\n");
+            }
+        }
+        free(input);
+        free(a);
+        free(b);
+    }
+    perf_close();
+    return wrong;
+}
@@ -0,0 +1,33 @@
+/**
+ * @file
+ * @brief Default hooks of the simple sorts of this directory.
+ *
+ * Each simple sort is written once, as a macro such as
+ * `DEFINE_BUBBLE_SORT(name, type, less, swap)` that defines
+ * `static inline void name(type *a, size_t n)`. The sort compares elements
+ * only through `less(x, y)`, a strict ordering that receives two
+ * `const type *`, and exchanges two elements only through
+ * `swap(type, x, y)`, which receives two `type *`. Sorts that move elements
+ * without exchanging them, like insertion sort, take no `swap` hook.
+ *
+ * ::SORT_LESS and ::SORT_SWAP are the plain hooks, which every header uses
+ * for its `int` instance. sort_bench.c instantiates the sorts a second time
+ * with hooks that count their calls, so the counting never shows in the
+ * timed instances.
+ */
+#ifndef SORT_HOOKS_H
+#define SORT_HOOKS_H
+
+/** ascending order of plain arithmetic types */
+#define SORT_LESS(x, y) (*(x) < *(y))
+
+/** exchanges the two elements of type `type` at x and y */
+#define SORT_SWAP(type, x, y)                                                  \
+    do                                                                         \
+    {                                                                          \
+        type sort_swap_tmp_ = *(x);                                            \
+        *(x) = *(y);                                                           \
+        *(y) = sort_swap_tmp_;                                                 \
+    } while (0)
+
+#endif /* SORT_HOOKS_H */
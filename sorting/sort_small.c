@@ -0,0 +1,179 @@
+/**
+ * @file
+ * @brief Tests and benchmark of the sorting networks of sort_small.h.
+ *
+ * usage: ./sort_small [number of arrays]
+ * runs the self tests, then prints the nanoseconds per array taken by
+ * sort_small(), the insertionSort() of insertion_sort.c and qsort() to sort
+ * that many random arrays (default 1000000) of 8, 16, 32 and 64 int32 values.
+ */
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sort_small.h"
+
+/** 32 random bits */
+static uint32_t random32(void)
+{
+    return (uint32_t)rand() << 16 ^ (uint32_t)rand();
+}
+
+/** comparison of int32 values for qsort() */
+static int compare_int32(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/** comparison of floats for qsort(), -0 before +0 like sort_small_float() */
+static int compare_float(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    if (x == y)
+        return signbit(y) - signbit(x) ? (signbit(x) ? -1 : 1) : 0;
+    return (x > y) - (x < y);
+}
+
+/** insertionSort() of insertion_sort.c */
+static void insertionSort(int32_t *arr, int size)
+{
+    for (int i = 1; i < size; i++)
+    {
+        int j = i - 1;
+        int32_t key = arr[i];
+        while (j >= 0 && key < arr[j])
+        {
+            arr[j + 1] = arr[j];
+            j = j - 1;
+        }
+        arr[j + 1] = key;
+    }
+}
+
+/** Test function
+ * @param n number of elements to sort
+ * @param range values are drawn from [0, range), or any int32 if 0
+ */
+static void test(size_t n, uint32_t range)
+{
+    int32_t a[100], b[100], padded[SORT_SMALL_MAX];
+    float f[100], g[100];
+    static const float specials[] = {0.0f, -0.0f, INFINITY, -INFINITY,
+                                     1e-40f, -1e-40f, 3.5f, -3.5f};
+
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t r = random32();
+        a[i] = b[i] = range ? (int32_t)(r % range) - (int32_t)range / 2
+                            : (int32_t)r;
+        f[i] = g[i] = r % 4 ? (float)a[i] / 7.0f : specials[r / 4 % 8];
+    }
+    if (n > 2)
+    {
+        a[0] = b[0] = INT32_MAX;
+        a[1] = b[1] = INT32_MIN;
+    }
+
+    sort_small(a, n);
+    qsort(b, n, sizeof(int32_t), compare_int32);
+    assert(n == 0 || memcmp(a, b, n * sizeof(int32_t)) == 0);
+
+    sort_small(f, n);
+    qsort(g, n, sizeof(float), compare_float);
+    assert(n == 0 || memcmp(f, g, n * sizeof(float)) == 0);
+
+    /* the scalar network, whatever the processor */
+    if (n > 0 && n <= SORT_SMALL_MAX)
+    {
+        size_t m = sort_small_padded(n);
+        for (size_t i = 0; i < m; i++)
+            padded[i] = i < n ? (int32_t)random32() : INT32_MAX;
+        memcpy(b, padded, n * sizeof(int32_t));
+        sort_small_scalar(padded, m);
+        qsort(b, n, sizeof(int32_t), compare_int32);
+        assert(memcmp(padded, b, n * sizeof(int32_t)) == 0);
+    }
+
+#ifdef SORT_SMALL_SIMD
+    /* the SSE4.1 network, even where the AVX2 one is picked */
+    if (n > 0 && n <= SORT_SMALL_MAX && sort_small_has_sse41())
+    {
+        size_t m = sort_small_padded(n);
+        for (size_t i = 0; i < m; i++)
+            padded[i] = i < n ? (int32_t)random32() : INT32_MAX;
+        memcpy(b, padded, n * sizeof(int32_t));
+        sort_small_sse41(padded, m);
+        qsort(b, n, sizeof(int32_t), compare_int32);
+        assert(memcmp(padded, b, n * sizeof(int32_t)) == 0);
+    }
+#endif
+}
+
+/** @returns seconds elapsed since start */
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/** Main function */
+int main(int argc, char *argv[])
+{
+    srand(time(NULL));
+
+    for (size_t n = 0; n <= 100; n++)
+    {
+        for (int repeat = 0; repeat < 20; repeat++)
+        {
+            test(n, 0);
+            test(n, 4);
+        }
+    }
+    printf("All tests passed\n\n");
+
+    size_t arrays = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+    int32_t *input = malloc(arrays * SORT_SMALL_MAX * sizeof(int32_t));
+    int32_t *a = malloc(arrays * SORT_SMALL_MAX * sizeof(int32_t));
+    if (arrays == 0 || !input || !a)
+    {
+        printf("Can't Malloc! Please try again.");
+        return 1;
+    }
+    for (size_t i = 0; i < arrays * SORT_SMALL_MAX; i++)
+        input[i] = (int32_t)random32();
+
+    printf("ns per array (%s kernels)\n",
+           sort_small_has_avx2()    ? "AVX2"
+           : sort_small_has_sse41() ? "SSE4.1"
+                                    : "scalar");
+    printf("%4s %12s %14s %10s\n", "n", "sort_small", "insertionSort",
+           "qsort");
+    for (size_t n = 8; n <= SORT_SMALL_MAX; n *= 2)
+    {
+        double ns[3];
+        for (int sort = 0; sort < 3; sort++)
+        {
+            memcpy(a, input, arrays * SORT_SMALL_MAX * sizeof(int32_t));
+            clock_t start = clock();
+            for (size_t i = 0; i < arrays; i++)
+            {
+                int32_t *array = a + i * SORT_SMALL_MAX;
+                if (sort == 0)
+                    sort_small(array, n);
+                else if (sort == 1)
+                    insertionSort(array, (int)n);
+                else
+                    qsort(array, n, sizeof(int32_t), compare_int32);
+            }
+            ns[sort] = seconds_since(start) * 1e9 / arrays;
+        }
+        printf("%4zu %12.1f %14.1f %10.1f\n", n, ns[0], ns[1], ns[2]);
+    }
+
+    free(input);
+    free(a);
+    return 0;
+}
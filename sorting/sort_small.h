@@ -0,0 +1,436 @@
+/**
+ * @file
+ * @brief [Bitonic sorting
+ * networks](https://en.wikipedia.org/wiki/Bitonic_sorter) for arrays of at
+ * most 64 `int32_t` or `float`, vectorized with AVX2 or SSE4.1.
+ *
+ * `sort_small(a, n)` sorts `n` <= ::SORT_SMALL_MAX elements of an `int32_t`
+ * or `float` array; sort_small_int32() and sort_small_float() are the typed
+ * functions. The elements are copied into a buffer padded to 8, 16, 32 or
+ * 64 elements with the largest key. The buffer is sorted by a bitonic
+ * network, which compares the same pairs whatever the data, so it has no
+ * data-dependent branches.
+ *
+ * With AVX2, one 256-bit register holds 8 keys. Each register is sorted by
+ * six min/max steps between its lanes, then sorted registers are merged
+ * pairwise: the second run is reversed, a min/max against the first splits
+ * the pair into a low and a high bitonic half, and each half is merged by
+ * min/max between registers and then within them. Without AVX2, SSE4.1
+ * runs the same merges on 128-bit registers of 4 keys with `_mm_min_epi32`
+ * and `_mm_max_epi32`. The processor is checked once at run time, as in
+ * hash_batch.h. Without either the same network runs on scalar code, with
+ * branch-free compare-exchanges.
+ *
+ * Floats are sorted as integers: flipping the 31 value bits of negative
+ * floats orders their bit patterns like the floats. -0 sorts before +0, and
+ * NaNs go to the end, or to the front if their sign bit is set.
+ *
+ * The networks are not stable; they are meant for keys whose equal values
+ * are interchangeable, and as the leaves of introsort.h and merge_sort.h.
+ */
+#ifndef SORT_SMALL_H
+#define SORT_SMALL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SORT_SMALL_SIMD 1 /**< the AVX2 and SSE4.1 kernels are compiled in */
+#include <immintrin.h>
+/** enables AVX2 code generation for a single function */
+#define SORT_SMALL_TARGET_AVX2 __attribute__((target("avx2")))
+/** enables SSE4.1 code generation for a single function */
+#define SORT_SMALL_TARGET_SSE41 __attribute__((target("sse4.1")))
+#endif
+
+/** largest number of elements sorted by a network */
+#define SORT_SMALL_MAX 64
+
+/** @cond internals of sort_small() */
+/* bitonic sort of m = 8, 16, 32 or 64 keys */
+static inline void sort_small_scalar(int32_t *a, size_t m)
+{
+    for (size_t k = 2; k <= m; k *= 2)
+    {
+        for (size_t j = k / 2; j > 0; j /= 2)
+        {
+            for (size_t i = 0; i < m; i++)
+            {
+                size_t l = i ^ j;
+                if (l > i)
+                {
+                    int32_t x = a[i], y = a[l];
+                    int32_t lo = x < y ? x : y, hi = x < y ? y : x;
+                    int up = (i & k) == 0;
+                    a[i] = up ? lo : hi;
+                    a[l] = up ? hi : lo;
+                }
+            }
+        }
+    }
+}
+
+#ifdef SORT_SMALL_SIMD
+/* lanes marked in `max_lanes` take the larger of each pair */
+#define SORT_SMALL_STEP(v, partner, max_lanes)                                 \
+    do                                                                         \
+    {                                                                          \
+        __m256i p_ = (partner);                                                \
+        (v) = _mm256_blend_epi32(_mm256_min_epi32((v), p_),                   \
+                                 _mm256_max_epi32((v), p_), (max_lanes));     \
+    } while (0)
+/* partners of the lanes at distances 4, 2 and 1 */
+#define SORT_SMALL_FAR(v) _mm256_permute2x128_si256((v), (v), 0x01)
+#define SORT_SMALL_NEAR2(v) _mm256_shuffle_epi32((v), 0x4E)
+#define SORT_SMALL_NEAR1(v) _mm256_shuffle_epi32((v), 0xB1)
+
+/* sorts the 8 lanes of v */
+static inline SORT_SMALL_TARGET_AVX2 __m256i sort_small_lanes(__m256i v)
+{
+    SORT_SMALL_STEP(v, SORT_SMALL_NEAR1(v), 0x66);
+    SORT_SMALL_STEP(v, SORT_SMALL_NEAR2(v), 0x3C);
+    SORT_SMALL_STEP(v, SORT_SMALL_NEAR1(v), 0x5A);
+    SORT_SMALL_STEP(v, SORT_SMALL_FAR(v), 0xF0);
+    SORT_SMALL_STEP(v, SORT_SMALL_NEAR2(v), 0xCC);
+    SORT_SMALL_STEP(v, SORT_SMALL_NEAR1(v), 0xAA);
+    return v;
+}
+
+/* sorts the 8 lanes of v, which are bitonic */
+static inline SORT_SMALL_TARGET_AVX2 __m256i sort_small_merge_lanes(__m256i v)
+{
+    SORT_SMALL_STEP(v, SORT_SMALL_FAR(v), 0xF0);
+    SORT_SMALL_STEP(v, SORT_SMALL_NEAR2(v), 0xCC);
+    SORT_SMALL_STEP(v, SORT_SMALL_NEAR1(v), 0xAA);
+    return v;
+}
+
+/* sorts the 8 k keys of v[0..k), which are bitonic */
+static inline SORT_SMALL_TARGET_AVX2 void sort_small_bitonic(__m256i *v,
+                                                             int k)
+{
+    for (int d = k / 2; d > 0; d /= 2)
+    {
+        for (int i = 0; i < k; i++)
+        {
+            if (!(i & d))
+            {
+                __m256i lo = _mm256_min_epi32(v[i], v[i + d]);
+                v[i + d] = _mm256_max_epi32(v[i], v[i + d]);
+                v[i] = lo;
+            }
+        }
+    }
+    for (int i = 0; i < k; i++) v[i] = sort_small_merge_lanes(v[i]);
+}
+
+/* merges the sorted runs v[0..w) and v[w..2w) */
+static inline SORT_SMALL_TARGET_AVX2 void sort_small_merge(__m256i *v, int w)
+{
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    for (int i = 0; i < w / 2; i++)
+    {
+        __m256i t = v[w + i];
+        v[w + i] = v[2 * w - 1 - i];
+        v[2 * w - 1 - i] = t;
+    }
+    for (int i = 0; i < w; i++)
+    {
+        __m256i b = _mm256_permutevar8x32_epi32(v[w + i], reverse);
+        v[w + i] = _mm256_max_epi32(v[i], b);
+        v[i] = _mm256_min_epi32(v[i], b);
+    }
+    sort_small_bitonic(v, w);
+    sort_small_bitonic(v + w, w);
+}
+
+/* sorts the 8 k keys of a, k = 1, 2, 4 or 8 */
+static inline SORT_SMALL_TARGET_AVX2 void sort_small_avx2_k(int32_t *a,
+                                                            int k)
+{
+    __m256i v[8];
+    for (int i = 0; i < k; i++)
+    {
+        v[i] = sort_small_lanes(_mm256_loadu_si256((const __m256i *)a + i));
+    }
+    for (int w = 1; w < k; w *= 2)
+    {
+        for (int i = 0; i < k; i += 2 * w) sort_small_merge(v + i, w);
+    }
+    for (int i = 0; i < k; i++) _mm256_storeu_si256((__m256i *)a + i, v[i]);
+}
+
+/* one body per size, so every loop above has a constant trip count */
+static SORT_SMALL_TARGET_AVX2 void sort_small_avx2(int32_t *a, size_t m)
+{
+    switch (m)
+    {
+    case 8:
+        sort_small_avx2_k(a, 1);
+        break;
+    case 16:
+        sort_small_avx2_k(a, 2);
+        break;
+    case 32:
+        sort_small_avx2_k(a, 4);
+        break;
+    default:
+        sort_small_avx2_k(a, 8);
+        break;
+    }
+}
+#undef SORT_SMALL_STEP
+#undef SORT_SMALL_FAR
+#undef SORT_SMALL_NEAR2
+#undef SORT_SMALL_NEAR1
+
+/* the SSE4.1 kernels: the same network on registers of 4 keys */
+#define SORT_SMALL_STEP(v, partner, max_lanes)                                 \
+    do                                                                         \
+    {                                                                          \
+        __m128i p_ = (partner);                                                \
+        (v) = _mm_blend_epi16(_mm_min_epi32((v), p_), _mm_max_epi32((v), p_),  \
+                              (max_lanes));                                    \
+    } while (0)
+/* partners of the lanes at distances 2 and 1 */
+#define SORT_SMALL_NEAR2(v) _mm_shuffle_epi32((v), 0x4E)
+#define SORT_SMALL_NEAR1(v) _mm_shuffle_epi32((v), 0xB1)
+
+/* sorts the 4 lanes of v; the masks select 16-bit halves, two per lane */
+static inline SORT_SMALL_TARGET_SSE41 __m128i sort_small_sse41_lanes(__m128i v)
+{
+    SORT_SMALL_STEP(v, SORT_SMALL_NEAR1(v), 0x3C);
+    SORT_SMALL_STEP(v, SORT_SMALL_NEAR2(v), 0xF0);
+    SORT_SMALL_STEP(v, SORT_SMALL_NEAR1(v), 0xCC);
+    return v;
+}
+
+/* sorts the 4 lanes of v, which are bitonic */
+static inline SORT_SMALL_TARGET_SSE41 __m128i
+sort_small_sse41_merge_lanes(__m128i v)
+{
+    SORT_SMALL_STEP(v, SORT_SMALL_NEAR2(v), 0xF0);
+    SORT_SMALL_STEP(v, SORT_SMALL_NEAR1(v), 0xCC);
+    return v;
+}
+
+/* sorts the 4 k keys of v[0..k), which are bitonic */
+static inline SORT_SMALL_TARGET_SSE41 void sort_small_sse41_bitonic(__m128i *v,
+                                                                    int k)
+{
+    for (int d = k / 2; d > 0; d /= 2)
+    {
+        for (int i = 0; i < k; i++)
+        {
+            if (!(i & d))
+            {
+                __m128i lo = _mm_min_epi32(v[i], v[i + d]);
+                v[i + d] = _mm_max_epi32(v[i], v[i + d]);
+                v[i] = lo;
+            }
+        }
+    }
+    for (int i = 0; i < k; i++) v[i] = sort_small_sse41_merge_lanes(v[i]);
+}
+
+/* merges the sorted runs v[0..w) and v[w..2w) */
+static inline SORT_SMALL_TARGET_SSE41 void sort_small_sse41_merge(__m128i *v,
+                                                                  int w)
+{
+    for (int i = 0; i < w / 2; i++)
+    {
+        __m128i t = v[w + i];
+        v[w + i] = v[2 * w - 1 - i];
+        v[2 * w - 1 - i] = t;
+    }
+    for (int i = 0; i < w; i++)
+    {
+        __m128i b = _mm_shuffle_epi32(v[w + i], 0x1B);
+        v[w + i] = _mm_max_epi32(v[i], b);
+        v[i] = _mm_min_epi32(v[i], b);
+    }
+    sort_small_sse41_bitonic(v, w);
+    sort_small_sse41_bitonic(v + w, w);
+}
+
+/* sorts the 4 k keys of a, k = 2, 4, 8 or 16 */
+static inline SORT_SMALL_TARGET_SSE41 void sort_small_sse41_k(int32_t *a,
+                                                              int k)
+{
+    __m128i v[16];
+    for (int i = 0; i < k; i++)
+    {
+        v[i] = sort_small_sse41_lanes(_mm_loadu_si128((const __m128i *)a + i));
+    }
+    for (int w = 1; w < k; w *= 2)
+    {
+        for (int i = 0; i < k; i += 2 * w) sort_small_sse41_merge(v + i, w);
+    }
+    for (int i = 0; i < k; i++) _mm_storeu_si128((__m128i *)a + i, v[i]);
+}
+
+/* one body per size, so every loop above has a constant trip count */
+static SORT_SMALL_TARGET_SSE41 void sort_small_sse41(int32_t *a, size_t m)
+{
+    switch (m)
+    {
+    case 8:
+        sort_small_sse41_k(a, 2);
+        break;
+    case 16:
+        sort_small_sse41_k(a, 4);
+        break;
+    case 32:
+        sort_small_sse41_k(a, 8);
+        break;
+    default:
+        sort_small_sse41_k(a, 16);
+        break;
+    }
+}
+#undef SORT_SMALL_STEP
+#undef SORT_SMALL_NEAR2
+#undef SORT_SMALL_NEAR1
+#endif /* SORT_SMALL_SIMD */
+
+/* @returns nonzero if the AVX2 kernels may be used */
+static inline int sort_small_has_avx2(void)
+{
+#if defined(__AVX2__)
+    return 1;
+#elif defined(SORT_SMALL_SIMD)
+    static int avx2 = -1;
+    if (avx2 < 0)
+        avx2 = __builtin_cpu_supports("avx2") != 0;
+    return avx2;
+#else
+    return 0;
+#endif
+}
+
+/* @returns nonzero if the SSE4.1 kernels may be used */
+static inline int sort_small_has_sse41(void)
+{
+#if defined(__SSE4_1__)
+    return 1;
+#elif defined(SORT_SMALL_SIMD)
+    static int sse41 = -1;
+    if (sse41 < 0)
+        sse41 = __builtin_cpu_supports("sse4.1") != 0;
+    return sse41;
+#else
+    return 0;
+#endif
+}
+
+/* sorts n keys through a buffer padded to m = 8, 16, 32 or 64 keys */
+static inline void sort_small_keys(int32_t *keys, size_t m)
+{
+#ifdef SORT_SMALL_SIMD
+    if (sort_small_has_avx2())
+    {
+        sort_small_avx2(keys, m);
+        return;
+    }
+    if (sort_small_has_sse41())
+    {
+        sort_small_sse41(keys, m);
+        return;
+    }
+#endif
+    sort_small_scalar(keys, m);
+}
+
+/* @returns the padded size for n keys */
+static inline size_t sort_small_padded(size_t n)
+{
+    size_t m = 8;
+    while (m < n) m *= 2;
+    return m;
+}
+
+/* int32 bit pattern of a float ordered like the floats; its own inverse */
+static inline int32_t sort_small_float_key(int32_t x)
+{
+    return x ^ (int32_t)((uint32_t)(x >> 31) >> 1);
+}
+
+/* the order of sort_small_float() */
+static inline int sort_small_float_less(float x, float y)
+{
+    int32_t a, b;
+    memcpy(&a, &x, sizeof(a));
+    memcpy(&b, &y, sizeof(b));
+    return sort_small_float_key(a) < sort_small_float_key(b);
+}
+/** @endcond */
+
+/**
+ * Sorts n int32 values in ascending order. n must be at most
+ * ::SORT_SMALL_MAX; larger arrays are insertion sorted.
+ */
+static inline void sort_small_int32(int32_t *a, size_t n)
+{
+    if (n > SORT_SMALL_MAX)
+    {
+        for (size_t i = 1; i < n; i++)
+        {
+            int32_t key = a[i];
+            size_t j = i;
+            for (; j > 0 && key < a[j - 1]; j--) a[j] = a[j - 1];
+            a[j] = key;
+        }
+        return;
+    }
+    if (n < 2)
+    {
+        return;
+    }
+
+    int32_t keys[SORT_SMALL_MAX];
+    size_t m = sort_small_padded(n);
+    memcpy(keys, a, n * sizeof(int32_t));
+    for (size_t i = n; i < m && i < SORT_SMALL_MAX; i++) keys[i] = INT32_MAX;
+    sort_small_keys(keys, m);
+    memcpy(a, keys, n * sizeof(int32_t));
+}
+
+/**
+ * Sorts n floats in ascending order, -0 before +0. n must be at most
+ * ::SORT_SMALL_MAX; larger arrays are insertion sorted.
+ */
+static inline void sort_small_float(float *a, size_t n)
+{
+    if (n > SORT_SMALL_MAX)
+    {
+        for (size_t i = 1; i < n; i++)
+        {
+            float key = a[i];
+            size_t j = i;
+            for (; j > 0 && sort_small_float_less(key, a[j - 1]); j--)
+                a[j] = a[j - 1];
+            a[j] = key;
+        }
+        return;
+    }
+    if (n < 2)
+    {
+        return;
+    }
+
+    int32_t keys[SORT_SMALL_MAX];
+    size_t m = sort_small_padded(n);
+    memcpy(keys, a, n * sizeof(float));
+    for (size_t i = 0; i < n; i++) keys[i] = sort_small_float_key(keys[i]);
+    for (size_t i = n; i < m && i < SORT_SMALL_MAX; i++) keys[i] = INT32_MAX;
+    sort_small_keys(keys, m);
+    for (size_t i = 0; i < n; i++) keys[i] = sort_small_float_key(keys[i]);
+    memcpy(a, keys, n * sizeof(float));
+}
+
+/** sorts n <= ::SORT_SMALL_MAX elements of an `int32_t` or `float` array */
+#define sort_small(a, n) \
+    _Generic((a), int32_t *: sort_small_int32, float *: sort_small_float)(a, n)
+
+#endif /* SORT_SMALL_H */
@@ -1,4 +1,7 @@
 #include <stdio.h>
+
+#include "stooge_sort.h"
+
 void stoogesort(int[], int, int);
 
 int main()
@@ -18,19 +21,9 @@ int main()
     return 0;
 }
 
+/* sorts arr[i..j] with the stooge sort of stooge_sort.h */
 void stoogesort(int arr[], int i, int j)
 {
-    int temp, k;
-    if (arr[i] > arr[j])
-    {
-        temp = arr[i];
-        arr[i] = arr[j];
-        arr[j] = temp;
-    }
-    if ((i + 1) >= j)
-        return;
-    k = (int)((j - i + 1) / 3);
-    stoogesort(arr, i, j - k);
-    stoogesort(arr, i + k, j);
-    stoogesort(arr, i, j - k);
+    if (i < j)
+        stooge_sort_int(arr + i, (size_t)(j - i + 1));
 }
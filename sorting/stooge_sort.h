@@ -0,0 +1,44 @@
+/**
+ * @file
+ * @brief [Stooge sort](https://en.wikipedia.org/wiki/Stooge_sort)
+ *
+ * `DEFINE_STOOGE_SORT(name, type, less, swap)` defines
+ * `static inline void name(type *a, size_t n)` with the hooks of
+ * sort_hooks.h. `stooge_sort_int` is provided for `int`.
+ *
+ * After ordering the ends of a range, the sort recursively sorts its first
+ * two thirds, its last two thirds and its first two thirds again:
+ * O(n^(log 3 / log 1.5)) = O(n^2.71) comparisons.
+ */
+#ifndef STOOGE_SORT_H
+#define STOOGE_SORT_H
+
+#include <stddef.h>
+
+#include "sort_hooks.h"
+
+/** Defines `static inline void name(type *a, size_t n)`, a stooge sort. */
+#define DEFINE_STOOGE_SORT(name, type, less, swap)                             \
+    /* sorts a[i..j] */                                                        \
+    static void name##_range(type *a, size_t i, size_t j)                      \
+    {                                                                          \
+        if (less(&a[j], &a[i]))                                                \
+            swap(type, &a[i], &a[j]);                                          \
+        if (j - i + 1 > 2)                                                     \
+        {                                                                      \
+            size_t third = (j - i + 1) / 3;                                    \
+            name##_range(a, i, j - third);                                     \
+            name##_range(a, i + third, j);                                     \
+            name##_range(a, i, j - third);                                     \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void name(type *a, size_t n)                                 \
+    {                                                                          \
+        if (n > 1)                                                             \
+            name##_range(a, 0, n - 1);                                         \
+    }
+
+DEFINE_STOOGE_SORT(stooge_sort_int, int, SORT_LESS, SORT_SWAP)
+
+#endif /* STOOGE_SORT_H */
@@ -0,0 +1,269 @@
+/**
+ * @file
+ * @brief Tests and benchmark of the string sort of string_sort.h.
+ *
+ * usage: ./string_sort [number of strings]
+ * runs the self tests, then times string_sort(), the multikey quicksort
+ * ssort2() of multikey_quick_sort.c and qsort() with strcmp() on that many
+ * random URLs (default 1000000), which share long prefixes.
+ */
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "string_sort.h"
+
+/** @cond ssort2() of multikey_quick_sort.c */
+#define min(a, b) ((a) <= (b) ? (a) : (b))
+#define swap2(a, b)  \
+    {                \
+        t = *(a);    \
+        *(a) = *(b); \
+        *(b) = t;    \
+    }
+#define ptr2char(i) (*(*(i) + depth))
+
+static void vecswap2(char **a, char **b, int n)
+{
+    while (n-- > 0)
+    {
+        char *t = *a;
+        *a++ = *b;
+        *b++ = t;
+    }
+}
+
+static char **med3func(char **a, char **b, char **c, int depth)
+{
+    int va, vb, vc;
+    if ((va = ptr2char(a)) == (vb = ptr2char(b)))
+        return a;
+    if ((vc = ptr2char(c)) == va || vc == vb)
+        return c;
+    return va < vb ? (vb < vc ? b : (va < vc ? c : a))
+                   : (vb > vc ? b : (va < vc ? a : c));
+}
+#define med3(a, b, c) med3func(a, b, c, depth)
+
+static void inssort(char **a, int n, int d)
+{
+    char **pi, **pj, *s, *t;
+    for (pi = a + 1; --n > 0; pi++)
+        for (pj = pi; pj > a; pj--)
+        {
+            for (s = *(pj - 1) + d, t = *pj + d; *s == *t && *s != 0; s++, t++)
+                ;
+            if (*s <= *t)
+                break;
+            swap2(pj, pj - 1);
+        }
+}
+
+static void ssort2(char **a, int n, int depth)
+{
+    int d, r, partval;
+    char **pa, **pb, **pc, **pd, **pl, **pm, **pn, *t;
+    if (n < 10)
+    {
+        inssort(a, n, depth);
+        return;
+    }
+    pl = a;
+    pm = a + (n / 2);
+    pn = a + (n - 1);
+    if (n > 30)
+    {
+        d = (n / 8);
+        pl = med3(pl, pl + d, pl + 2 * d);
+        pm = med3(pm - d, pm, pm + d);
+        pn = med3(pn - 2 * d, pn - d, pn);
+    }
+    pm = med3(pl, pm, pn);
+    swap2(a, pm);
+    partval = ptr2char(a);
+    pa = pb = a + 1;
+    pc = pd = a + n - 1;
+    for (;;)
+    {
+        while (pb <= pc && (r = ptr2char(pb) - partval) <= 0)
+        {
+            if (r == 0)
+            {
+                swap2(pa, pb);
+                pa++;
+            }
+            pb++;
+        }
+        while (pb <= pc && (r = ptr2char(pc) - partval) >= 0)
+        {
+            if (r == 0)
+            {
+                swap2(pc, pd);
+                pd--;
+            }
+            pc--;
+        }
+        if (pb > pc)
+            break;
+        swap2(pb, pc);
+        pb++;
+        pc--;
+    }
+    pn = a + n;
+    r = min(pa - a, pb - pa);
+    vecswap2(a, pb - r, r);
+    r = min(pd - pc, pn - pd - 1);
+    vecswap2(pb, pn - r, r);
+    if ((r = pb - pa) > 1)
+        ssort2(a, r, depth);
+    if (ptr2char(a + r) != 0)
+        ssort2(a + r, pa - a + pn - pd - 1, depth + 1);
+    if ((r = pd - pc) > 1)
+        ssort2(a + n - r, r, depth);
+}
+/** @endcond */
+
+/** comparison of two strings for qsort() */
+static int compare_strings(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * writes a random URL of at most `size` bytes to `s`. There are few hosts
+ * and path words, so many URLs share long prefixes and some are equal.
+ */
+static void random_url(char *s, size_t size)
+{
+    static const char *const words[] = {"index", "news", "articles", "2024",
+                                        "products", "item", "search", "a",
+                                        "user", "profile", "en", "static"};
+    const size_t nwords = sizeof(words) / sizeof(words[0]);
+    int length = snprintf(s, size, "https://www.host%d.example.com",
+                          rand() % 64);
+    int segments = rand() % 6;
+
+    for (int i = 0; i < segments && (size_t)length < size; i++)
+    {
+        length += snprintf(s + length, size - length, "/%s",
+                           words[rand() % nwords]);
+    }
+    if ((size_t)length < size && rand() % 2)
+    {
+        snprintf(s + length, size - length, "?id=%d", rand() % 1000);
+    }
+}
+
+/** Test function
+ * @param n number of strings to sort
+ * @param kind 0 for random URLs, 1 for short random strings of all bytes,
+ * 2 for strings that are all equal or prefixes of each other
+ */
+static void test(size_t n, int kind)
+{
+    const size_t size = 96;
+    char *text = malloc(n * size + 1);
+    char **a = malloc(n * sizeof(char *)), **b = malloc(n * sizeof(char *));
+    assert(n == 0 || (text && a && b));
+
+    for (size_t i = 0; i < n; i++)
+    {
+        char *s = text + i * size;
+        if (kind == 0)
+        {
+            random_url(s, size);
+        }
+        else if (kind == 1)
+        {
+            size_t length = rand() % 12;
+            for (size_t j = 0; j < length; j++)
+            {
+                s[j] = (char)(rand() % 255 + 1); /* bytes above 127 too */
+            }
+            s[length] = '\0';
+        }
+        else
+        {
+            size_t length = rand() % 40;
+            memset(s, 'x', length);
+            s[length] = '\0';
+        }
+        a[i] = b[i] = s;
+    }
+
+    assert(string_sort(a, n) == 0);
+    qsort(b, n, sizeof(char *), compare_strings);
+    for (size_t i = 0; i < n; i++)
+    {
+        assert(strcmp(a[i], b[i]) == 0);
+    }
+
+    free(text);
+    free(a);
+    free(b);
+}
+
+/** @returns seconds elapsed since start */
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/** Main function */
+int main(int argc, char *argv[])
+{
+    srand(time(NULL));
+
+    const size_t sizes[] = {0, 1, 2, 32, 33, 1000, 100000};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        for (int kind = 0; kind < 3; kind++)
+        {
+            test(sizes[i], kind);
+        }
+    }
+    printf("All tests passed\n\n");
+
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+    const size_t size = 96;
+    char *text = malloc(n * size);
+    char **input = malloc(n * sizeof(char *)), **a = malloc(n * sizeof(char *));
+    if (n == 0 || !text || !input || !a)
+    {
+        printf("Can't Malloc! Please try again.");
+        return 1;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        input[i] = text + i * size;
+        random_url(input[i], size);
+    }
+
+    printf("%zu URLs\n", n);
+    for (int sort = 0; sort < 3; sort++)
+    {
+        static const char *const names[] = {"string_sort", "ssort2", "qsort"};
+        memcpy(a, input, n * sizeof(char *));
+        clock_t start = clock();
+        switch (sort)
+        {
+        case 0:
+            string_sort(a, n);
+            break;
+        case 1:
+            ssort2(a, (int)n, 0);
+            break;
+        default:
+            qsort(a, n, sizeof(char *), compare_strings);
+            break;
+        }
+        printf("%-12s %.3f s\n", names[sort], seconds_since(start));
+    }
+
+    free(text);
+    free(input);
+    free(a);
+    return 0;
+}
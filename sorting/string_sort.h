@@ -0,0 +1,363 @@
+/**
+ * @file
+ * @brief Parallel [multikey
+ * quicksort](https://en.wikipedia.org/wiki/Multi-key_quicksort) of C strings
+ * with cached 8-byte prefixes.
+ *
+ * string_sort() sorts an array of NUL-terminated strings in strcmp() order.
+ * The plain multikey quicksort of multikey_quick_sort.c reads `x[i][depth]`
+ * through the pointer on every comparison, so nearly every character access
+ * is a cache miss. Here every string gets a ::string_sort_item holding its
+ * pointer and the next 8 bytes from the current depth, packed big-endian in
+ * one integer. Partitioning compares these integers only, so one step
+ * advances 8 characters instead of one. The strings are dereferenced again
+ * only to refill the cache of the equal partition, which moves on to the
+ * next 8 bytes.
+ *
+ * Partitions of at most ::STRING_SORT_CUTOFF strings are insertion sorted.
+ * The insertion sort remembers the common prefix of neighbouring strings,
+ * so most steps are decided from those lengths alone and the others read
+ * the strings only past the prefix already known to be shared.
+ *
+ * Each step loops on the largest of its three partitions and sorts the
+ * other two separately, so the recursion depth stays O(log n) per 8
+ * characters. With OpenMP those two are sorted as tasks once they hold at
+ * least ::STRING_SORT_TASK_CUTOFF strings.
+ */
+#ifndef STRING_SORT_H
+#define STRING_SORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** partitions of at most this many strings are insertion sorted */
+#define STRING_SORT_CUTOFF 32
+/** partitions smaller than this are sorted by the task that reaches them */
+#define STRING_SORT_TASK_CUTOFF (1 << 14)
+
+#ifdef _OPENMP
+#define STRING_SORT_PRAGMA(x) _Pragma(x)
+#else
+#define STRING_SORT_PRAGMA(x)
+#endif
+
+/** a string with 8 of its bytes from the current depth */
+typedef struct
+{
+    uint64_t cache; /**< bytes depth..depth+7, first byte highest */
+    char *string;
+} string_sort_item;
+
+/**
+ * @returns the 8 bytes of s from `depth` on, first byte highest, with zero
+ * bytes past the end of the string
+ */
+static inline uint64_t string_sort_prefix(const char *s, size_t depth)
+{
+    const unsigned char *p = (const unsigned char *)s + depth;
+    uint64_t x = 0;
+    int ended = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        x <<= 8;
+        if (!ended)
+        {
+            x |= p[i];
+            ended = p[i] == 0;
+        }
+    }
+    return x;
+}
+
+/** @returns nonzero if the string of the cache ends within its 8 bytes */
+static inline int string_sort_ended(uint64_t cache)
+{
+    return (cache & 0xff) == 0;
+}
+
+/** @cond internals of string_sort() */
+/** @returns the index of the first nonzero byte of x, first byte highest */
+static inline size_t string_sort_first_nonzero(uint64_t x)
+{
+    size_t k = 0;
+    while (k < 8 && (x >> (56 - 8 * k) & 0xff) == 0)
+    {
+        k++;
+    }
+    return k;
+}
+
+/** @returns the index of the first zero byte of x, first byte highest */
+static inline size_t string_sort_first_zero(uint64_t x)
+{
+    size_t k = 0;
+    while (k < 8 && (x >> (56 - 8 * k) & 0xff) != 0)
+    {
+        k++;
+    }
+    return k;
+}
+
+/**
+ * compares x and y, which are known to share their first `h` bytes, and
+ * sets `*lcp` to the length of their common prefix, not counting the NUL
+ * of equal strings. Both caches hold the bytes from `depth`.
+ * @returns negative, zero or positive as x is below, equal to or above y
+ */
+static inline int string_sort_compare_from(const string_sort_item *x,
+                                           const string_sort_item *y,
+                                           size_t h, size_t depth,
+                                           size_t *lcp)
+{
+    if (h < depth + 8)
+    {
+        uint64_t diff = x->cache ^ y->cache;
+        if (diff)
+        {
+            *lcp = depth + string_sort_first_nonzero(diff);
+            return x->cache < y->cache ? -1 : 1;
+        }
+        if (string_sort_ended(x->cache))
+        {
+            *lcp = depth + string_sort_first_zero(x->cache);
+            return 0;
+        }
+        h = depth + 8;
+    }
+
+    const unsigned char *p = (const unsigned char *)x->string;
+    const unsigned char *q = (const unsigned char *)y->string;
+    while (p[h] != 0 && p[h] == q[h])
+    {
+        h++;
+    }
+    *lcp = h;
+    return (int)p[h] - (int)q[h];
+}
+
+/**
+ * LCP-aware insertion sort of at most ::STRING_SORT_CUTOFF items (Bingmann
+ * and Sanders). lcp[k] is the common prefix of a[k - 1] and a[k] in the
+ * sorted front, and moves along with a[k]. The item being inserted moves
+ * left with h, its common prefix with the item right of the gap. A
+ * neighbour whose lcp with that item is above h is greater without reading
+ * a byte, one below h is less, and only on a tie are characters compared,
+ * starting at h.
+ */
+static inline void string_sort_insertion(string_sort_item *a, size_t n,
+                                         size_t depth)
+{
+    size_t lcp[STRING_SORT_CUTOFF];
+
+    for (size_t i = 1; i < n; i++)
+    {
+        string_sort_item key = a[i];
+        size_t h, left;
+
+        if (string_sort_compare_from(&key, &a[i - 1], depth, depth, &h) >= 0)
+        {
+            lcp[i] = h;
+            continue;
+        }
+
+        /* the gap is at j, key is less than a[j + 1] and shares h bytes */
+        size_t j = i - 1;
+        a[i] = a[j];
+        lcp[i] = lcp[j];
+        left = depth;
+        while (j > 0)
+        {
+            /* lcp[j + 1] belongs to a[j + 1] and its old neighbour a[j - 1] */
+            if (lcp[j + 1] < h)
+            {
+                left = lcp[j + 1];
+                break;
+            }
+            if (lcp[j + 1] == h)
+            {
+                if (string_sort_compare_from(&key, &a[j - 1], h, depth,
+                                             &left) >= 0)
+                {
+                    break;
+                }
+                h = left;
+            }
+            a[j] = a[j - 1];
+            lcp[j] = lcp[j - 1];
+            j--;
+        }
+        a[j] = key;
+        lcp[j] = left;
+        lcp[j + 1] = h;
+    }
+}
+
+static inline uint64_t string_sort_median3(uint64_t a, uint64_t b, uint64_t c)
+{
+    return a < b ? (b < c ? b : (a < c ? c : a))
+                 : (b > c ? b : (a < c ? a : c));
+}
+
+/** median of 3 caches, pseudomedian of 9 on large partitions */
+static inline uint64_t string_sort_pivot(const string_sort_item *a, size_t n)
+{
+    size_t m = n / 2, l = n - 1;
+    if (n > 1024)
+    {
+        size_t d = n / 8;
+        return string_sort_median3(
+            string_sort_median3(a[0].cache, a[d].cache, a[2 * d].cache),
+            string_sort_median3(a[m - d].cache, a[m].cache, a[m + d].cache),
+            string_sort_median3(a[l - 2 * d].cache, a[l - d].cache,
+                                a[l].cache));
+    }
+    return string_sort_median3(a[0].cache, a[m].cache, a[l].cache);
+}
+
+static void string_sort_mkqs(string_sort_item *a, size_t n, size_t depth);
+
+/** moves the caches of a[0..n) on to the 8 bytes from `depth` */
+static inline void string_sort_refill(string_sort_item *a, size_t n,
+                                      size_t depth)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        a[i].cache = string_sort_prefix(a[i].string, depth);
+    }
+}
+
+/**
+ * sorts a partition that is not the one the caller loops on, as a task if
+ * it is large; `refill` moves its caches on to `depth` first
+ */
+static inline void string_sort_branch(string_sort_item *a, size_t n,
+                                      size_t depth, int refill)
+{
+    if (n >= STRING_SORT_TASK_CUTOFF)
+    {
+        STRING_SORT_PRAGMA("omp task")
+        {
+            if (refill)
+            {
+                string_sort_refill(a, n, depth);
+            }
+            string_sort_mkqs(a, n, depth);
+        }
+    }
+    else if (n > 1)
+    {
+        if (refill)
+        {
+            string_sort_refill(a, n, depth);
+        }
+        string_sort_mkqs(a, n, depth);
+    }
+}
+
+static void string_sort_mkqs(string_sort_item *a, size_t n, size_t depth)
+{
+    while (n > STRING_SORT_CUTOFF)
+    {
+        uint64_t pivot = string_sort_pivot(a, n);
+
+        /* three-way partition: a[0..lt) < pivot < a[gt..n) */
+        size_t lt = 0, i = 0, gt = n;
+        while (i < gt)
+        {
+            if (a[i].cache < pivot)
+            {
+                string_sort_item t = a[lt];
+                a[lt++] = a[i];
+                a[i++] = t;
+            }
+            else if (a[i].cache > pivot)
+            {
+                string_sort_item t = a[--gt];
+                a[gt] = a[i];
+                a[i] = t;
+            }
+            else
+            {
+                i++;
+            }
+        }
+
+        /*
+         * Loop on the largest partition and branch off the other two, so
+         * that the stack holds O(log n) frames per 8 characters. Equal
+         * caches that end the strings hold equal strings and are done.
+         */
+        size_t less = lt, greater = n - gt;
+        size_t equal = string_sort_ended(pivot) ? 0 : gt - lt;
+        if (equal >= less && equal >= greater)
+        {
+            string_sort_branch(a, less, depth, 0);
+            string_sort_branch(a + gt, greater, depth, 0);
+            a += lt;
+            n = equal;
+            depth += 8;
+            string_sort_refill(a, n, depth);
+        }
+        else if (less >= greater)
+        {
+            string_sort_branch(a + lt, equal, depth + 8, 1);
+            string_sort_branch(a + gt, greater, depth, 0);
+            n = less;
+        }
+        else
+        {
+            string_sort_branch(a, less, depth, 0);
+            string_sort_branch(a + lt, equal, depth + 8, 1);
+            a += gt;
+            n = greater;
+        }
+    }
+    string_sort_insertion(a, n, depth);
+}
+/** @endcond */
+
+/**
+ * Sorts n strings in strcmp() order.
+ * @returns 0 on success, -1 if the array of cached prefixes cannot be
+ * allocated, in which case `a` is left unchanged
+ */
+static inline int string_sort(char **a, size_t n)
+{
+    if (n < 2)
+    {
+        return 0;
+    }
+    string_sort_item *items =
+        (string_sort_item *)malloc(n * sizeof(string_sort_item));
+    if (!items)
+    {
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        items[i].cache = string_sort_prefix(a[i], 0);
+        items[i].string = a[i];
+    }
+
+    if (n < STRING_SORT_TASK_CUTOFF)
+    {
+        string_sort_mkqs(items, n, 0);
+    }
+    else
+    {
+        STRING_SORT_PRAGMA("omp parallel")
+        STRING_SORT_PRAGMA("omp single")
+        string_sort_mkqs(items, n, 0);
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        a[i] = items[i].string;
+    }
+    free(items);
+    return 0;
+}
+
+#endif /* STRING_SORT_H */